@@ -0,0 +1,556 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    grig-bench.c
+ *  \ingroup main
+ *  \brief   Daemon benchmark.
+ *
+ * This program runs the rig daemon without the GUI for a fixed time while
+ * changing the frequency at a regular interval, like a user turning the
+ * dial, and prints the measured performance:
+ *
+ *  - commands per second and bus utilisation,
+ *  - daemon cycle time,
+ *  - latency from rig_data_set_freq() to the execution of rig_set_freq(),
+ *  - CPU time per command,
+ *  - execution time and errors of each command.
+ *
+ * The output has one key=value pair per line so that the results of
+ * different builds can be compared with diff or a script. By default the
+ * simulated rig (see rig-sim.c) is used; any Hamlib model can be selected
+ * with -m.
+ *
+ * With -N several rigs of the same model are run at the same time, each
+ * with its own daemon, to measure how the throughput scales with the
+ * number of rigs. The totals are summed over the rigs; the histograms are
+ * those of the first rig.
+ *
+ * With --check-post, a test is run instead of the benchmark: a frequency
+ * is set again while the previous one is being sent to the rig, and both
+ * must be applied. The exit status is 0 if the test passed.
+ *
+ * The capability cache in ~/.grig/caps is disabled, so every run probes
+ * the rig and the user's cache is left alone.
+ */
+#include <stdlib.h>
+#include <time.h>
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <hamlib/rig.h>
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+#ifdef HAVE_GETOPT_H
+#  include <getopt.h>
+#endif
+#include "grig-debug.h"
+#include "rig-daemon.h"
+#include "rig-daemon-cache.h"
+#include "rig-daemon-prof.h"
+#include "rig-data.h"
+#include "rig-gui-smeter.h"
+#include "rig-sim.h"
+
+
+#define C_BENCH_DEF_DURATION  30     /*!< Default duration of the run [sec] */
+#define C_BENCH_DEF_INTERVAL  200    /*!< Default interval between frequency changes [msec] */
+
+
+static gint     rignum    = C_RIG_SIM_MODEL;  /*!< Rig model. */
+static gchar   *rigfile   = NULL;    /*!< Rig port. */
+static gint     rigspeed  = 0;       /*!< Serial speed. */
+static gchar   *rigconf   = NULL;    /*!< Conf parameters. */
+static gint     delay     = 0;       /*!< Command delay. */
+static gint     debug     = RIG_DEBUG_NONE;  /*!< Debug level. */
+static gint     duration  = C_BENCH_DEF_DURATION;  /*!< Duration of the run [sec]. */
+static gint     interval  = C_BENCH_DEF_INTERVAL;  /*!< Interval between frequency changes [msec]. */
+static gboolean nothread  = FALSE;   /*!< Run the daemon as a timeout callback. */
+static gint     rigs      = 1;       /*!< Number of rigs run at the same time. */
+static gboolean checkpost = FALSE;   /*!< Run the repost test instead of the benchmark. */
+
+static rig_daemon_hist_t setlat;     /*!< Set-to-apply latency of RIG_CMD_SET_FREQ_1. */
+static guint             setcount;   /*!< Number of rig_data_set_freq() calls. */
+static guint             applied[C_MAX_RIGS];  /*!< Number of latencies seen so far. */
+static gint64            started;    /*!< Time spent in rig_daemon_start() [usec]. */
+
+
+/** \brief Short options. */
+#define SHORT_OPTIONS "m:r:s:C:d:D:t:i:N:nPh"
+
+/** \brief Table of command line options. */
+static struct option long_options[] =
+{
+	{"model",        1, 0, 'm'},
+	{"rig-file",     1, 0, 'r'},
+	{"speed",        1, 0, 's'},
+	{"set-conf",     1, 0, 'C'},
+	{"debug",        1, 0, 'd'},
+	{"delay",        1, 0, 'D'},
+	{"time",         1, 0, 't'},
+	{"interval",     1, 0, 'i'},
+	{"rigs",         1, 0, 'N'},
+	{"nothread",     0, 0, 'n'},
+	{"check-post",   0, 0, 'P'},
+	{"help",         0, 0, 'h'},
+	{NULL, 0, 0, 0}
+};
+
+
+static gint     grig_bench_check_post (void);
+static gboolean grig_bench_set_freq (gpointer);
+static gboolean grig_bench_stop     (gpointer);
+static void     grig_bench_harvest  (void);
+static void     grig_bench_report   (gint64, clock_t);
+static void     grig_bench_hist     (const gchar *, const rig_daemon_hist_t *);
+static void     grig_bench_help     (void);
+
+
+
+/** \brief Main program.
+ *  \param argc Number of arguments.
+ *  \param argv The arguments.
+ *  \return 0 on success, 1 if the rig could not be started.
+ */
+int
+main (int argc, char *argv[])
+{
+	GMainLoop *loop;
+	gint64     start;
+	clock_t    cpu;
+	gint       i;
+
+
+#ifdef ENABLE_NLS
+	bindtextdomain (PACKAGE, PACKAGE_LOCALE_DIR);
+	bind_textdomain_codeset (PACKAGE, "UTF-8");
+	textdomain (PACKAGE);
+#endif
+
+	while (1) {
+		int c;
+		int option_index = 0;
+
+		c = getopt_long (argc, argv, SHORT_OPTIONS,
+				 long_options, &option_index);
+
+		if (c == -1)
+			break;
+
+		switch (c) {
+
+		case 'm':
+			rignum = atoi (optarg);
+			break;
+
+		case 'r':
+			rigfile = optarg;
+			break;
+
+		case 's':
+			rigspeed = atoi (optarg);
+			break;
+
+		case 'C':
+			rigconf = optarg;
+			break;
+
+		case 'd':
+			debug = atoi (optarg);
+			break;
+
+		case 'D':
+			delay = atoi (optarg);
+			break;
+
+		case 't':
+			duration = MAX (1, atoi (optarg));
+			break;
+
+		case 'i':
+			interval = MAX (1, atoi (optarg));
+			break;
+
+		case 'N':
+			rigs = CLAMP (atoi (optarg), 1, C_MAX_RIGS);
+			break;
+
+		case 'n':
+			nothread = TRUE;
+			break;
+
+		case 'P':
+			checkpost = TRUE;
+			break;
+
+		default:
+			grig_bench_help ();
+			return (c == 'h') ? 0 : 1;
+		}
+	}
+
+	rig_sim_register ();
+	rig_daemon_cache_set_enabled (FALSE);
+
+	/* the test waits in the main thread and needs slow commands */
+	if (checkpost) {
+		rigs = 1;
+		nothread = FALSE;
+		if ((rignum == C_RIG_SIM_MODEL) && (rigconf == NULL)) {
+			rigconf = "latency=100";
+		}
+	}
+
+	grig_debug_set_level (CLAMP (debug, RIG_DEBUG_NONE, RIG_DEBUG_TRACE));
+	grig_debug_init (NULL);
+
+	start = g_get_monotonic_time ();
+
+	for (i = 0; i < rigs; i++) {
+		rig_data_select (i);
+
+		if (rig_daemon_start (rignum, rigfile, rigspeed, NULL, rigconf,
+				      delay, nothread, FALSE, FALSE)) {
+			g_printerr (_("Could not start rig %d\n"), rignum);
+
+			/* stop the rigs that have already been started */
+			while (i-- > 0) {
+				rig_data_select (i);
+				rig_daemon_stop ();
+			}
+
+			grig_debug_close ();
+			return 1;
+		}
+	}
+
+	started = g_get_monotonic_time () - start;
+
+	if (checkpost) {
+		i = grig_bench_check_post ();
+
+		rig_data_select (0);
+		rig_daemon_stop ();
+		grig_debug_close ();
+
+		return i;
+	}
+
+	/* the measurement starts after the capabilities have been probed */
+	for (i = 0; i < rigs; i++) {
+		rig_data_select (i);
+		rig_daemon_prof_init ();
+	}
+
+	start = g_get_monotonic_time ();
+	cpu = clock ();
+
+	loop = g_main_loop_new (NULL, FALSE);
+	g_timeout_add (interval, grig_bench_set_freq, NULL);
+	g_timeout_add_seconds (duration, grig_bench_stop, loop);
+	g_main_loop_run (loop);
+	g_main_loop_unref (loop);
+
+	grig_bench_harvest ();
+	grig_bench_report (g_get_monotonic_time () - start, clock () - cpu);
+
+	for (i = 0; i < rigs; i++) {
+		rig_data_select (i);
+		rig_daemon_stop ();
+	}
+
+	grig_debug_close ();
+
+	return 0;
+}
+
+
+/** \brief TX meter polled by the daemon.
+ *  \return Always SMETER_TX_MODE_POWER.
+ *
+ * The daemon asks the S-meter widget which TX meter to poll; there is no
+ * widget here.
+ */
+smeter_tx_mode_t
+rig_gui_smeter_get_tx_mode ()
+{
+	return SMETER_TX_MODE_POWER;
+}
+
+
+/** \brief Set a value again while it is being sent.
+ *  \return 0 if both values have been applied, 1 otherwise.
+ *
+ * The first frequency is set and, as soon as the daemon has taken the
+ * command from the queue, i.e. while the simulated rig is still busy with
+ * it, the second one. The second frequency must be sent as well and must
+ * end up in 'get'.
+ */
+static gint
+grig_bench_check_post ()
+{
+	rig_daemon_latency_t lat;
+	guint                count;
+	gint64               end;
+	gboolean             ok;
+
+
+	rig_data_select (0);
+
+	rig_daemon_get_latency (RIG_CMD_SET_FREQ_1, &lat);
+	count = lat.count;
+
+	end = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+
+	rig_data_set_freq (1, MHz (14.15));
+
+	while (rig_daemon_cmd_queued (RIG_CMD_SET_FREQ_1) &&
+	       (g_get_monotonic_time () < end)) {
+		g_usleep (1000);
+	}
+
+	rig_data_set_freq (1, MHz (14.25));
+
+	do {
+		g_usleep (10000);
+		rig_daemon_get_latency (RIG_CMD_SET_FREQ_1, &lat);
+	} while ((lat.count < count + 2) && (g_get_monotonic_time () < end));
+
+	ok = (lat.count >= count + 2) && (rig_data_get_freq (1) == MHz (14.25));
+
+	g_print ("check_post.applied=%u\n", lat.count - count);
+	g_print ("check_post.freq=%.0f\n", rig_data_get_freq (1));
+	g_print ("check_post=%s\n", ok ? "ok" : "failed");
+
+	return ok ? 0 : 1;
+}
+
+
+/** \brief Change the frequency.
+ *  \param data Unused.
+ *  \return Always TRUE to keep the timer running.
+ *
+ * The frequency is stepped through 100 kHz in 1 kHz steps so that every
+ * call sets a new value. All rigs get the same frequency.
+ */
+static gboolean
+grig_bench_set_freq (gpointer data)
+{
+	gint i;
+
+	grig_bench_harvest ();
+
+	for (i = 0; i < rigs; i++) {
+		rig_data_select (i);
+		rig_data_set_freq (1, MHz (14.0) + kHz (setcount % 100));
+	}
+
+	setcount++;
+
+	return TRUE;
+}
+
+
+/** \brief End the run.
+ *  \param loop The main loop.
+ *  \return Always FALSE.
+ */
+static gboolean
+grig_bench_stop (gpointer loop)
+{
+	g_main_loop_quit ((GMainLoop *) loop);
+
+	return FALSE;
+}
+
+
+/** \brief Collect the latency of the latest frequency change.
+ *
+ * The daemon keeps only the latest set-to-apply latency of each command,
+ * so it is sampled before each new frequency is set. The latencies of
+ * all rigs go into the same histogram.
+ */
+static void
+grig_bench_harvest ()
+{
+	rig_daemon_latency_t lat;
+	gint                 i;
+
+
+	for (i = 0; i < rigs; i++) {
+		rig_data_select (i);
+
+		if (rig_daemon_get_latency (RIG_CMD_SET_FREQ_1, &lat) && (lat.count > applied[i])) {
+			rig_daemon_prof_add (&setlat, lat.last, FALSE);
+			applied[i] = lat.count;
+		}
+	}
+}
+
+
+/** \brief Print the results.
+ *  \param elapsed Duration of the run [usec].
+ *  \param cpu CPU time used during the run.
+ */
+static void
+grig_bench_report (gint64 elapsed, clock_t cpu)
+{
+	rig_daemon_prof_totals_t totals;
+	rig_daemon_hist_t        hist;
+	rig_daemon_latency_t     stall;
+	gdouble                  cpusec;
+	gdouble                  rate = 0.0;
+	gdouble                  util = 0.0;
+	gdouble                  idle = 0.0;
+	gint64                   stalltotal = 0;
+	gint64                   stallmax = 0;
+	guint                    stallcount = 0;
+	guint                    commands = 0;
+	guint                    i;
+
+
+	cpusec = (gdouble) cpu / CLOCKS_PER_SEC;
+
+	g_print ("model=%d\n", rignum);
+	g_print ("rigs=%d\n", rigs);
+	g_print ("threaded=%d\n", !nothread);
+	g_print ("duration_s=%.3f\n", elapsed / 1.0e6);
+
+	/* each rig runs on its own bus; the rates add up */
+	for (i = 0; i < rigs; i++) {
+		rig_data_select (i);
+		rig_daemon_prof_get_totals (&totals);
+
+		commands += totals.commands;
+
+		if (totals.elapsed) {
+			rate += 1.0e6 * totals.commands / totals.elapsed;
+			util += (gdouble) totals.busy / totals.elapsed / rigs;
+			idle += (gdouble) totals.idle / totals.elapsed / rigs;
+		}
+
+		/* without threads the callback blocks the main loop */
+		if (rig_daemon_get_stall (&stall) && stall.count) {
+			stallcount += stall.count;
+			stalltotal += stall.total;
+			stallmax = MAX (stallmax, stall.max);
+		}
+
+		if (rigs > 1) {
+			g_print ("rig%u.commands=%u\n", i, totals.commands);
+			g_print ("rig%u.cmds_per_sec=%.2f\n", i,
+				 totals.elapsed ? 1.0e6 * totals.commands / totals.elapsed : 0.0);
+		}
+	}
+
+	g_print ("commands=%u\n", commands);
+	g_print ("cmds_per_sec=%.2f\n", rate);
+	g_print ("bus_util=%.4f\n", util);
+	g_print ("idle=%.4f\n", idle);
+	g_print ("cpu_s=%.3f\n", cpusec);
+	g_print ("cpu_per_cmd_us=%.1f\n", commands ? 1.0e6 * cpusec / commands : 0.0);
+	g_print ("set_freq_calls=%u\n", setcount);
+	g_print ("start_ms=%.1f\n", started / 1000.0);
+
+	if (stallcount) {
+		g_print ("stall_mean_ms=%.2f\n", stalltotal / (1000.0 * stallcount));
+		g_print ("stall_max_ms=%.2f\n", stallmax / 1000.0);
+	}
+
+	/* the histograms are those of the first rig */
+	rig_data_select (0);
+	rig_daemon_prof_get_totals (&totals);
+
+	grig_bench_hist ("set_freq_latency", &setlat);
+	grig_bench_hist ("cycle", &totals.cycle);
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		if (rig_daemon_prof_get_cmd (i, &hist) && hist.count) {
+			/* skip the RIG_CMD_ prefix */
+			gchar *name = g_strdup_printf ("cmd.%s", rig_daemon_cmd_to_str (i) + 8);
+
+			grig_bench_hist (name, &hist);
+			g_free (name);
+		}
+	}
+}
+
+
+/** \brief Print a histogram.
+ *  \param name Prefix of the keys.
+ *  \param hist The histogram.
+ */
+static void
+grig_bench_hist (const gchar *name, const rig_daemon_hist_t *hist)
+{
+	g_print ("%s.count=%u\n", name, hist->count);
+	g_print ("%s.errors=%u\n", name, hist->errors);
+	g_print ("%s.mean_us=%" G_GINT64_FORMAT "\n", name,
+		 hist->count ? hist->total / hist->count : 0);
+	g_print ("%s.p50_us=%" G_GINT64_FORMAT "\n", name,
+		 rig_daemon_prof_percentile (hist, 0.50));
+	g_print ("%s.p99_us=%" G_GINT64_FORMAT "\n", name,
+		 rig_daemon_prof_percentile (hist, 0.99));
+	g_print ("%s.max_us=%" G_GINT64_FORMAT "\n", name, hist->max);
+}
+
+
+/** \brief Show help message. */
+static void
+grig_bench_help ()
+{
+	g_print (_("Usage: grig-bench [OPTION]...\n\n"));
+	g_print (_("  -m, --model=ID              "\
+		   "radio model number (default: %d, simulated rig)\n"), C_RIG_SIM_MODEL);
+	g_print (_("  -r, --rig-file=DEVICE       "\
+		   "set device of the radio\n"));
+	g_print (_("  -s, --speed=BAUD            "\
+		   "set transfer rate\n"));
+	g_print (_("  -C, --set-conf=param=val    "\
+		   "set config parameters, eg. latency=10,timeouts=1\n"));
+	g_print (_("  -d, --debug=LEVEL           "\
+		   "set hamlib debug level (0..5)\n"));
+	g_print (_("  -D, --delay=val             "\
+		   "set delay between commands in msec\n"));
+	g_print (_("  -t, --time=SEC              "\
+		   "duration of the run (default: %d)\n"), C_BENCH_DEF_DURATION);
+	g_print (_("  -i, --interval=MSEC         "\
+		   "interval between frequency changes (default: %d)\n"), C_BENCH_DEF_INTERVAL);
+	g_print (_("  -N, --rigs=N                "\
+		   "run N rigs at the same time (1..%d)\n"), C_MAX_RIGS);
+	g_print (_("  -n, --nothread              "\
+		   "run the daemon without threads\n"));
+	g_print (_("  -P, --check-post            "\
+		   "test that a value set during its execution is sent\n"));
+	g_print (_("  -h, --help                  "\
+		   "show this help message and exit\n"));
+	g_print ("\n");
+}
@@ -0,0 +1,233 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    grig-cmdrec.c
+ *  \ingroup debug
+ *  \brief   Command trace recorder.
+ *
+ * The rig daemon can record every executed command in a ring buffer which
+ * is saved to a file on request and when the daemon stops. The file
+ * contains the command names so that it can be read without the daemon,
+ * see grig-replay.c.
+ *
+ * The records are written in the byte order of the writer; the reader
+ * refuses files written with a different byte order.
+ */
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include "grig-cmdrec.h"
+
+
+
+/** \brief Create a ring buffer.
+ *  \param size The number of records to keep.
+ *  \return A new ring buffer.
+ */
+grig_cmdrec_ring_t *
+grig_cmdrec_ring_new (guint size)
+{
+	grig_cmdrec_ring_t *ring;
+
+
+	ring = g_new0 (grig_cmdrec_ring_t, 1);
+	g_mutex_init (&ring->mutex);
+	ring->size = MAX (size, 1);
+	ring->recs = g_new (grig_cmdrec_t, ring->size);
+
+	return ring;
+}
+
+
+/** \brief Free a ring buffer.
+ *  \param ring The ring buffer.
+ */
+void
+grig_cmdrec_ring_free (grig_cmdrec_ring_t *ring)
+{
+	if (ring == NULL)
+		return;
+
+	g_mutex_clear (&ring->mutex);
+	g_free (ring->recs);
+	g_free (ring);
+}
+
+
+/** \brief Add a record.
+ *  \param ring The ring buffer.
+ *  \param rec The record; the oldest record is dropped when the ring is full.
+ */
+void
+grig_cmdrec_ring_add (grig_cmdrec_ring_t *ring, const grig_cmdrec_t *rec)
+{
+	g_mutex_lock (&ring->mutex);
+
+	ring->recs[ring->head] = *rec;
+	ring->head = (ring->head + 1) % ring->size;
+	if (ring->count < ring->size)
+		ring->count++;
+	ring->total++;
+
+	g_mutex_unlock (&ring->mutex);
+}
+
+
+/** \brief Save the records to a file.
+ *  \param ring The ring buffer.
+ *  \param filename The file; an existing file is replaced.
+ *  \param names The command names, indexed by rig_cmd_t.
+ *  \param nnames The number of names.
+ *  \param error Location for the error or NULL.
+ *  \return TRUE if the file has been written.
+ *
+ * The records are copied under the lock and written afterwards, so the
+ * daemon is only held up for the copy. The records stay in the ring.
+ */
+gboolean
+grig_cmdrec_ring_save (grig_cmdrec_ring_t *ring,
+		       const gchar *filename,
+		       const gchar * const *names,
+		       guint nnames,
+		       GError **error)
+{
+	grig_cmdrec_header_t  hdr;
+	GByteArray           *data;
+	guint                 first;
+	guint                 tail;
+	guint                 i;
+	gboolean              ok;
+
+
+	memset (&hdr, 0, sizeof (hdr));
+	memcpy (hdr.magic, GRIG_CMDREC_MAGIC, sizeof (hdr.magic));
+	hdr.bom = GRIG_CMDREC_BOM;
+	hdr.version = 1;
+	hdr.ncmds = nnames;
+
+	data = g_byte_array_new ();
+	g_byte_array_append (data, (const guint8 *) &hdr, sizeof (hdr));
+
+	for (i = 0; i < nnames; i++) {
+		g_byte_array_append (data, (const guint8 *) names[i], strlen (names[i]) + 1);
+	}
+
+	g_mutex_lock (&ring->mutex);
+
+	hdr.count = ring->count;
+	hdr.lost = ring->total - ring->count;
+
+	/* oldest record first */
+	first = (ring->head + ring->size - ring->count) % ring->size;
+	tail = MIN (ring->count, ring->size - first);
+
+	g_byte_array_append (data, (const guint8 *) &ring->recs[first],
+			     tail * sizeof (grig_cmdrec_t));
+	g_byte_array_append (data, (const guint8 *) ring->recs,
+			     (ring->count - tail) * sizeof (grig_cmdrec_t));
+
+	g_mutex_unlock (&ring->mutex);
+
+	memcpy (data->data, &hdr, sizeof (hdr));
+
+	ok = g_file_set_contents (filename, (const gchar *) data->data, data->len, error);
+
+	g_byte_array_free (data, TRUE);
+
+	return ok;
+}
+
+
+/** \brief Load a command trace.
+ *  \param filename The file.
+ *  \param names Array to which the command names are appended (g_free them).
+ *  \param lost Location for the number of lost records or NULL.
+ *  \param error Location for the error or NULL.
+ *  \return An array of grig_cmdrec_t or NULL on error.
+ */
+GArray *
+grig_cmdrec_load (const gchar *filename, GPtrArray *names, guint64 *lost, GError **error)
+{
+	grig_cmdrec_header_t  hdr;
+	GArray               *recs;
+	gchar                *data;
+	gsize                 len;
+	gsize                 pos;
+	gsize                 end;
+	guint                 i;
+
+
+	if (!g_file_get_contents (filename, &data, &len, error))
+		return NULL;
+
+	if (len < sizeof (hdr))
+		goto invalid;
+
+	memcpy (&hdr, data, sizeof (hdr));
+
+	if (memcmp (hdr.magic, GRIG_CMDREC_MAGIC, sizeof (hdr.magic)) ||
+	    (hdr.bom != GRIG_CMDREC_BOM) || (hdr.version != 1))
+		goto invalid;
+
+	pos = sizeof (hdr);
+
+	for (i = 0; i < hdr.ncmds; i++) {
+		end = pos;
+		while ((end < len) && (data[end] != '\0'))
+			end++;
+
+		if (end == len)
+			goto invalid;
+
+		g_ptr_array_add (names, g_strdup (data + pos));
+		pos = end + 1;
+	}
+
+	if ((len - pos) / sizeof (grig_cmdrec_t) < hdr.count)
+		goto invalid;
+
+	recs = g_array_sized_new (FALSE, FALSE, sizeof (grig_cmdrec_t), hdr.count);
+	g_array_append_vals (recs, data + pos, hdr.count);
+
+	if (lost != NULL)
+		*lost = hdr.lost;
+
+	g_free (data);
+
+	return recs;
+
+invalid:
+	g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+		     _("%s is not a command trace of this machine"), filename);
+	g_free (data);
+
+	return NULL;
+}
@@ -0,0 +1,95 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+#ifndef GRIG_CMDREC_H
+#define GRIG_CMDREC_H 1
+
+#include <glib.h>
+
+
+#define GRIG_CMDREC_MAGIC     "GRIGCMD1"   /*!< First bytes of a command trace file. */
+#define GRIG_CMDREC_BOM       0x01020304   /*!< Byte order mark. */
+#define C_CMDREC_DEF_SIZE     100000       /*!< Default number of records kept. */
+
+
+/** \brief File header of a command trace.
+ *
+ * The header is followed by \a ncmds NUL-terminated command names, indexed
+ * by the cmd field of the records, and then by \a count records.
+ */
+typedef struct {
+	gchar    magic[8];   /*!< GRIG_CMDREC_MAGIC */
+	guint32  bom;        /*!< GRIG_CMDREC_BOM in the byte order of the writer. */
+	guint32  version;    /*!< Format version, currently 1. */
+	guint32  ncmds;      /*!< Number of command names. */
+	guint32  count;      /*!< Number of records. */
+	guint64  lost;       /*!< Records overwritten before the trace was saved. */
+} grig_cmdrec_header_t;
+
+
+/** \brief One executed command. */
+typedef struct {
+	gint64   start;      /*!< Monotonic time when the command started [usec]. */
+	guint32  duration;   /*!< Execution time [usec]. */
+	guint16  cmd;        /*!< rig_cmd_t */
+	gint16   retcode;    /*!< Hamlib return code of the last call. */
+	guint64  value;      /*!< Raw bits of the value read or written, 0 if none. */
+} grig_cmdrec_t;
+
+
+/** \brief Ring buffer holding the latest records. */
+typedef struct {
+	GMutex         mutex;   /*!< Protects the ring. */
+	grig_cmdrec_t *recs;    /*!< The records. */
+	guint          size;    /*!< Number of slots. */
+	guint          head;    /*!< Next slot to write. */
+	guint          count;   /*!< Number of valid records. */
+	guint64        total;   /*!< Number of records added so far. */
+} grig_cmdrec_ring_t;
+
+
+grig_cmdrec_ring_t *grig_cmdrec_ring_new  (guint size);
+void                grig_cmdrec_ring_free (grig_cmdrec_ring_t *ring);
+void                grig_cmdrec_ring_add  (grig_cmdrec_ring_t *ring,
+					   const grig_cmdrec_t *rec);
+gboolean            grig_cmdrec_ring_save (grig_cmdrec_ring_t *ring,
+					   const gchar *filename,
+					   const gchar * const *names,
+					   guint nnames,
+					   GError **error);
+
+GArray             *grig_cmdrec_load      (const gchar *filename,
+					   GPtrArray *names,
+					   guint64 *lost,
+					   GError **error);
+
+#endif
@@ -36,10 +36,50 @@
  * hamlib and grig itself. The debug messages are printed on stderr and
  * saved into a file, if the debug handler has been initialised with a file
  * name.
+ *
+ * Between grig_debug_init() and grig_debug_close() the messages are not
+ * written by the caller. Instead, the raw message is formatted into a slot
+ * of a lock-free ring buffer and a writer thread takes care of splitting,
+ * time stamping and writing the messages in batches. This way the daemon
+ * thread never blocks on I/O, even with hamlib at RIG_DEBUG_TRACE. When the
+ * ring is full the message is dropped and counted; the writer reports the
+ * number of dropped messages with the next batch.
+ *
+ * The ring is a bounded multi-producer queue where each slot carries a
+ * sequence number telling whether it is free for the producer that reserved
+ * the position or ready for the writer. Producers announce themselves in a
+ * counter before they look at the running flag; grig_debug_close() clears
+ * the flag, waits for the counter to drop to zero and only then lets the
+ * writer drain the ring and exit, so no message is lost half-written.
+ *
+ * If a log file is given to grig_debug_init() the writer also appends each
+ * batch to it through a large stdio buffer, which is flushed every few
+ * seconds rather than for every line. When the file grows beyond
+ * C_DEBUG_FILE_MAX_SIZE or gets older than C_DEBUG_FILE_MAX_AGE it is
+ * rotated to file.1, file.2 ... keeping C_DEBUG_FILE_KEEP old segments.
+ * Rotated segments can be gzip compressed by a helper thread, see
+ * grig_debug_set_compress(). The file uses the same format as stderr so
+ * that it can be loaded into the message window, unless the binary trace
+ * format has been selected with grig_debug_set_binary(), see grig-trace.c.
+ *
+ * Messages that may repeat on every polling cycle, such as command failures,
+ * should be logged with grig_debug_limited(). It keeps a small table of the
+ * recent messages keyed by rig, call site and text, and drops a message
+ * that is already in the table for C_DEBUG_LIMIT_INTERVAL seconds. The
+ * writer thread logs the number of dropped repeats when the interval has
+ * passed, as does grig_debug_close().
+ *
+ * The writer also keeps the last C_DEBUG_HISTORY lines in memory so that
+ * the message window can show them without reading any file, see
+ * grig_debug_get_history().
  */
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <sys/time.h>
 #include <hamlib/rig.h>
@@ -47,14 +87,83 @@
 #  include <config.h>
 #endif
 #include "grig-debug.h"
+#include "rig-daemon.h"
+#include "grig-trace.h"
+
+
+#define C_DEBUG_RING_SIZE    1024   /*!< Number of slots in the ring (power of 2). */
+#define C_DEBUG_MSG_LEN      512    /*!< Max length of one message incl. NUL. */
+#define C_DEBUG_WRITER_IDLE  50     /*!< Writer thread period in msec. */
+
+#define C_DEBUG_FILE_BUFFER    65536             /*!< Log file stdio buffer size. */
+#define C_DEBUG_FILE_FLUSH     5                 /*!< Log file flush interval in sec. */
+#define C_DEBUG_FILE_MAX_SIZE  (4 * 1024 * 1024) /*!< Rotate log file at this size. */
+#define C_DEBUG_FILE_MAX_AGE   (24 * 3600)       /*!< Rotate log file at this age in sec. */
+#define C_DEBUG_FILE_KEEP      5                 /*!< Number of rotated segments to keep. */
+
+#define C_DEBUG_LIMIT_INTERVAL 60    /*!< Min. time between identical messages in sec. */
+#define C_DEBUG_LIMIT_SITES    64    /*!< Number of messages remembered by grig_debug_limited(). */
+
+#define C_DEBUG_HISTORY        4096  /*!< Number of lines kept for the message window. */
+
 
+/** \brief Message remembered by grig_debug_limited(). */
+typedef struct {
+	const gchar *fmt;   /*!< Format string of the call site; NULL if unused. */
+	gint     rig;       /*!< Rig of the thread that logged it. */
+	gint     level;     /*!< Debug level of the message. */
+	gint64   time;      /*!< When it was last logged or reported (monotonic usec). */
+	guint    repeats;   /*!< Identical messages suppressed since then. */
+	gchar    text[C_DEBUG_MSG_LEN];  /*!< The formatted message. */
+} debug_site_t;
 
 
+/** \brief Raw debug message waiting in the ring buffer. */
+typedef struct {
+	gint     sequence;                 /*!< Slot state, see file description. */
+	gint64   time;                     /*!< Wall clock time in usec. */
+	guint8   source;                   /*!< debug_msg_src_t */
+	guint8   level;                    /*!< enum rig_debug_level_e */
+	guint16  cmd;                      /*!< Command being executed. */
+	gchar    text[C_DEBUG_MSG_LEN];    /*!< Formatted message, may be multi-line. */
+} debug_record_t;
+
 
 static enum rig_debug_level_e dbglvl = RIG_DEBUG_NONE;
+static gint   riglvl[C_MAX_RIGS];          /*!< Level of each rig + 1; 0 uses dbglvl. */
+
+static debug_record_t ring[C_DEBUG_RING_SIZE];
+static gint           ringhead  = 0;      /*!< Next position to reserve. */
+static guint          ringtail  = 0;      /*!< Next position to write (writer only). */
+static gint           dropped   = 0;      /*!< Messages lost because the ring was full. */
+static gint           running   = FALSE;  /*!< Whether messages go into the ring. */
+static gint           posting   = 0;      /*!< Producers between the running check and publishing. */
+static gboolean       stopwriter = FALSE;
+static GThread       *writer    = NULL;
+static GMutex         writermutex;
+static GCond          writercond;
 
 static gchar      *logfname = NULL;
-/*static GIOChannel *logfile  = NULL;*/
+static FILE       *logfile  = NULL;     /*!< Only used by the writer thread. */
+static gchar      *logbuf   = NULL;     /*!< stdio buffer of logfile. */
+static gsize       logsize  = 0;        /*!< Current size of logfile. */
+static gint64      logopened = 0;       /*!< When logfile was started (monotonic usec). */
+static gint64      logflushed = 0;      /*!< Last flush of logfile (monotonic usec). */
+static gboolean    logcompress = FALSE; /*!< Compress rotated segments. */
+static GThread    *compressor = NULL;   /*!< Compresses the last rotated segment. */
+static gboolean    logbinary = FALSE;   /*!< Write a binary trace instead of text. */
+static grig_trace_writer_t tracewriter; /*!< Block being built in binary mode. */
+
+static GPrivate    curcmd;              /*!< Command of the calling thread + 1. */
+static GPrivate    currig;              /*!< Rig of the calling thread + 1. */
+
+static debug_site_t sites[C_DEBUG_LIMIT_SITES];
+static GMutex      sitemutex;
+static guint       suppressed = 0;      /*!< Total number of suppressed messages. */
+
+static gchar      *history[C_DEBUG_HISTORY];  /*!< Last lines written by the writer. */
+static guint64     historyseq = 0;      /*!< Sequence number of the next line. */
+static GMutex      historymutex;
 
 
 const gchar *SRC_TO_STR[] = {N_("NONE"), N_("HAMLIB"), N_("GRIG")};
@@ -63,6 +172,32 @@ const gchar *SRC_TO_STR[] = {N_("NONE"), N_("HAMLIB"), N_("GRIG")};
 static void manage_debug_message (debug_msg_src_t source,
 				  enum rig_debug_level_e debug_level,
 				  const gchar *message);
+static void debug_message_sync   (debug_msg_src_t source,
+				  enum rig_debug_level_e debug_level,
+				  const char *fmt,
+				  va_list ap);
+static void debug_message_queue  (debug_msg_src_t source,
+				  enum rig_debug_level_e debug_level,
+				  const char *fmt,
+				  va_list ap);
+static void debug_message_post   (debug_msg_src_t source,
+				  enum rig_debug_level_e debug_level,
+				  const char *fmt,
+				  va_list ap);
+static guint    debug_ring_drain (GString *out, grig_debug_stamp_t *stamp);
+static gpointer debug_writer     (gpointer data);
+static gboolean debug_file_open  (void);
+static void     debug_file_close (void);
+static void     debug_file_write (const GString *out);
+static void     debug_file_rotate (void);
+static gchar   *debug_file_segment (guint index, gboolean gz);
+static gpointer debug_file_compress (gpointer data);
+static void     debug_sites_flush (gboolean all);
+static void     debug_message_printf (debug_msg_src_t source,
+				      enum rig_debug_level_e debug_level,
+				      const char *fmt,
+				      ...);
+static void     debug_history_add (const GString *out);
 
 
 
@@ -76,11 +211,38 @@ static void manage_debug_message (debug_msg_src_t source,
 void
 grig_debug_init  (gchar *filename)
 {
+	gint i;
 
         if (filename != NULL) {
-                /*** FIXME: open file for write/append ***/
+		g_free (logfname);
+		logfname = g_strdup (filename);
+
+		if (!debug_file_open ()) {
+			g_free (logfname);
+			logfname = NULL;
+		}
         }
 
+	/* reset the ring and start the writer thread */
+	for (i = 0; i < C_DEBUG_RING_SIZE; i++) {
+		ring[i].sequence = i;
+	}
+	ringhead = 0;
+	ringtail = 0;
+	dropped = 0;
+	stopwriter = FALSE;
+
+	writer = g_thread_try_new ("grig-debug", debug_writer, NULL, NULL);
+	if (writer != NULL) {
+		g_atomic_int_set (&running, TRUE);
+	}
+	else if (logfile != NULL) {
+		/* the file is only written by the writer thread */
+		debug_file_close ();
+		g_free (logfname);
+		logfname = NULL;
+	}
+
         /* set debug handler */
         rig_set_debug_callback (grig_debug_hamlib_cb, NULL);
         
@@ -106,10 +268,117 @@ grig_debug_close ()
 			  _("%s: Shutting down debug handler."),
 			  __FUNCTION__);
 
+	/* report the repeats that are still pending */
+	debug_sites_flush (TRUE);
+
         /* remove debug handler */
         rig_set_debug_callback (NULL, NULL);
 
+	/* stop new posts and wait for those in flight; after that the
+	   writer can drain the ring completely before it exits */
+	if (writer != NULL) {
+		g_atomic_int_set (&running, FALSE);
+
+		while (g_atomic_int_get (&posting) > 0)
+			g_thread_yield ();
+
+		g_mutex_lock (&writermutex);
+		stopwriter = TRUE;
+		g_cond_signal (&writercond);
+		g_mutex_unlock (&writermutex);
+
+		g_thread_join (writer);
+		writer = NULL;
+	}
+
         /* close log file if open */
+	if (logfile != NULL) {
+		debug_file_close ();
+	}
+
+	if (compressor != NULL) {
+		g_thread_join (compressor);
+		compressor = NULL;
+	}
+
+	g_mutex_lock (&sitemutex);
+	memset (sites, 0, sizeof (sites));
+	g_mutex_unlock (&sitemutex);
+}
+
+
+/** \brief Write the log file as a binary trace.
+ *  \param binary TRUE to write a binary trace, FALSE for text.
+ *
+ * This function should be called before grig_debug_init(). A trace is
+ * smaller and cheaper to write and filter than the text log; it can be
+ * converted to text with grig_trace_to_text().
+ */
+void
+grig_debug_set_binary (gboolean binary)
+{
+	logbinary = binary;
+}
+
+
+/** \brief Set the command executed by the calling thread.
+ *  \param cmd The rig_cmd_t or GRIG_DEBUG_NO_CMD.
+ *
+ * The rig daemon calls this around each command so that the messages
+ * logged meanwhile, including those from hamlib, are tagged with the
+ * command in the binary trace.
+ */
+void
+grig_debug_set_cmd (gint cmd)
+{
+	g_private_set (&curcmd, GINT_TO_POINTER (cmd + 1));
+}
+
+
+/** \brief Set the rig the calling thread works for.
+ *  \param rig The rig or GRIG_DEBUG_NO_RIG.
+ *
+ * rig_data_bind() calls this so that the messages of a thread are
+ * filtered with the debug level of its rig.
+ */
+void
+grig_debug_set_rig (gint rig)
+{
+	g_private_set (&currig, GINT_TO_POINTER (rig + 1));
+}
+
+
+/** \brief Get the debug level that applies to the calling thread. */
+static enum rig_debug_level_e
+debug_level_current (void)
+{
+	gint rig;
+	gint level;
+
+	rig = GPOINTER_TO_INT (g_private_get (&currig)) - 1;
+
+	if ((rig >= 0) && (rig < C_MAX_RIGS)) {
+		level = g_atomic_int_get (&riglvl[rig]);
+
+		if (level > 0)
+			return level - 1;
+	}
+
+	return dbglvl;
+}
+
+
+/** \brief Enable compression of rotated log files.
+ *  \param compress TRUE to gzip the rotated segments.
+ *
+ * This function should be called before grig_debug_init(). The compression
+ * runs in a helper thread so that neither the writer nor the daemon waits
+ * for it.
+ */
+void
+grig_debug_set_compress (gboolean compress)
+{
+	logcompress = compress;
 }
 
 
@@ -122,16 +391,57 @@ grig_debug_hamlib_cb    (enum rig_debug_level_e debug_level,
 			 va_list ap)
 {
 
-	gchar          *msg;       /* formatted debug message */
-	gchar         **msgv;      /* debug message line by line */
-	guint           numlines;  /* the number of lines in the message */
-	guint           i;
+	if (debug_level > debug_level_current ())
+		return RIG_OK;
+
+	debug_message_queue (MSG_SRC_HAMLIB, debug_level, fmt, ap);
+
+	return RIG_OK;
+
+}
+
+
+/** \brief Manage GRIG debug messages. */
+int
+grig_debug_local    (enum rig_debug_level_e debug_level,
+		     const char *fmt,
+		     ...)
+{
+
+	va_list     ap;
 
 
-	if (debug_level > dbglvl)
+	if (debug_level > debug_level_current ())
 		return RIG_OK;
 
 
+	va_start (ap, fmt);
+	debug_message_queue (MSG_SRC_GRIG, debug_level, fmt, ap);
+	va_end(ap);
+
+	return RIG_OK;
+
+}
+
+
+/** \brief Format and write a debug message in the calling thread.
+ *
+ * This is used before the writer thread has been started and after it
+ * has been stopped.
+ */
+static void
+debug_message_sync (debug_msg_src_t source,
+		    enum rig_debug_level_e debug_level,
+		    const char *fmt,
+		    va_list ap)
+{
+
+	gchar      *msg;       /* formatted debug message */
+	gchar     **msgv;      /* debug message line by line */
+	guint       numlines;  /* the number of lines in the message */
+	guint       i;
+
+
 	/* create character string and split it in case
 	   it is a multi-line message */
 	msg = g_strdup_vprintf (fmt, ap);
@@ -150,67 +460,713 @@ grig_debug_hamlib_cb    (enum rig_debug_level_e debug_level,
 	   a logfile
 	*/
 	for (i = 0; i < numlines; i++) {
-		manage_debug_message (MSG_SRC_HAMLIB, debug_level, msgv[i]);
+		manage_debug_message (source, debug_level, msgv[i]);
 	}
 
-
 	g_strfreev (msgv);
-	
-	return RIG_OK;
+}
+
+
+/** \brief Hand a debug message to the writer or write it directly.
+ *
+ * The producer is counted in posting before it checks the running flag.
+ * grig_debug_close() clears the flag before it waits for posting to become
+ * zero, so either it waits for this message or the message is written
+ * here in the calling thread.
+ */
+static void
+debug_message_queue (debug_msg_src_t source,
+		     enum rig_debug_level_e debug_level,
+		     const char *fmt,
+		     va_list ap)
+{
+	g_atomic_int_inc (&posting);
 
+	if (g_atomic_int_get (&running)) {
+		debug_message_post (source, debug_level, fmt, ap);
+		g_atomic_int_dec_and_test (&posting);
+	}
+	else {
+		g_atomic_int_dec_and_test (&posting);
+		debug_message_sync (source, debug_level, fmt, ap);
+	}
 }
 
 
-/** \brief Manage GRIG debug messages. */
+/** \brief Log a message without checking the debug level. */
+static void
+debug_message_printf (debug_msg_src_t source,
+		      enum rig_debug_level_e debug_level,
+		      const char *fmt,
+		      ...)
+{
+	va_list ap;
+
+	va_start (ap, fmt);
+	debug_message_queue (source, debug_level, fmt, ap);
+	va_end (ap);
+}
+
+
+/** \brief Queue a debug message for the writer thread.
+ *
+ * The message is formatted directly into a free slot of the ring; nothing
+ * is allocated and the caller never waits. If the ring is full the message
+ * is dropped and counted.
+ */
+static void
+debug_message_post (debug_msg_src_t source,
+		    enum rig_debug_level_e debug_level,
+		    const char *fmt,
+		    va_list ap)
+{
+	debug_record_t *rec;
+	gint            pos;
+	gint            seq;
+	gint            diff;
+
+
+	/* reserve a slot */
+	pos = g_atomic_int_get (&ringhead);
+	for (;;) {
+		rec = &ring[pos & (C_DEBUG_RING_SIZE - 1)];
+		seq = g_atomic_int_get (&rec->sequence);
+		diff = (gint) ((guint) seq - (guint) pos);
+
+		if (diff == 0) {
+			if (g_atomic_int_compare_and_exchange (&ringhead, pos,
+							       (gint) ((guint) pos + 1)))
+				break;
+			pos = g_atomic_int_get (&ringhead);
+		}
+		else if (diff < 0) {
+			/* slot still holds a message from the previous lap: full */
+			g_atomic_int_inc (&dropped);
+			return;
+		}
+		else {
+			/* another producer took this position */
+			pos = g_atomic_int_get (&ringhead);
+		}
+	}
+
+	rec->time = g_get_real_time ();
+	rec->source = source;
+	rec->level = debug_level;
+	rec->cmd = GPOINTER_TO_INT (g_private_get (&curcmd)) - 1;
+	g_vsnprintf (rec->text, C_DEBUG_MSG_LEN, fmt, ap);
+
+	/* publish the slot to the writer */
+	g_atomic_int_set (&rec->sequence, (gint) ((guint) pos + 1));
+
+	/* wake up the writer early when the ring is filling up */
+	if ((pos & (C_DEBUG_RING_SIZE / 2 - 1)) == 0) {
+		g_cond_signal (&writercond);
+	}
+}
+
+
+/** \brief Move the pending messages from the ring into a buffer.
+ *  \param out The buffer where the formatted lines are appended.
+ *  \param stamp Time stamp cache of the caller.
+ *  \return The number of messages taken from the ring.
+ */
+static guint
+debug_ring_drain (GString *out, grig_debug_stamp_t *stamp)
+{
+	debug_record_t *rec;
+	gchar          *line;
+	gchar          *next;
+	guint           count = 0;
+	gint            lost;
+
+
+	for (;;) {
+		rec = &ring[ringtail & (C_DEBUG_RING_SIZE - 1)];
+
+		if (g_atomic_int_get (&rec->sequence) != (gint) (ringtail + 1))
+			break;
+
+		g_strchomp (rec->text);
+
+		/* the trace keeps the message as it is */
+		if (logbinary && (logfile != NULL)) {
+			grig_trace_add (&tracewriter, rec->time, rec->source,
+					rec->level, rec->cmd, rec->text,
+					strlen (rec->text));
+		}
+
+		/* one line per line of the message, without the trailing \n */
+		line = rec->text;
+		do {
+			next = strchr (line, '\n');
+			if (next != NULL)
+				*next++ = '\0';
+
+			grig_debug_format_line (out, stamp, rec->time, rec->source, rec->level, line);
+			line = next;
+		} while (line != NULL);
+
+		/* hand the slot back to the producers for the next lap */
+		g_atomic_int_set (&rec->sequence, (gint) (ringtail + C_DEBUG_RING_SIZE));
+		ringtail++;
+		count++;
+	}
+
+	lost = g_atomic_int_and (&dropped, 0);
+	if (lost > 0) {
+		line = g_strdup_printf (_("%s: %d debug messages dropped (buffer full)"),
+					__FUNCTION__, lost);
+		grig_debug_format_line (out, stamp, g_get_real_time (), MSG_SRC_GRIG,
+					RIG_DEBUG_WARN, line);
+		if (logbinary && (logfile != NULL)) {
+			grig_trace_add (&tracewriter, g_get_real_time (), MSG_SRC_GRIG,
+					RIG_DEBUG_WARN, GRIG_DEBUG_NO_CMD,
+					line, strlen (line));
+		}
+		g_free (line);
+	}
+
+	return count;
+}
+
+
+/** \brief Debug writer thread.
+ *
+ * The writer wakes up periodically, drains the ring into one buffer and
+ * writes it with a single call. It keeps going until grig_debug_close()
+ * is called and then flushes whatever is left; by then no producer is
+ * posting any more.
+ */
+static gpointer
+debug_writer (gpointer data)
+{
+	GString       *out;
+	grig_debug_stamp_t  stamp = { -1, NULL };
+	gint64         end;
+	gboolean       stop = FALSE;
+
+
+	out = g_string_sized_new (C_DEBUG_MSG_LEN * 16);
+
+	while (!stop) {
+		end = g_get_monotonic_time () + 1000 * C_DEBUG_WRITER_IDLE;
+
+		/* sleep until the next period or until a producer wakes us up */
+		g_mutex_lock (&writermutex);
+		if (!stopwriter)
+			g_cond_wait_until (&writercond, &writermutex, end);
+		stop = stopwriter;
+		g_mutex_unlock (&writermutex);
+
+		/* the reports go into the ring and are written below */
+		if (!stop)
+			debug_sites_flush (FALSE);
+
+		g_string_truncate (out, 0);
+		debug_ring_drain (out, &stamp);
+
+		if (out->len > 0) {
+			fwrite (out->str, 1, out->len, stderr);
+			fflush (stderr);
+		}
+
+		if (logfile != NULL) {
+			debug_file_write (out);
+		}
+
+		debug_history_add (out);
+	}
+
+	g_string_free (out, TRUE);
+	g_free (stamp.str);
+
+	return NULL;
+}
+
+
+
+/** \brief Open the log file for appending.
+ *  \return TRUE if the file could be opened.
+ */
+static gboolean
+debug_file_open ()
+{
+	GStatBuf  st;
+
+
+	logfile = g_fopen (logfname, "a");
+	if (logfile == NULL) {
+		g_fprintf (stderr, _("%s: Can not open log file %s\n"),
+			   __FUNCTION__, logfname);
+		return FALSE;
+	}
+
+	/* large buffer so that we do not hit the disk for each batch */
+	if (logbuf == NULL) {
+		logbuf = g_malloc (C_DEBUG_FILE_BUFFER);
+	}
+	setvbuf (logfile, logbuf, _IOFBF, C_DEBUG_FILE_BUFFER);
+
+	logsize = 0;
+	if (g_stat (logfname, &st) == 0) {
+		logsize = st.st_size;
+	}
+
+	/* a trace can only be appended to a trace; its block index is
+	   rebuilt so that the index written on close covers the whole file */
+	if (logbinary) {
+		if (logsize == 0) {
+			logsize = grig_trace_write_header (&tracewriter, logfile);
+		}
+		else if (!grig_trace_is_binary (logfname) ||
+			 !grig_trace_resume (&tracewriter, logfname)) {
+			g_fprintf (stderr, _("%s: %s is a text log; "\
+					     "writing text instead of binary trace\n"),
+				   __FUNCTION__, logfname);
+			logbinary = FALSE;
+		}
+	}
+
+	logopened = g_get_monotonic_time ();
+	logflushed = logopened;
+
+	return TRUE;
+}
+
+
+/** \brief Flush and close the log file; a trace gets its block index. */
+static void
+debug_file_close ()
+{
+	if (logbinary) {
+		grig_trace_write_index (&tracewriter, logfile);
+	}
+
+	fclose (logfile);
+	logfile = NULL;
+}
+
+
+/** \brief Append a batch of lines to the log file.
+ *  \param out The formatted lines.
+ *
+ * The file is flushed every C_DEBUG_FILE_FLUSH seconds and rotated when
+ * it has become too large or too old.
+ */
+static void
+debug_file_write (const GString *out)
+{
+	gint64 now = g_get_monotonic_time ();
+
+
+	if (logbinary) {
+		/* the records have been added while draining the ring */
+		if ((tracewriter.data != NULL) &&
+		    ((tracewriter.data->len >= GRIG_TRACE_BLOCK_SIZE) ||
+		     (now - logflushed >= C_DEBUG_FILE_FLUSH * G_USEC_PER_SEC))) {
+			logsize += grig_trace_flush (&tracewriter, logfile);
+		}
+	}
+	else if (out->len > 0) {
+		fwrite (out->str, 1, out->len, logfile);
+		logsize += out->len;
+	}
+
+	if ((logsize >= C_DEBUG_FILE_MAX_SIZE) ||
+	    (now - logopened >= (gint64) C_DEBUG_FILE_MAX_AGE * G_USEC_PER_SEC)) {
+		debug_file_rotate ();
+	}
+	else if (now - logflushed >= C_DEBUG_FILE_FLUSH * G_USEC_PER_SEC) {
+		fflush (logfile);
+		logflushed = now;
+	}
+}
+
+
+/** \brief Get the file name of a rotated log segment.
+ *  \param index The segment number, 0 being the current file.
+ *  \param gz Whether the segment is compressed.
+ *  \return A newly allocated file name.
+ */
+static gchar *
+debug_file_segment (guint index, gboolean gz)
+{
+	if (index == 0) {
+		return g_strdup (logfname);
+	}
+
+	return g_strdup_printf ("%s.%u%s", logfname, index, gz ? ".gz" : "");
+}
+
+
+/** \brief Rotate the log file.
+ *
+ * The segments are shifted by one, dropping the oldest one, the current
+ * file becomes segment 1 and a new file is started. Both compressed and
+ * uncompressed segments are shifted since compression may have been
+ * switched on or off between runs.
+ */
+static void
+debug_file_rotate ()
+{
+	gchar   *from;
+	gchar   *to;
+	guint    i;
+	gint     gz;
+
+
+	debug_file_close ();
+
+	/* the previous segment must be finished before it is renamed */
+	if (compressor != NULL) {
+		g_thread_join (compressor);
+		compressor = NULL;
+	}
+
+	for (gz = 0; gz < 2; gz++) {
+		from = debug_file_segment (C_DEBUG_FILE_KEEP, gz);
+		g_unlink (from);
+		g_free (from);
+
+		for (i = C_DEBUG_FILE_KEEP - 1; i > 0; i--) {
+			from = debug_file_segment (i, gz);
+			to = debug_file_segment (i + 1, gz);
+			g_rename (from, to);
+			g_free (from);
+			g_free (to);
+		}
+	}
+
+	from = debug_file_segment (0, FALSE);
+	to = debug_file_segment (1, FALSE);
+	g_rename (from, to);
+	g_free (from);
+
+	if (logcompress) {
+		/* the thread takes ownership of the name */
+		compressor = g_thread_try_new ("grig-debug-gz", debug_file_compress,
+					       to, NULL);
+		if (compressor == NULL) {
+			g_free (to);
+		}
+	}
+	else {
+		g_free (to);
+	}
+
+	/* on failure logfile stays NULL and we continue on stderr only */
+	debug_file_open ();
+}
+
+
+/** \brief Compress a rotated log segment.
+ *  \param data The file name of the segment; freed by this function.
+ *
+ * The segment is written to name.gz and removed when the compression
+ * succeeded.
+ */
+static gpointer
+debug_file_compress (gpointer data)
+{
+	gchar          *src = (gchar *) data;
+	gchar          *dst;
+	GFile          *infile;
+	GFile          *outfile;
+	GInputStream   *in;
+	GOutputStream  *out;
+	GOutputStream  *gzout;
+	GConverter     *conv;
+	GError         *error = NULL;
+
+
+	dst = g_strconcat (src, ".gz", NULL);
+	infile = g_file_new_for_path (src);
+	outfile = g_file_new_for_path (dst);
+
+	in = G_INPUT_STREAM (g_file_read (infile, NULL, &error));
+	if (in != NULL) {
+		out = G_OUTPUT_STREAM (g_file_replace (outfile, NULL, FALSE,
+						       G_FILE_CREATE_NONE,
+						       NULL, &error));
+		if (out != NULL) {
+			conv = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+			gzout = g_converter_output_stream_new (out, conv);
+
+			if (g_output_stream_splice (gzout, in,
+						    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+						    G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+						    NULL, &error) >= 0) {
+				g_unlink (src);
+			}
+			else {
+				g_unlink (dst);
+			}
+
+			g_object_unref (gzout);
+			g_object_unref (conv);
+			g_object_unref (out);
+		}
+		g_object_unref (in);
+	}
+
+	if (error != NULL) {
+		grig_debug_local (RIG_DEBUG_WARN,
+				  _("%s: Failed to compress %s: %s"),
+				  __FUNCTION__, src, error->message);
+		g_error_free (error);
+	}
+
+	g_object_unref (infile);
+	g_object_unref (outfile);
+	g_free (dst);
+	g_free (src);
+
+	return NULL;
+}
+
+
+
+/** \brief Log a message that may repeat many times.
+ *  \param debug_level The debug level of the message.
+ *  \param fmt Format string; also identifies the call site.
+ *  \return Always RIG_OK.
+ *
+ * This function works like grig_debug_local() except that a message which
+ * the same rig has logged from the same call site (same \a fmt) with the
+ * same text within the last C_DEBUG_LIMIT_INTERVAL seconds is suppressed.
+ * The number of suppressed repeats is logged when the interval is over.
+ *
+ * The table remembers the C_DEBUG_LIMIT_SITES most recent messages; when
+ * it is full the oldest entry is reported and reused.
+ */
 int
-grig_debug_local    (enum rig_debug_level_e debug_level,
+grig_debug_limited  (enum rig_debug_level_e debug_level,
 		     const char *fmt,
 		     ...)
 {
+	debug_site_t *site;
+	debug_site_t *oldest = NULL;
+	gchar         msg[C_DEBUG_MSG_LEN];
+	gchar         evicted[C_DEBUG_MSG_LEN];
+	gint          evictedlevel = RIG_DEBUG_NONE;
+	guint         repeats = 0;
+	gint64        now;
+	gint          rig;
+	guint         i;
+	va_list       ap;
+
+
+	if (debug_level > debug_level_current ())
+		return RIG_OK;
 
-	gchar      *msg;       /* formatted debug message */
-	gchar     **msgv;      /* debug message line by line */
-	guint       numlines;  /* the number of lines in the message */
-	guint       i;
-	va_list     ap;
+	va_start (ap, fmt);
+	g_vsnprintf (msg, C_DEBUG_MSG_LEN, fmt, ap);
+	va_end (ap);
 
+	now = g_get_monotonic_time ();
+	rig = GPOINTER_TO_INT (g_private_get (&currig)) - 1;
 
-	if (debug_level > dbglvl)
-		return RIG_OK;
+	g_mutex_lock (&sitemutex);
 
+	for (i = 0; i < C_DEBUG_LIMIT_SITES; i++) {
+		site = &sites[i];
 
-	va_start (ap, fmt);
+		if ((site->fmt == fmt) && (site->rig == rig) && !strcmp (site->text, msg)) {
 
-	/* create character string and split it in case
-	   it is a multi-line message */
-	msg = g_strdup_vprintf (fmt, ap);
+			if (now - site->time < (gint64) C_DEBUG_LIMIT_INTERVAL * G_USEC_PER_SEC) {
+				/* same as before and too soon */
+				site->repeats++;
+				suppressed++;
+				g_mutex_unlock (&sitemutex);
 
-	/* remove trailing \n */
-	g_strchomp (msg);
+				return RIG_OK;
+			}
 
-	/* split the message in case it is a multiline message */
-	msgv = g_strsplit_set (msg, "\n", 0);
-	numlines = g_strv_length (msgv);
+			/* the interval is over; log it again */
+			oldest = site;
+			break;
+		}
 
-	g_free (msg);
+		if ((oldest == NULL) || (site->fmt == NULL) ||
+		    ((oldest->fmt != NULL) && (site->time < oldest->time))) {
+			oldest = site;
+		}
+	}
 
-	/* for each line in msgv, call the real debug handler
-	   which will print the debug message and save it to
-	   a logfile
-	*/
-	for (i = 0; i < numlines; i++) {
-		manage_debug_message (MSG_SRC_GRIG, debug_level, msgv[i]);
+	/* the repeats of the entry are reported before it is reused */
+	if (oldest->repeats > 0) {
+		g_strlcpy (evicted, oldest->text, C_DEBUG_MSG_LEN);
+		evictedlevel = oldest->level;
+		repeats = oldest->repeats;
 	}
 
-	va_end(ap);
+	oldest->fmt = fmt;
+	oldest->rig = rig;
+	oldest->level = debug_level;
+	oldest->time = now;
+	oldest->repeats = 0;
+	g_strlcpy (oldest->text, msg, C_DEBUG_MSG_LEN);
+
+	g_mutex_unlock (&sitemutex);
+
+	if (repeats > 0) {
+		debug_message_printf (MSG_SRC_GRIG, evictedlevel,
+				      _("%s: Message repeated %u times: %s"),
+				      __FUNCTION__, repeats, evicted);
+	}
+
+	grig_debug_local (debug_level, "%s", msg);
 
-	g_strfreev (msgv);
-	
 	return RIG_OK;
+}
+
+
+/** \brief Report the suppressed repeats.
+ *  \param all TRUE to report all of them, FALSE to report only those
+ *              whose interval is over.
+ *
+ * The writer thread calls this periodically so that the count of a message
+ * that stopped repeating is not lost; grig_debug_close() calls it with
+ * \a all set. A reported entry starts a new interval.
+ */
+static void
+debug_sites_flush (gboolean all)
+{
+	debug_site_t *site;
+	GPtrArray    *reports = NULL;
+	GArray       *levels = NULL;
+	gint64        now;
+	gint          level;
+	guint         i;
+
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (&sitemutex);
+
+	for (i = 0; i < C_DEBUG_LIMIT_SITES; i++) {
+		site = &sites[i];
+
+		if ((site->fmt == NULL) || (site->repeats == 0))
+			continue;
+
+		if (!all &&
+		    (now - site->time < (gint64) C_DEBUG_LIMIT_INTERVAL * G_USEC_PER_SEC))
+			continue;
+
+		if (reports == NULL) {
+			reports = g_ptr_array_new_with_free_func (g_free);
+			levels = g_array_new (FALSE, FALSE, sizeof (gint));
+		}
 
+		g_ptr_array_add (reports,
+				 g_strdup_printf (_("%s: Message repeated %u times: %s"),
+						  "grig_debug_limited", site->repeats,
+						  site->text));
+		g_array_append_val (levels, site->level);
+
+		site->repeats = 0;
+		site->time = now;
+	}
+
+	g_mutex_unlock (&sitemutex);
+
+	if (reports == NULL)
+		return;
+
+	for (i = 0; i < reports->len; i++) {
+		level = g_array_index (levels, gint, i);
+		debug_message_printf (MSG_SRC_GRIG, level, "%s",
+				      (gchar *) g_ptr_array_index (reports, i));
+	}
+
+	g_ptr_array_free (reports, TRUE);
+	g_array_free (levels, TRUE);
+}
+
+
+/** \brief Store a batch of lines in the history. */
+static void
+debug_history_add (const GString *out)
+{
+	const gchar *line;
+	const gchar *end;
+	guint        idx;
+
+
+	if (out->len == 0)
+		return;
+
+	g_mutex_lock (&historymutex);
+
+	for (line = out->str; *line != '\0'; line = end + 1) {
+		end = strchr (line, '\n');
+		if (end == NULL)
+			break;
+
+		idx = historyseq % C_DEBUG_HISTORY;
+		g_free (history[idx]);
+		history[idx] = g_strndup (line, end - line);
+		historyseq++;
+	}
+
+	g_mutex_unlock (&historymutex);
 }
 
 
+/** \brief Get the latest debug lines.
+ *  \param seq Sequence number of the first line wanted; updated to the
+ *              sequence number of the next line to ask for.
+ *  \param lines Array where newly allocated lines are added.
+ *  \return The number of lines that were no longer available.
+ *
+ * The lines are formatted the same way as in the log file. Lines older than
+ * the last C_DEBUG_HISTORY lines are lost; pass 0 as \a seq the first time
+ * to get all lines that are still available.
+ */
+guint
+grig_debug_get_history (guint64 *seq, GPtrArray *lines)
+{
+	guint64 first;
+	guint64 i;
+	guint   lost = 0;
+
+
+	g_mutex_lock (&historymutex);
+
+	first = (historyseq > C_DEBUG_HISTORY) ? historyseq - C_DEBUG_HISTORY : 0;
+	if (*seq < first) {
+		lost = first - *seq;
+		*seq = first;
+	}
+
+	for (i = *seq; i < historyseq; i++) {
+		g_ptr_array_add (lines, g_strdup (history[i % C_DEBUG_HISTORY]));
+	}
+	*seq = historyseq;
+
+	g_mutex_unlock (&historymutex);
+
+	return lost;
+}
+
+
+/** \brief Get the number of suppressed messages.
+ *  \return The number of messages dropped by grig_debug_limited().
+ */
+guint
+grig_debug_get_suppressed ()
+{
+	guint count;
+
+	g_mutex_lock (&sitemutex);
+	count = suppressed;
+	g_mutex_unlock (&sitemutex);
+
+	return count;
+}
+
 
 /** \brief Get the name of the current log file.
  *  \return The name of the current log file or NULL.
@@ -239,34 +1195,109 @@ manage_debug_message (debug_msg_src_t source,
               enum rig_debug_level_e debug_level,
               const gchar *message)
 {
-    /* get the time */
-    GDateTime *tval = g_date_time_new_now_local ();
-    gchar *msg_time = g_date_time_format (tval, "%Y/%m/%d %H:%M:%S");
+    GString       *out = g_string_new (NULL);
+    grig_debug_stamp_t  stamp = { -1, NULL };
 
-    g_fprintf (stderr,
+    grig_debug_format_line (out, &stamp, g_get_real_time (), source, debug_level, message);
+    fputs (out->str, stderr);
+
+    g_string_free (out, TRUE);
+    g_free (stamp.str);
+}
+
+
+/** \brief Append one formatted log line to a buffer.
+ *  \param out The buffer.
+ *  \param stamp Time stamp cache of the caller, initialised to { -1, NULL }.
+ *  \param time Wall clock time of the message in usec.
+ *  \param source The source of the message.
+ *  \param debug_level The debug level of the message.
+ *  \param message The message; must be a single line.
+ *
+ * The time stamp string is kept in \a stamp and only rebuilt when the
+ * second changes, which saves most of the date formatting in a batch.
+ * The caller frees stamp->str when done.
+ */
+void
+grig_debug_format_line (GString *out,
+			grig_debug_stamp_t *stamp,
+			gint64 time,
+			debug_msg_src_t source,
+			enum rig_debug_level_e debug_level,
+			const gchar *message)
+{
+    GDateTime     *tval;
+    gint64         sec = time / G_USEC_PER_SEC;
+
+    if (sec != stamp->sec) {
+        tval = g_date_time_new_from_unix_local (sec);
+        g_free (stamp->str);
+        stamp->str = g_date_time_format (tval, "%Y/%m/%d %H:%M:%S");
+        g_date_time_unref (tval);
+        stamp->sec = sec;
+    }
+
+    g_string_append_printf (out,
            "%s%s%s%s%d%s%s\n",
-           msg_time,
+           stamp->str,
            GRIG_DEBUG_SEPARATOR,
            SRC_TO_STR[source],
            GRIG_DEBUG_SEPARATOR,
            debug_level,
            GRIG_DEBUG_SEPARATOR,
            message);
-
-    g_free(msg_time);
 }
 
 
+/** \brief Set the debug level of all rigs.
+ *  \param level The new level.
+ *
+ * This also drops the levels set with grig_debug_set_rig_level().
+ */
 void
 grig_debug_set_level (enum rig_debug_level_e level)
 {
+	gint i;
+
 	if ((level >= RIG_DEBUG_NONE) && (level <= RIG_DEBUG_TRACE)) {
 
 		dbglvl = level;
+
+		for (i = 0; i < C_MAX_RIGS; i++)
+			g_atomic_int_set (&riglvl[i], 0);
+
 		rig_set_debug (level);
 	}
 }
 
+
+/** \brief Set the debug level of one rig.
+ *  \param rig The rig.
+ *  \param level The new level.
+ *
+ * The level applies to the messages of the threads bound to the rig.
+ * Hamlib filters with the highest level of all rigs.
+ */
+void
+grig_debug_set_rig_level (gint rig, enum rig_debug_level_e level)
+{
+	enum rig_debug_level_e max = dbglvl;
+	gint i;
+
+	if ((rig < 0) || (rig >= C_MAX_RIGS) ||
+	    (level < RIG_DEBUG_NONE) || (level > RIG_DEBUG_TRACE))
+		return;
+
+	g_atomic_int_set (&riglvl[rig], level + 1);
+
+	for (i = 0; i < C_MAX_RIGS; i++) {
+		if (g_atomic_int_get (&riglvl[i]) - 1 > (gint) max)
+			max = g_atomic_int_get (&riglvl[i]) - 1;
+	}
+
+	rig_set_debug (max);
+}
+
 int
 grig_debug_get_level ()
 {
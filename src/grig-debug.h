@@ -37,6 +37,8 @@
 
 
 #define GRIG_DEBUG_SEPARATOR ";;"
+#define GRIG_DEBUG_NO_CMD    0xFFFF   /*!< No command is being executed. */
+#define GRIG_DEBUG_NO_RIG    -1       /*!< The thread does not work for a rig. */
 
 /** \brief Debug message sources. */
 typedef enum {
@@ -46,6 +48,13 @@ typedef enum {
 } debug_msg_src_t;
 
 
+/** \brief Cached time stamp string, rebuilt when the second changes. */
+typedef struct {
+	gint64   sec;      /*!< The second the string belongs to. */
+	gchar   *str;      /*!< Formatted local time. */
+} grig_debug_stamp_t;
+
+
 
 void grig_debug_init           (gchar *filename);
 void grig_debug_close          (void);
@@ -58,10 +67,28 @@ int  grig_debug_local      (enum rig_debug_level_e debug_level,
                             const char *fmt,
                             ...);
 
+int  grig_debug_limited    (enum rig_debug_level_e debug_level,
+                            const char *fmt,
+                            ...);
+
+guint  grig_debug_get_suppressed (void);
+guint  grig_debug_get_history    (guint64 *seq, GPtrArray *lines);
+
 gchar *grig_debug_get_log_file (void);
+void   grig_debug_format_line  (GString *out,
+                                grig_debug_stamp_t *stamp,
+                                gint64 time,
+                                debug_msg_src_t source,
+                                enum rig_debug_level_e debug_level,
+                                const gchar *message);
+void   grig_debug_set_compress (gboolean compress);
+void   grig_debug_set_binary   (gboolean binary);
+void   grig_debug_set_cmd      (gint cmd);
+void   grig_debug_set_rig      (gint rig);
 
 
 void grig_debug_set_level (enum rig_debug_level_e level);
+void grig_debug_set_rig_level (gint rig, enum rig_debug_level_e level);
 int  grig_debug_get_level (void);
 
 #endif
@@ -32,6 +32,9 @@
 #include "grig-about.h"
 #include "grig-config.h"
 #include "grig-menubar.h"
+#include "rig-gui-anomaly.h"
+#include "rig-gui-profiler.h"
+#include "rig-gui.h"
 #include "rig-gui-info.h"
 #include "rig-gui-message-window.h"
 #include "rig-gui-rx.h"
@@ -39,6 +42,8 @@
 #include "rig-gui-func.h"
 #include "rig-state.h"
 #include "grig-debug.h"
+#include "rig-daemon.h"
+#include "rig-data.h"
 
 
 
@@ -52,6 +57,8 @@ static void  grig_menu_set_debug_level (GtkRadioAction *, gpointer);
 static void  rx_window_cb (GtkToggleAction *toggleaction, gpointer data);
 static void  tx_window_cb (GtkToggleAction *toggleaction, gpointer data);
 static void  func_window_cb (GtkToggleAction *toggleaction, gpointer data);
+static void  grig_menu_add_rigs        (GtkActionGroup *);
+static void  grig_menu_select_rig      (GtkRadioAction *, gpointer);
 
 
 /** \brief Regular menu items. */
@@ -64,6 +71,9 @@ static GtkActionEntry entries[] = {
 
 	/* FileMenu */
 	{ "Info", GTK_STOCK_DND, N_("_Info"), "<control>I", N_("Show info about radio"), G_CALLBACK (rig_gui_info_run) },
+	{ "Errors", GTK_STOCK_DIALOG_WARNING, N_("Command _Errors"), NULL, N_("Show command error statistics"), G_CALLBACK (rig_gui_anomaly_run) },
+	{ "Profiler", GTK_STOCK_PROPERTIES, N_("Daemon _Profiler"), NULL, N_("Show daemon timing statistics"), G_CALLBACK (rig_gui_profiler_run) },
+	{ "RigMenu", NULL, N_("Select _Rig"), NULL, N_("Select which rig is shown"), NULL },
 	{ "Stop", GTK_STOCK_STOP, N_("St_op daemon"), NULL, N_("Stop the Grig daemon"), NULL },
 	{ "Start", GTK_STOCK_EXECUTE, N_("St_art daemon"), NULL, N_("Start the Grig daemon"), NULL },
 	{ "Save", GTK_STOCK_SAVE, N_("_Save State"), "<control>S", N_("Save the state of the rig to a file"), G_CALLBACK (rig_state_save_cb) },
@@ -112,6 +122,9 @@ static const char *menu_desc =
 "  <menubar name='GrigMenu'>"
 "    <menu action='FileMenu'>"
 "       <menuitem action='Info'/>"
+"       <menuitem action='Errors'/>"
+"       <menuitem action='Profiler'/>"
+"       <placeholder name='Rigs'/>"
 "       <separator/>"
 /*"       <menuitem action='Start'/>"
 "       <menuitem action='Stop'/>"
@@ -220,6 +233,9 @@ grig_menubar_create ()
 		return NULL;
 	}
 
+	/* rig selector; only when controlling more than one rig */
+	grig_menu_add_rigs (actgrp);
+
 	/* now, finally, get the menubar */
 	menubar = gtk_ui_manager_get_widget (uimgr, "/GrigMenu");
 
@@ -246,6 +262,105 @@ grig_menu_app_exit       (GtkWidget *widget, gpointer data)
 
 
 
+/** \brief Add rig selector to the menubar.
+ *  \param actgrp The action group of the menubar.
+ *
+ * This function adds a radio item for each running rig to the Radio menu,
+ * provided that more than one rig has been started.
+ */
+static void
+grig_menu_add_rigs (GtkActionGroup *actgrp)
+{
+	GtkRadioActionEntry  rigs[C_MAX_RIGS];
+	gchar               *names[C_MAX_RIGS];
+	gchar               *labels[C_MAX_RIGS];
+	gchar               *brand;
+	gchar               *model;
+	guint                merge;
+	gint                 prev;
+	gint                 i,n;
+
+
+	for (n = 0; n < C_MAX_RIGS; n++) {
+		prev = rig_data_bind (n);
+
+		if (rig_daemon_get_rig () == NULL) {
+			rig_data_bind (prev);
+			break;
+		}
+
+		brand = rig_daemon_get_brand ();
+		model = rig_daemon_get_model ();
+		rig_data_bind (prev);
+
+		names[n]  = g_strdup_printf ("Rig%d", n);
+		labels[n] = g_strdup_printf ("_%d %s %s", n + 1, brand, model);
+		g_free (brand);
+		g_free (model);
+
+		rigs[n].name        = names[n];
+		rigs[n].stock_id    = NULL;
+		rigs[n].label       = labels[n];
+		rigs[n].accelerator = NULL;
+		rigs[n].tooltip     = NULL;
+		rigs[n].value       = n;
+	}
+
+	if (n > 1) {
+		gtk_action_group_add_radio_actions (actgrp, rigs, n,
+						    rig_data_get_selected (),
+						    G_CALLBACK (grig_menu_select_rig),
+						    NULL);
+
+		merge = gtk_ui_manager_new_merge_id (uimgr);
+		gtk_ui_manager_add_ui (uimgr, merge, "/GrigMenu/FileMenu/Rigs",
+				       "RigMenu", "RigMenu",
+				       GTK_UI_MANAGER_MENU, FALSE);
+		for (i = 0; i < n; i++) {
+			gtk_ui_manager_add_ui (uimgr, merge, "/GrigMenu/FileMenu/Rigs/RigMenu",
+					       names[i], names[i],
+					       GTK_UI_MANAGER_MENUITEM, FALSE);
+		}
+	}
+
+	/* the action group keeps its own copies */
+	for (i = 0; i < n; i++) {
+		g_free (names[i]);
+		g_free (labels[i]);
+	}
+}
+
+
+/** \brief Select rig.
+ *  \param action The GtkRadioAction item.
+ *  \param data  Pointer to user data (not used).
+ *
+ * This function is called when the user selects another rig. The controls
+ * are rebuilt from the capabilities of the new rig and refreshed from its
+ * state. Open RX, TX and function windows stay bound to their own rig.
+ */
+static void
+grig_menu_select_rig (GtkRadioAction *action, gpointer data)
+{
+	gchar *brand;
+	gchar *model;
+	gchar *title;
+
+
+	rig_data_select (gtk_radio_action_get_current_value (action));
+	rig_gui_rebuild ();
+
+	brand = rig_daemon_get_brand ();
+	model = rig_daemon_get_model ();
+	title = g_strdup_printf (_("GRIG: %s %s"), brand, model);
+	gtk_window_set_title (GTK_WINDOW (grigapp), title);
+
+	g_free (title);
+	g_free (brand);
+	g_free (model);
+}
+
+
 /** \brief Set debug level.
  *  \param action The GtkRadioAction item.
  *  \param data  Pointer to user data (not used).
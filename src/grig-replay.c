@@ -0,0 +1,847 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    grig-replay.c
+ *  \ingroup main
+ *  \brief   Command record analysis.
+ *
+ * This program reads a command record saved by grig --record (see
+ * grig-cmdrec.c) and prints a timing analysis:
+ *
+ *  - the commands taking most of the time,
+ *  - the longest single commands (stalls),
+ *  - the longest idle intervals between commands (gaps),
+ *  - for each 'get' command the longest and mean interval between two
+ *    successful reads, ie. how stale the displayed value could get, and
+ *    how often the value actually changed.
+ *
+ * With --simulate the commands are executed once more against the
+ * simulated rig (see rig-sim.c), optionally at their original pace, and
+ * the simulated execution times are printed next to the recorded ones.
+ * This shows whether a given latency and error setting of the simulator
+ * reproduces the behaviour of the real rig. The daemon commands are
+ * mapped onto the Hamlib call the simulator times them by; commands the
+ * simulator has no model for are replayed as a level.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <hamlib/rig.h>
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+#ifdef HAVE_GETOPT_H
+#  include <getopt.h>
+#endif
+#include "grig-cmdrec.h"
+#include "grig-debug.h"
+#include "rig-sim.h"
+
+
+#define C_REPLAY_DEF_TOP  10     /*!< Default number of entries in each list. */
+
+
+/** \brief Statistics of one command. */
+typedef struct {
+	guint    cmd;        /*!< Index into the command names. */
+	guint    count;      /*!< Number of executions. */
+	guint    errors;     /*!< Executions with an error. */
+	gint64   total;      /*!< Total execution time [usec]. */
+	GArray  *durs;       /*!< Execution times [usec], guint32. */
+} replay_stat_t;
+
+
+/** \brief An idle interval. */
+typedef struct {
+	gint64   start;      /*!< End of the previous command. */
+	gint64   length;     /*!< Length of the interval [usec]. */
+	guint    before;     /*!< Index of the previous command. */
+} replay_gap_t;
+
+
+static gint      top       = C_REPLAY_DEF_TOP;  /*!< Number of entries in each list. */
+static gboolean  simulate  = FALSE;  /*!< Replay against the simulator. */
+static gboolean  pace      = FALSE;  /*!< Replay at the original pace. */
+static gchar    *rigconf   = NULL;   /*!< Simulator conf parameters. */
+static gint      rigspeed  = 0;      /*!< Simulated serial speed. */
+
+
+/** \brief Short options. */
+#define SHORT_OPTIONS "n:sC:b:ph"
+
+/** \brief Table of command line options. */
+static struct option long_options[] =
+{
+	{"top",          1, 0, 'n'},
+	{"simulate",     0, 0, 's'},
+	{"set-conf",     1, 0, 'C'},
+	{"speed",        1, 0, 'b'},
+	{"pace",         0, 0, 'p'},
+	{"help",         0, 0, 'h'},
+	{NULL, 0, 0, 0}
+};
+
+
+static GArray  *grig_replay_stats     (GArray *, GArray *, guint);
+static void     grig_replay_stats_free (GArray *);
+static gint64   grig_replay_percentile (GArray *, gdouble);
+static void     grig_replay_summary   (GArray *, guint64);
+static void     grig_replay_top       (GArray *, GPtrArray *);
+static void     grig_replay_stalls    (GArray *, GPtrArray *);
+static void     grig_replay_gaps      (GArray *, GPtrArray *);
+static void     grig_replay_staleness (GArray *, GPtrArray *);
+static GArray  *grig_replay_simulate  (GArray *, GPtrArray *);
+static gint     grig_replay_exec      (RIG *, const gchar *, const grig_cmdrec_t *);
+static void     grig_replay_compare   (GArray *, GArray *, GPtrArray *);
+static void     grig_replay_help      (void);
+
+
+
+/** \brief Main program.
+ *  \param argc Number of arguments.
+ *  \param argv The arguments.
+ *  \return 0 on success, 1 on error.
+ */
+int
+main (int argc, char *argv[])
+{
+	GPtrArray *names;
+	GArray    *recs;
+	GArray    *simdurs;
+	GError    *error = NULL;
+	guint64    lost = 0;
+
+
+#ifdef ENABLE_NLS
+	bindtextdomain (PACKAGE, PACKAGE_LOCALE_DIR);
+	bind_textdomain_codeset (PACKAGE, "UTF-8");
+	textdomain (PACKAGE);
+#endif
+
+	while (1) {
+		int c;
+		int option_index = 0;
+
+		c = getopt_long (argc, argv, SHORT_OPTIONS,
+				 long_options, &option_index);
+
+		if (c == -1)
+			break;
+
+		switch (c) {
+
+		case 'n':
+			top = MAX (1, atoi (optarg));
+			break;
+
+		case 's':
+			simulate = TRUE;
+			break;
+
+		case 'C':
+			rigconf = optarg;
+			break;
+
+		case 'b':
+			rigspeed = atoi (optarg);
+			break;
+
+		case 'p':
+			pace = TRUE;
+			break;
+
+		default:
+			grig_replay_help ();
+			return (c == 'h') ? 0 : 1;
+		}
+	}
+
+	if (optind != argc - 1) {
+		grig_replay_help ();
+		return 1;
+	}
+
+	names = g_ptr_array_new_with_free_func (g_free);
+	recs = grig_cmdrec_load (argv[optind], names, &lost, &error);
+
+	if (recs == NULL) {
+		g_printerr ("%s\n", error->message);
+		g_clear_error (&error);
+		g_ptr_array_free (names, TRUE);
+		return 1;
+	}
+
+	if (recs->len == 0) {
+		g_print (_("No commands recorded.\n"));
+	}
+	else {
+		grig_replay_summary (recs, lost);
+		grig_replay_top (recs, names);
+		grig_replay_stalls (recs, names);
+		grig_replay_gaps (recs, names);
+		grig_replay_staleness (recs, names);
+
+		if (simulate) {
+			simdurs = grig_replay_simulate (recs, names);
+			if (simdurs != NULL) {
+				grig_replay_compare (recs, simdurs, names);
+				g_array_free (simdurs, TRUE);
+			}
+		}
+	}
+
+	g_array_free (recs, TRUE);
+	g_ptr_array_free (names, TRUE);
+
+	return 0;
+}
+
+
+/** \brief Compare two guint32 values. */
+static gint
+grig_replay_cmp_u32 (gconstpointer a, gconstpointer b)
+{
+	guint32 x = *(const guint32 *) a;
+	guint32 y = *(const guint32 *) b;
+
+	return (x > y) - (x < y);
+}
+
+
+/** \brief Order command statistics by decreasing total time. */
+static gint
+grig_replay_cmp_total (gconstpointer a, gconstpointer b)
+{
+	const replay_stat_t *x = a;
+	const replay_stat_t *y = b;
+
+	return (x->total < y->total) - (x->total > y->total);
+}
+
+
+/** \brief Order records by decreasing duration. */
+static gint
+grig_replay_cmp_duration (gconstpointer a, gconstpointer b)
+{
+	const grig_cmdrec_t *x = a;
+	const grig_cmdrec_t *y = b;
+
+	return (x->duration < y->duration) - (x->duration > y->duration);
+}
+
+
+/** \brief Order gaps by decreasing length. */
+static gint
+grig_replay_cmp_gap (gconstpointer a, gconstpointer b)
+{
+	const replay_gap_t *x = a;
+	const replay_gap_t *y = b;
+
+	return (x->length < y->length) - (x->length > y->length);
+}
+
+
+/** \brief Collect the statistics of each command.
+ *  \param recs The records.
+ *  \param durs Execution times to use instead of those of the records, or NULL.
+ *  \param ncmds Number of command names.
+ *  \return Array of replay_stat_t, one per command, with sorted durations.
+ */
+static GArray *
+grig_replay_stats (GArray *recs, GArray *durs, guint ncmds)
+{
+	GArray        *stats;
+	replay_stat_t *st;
+	grig_cmdrec_t *rec;
+	guint32        dur;
+	guint          i;
+
+
+	stats = g_array_sized_new (FALSE, TRUE, sizeof (replay_stat_t), ncmds);
+	g_array_set_size (stats, ncmds);
+
+	for (i = 0; i < ncmds; i++) {
+		st = &g_array_index (stats, replay_stat_t, i);
+		st->cmd = i;
+		st->durs = g_array_new (FALSE, FALSE, sizeof (guint32));
+	}
+
+	for (i = 0; i < recs->len; i++) {
+		rec = &g_array_index (recs, grig_cmdrec_t, i);
+		if (rec->cmd >= ncmds)
+			continue;
+
+		dur = durs ? g_array_index (durs, guint32, i) : rec->duration;
+
+		st = &g_array_index (stats, replay_stat_t, rec->cmd);
+		st->count++;
+		st->total += dur;
+		if (rec->retcode != RIG_OK)
+			st->errors++;
+		g_array_append_val (st->durs, dur);
+	}
+
+	for (i = 0; i < ncmds; i++) {
+		st = &g_array_index (stats, replay_stat_t, i);
+		g_array_sort (st->durs, grig_replay_cmp_u32);
+	}
+
+	return stats;
+}
+
+
+/** \brief Free command statistics. */
+static void
+grig_replay_stats_free (GArray *stats)
+{
+	guint i;
+
+	for (i = 0; i < stats->len; i++) {
+		g_array_free (g_array_index (stats, replay_stat_t, i).durs, TRUE);
+	}
+
+	g_array_free (stats, TRUE);
+}
+
+
+/** \brief Get a percentile of sorted execution times.
+ *  \param durs The sorted times.
+ *  \param p The percentile, 0..1.
+ *  \return The time [usec].
+ */
+static gint64
+grig_replay_percentile (GArray *durs, gdouble p)
+{
+	guint idx;
+
+	if (durs->len == 0)
+		return 0;
+
+	idx = MIN ((guint) (p * durs->len), durs->len - 1);
+
+	return g_array_index (durs, guint32, idx);
+}
+
+
+/** \brief Print the summary of the record.
+ *  \param recs The records.
+ *  \param lost Number of records lost before the record was saved.
+ */
+static void
+grig_replay_summary (GArray *recs, guint64 lost)
+{
+	grig_cmdrec_t *first;
+	grig_cmdrec_t *last;
+	gint64         span;
+	gint64         busy = 0;
+	guint          errors = 0;
+	guint          i;
+
+
+	first = &g_array_index (recs, grig_cmdrec_t, 0);
+	last = &g_array_index (recs, grig_cmdrec_t, recs->len - 1);
+	span = MAX (last->start + last->duration - first->start, 1);
+
+	for (i = 0; i < recs->len; i++) {
+		busy += g_array_index (recs, grig_cmdrec_t, i).duration;
+		if (g_array_index (recs, grig_cmdrec_t, i).retcode != RIG_OK)
+			errors++;
+	}
+
+	g_print (_("Commands:   %u (%" G_GUINT64_FORMAT " older ones lost)\n"), recs->len, lost);
+	g_print (_("Span:       %.3f s\n"), span / 1.0e6);
+	g_print (_("Rate:       %.1f commands/s\n"), recs->len * 1.0e6 / span);
+	g_print (_("Busy:       %.1f %%\n"), 100.0 * busy / span);
+	g_print (_("Errors:     %u\n"), errors);
+	g_print ("\n");
+}
+
+
+/** \brief Print the commands taking most of the time.
+ *  \param recs The records.
+ *  \param names The command names.
+ */
+static void
+grig_replay_top (GArray *recs, GPtrArray *names)
+{
+	GArray        *stats;
+	replay_stat_t *st;
+	guint          i;
+
+
+	stats = grig_replay_stats (recs, NULL, names->len);
+	g_array_sort (stats, grig_replay_cmp_total);
+
+	g_print (_("Most expensive commands [ms]:\n"));
+	g_print ("  %-24s %8s %7s %9s %8s %8s %8s %8s\n", _("Command"), _("Count"),
+		 _("Errors"), _("Total"), _("Mean"), _("p50"), _("p99"), _("Max"));
+
+	for (i = 0; (i < stats->len) && (i < (guint) top); i++) {
+		st = &g_array_index (stats, replay_stat_t, i);
+		if (st->count == 0)
+			break;
+
+		g_print ("  %-24s %8u %7u %9.1f %8.2f %8.2f %8.2f %8.2f\n",
+			 (const gchar *) g_ptr_array_index (names, st->cmd),
+			 st->count, st->errors, st->total / 1000.0,
+			 st->total / (1000.0 * st->count),
+			 grig_replay_percentile (st->durs, 0.50) / 1000.0,
+			 grig_replay_percentile (st->durs, 0.99) / 1000.0,
+			 g_array_index (st->durs, guint32, st->durs->len - 1) / 1000.0);
+	}
+	g_print ("\n");
+
+	grig_replay_stats_free (stats);
+}
+
+
+/** \brief Print the longest commands.
+ *  \param recs The records.
+ *  \param names The command names.
+ */
+static void
+grig_replay_stalls (GArray *recs, GPtrArray *names)
+{
+	GArray        *sorted;
+	grig_cmdrec_t *rec;
+	gint64         t0;
+	guint          i;
+
+
+	t0 = g_array_index (recs, grig_cmdrec_t, 0).start;
+
+	sorted = g_array_sized_new (FALSE, FALSE, sizeof (grig_cmdrec_t), recs->len);
+	g_array_append_vals (sorted, recs->data, recs->len);
+	g_array_sort (sorted, grig_replay_cmp_duration);
+
+	g_print (_("Longest commands:\n"));
+	g_print ("  %10s %-24s %10s %8s\n", _("At [s]"), _("Command"),
+		 _("Time [ms]"), _("Result"));
+
+	for (i = 0; (i < sorted->len) && (i < (guint) top); i++) {
+		rec = &g_array_index (sorted, grig_cmdrec_t, i);
+
+		g_print ("  %10.3f %-24s %10.2f %8d\n",
+			 (rec->start - t0) / 1.0e6,
+			 (rec->cmd < names->len) ?
+			 (const gchar *) g_ptr_array_index (names, rec->cmd) : "?",
+			 rec->duration / 1000.0, rec->retcode);
+	}
+	g_print ("\n");
+
+	g_array_free (sorted, TRUE);
+}
+
+
+/** \brief Print the longest idle intervals.
+ *  \param recs The records.
+ *  \param names The command names.
+ */
+static void
+grig_replay_gaps (GArray *recs, GPtrArray *names)
+{
+	GArray        *gaps;
+	replay_gap_t   gap;
+	replay_gap_t  *g;
+	grig_cmdrec_t *prev;
+	grig_cmdrec_t *rec;
+	gint64         t0;
+	guint          i;
+
+
+	t0 = g_array_index (recs, grig_cmdrec_t, 0).start;
+	gaps = g_array_new (FALSE, FALSE, sizeof (replay_gap_t));
+
+	for (i = 1; i < recs->len; i++) {
+		prev = &g_array_index (recs, grig_cmdrec_t, i - 1);
+		rec = &g_array_index (recs, grig_cmdrec_t, i);
+
+		gap.start = prev->start + prev->duration;
+		gap.length = rec->start - gap.start;
+		gap.before = i - 1;
+		g_array_append_val (gaps, gap);
+	}
+
+	g_array_sort (gaps, grig_replay_cmp_gap);
+
+	g_print (_("Longest gaps:\n"));
+	g_print ("  %10s %10s  %-24s %-24s\n", _("At [s]"), _("Idle [ms]"),
+		 _("After"), _("Before"));
+
+	for (i = 0; (i < gaps->len) && (i < (guint) top); i++) {
+		g = &g_array_index (gaps, replay_gap_t, i);
+		prev = &g_array_index (recs, grig_cmdrec_t, g->before);
+		rec = &g_array_index (recs, grig_cmdrec_t, g->before + 1);
+
+		g_print ("  %10.3f %10.2f  %-24s %-24s\n",
+			 (g->start - t0) / 1.0e6, g->length / 1000.0,
+			 (prev->cmd < names->len) ?
+			 (const gchar *) g_ptr_array_index (names, prev->cmd) : "?",
+			 (rec->cmd < names->len) ?
+			 (const gchar *) g_ptr_array_index (names, rec->cmd) : "?");
+	}
+	g_print ("\n");
+
+	g_array_free (gaps, TRUE);
+}
+
+
+/** \brief Print the staleness of the values read by 'get' commands.
+ *  \param recs The records.
+ *  \param names The command names.
+ *
+ * The age of a value grows until the next successful read of the same
+ * command, so the interval between two successful reads is the worst
+ * case staleness of what the user sees.
+ */
+static void
+grig_replay_staleness (GArray *recs, GPtrArray *names)
+{
+	grig_cmdrec_t *rec;
+	grig_cmdrec_t *prev;
+	gint64         maxage;
+	gint64         total;
+	guint          reads;
+	guint          changes;
+	guint          cmd;
+	guint          i;
+
+
+	g_print (_("Value staleness [ms]:\n"));
+	g_print ("  %-24s %8s %8s %9s %9s\n", _("Command"), _("Reads"),
+		 _("Changed"), _("Mean"), _("Max"));
+
+	for (cmd = 0; cmd < names->len; cmd++) {
+		if (!strstr (g_ptr_array_index (names, cmd), "_GET_"))
+			continue;
+
+		prev = NULL;
+		maxage = 0;
+		total = 0;
+		reads = 0;
+		changes = 0;
+
+		for (i = 0; i < recs->len; i++) {
+			rec = &g_array_index (recs, grig_cmdrec_t, i);
+			if ((rec->cmd != cmd) || (rec->retcode != RIG_OK))
+				continue;
+
+			if (prev != NULL) {
+				maxage = MAX (maxage, rec->start - prev->start);
+				total += rec->start - prev->start;
+				if (rec->value != prev->value)
+					changes++;
+			}
+
+			prev = rec;
+			reads++;
+		}
+
+		if (reads < 2)
+			continue;
+
+		g_print ("  %-24s %8u %8u %9.1f %9.1f\n",
+			 (const gchar *) g_ptr_array_index (names, cmd),
+			 reads, changes, total / (1000.0 * (reads - 1)),
+			 maxage / 1000.0);
+	}
+	g_print ("\n");
+}
+
+
+/** \brief Replay the commands against the simulated rig.
+ *  \param recs The records.
+ *  \param names The command names.
+ *  \return The simulated execution times (guint32) or NULL on error.
+ *
+ * The return codes of the simulation replace those of the records.
+ */
+static GArray *
+grig_replay_simulate (GArray *recs, GPtrArray *names)
+{
+	RIG           *rig;
+	GArray        *durs;
+	grig_cmdrec_t *rec;
+	gchar        **confvec;
+	gchar        **confent;
+	gint64         t0;
+	gint64         start;
+	gint64         due;
+	guint32        dur;
+	guint          i;
+
+
+	grig_debug_set_level (RIG_DEBUG_NONE);
+	grig_debug_init (NULL);
+	rig_sim_register ();
+
+	rig = rig_init (C_RIG_SIM_MODEL);
+	if (rig == NULL) {
+		g_printerr (_("Could not initialise the simulated rig\n"));
+		grig_debug_close ();
+		return NULL;
+	}
+
+	if (rigspeed > 0)
+		rig->state.rigport.parm.serial.rate = rigspeed;
+
+	if (rigconf != NULL) {
+		confvec = g_strsplit (rigconf, ",", 0);
+
+		for (i = 0; confvec[i] != NULL; i++) {
+			confent = g_strsplit (confvec[i], "=", 2);
+
+			if (rig_set_conf (rig, rig_token_lookup (rig, confent[0]),
+					  confent[1]) != RIG_OK) {
+				g_printerr (_("Invalid conf parameter %s\n"), confvec[i]);
+			}
+
+			g_strfreev (confent);
+		}
+
+		g_strfreev (confvec);
+	}
+
+	if (rig_open (rig) != RIG_OK) {
+		g_printerr (_("Could not open the simulated rig\n"));
+		rig_cleanup (rig);
+		grig_debug_close ();
+		return NULL;
+	}
+
+	durs = g_array_sized_new (FALSE, FALSE, sizeof (guint32), recs->len);
+	t0 = g_array_index (recs, grig_cmdrec_t, 0).start;
+	start = g_get_monotonic_time ();
+
+	for (i = 0; i < recs->len; i++) {
+		rec = &g_array_index (recs, grig_cmdrec_t, i);
+
+		/* wait for the original start; commands are never skipped */
+		if (pace) {
+			due = start + (rec->start - t0) - g_get_monotonic_time ();
+			if (due > 0)
+				g_usleep (due);
+		}
+
+		due = g_get_monotonic_time ();
+		rec->retcode = (rec->cmd < names->len) ?
+			grig_replay_exec (rig, g_ptr_array_index (names, rec->cmd), rec) : RIG_OK;
+		dur = (guint32) MIN (g_get_monotonic_time () - due, G_MAXUINT32);
+
+		g_array_append_val (durs, dur);
+	}
+
+	rig_close (rig);
+	rig_cleanup (rig);
+	grig_debug_close ();
+
+	return durs;
+}
+
+
+/** \brief Execute a recorded command on the simulated rig.
+ *  \param rig The simulated rig.
+ *  \param name The command name, eg. RIG_CMD_GET_FREQ_1.
+ *  \param rec The record; 'set' commands send the recorded value.
+ *  \return The Hamlib return code.
+ */
+static gint
+grig_replay_exec (RIG *rig, const gchar *name, const grig_cmdrec_t *rec)
+{
+	gboolean    set;
+	vfo_t       vfo;
+	freq_t      freq;
+	rmode_t     mode;
+	pbwidth_t   pbw;
+	ptt_t       ptt;
+	powerstat_t pstat;
+	shortfreq_t sfreq;
+	value_t     val;
+	gint        status;
+
+
+	if (g_str_has_prefix (name, "RIG_CMD_"))
+		name += strlen ("RIG_CMD_");
+
+	set = g_str_has_prefix (name, "SET_");
+
+	if (g_str_has_prefix (name, "VFO_")) {
+		vfo_op_t op = RIG_OP_TOGGLE;
+
+		if (!strcmp (name, "VFO_COPY"))
+			op = RIG_OP_CPY;
+		else if (!strcmp (name, "VFO_XCHG"))
+			op = RIG_OP_XCHG;
+
+		return rig_vfo_op (rig, RIG_VFO_CURR, op);
+	}
+
+	if (strstr (name, "_FREQ_")) {
+		vfo = g_str_has_suffix (name, "_2") ? RIG_VFO_B : RIG_VFO_CURR;
+		if (!set)
+			return rig_get_freq (rig, vfo, &freq);
+
+		memcpy (&freq, &rec->value, sizeof (freq));
+		return rig_set_freq (rig, vfo, freq);
+	}
+
+	if (g_str_has_suffix (name, "_MODE")) {
+		if (!set)
+			return rig_get_mode (rig, RIG_VFO_CURR, &mode, &pbw);
+
+		memcpy (&mode, &rec->value, sizeof (mode));
+		return rig_set_mode (rig, RIG_VFO_CURR, mode, RIG_PASSBAND_NORMAL);
+	}
+
+	if (g_str_has_suffix (name, "_VFO")) {
+		if (!set)
+			return rig_get_vfo (rig, &vfo);
+
+		memcpy (&vfo, &rec->value, sizeof (vfo));
+		return rig_set_vfo (rig, vfo);
+	}
+
+	if (g_str_has_suffix (name, "_PTT")) {
+		if (!set)
+			return rig_get_ptt (rig, RIG_VFO_CURR, &ptt);
+
+		memcpy (&ptt, &rec->value, sizeof (ptt));
+		return rig_set_ptt (rig, RIG_VFO_CURR, ptt);
+	}
+
+	if (g_str_has_suffix (name, "_PSTAT")) {
+		if (!set)
+			return rig_get_powerstat (rig, &pstat);
+
+		memcpy (&pstat, &rec->value, sizeof (pstat));
+		return rig_set_powerstat (rig, pstat);
+	}
+
+	if (g_str_has_suffix (name, "_RIT") || g_str_has_suffix (name, "_XIT")) {
+		gboolean rit = g_str_has_suffix (name, "_RIT");
+
+		if (!set)
+			return rit ? rig_get_rit (rig, RIG_VFO_CURR, &sfreq) :
+				rig_get_xit (rig, RIG_VFO_CURR, &sfreq);
+
+		memcpy (&sfreq, &rec->value, sizeof (sfreq));
+		return rit ? rig_set_rit (rig, RIG_VFO_CURR, sfreq) :
+			rig_set_xit (rig, RIG_VFO_CURR, sfreq);
+	}
+
+	if (g_str_has_suffix (name, "_FUNC") || g_str_has_suffix (name, "_LOCK")) {
+		if (!set)
+			return rig_get_func (rig, RIG_VFO_CURR, RIG_FUNC_LOCK, &status);
+
+		return rig_set_func (rig, RIG_VFO_CURR, RIG_FUNC_LOCK, rec->value != 0);
+	}
+
+	/* everything else is a level as far as the simulator is concerned */
+	if (!set)
+		return rig_get_level (rig, RIG_VFO_CURR, RIG_LEVEL_AF, &val);
+
+	val.f = 0.5;
+	return rig_set_level (rig, RIG_VFO_CURR, RIG_LEVEL_AF, val);
+}
+
+
+/** \brief Print recorded and simulated execution times side by side.
+ *  \param recs The records, with the simulated return codes.
+ *  \param simdurs The simulated execution times.
+ *  \param names The command names.
+ */
+static void
+grig_replay_compare (GArray *recs, GArray *simdurs, GPtrArray *names)
+{
+	GArray        *real;
+	GArray        *sim;
+	replay_stat_t *r;
+	replay_stat_t *s;
+	gint64         rtotal = 0;
+	gint64         stotal = 0;
+	guint          i;
+
+
+	/* the recorded times do not depend on the return codes */
+	real = grig_replay_stats (recs, NULL, names->len);
+	sim = grig_replay_stats (recs, simdurs, names->len);
+
+	g_print (_("Recorded vs. simulated [ms]:\n"));
+	g_print ("  %-24s %8s %8s %8s %8s %8s %7s\n", _("Command"), _("Count"),
+		 _("Mean"), _("Sim"), _("p99"), _("Sim"), _("Errors"));
+
+	for (i = 0; i < names->len; i++) {
+		r = &g_array_index (real, replay_stat_t, i);
+		s = &g_array_index (sim, replay_stat_t, i);
+		if (r->count == 0)
+			continue;
+
+		g_print ("  %-24s %8u %8.2f %8.2f %8.2f %8.2f %7u\n",
+			 (const gchar *) g_ptr_array_index (names, i), r->count,
+			 r->total / (1000.0 * r->count), s->total / (1000.0 * s->count),
+			 grig_replay_percentile (r->durs, 0.99) / 1000.0,
+			 grig_replay_percentile (s->durs, 0.99) / 1000.0,
+			 s->errors);
+
+		rtotal += r->total;
+		stotal += s->total;
+	}
+
+	g_print (_("  Total busy time: recorded %.1f s, simulated %.1f s\n"),
+		 rtotal / 1.0e6, stotal / 1.0e6);
+	g_print ("\n");
+
+	grig_replay_stats_free (real);
+	grig_replay_stats_free (sim);
+}
+
+
+/** \brief Show help message. */
+static void
+grig_replay_help ()
+{
+	g_print (_("Usage: grig-replay [OPTION]... FILE\n\n"));
+	g_print (_("Analyse a command record saved by grig --record.\n\n"));
+	g_print (_("  -n, --top=N                 "\
+		   "number of entries in each list (default: %d)\n"), C_REPLAY_DEF_TOP);
+	g_print (_("  -s, --simulate              "\
+		   "replay the commands against the simulated rig\n"));
+	g_print (_("  -C, --set-conf=param=val    "\
+		   "set simulator parameters, eg. latency=10,timeouts=1\n"));
+	g_print (_("  -b, --speed=BAUD            "\
+		   "simulated transfer rate (default: %d)\n"), C_RIG_SIM_DEF_RATE);
+	g_print (_("  -p, --pace                  "\
+		   "keep the original start times when simulating\n"));
+	g_print (_("  -h, --help                  "\
+		   "show this help message and exit\n"));
+	g_print ("\n");
+}
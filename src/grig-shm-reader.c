@@ -0,0 +1,237 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    grig-shm-reader.c
+ *  \ingroup shm
+ *  \brief   Reader of the shared memory rig state.
+ *
+ * This is the library used by other programs to read the state published
+ * by grig, see grig-shm.h. It only needs POSIX and, for waiting on Linux,
+ * the futex system call; it does not use GLib so that it can be linked
+ * into any program.
+ *
+ * The segment is mapped read-only. Readers never block grig: a read that
+ * overlaps an update is simply repeated.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#endif
+#include "grig-shm.h"
+
+
+/** \brief An open segment. */
+struct grig_shm_reader {
+	const grig_shm_t *shm;    /*!< The mapped segment. */
+	size_t            size;   /*!< Size of the mapping. */
+};
+
+
+
+/** \brief Open the segment of a rig.
+ *  \param rig The rig number, 0 for the first rig.
+ *  \return The segment or NULL if grig does not publish the rig or the
+ *          layout is not the one of this header (errno is set).
+ */
+grig_shm_reader_t *
+grig_shm_open (int rig)
+{
+	grig_shm_reader_t *reader;
+	struct stat        st;
+	char               name[32];
+	void              *map;
+	int                fd;
+
+
+	snprintf (name, sizeof (name), GRIG_SHM_NAME, rig);
+
+	fd = shm_open (name, O_RDONLY, 0);
+	if (fd < 0)
+		return NULL;
+
+	if ((fstat (fd, &st) < 0) || (st.st_size < (off_t) sizeof (grig_shm_t))) {
+		close (fd);
+		errno = EPROTO;
+		return NULL;
+	}
+
+	map = mmap (NULL, sizeof (grig_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+
+	if (map == MAP_FAILED)
+		return NULL;
+
+	if ((((const grig_shm_t *) map)->magic != GRIG_SHM_MAGIC) ||
+	    (((const grig_shm_t *) map)->version != GRIG_SHM_VERSION) ||
+	    (((const grig_shm_t *) map)->size != sizeof (grig_shm_t))) {
+		munmap (map, sizeof (grig_shm_t));
+		errno = EPROTO;
+		return NULL;
+	}
+
+	reader = calloc (1, sizeof (*reader));
+	if (reader == NULL) {
+		munmap (map, sizeof (grig_shm_t));
+		return NULL;
+	}
+
+	reader->shm = map;
+	reader->size = sizeof (grig_shm_t);
+
+	return reader;
+}
+
+
+/** \brief Close a segment.
+ *  \param shm The segment or NULL.
+ */
+void
+grig_shm_close (grig_shm_reader_t *shm)
+{
+	if (shm == NULL)
+		return;
+
+	munmap ((void *) shm->shm, shm->size);
+	free (shm);
+}
+
+
+/** \brief Get the header of a segment.
+ *  \param shm The segment.
+ *  \return The mapped segment; only the constant header fields may be
+ *          read directly, use grig_shm_read() for the state.
+ */
+const grig_shm_t *
+grig_shm_header (const grig_shm_reader_t *shm)
+{
+	return shm->shm;
+}
+
+
+/** \brief Read a consistent copy of the state.
+ *  \param shm The segment.
+ *  \param state Where to store the copy.
+ *  \return The sequence number of the copy, to be passed to grig_shm_wait().
+ */
+uint32_t
+grig_shm_read (const grig_shm_reader_t *shm, grig_shm_state_t *state)
+{
+	const grig_shm_t *s = shm->shm;
+	uint32_t          seq;
+
+
+	do {
+		/* wait for the writer to finish */
+		while ((seq = __atomic_load_n (&s->seq, __ATOMIC_ACQUIRE)) & 1) {
+		}
+
+		memcpy (state, (const void *) &s->state, sizeof (*state));
+
+		__atomic_thread_fence (__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n (&s->seq, __ATOMIC_RELAXED) != seq);
+
+	return seq;
+}
+
+
+/** \brief Wait for an update.
+ *  \param shm The segment.
+ *  \param seq The sequence number returned by grig_shm_read().
+ *  \param timeout Maximum time to wait [msec]; negative waits forever.
+ *  \return 1 if the state has changed since seq, 0 on timeout.
+ *
+ * On Linux the caller sleeps on the futex; elsewhere the sequence number
+ * is checked every millisecond.
+ */
+int
+grig_shm_wait (const grig_shm_reader_t *shm, uint32_t seq, int timeout)
+{
+	const grig_shm_t *s = shm->shm;
+	struct timespec   end;
+	struct timespec   now;
+	struct timespec   rel;
+	int64_t           left;
+
+
+	clock_gettime (CLOCK_MONOTONIC, &end);
+	end.tv_sec += timeout / 1000;
+	end.tv_nsec += (timeout % 1000) * 1000000L;
+	if (end.tv_nsec >= 1000000000L) {
+		end.tv_sec++;
+		end.tv_nsec -= 1000000000L;
+	}
+
+	while (__atomic_load_n (&s->seq, __ATOMIC_ACQUIRE) == seq) {
+
+		if (timeout >= 0) {
+			clock_gettime (CLOCK_MONOTONIC, &now);
+			left = (int64_t) (end.tv_sec - now.tv_sec) * 1000000000LL +
+				(end.tv_nsec - now.tv_nsec);
+			if (left <= 0)
+				return 0;
+
+			rel.tv_sec = left / 1000000000LL;
+			rel.tv_nsec = left % 1000000000LL;
+		}
+
+#ifdef __linux__
+		/* returns at once if seq has already changed */
+		syscall (SYS_futex, &s->seq, FUTEX_WAIT, seq,
+			 (timeout >= 0) ? &rel : NULL, NULL, 0);
+#else
+		rel.tv_sec = 0;
+		rel.tv_nsec = 1000000L;
+		nanosleep (&rel, NULL);
+#endif
+	}
+
+	return 1;
+}
+
+
+/** \brief Check whether grig still publishes to a segment.
+ *  \param shm The segment.
+ *  \return 0 after grig has closed the segment.
+ */
+int
+grig_shm_alive (const grig_shm_reader_t *shm)
+{
+	return (__atomic_load_n (&shm->shm->flags, __ATOMIC_ACQUIRE) & GRIG_SHM_FLAG_ALIVE) != 0;
+}
@@ -0,0 +1,216 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+/** \file    grig-shm.h
+ *  \ingroup shm
+ *  \brief   Shared memory publication of the rig state.
+ *
+ * With --shm, grig publishes the values read from each rig in a POSIX
+ * shared memory segment named /grig-rigN, N being the rig number starting
+ * from 0. Local programs reading the frequency at a high rate can take a
+ * consistent copy without any system call and can sleep until the next
+ * update.
+ *
+ * The segment holds a grig_shm_t. The state is protected by a sequence
+ * lock: grig makes the sequence number odd while it updates the state and
+ * even again afterwards. The sequence number is also a futex word; grig
+ * wakes all waiters after each update.
+ *
+ * All times are CLOCK_MONOTONIC in microseconds. The layout only changes
+ * together with GRIG_SHM_VERSION. This header does not depend on GLib or
+ * Hamlib; the reader functions are in libgrigshm:
+ *
+ * \code
+ * grig_shm_reader_t  *shm = grig_shm_open (0);
+ * grig_shm_state_t    state;
+ * uint32_t            seq;
+ *
+ * while (shm != NULL) {
+ *         seq = grig_shm_read (shm, &state);
+ *         printf ("%.0f Hz\n", state.values.freq1);
+ *         grig_shm_wait (shm, seq, 1000);
+ * }
+ * \endcode
+ */
+#ifndef GRIG_SHM_H
+#define GRIG_SHM_H 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define GRIG_SHM_MAGIC     0x47524947u    /*!< "GRIG" */
+#define GRIG_SHM_VERSION   1              /*!< Layout version. */
+#define GRIG_SHM_NAME      "/grig-rig%d"  /*!< Segment name; %d is the rig number. */
+#define GRIG_SHM_FIELDS    64             /*!< Number of field time stamps. */
+
+#define GRIG_SHM_FLAG_ALIVE  0x1          /*!< Cleared when grig closes the segment. */
+
+
+/** \brief Index of a field in grig_shm_state_t::stamps. */
+typedef enum {
+	GRIG_SHM_FIELD_PSTAT = 0,
+	GRIG_SHM_FIELD_PTT,
+	GRIG_SHM_FIELD_LOCK,
+	GRIG_SHM_FIELD_VFO,
+	GRIG_SHM_FIELD_MODE,
+	GRIG_SHM_FIELD_PBW,
+	GRIG_SHM_FIELD_FREQ1,
+	GRIG_SHM_FIELD_FREQ2,
+	GRIG_SHM_FIELD_RIT,
+	GRIG_SHM_FIELD_XIT,
+	GRIG_SHM_FIELD_AGC,
+	GRIG_SHM_FIELD_ATT,
+	GRIG_SHM_FIELD_PREAMP,
+	GRIG_SHM_FIELD_SPLIT,
+	GRIG_SHM_FIELD_ANTENNA,
+	GRIG_SHM_FIELD_AFG,
+	GRIG_SHM_FIELD_RFG,
+	GRIG_SHM_FIELD_SQL,
+	GRIG_SHM_FIELD_IFS,
+	GRIG_SHM_FIELD_APF,
+	GRIG_SHM_FIELD_NR,
+	GRIG_SHM_FIELD_NOTCH,
+	GRIG_SHM_FIELD_PBTIN,
+	GRIG_SHM_FIELD_PBTOUT,
+	GRIG_SHM_FIELD_CWPITCH,
+	GRIG_SHM_FIELD_KEYSPD,
+	GRIG_SHM_FIELD_BKINDEL,
+	GRIG_SHM_FIELD_BALANCE,
+	GRIG_SHM_FIELD_VOXDEL,
+	GRIG_SHM_FIELD_VOXG,
+	GRIG_SHM_FIELD_ANTIVOX,
+	GRIG_SHM_FIELD_MICG,
+	GRIG_SHM_FIELD_COMP,
+	GRIG_SHM_FIELD_POWER,
+	GRIG_SHM_FIELD_STRENGTH,
+	GRIG_SHM_FIELD_SWR,
+	GRIG_SHM_FIELD_ALC,
+	GRIG_SHM_FIELD_FUNCS,
+	GRIG_SHM_FIELD_FLIMITS,
+	GRIG_SHM_FIELD_NUMBER
+} grig_shm_field_t;
+
+
+/** \brief The rig values.
+ *
+ * Enumerations and bit fields use the Hamlib values.
+ */
+typedef struct {
+	double    freq1;      /*!< Primary frequency [Hz]. */
+	double    freq2;      /*!< Secondary frequency [Hz]. */
+	double    fmin;       /*!< Lower frequency limit of the mode [Hz]. */
+	double    fmax;       /*!< Upper frequency limit of the mode [Hz]. */
+	uint64_t  mode;       /*!< rmode_t */
+	uint64_t  funcs;      /*!< Active functions, setting_t bits. */
+	uint32_t  vfo;        /*!< vfo_t */
+	uint32_t  antenna;    /*!< ant_t */
+	int32_t   pbw;        /*!< Passband: 0 wide, 1 normal, 2 narrow. */
+	int32_t   pstat;      /*!< powerstat_t */
+	int32_t   ptt;        /*!< ptt_t */
+	int32_t   lock;       /*!< Dial lock. */
+	int32_t   split;      /*!< split_t */
+	int32_t   rit;        /*!< RIT [Hz]. */
+	int32_t   xit;        /*!< XIT [Hz]. */
+	int32_t   fstep;      /*!< Smallest tuning step of the mode [Hz]. */
+	int32_t   agc;        /*!< AGC level. */
+	int32_t   att;        /*!< Attenuator [dB]. */
+	int32_t   preamp;     /*!< Preamplifier [dB]. */
+	int32_t   ifs;        /*!< IF shift [Hz]. */
+	int32_t   notch;      /*!< Notch frequency [Hz]. */
+	int32_t   cwpitch;    /*!< CW pitch [Hz]. */
+	int32_t   keyspd;     /*!< Keyer speed [WPM]. */
+	int32_t   bkindel;    /*!< Break-in delay. */
+	int32_t   voxdel;     /*!< VOX delay. */
+	int32_t   strength;   /*!< Signal strength [dB relative to S9]. */
+	float     afg;        /*!< AF gain 0..1 */
+	float     rfg;        /*!< RF gain 0..1 */
+	float     sql;        /*!< Squelch 0..1 */
+	float     apf;        /*!< APF 0..1 */
+	float     nr;         /*!< Noise reduction 0..1 */
+	float     pbtin;      /*!< PBT in 0..1 */
+	float     pbtout;     /*!< PBT out 0..1 */
+	float     balance;    /*!< Balance 0..1 */
+	float     voxg;       /*!< VOX gain 0..1 */
+	float     antivox;    /*!< Anti-VOX 0..1 */
+	float     micg;       /*!< Microphone gain 0..1 */
+	float     comp;       /*!< Compression 0..1 */
+	float     power;      /*!< TX power 0..1 */
+	float     swr;        /*!< SWR */
+	float     alc;        /*!< ALC 0..1 */
+	uint32_t  reserved;   /*!< Padding; zero. */
+} grig_shm_values_t;
+
+
+/** \brief The state protected by the sequence lock. */
+typedef struct {
+	uint64_t           updates;   /*!< Number of updates since grig started. */
+	int64_t            updated;   /*!< Time of the last update. */
+	int64_t            stamps[GRIG_SHM_FIELDS];  /*!< Time of the last change of each field. */
+	grig_shm_values_t  values;    /*!< The values. */
+} grig_shm_state_t;
+
+
+/** \brief Layout of the shared memory segment. */
+typedef struct {
+	uint32_t           magic;     /*!< GRIG_SHM_MAGIC */
+	uint32_t           version;   /*!< GRIG_SHM_VERSION */
+	uint32_t           size;      /*!< sizeof (grig_shm_t) */
+	uint32_t           flags;     /*!< GRIG_SHM_FLAG_ALIVE */
+	int32_t            pid;       /*!< Process ID of grig. */
+	int32_t            model;     /*!< Hamlib rig model. */
+	volatile uint32_t  seq;       /*!< Sequence lock and futex word. */
+	uint32_t           reserved;  /*!< Padding; zero. */
+	grig_shm_state_t   state;     /*!< The state. */
+} grig_shm_t;
+
+
+/** \brief An open segment, see grig_shm_open(). */
+typedef struct grig_shm_reader grig_shm_reader_t;
+
+
+grig_shm_reader_t *grig_shm_open   (int rig);
+void               grig_shm_close  (grig_shm_reader_t *shm);
+const grig_shm_t  *grig_shm_header (const grig_shm_reader_t *shm);
+uint32_t           grig_shm_read   (const grig_shm_reader_t *shm, grig_shm_state_t *state);
+int                grig_shm_wait   (const grig_shm_reader_t *shm, uint32_t seq, int timeout);
+int                grig_shm_alive  (const grig_shm_reader_t *shm);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,242 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    grig-startup.c
+ *  \ingroup debug
+ *  \brief   Timing of the start-up phases.
+ *
+ * The start-up of grig is divided into phases like opening the rig port,
+ * detecting the capabilities, building the widgets or reading the initial
+ * values. Each phase is measured like this:
+ *
+ * \code
+ * gint64 start = grig_startup_begin ();
+ * ...
+ * grig_startup_end ("open", rig, start);
+ * \endcode
+ *
+ * Phases may run in any thread; the phase names must be static strings.
+ * They are also recorded in the timeline, see grig-timeline.c.
+ *
+ * Some phases, like reading the initial values, end after the main window
+ * has been shown. They call grig_startup_hold() when they are started and
+ * grig_startup_release() when they are done; the start-up is complete when
+ * nothing holds it anymore. At that point the total time and the peak
+ * memory use are logged and, with grig --startup-profile, the phases are
+ * printed to stderr. Later phases are not recorded.
+ */
+#include <sys/resource.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <hamlib/rig.h>
+#include "grig-debug.h"
+#include "grig-startup.h"
+#include "grig-timeline.h"
+
+
+/** \brief One start-up phase. */
+typedef struct {
+	const gchar *phase;    /*!< Name of the phase. */
+	gint         rig;      /*!< The rig or -1. */
+	gint64       start;    /*!< Monotonic start time [usec]. */
+	gint64       dur;      /*!< Duration [usec]. */
+	gboolean     main;     /*!< Whether the phase ran in the main thread. */
+} startup_phase_t;
+
+
+static gint64    t0 = 0;              /*!< Time of grig_startup_init(). */
+static GThread  *mainthread = NULL;   /*!< The thread that called grig_startup_init(). */
+static GMutex    phasemutex;          /*!< Protects phases and holds. */
+static GArray   *phases = NULL;       /*!< startup_phase_t; NULL when complete. */
+static guint     holds = 0;           /*!< Number of unfinished asynchronous phases. */
+static gchar    *mode = NULL;         /*!< Name of the mode grig runs in. */
+static gboolean  print = FALSE;       /*!< Print the phases when complete. */
+
+
+static gboolean grig_startup_report (gpointer);
+
+
+
+/** \brief Start measuring the start-up.
+ *
+ * This function should be the first thing main() calls. The start-up is
+ * held by the main program until it calls grig_startup_release().
+ */
+void
+grig_startup_init ()
+{
+	t0 = g_get_monotonic_time ();
+	mainthread = g_thread_self ();
+	phases = g_array_new (FALSE, FALSE, sizeof (startup_phase_t));
+	holds = 1;
+}
+
+
+/** \brief Configure the report.
+ *  \param name The mode grig runs in, eg. "GUI".
+ *  \param enable Whether the phases are printed to stderr.
+ */
+void
+grig_startup_set_report (const gchar *name, gboolean enable)
+{
+	g_free (mode);
+	mode = g_strdup (name);
+	print = enable;
+}
+
+
+/** \brief Start a phase.
+ *  \return The start time to pass to grig_startup_end().
+ */
+gint64
+grig_startup_begin ()
+{
+	return g_get_monotonic_time ();
+}
+
+
+/** \brief Finish a phase.
+ *  \param phase The name of the phase (static string).
+ *  \param rig The rig the phase belongs to or -1.
+ *  \param start The time returned by grig_startup_begin().
+ */
+void
+grig_startup_end (const gchar *phase, gint rig, gint64 start)
+{
+	startup_phase_t p;
+
+
+	grig_timeline_end ("startup", phase, start, (rig < 0) ? NULL : "rig", rig);
+
+	p.phase = phase;
+	p.rig = rig;
+	p.start = start;
+	p.dur = g_get_monotonic_time () - start;
+	p.main = (g_thread_self () == mainthread);
+
+	g_mutex_lock (&phasemutex);
+	if (phases != NULL)
+		g_array_append_val (phases, p);
+	g_mutex_unlock (&phasemutex);
+}
+
+
+/** \brief Hold the start-up until an asynchronous phase is done. */
+void
+grig_startup_hold ()
+{
+	g_mutex_lock (&phasemutex);
+	if (phases != NULL)
+		holds++;
+	g_mutex_unlock (&phasemutex);
+}
+
+
+/** \brief Release a hold taken with grig_startup_hold().
+ *
+ * May be called from any thread; the report is made in the main loop.
+ */
+void
+grig_startup_release ()
+{
+	g_mutex_lock (&phasemutex);
+	if ((phases != NULL) && (holds > 0) && (--holds == 0))
+		g_idle_add (grig_startup_report, NULL);
+	g_mutex_unlock (&phasemutex);
+}
+
+
+/** \brief Report the complete start-up.
+ *  \param data Unused.
+ *  \return Always FALSE to remove the idle source.
+ */
+static gboolean
+grig_startup_report (gpointer data)
+{
+	struct rusage    usage;
+	GArray          *done;
+	GString         *out;
+	startup_phase_t *p;
+	gint64           total;
+	guint            i;
+
+
+	total = g_get_monotonic_time () - t0;
+	getrusage (RUSAGE_SELF, &usage);
+
+	g_mutex_lock (&phasemutex);
+	done = phases;
+	phases = NULL;
+	g_mutex_unlock (&phasemutex);
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Started in %s mode after %" G_GINT64_FORMAT \
+			    " ms using %ld kB of memory"),
+			  __FUNCTION__, mode ? mode : "GUI",
+			  total / 1000, usage.ru_maxrss);
+
+	if (print) {
+		out = g_string_new (NULL);
+
+		g_string_append_printf (out, _("Start-up profile (%s mode):\n"),
+					mode ? mode : "GUI");
+		g_string_append_printf (out, "  %-24s %10s %10s  %s\n",
+					_("Phase"), _("Start [ms]"),
+					_("Time [ms]"), _("Thread"));
+
+		for (i = 0; i < done->len; i++) {
+			gchar *name;
+
+			p = &g_array_index (done, startup_phase_t, i);
+
+			name = (p->rig < 0) ? g_strdup (p->phase) :
+				g_strdup_printf (_("rig %d %s"), p->rig, p->phase);
+
+			g_string_append_printf (out, "  %-24s %10.1f %10.1f  %s\n",
+						name,
+						(p->start - t0) / 1000.0,
+						p->dur / 1000.0,
+						p->main ? _("main") : _("daemon"));
+			g_free (name);
+		}
+
+		g_string_append_printf (out, _("  Complete after %.1f ms, "\
+					       "peak memory %ld kB\n"),
+					total / 1000.0, usage.ru_maxrss);
+
+		g_printerr ("%s", out->str);
+		g_string_free (out, TRUE);
+	}
+
+	g_array_free (done, TRUE);
+
+	return FALSE;
+}
@@ -0,0 +1,390 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    grig-timeline.c
+ *  \ingroup debug
+ *  \brief   Timeline of daemon commands and GUI callbacks.
+ *
+ * When enabled with grig --timeline=FILE, the daemon commands, the GUI
+ * timers and the expose handlers are recorded as duration events and
+ * written to FILE on exit in the Trace Event Format (JSON), which can be
+ * opened with chrome://tracing or ui.perfetto.dev to see how polling and
+ * redrawing interleave.
+ *
+ * Each thread appends to its own buffer so that recording takes no lock;
+ * a lock is only taken when a thread records its first event. Event names
+ * and categories are not copied and must be static strings. The buffers
+ * are written out by grig_timeline_close() after the daemon threads have
+ * stopped. A thread that is still running then, e.g. a daemon thread
+ * stuck in a command that rig_daemon_stop() gave up waiting for, keeps
+ * its buffer; its events are not written and the buffer is freed when the
+ * thread exits.
+ *
+ * A callback is instrumented like this:
+ *
+ * \code
+ * gint64 start = grig_timeline_begin ();
+ * ...
+ * grig_timeline_end ("timer", __FUNCTION__, start, NULL, 0);
+ * \endcode
+ *
+ * grig_timeline_begin() returns 0 when the timeline is disabled and
+ * grig_timeline_end() then returns immediately.
+ */
+#include <glib.h>
+#include <glib/gi18n.h>
+#include "grig-timeline.h"
+
+
+/** \brief One duration event. */
+typedef struct {
+	const gchar *cat;       /*!< Category. */
+	const gchar *name;      /*!< Name. */
+	const gchar *argname;   /*!< Name of the argument or NULL. */
+	gint64       arg;       /*!< Argument value. */
+	gint64       start;     /*!< Monotonic start time [usec]. */
+	gint64       dur;       /*!< Duration [usec]. */
+} timeline_event_t;
+
+
+/** \brief Events of one thread. */
+typedef struct {
+	guint    tid;       /*!< Thread number in the trace. */
+	gchar   *name;      /*!< Thread name or NULL. */
+	GArray  *events;    /*!< timeline_event_t */
+	guint    dropped;   /*!< Events dropped because the buffer was full. */
+	gboolean exited;    /*!< The thread has exited; protected by threadmutex. */
+} timeline_thread_t;
+
+
+static void grig_timeline_thread_exit (gpointer);
+
+static gint      enabled = FALSE;     /*!< Whether events are recorded; atomic. */
+static gchar    *outfile = NULL;      /*!< The output file. */
+static gint64    t0;                  /*!< Time of grig_timeline_init(). */
+static GMutex    threadmutex;         /*!< Protects threads. */
+static GPtrArray *threads = NULL;     /*!< All timeline_thread_t. */
+static GPrivate  curthread = G_PRIVATE_INIT (grig_timeline_thread_exit);
+                                      /*!< The timeline_thread_t of the calling thread. */
+
+
+static timeline_thread_t *grig_timeline_thread (void);
+static void               grig_timeline_escape (GString *, const gchar *);
+
+
+
+/** \brief Enable the timeline.
+ *  \param filename The file written by grig_timeline_close().
+ *  \return TRUE if the timeline has been enabled.
+ *
+ * The calling thread becomes thread 1, usually the GTK main thread. The
+ * timeline can only be enabled once per process since the threads keep
+ * their buffer pointers.
+ */
+gboolean
+grig_timeline_init (const gchar *filename)
+{
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	if (t0 != 0)
+		return FALSE;
+
+	outfile = g_strdup (filename);
+	threads = g_ptr_array_new ();
+	t0 = g_get_monotonic_time ();
+	g_atomic_int_set (&enabled, TRUE);
+
+	grig_timeline_thread_name ("main");
+
+	return TRUE;
+}
+
+
+/** \brief Write the timeline and disable it.
+ *  \param error Location for the error or NULL.
+ *  \return TRUE if the file has been written or the timeline is disabled.
+ *
+ * Only the events of the calling thread and of the threads that have
+ * exited are written. The buffer of a thread that is still running may
+ * still be in use; it is left alone and freed when the thread exits.
+ */
+gboolean
+grig_timeline_close (GError **error)
+{
+	timeline_thread_t *th;
+	timeline_thread_t *self;
+	timeline_event_t  *ev;
+	GString           *json;
+	gboolean           ok;
+	guint              i;
+	guint              j;
+
+
+	if (!g_atomic_int_get (&enabled))
+		return TRUE;
+
+	g_atomic_int_set (&enabled, FALSE);
+
+	/* the caller's buffer is freed below, not when it exits */
+	self = g_private_get (&curthread);
+	g_private_set (&curthread, NULL);
+
+	json = g_string_sized_new (1 << 20);
+	g_string_append (json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	g_string_append (json, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+			 "\"args\":{\"name\":\"grig\"}}");
+
+	g_mutex_lock (&threadmutex);
+
+	for (i = 0; i < threads->len; i++) {
+		th = g_ptr_array_index (threads, i);
+
+		if ((th != self) && !th->exited) {
+			g_printerr (_("Timeline: thread %u is still running; "
+				      "its events are not written\n"), th->tid);
+			continue;
+		}
+
+		if (th->name != NULL) {
+			g_string_append_printf (json, ",\n{\"name\":\"thread_name\",\"ph\":\"M\","
+						"\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", th->tid);
+			grig_timeline_escape (json, th->name);
+			g_string_append (json, "\"}}");
+		}
+
+		for (j = 0; j < th->events->len; j++) {
+			ev = &g_array_index (th->events, timeline_event_t, j);
+
+			g_string_append (json, ",\n{\"name\":\"");
+			grig_timeline_escape (json, ev->name);
+			g_string_append (json, "\",\"cat\":\"");
+			grig_timeline_escape (json, ev->cat);
+			g_string_append_printf (json, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+						"\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT,
+						th->tid, ev->start - t0, ev->dur);
+
+			if (ev->argname != NULL) {
+				g_string_append (json, ",\"args\":{\"");
+				grig_timeline_escape (json, ev->argname);
+				g_string_append_printf (json, "\":%" G_GINT64_FORMAT "}", ev->arg);
+			}
+
+			g_string_append_c (json, '}');
+		}
+
+		if (th->dropped) {
+			g_printerr (_("Timeline: %u events of thread %u dropped\n"),
+				    th->dropped, th->tid);
+		}
+
+		g_array_free (th->events, TRUE);
+		g_free (th->name);
+		g_free (th);
+	}
+
+	g_ptr_array_free (threads, TRUE);
+	threads = NULL;
+
+	g_mutex_unlock (&threadmutex);
+
+	g_string_append (json, "\n]}\n");
+
+	ok = g_file_set_contents (outfile, json->str, json->len, error);
+
+	g_string_free (json, TRUE);
+	g_free (outfile);
+	outfile = NULL;
+
+	return ok;
+}
+
+
+/** \brief Check whether the timeline is enabled.
+ *  \return TRUE if events are recorded.
+ */
+gboolean
+grig_timeline_enabled ()
+{
+	return g_atomic_int_get (&enabled);
+}
+
+
+/** \brief Name the calling thread in the timeline.
+ *  \param name The name shown by the trace viewer.
+ */
+void
+grig_timeline_thread_name (const gchar *name)
+{
+	timeline_thread_t *th;
+
+
+	if (!g_atomic_int_get (&enabled))
+		return;
+
+	th = grig_timeline_thread ();
+	if (th == NULL)
+		return;
+
+	g_free (th->name);
+	th->name = g_strdup (name);
+}
+
+
+/** \brief Start an event.
+ *  \return The start time to pass to grig_timeline_end(), 0 if disabled.
+ */
+gint64
+grig_timeline_begin ()
+{
+	return g_atomic_int_get (&enabled) ? g_get_monotonic_time () : 0;
+}
+
+
+/** \brief Record an event.
+ *  \param cat The category (static string).
+ *  \param name The name (static string).
+ *  \param start The start time from grig_timeline_begin() or g_get_monotonic_time().
+ *  \param argname The name of the argument (static string) or NULL.
+ *  \param arg The value of the argument.
+ *
+ * The event ends now.
+ */
+void
+grig_timeline_end (const gchar *cat, const gchar *name, gint64 start,
+		   const gchar *argname, gint64 arg)
+{
+	timeline_thread_t *th;
+	timeline_event_t   ev;
+
+
+	if (!g_atomic_int_get (&enabled) || (start == 0))
+		return;
+
+	th = grig_timeline_thread ();
+	if (th == NULL)
+		return;
+
+	if (th->events->len >= C_TIMELINE_MAX_EVENTS) {
+		th->dropped++;
+		return;
+	}
+
+	ev.cat = cat;
+	ev.name = name;
+	ev.argname = argname;
+	ev.arg = arg;
+	ev.start = start;
+	ev.dur = g_get_monotonic_time () - start;
+
+	g_array_append_val (th->events, ev);
+}
+
+
+/** \brief Get the buffer of the calling thread.
+ *  \return The buffer; created on first use. NULL if the timeline has
+ *          been closed meanwhile.
+ */
+static timeline_thread_t *
+grig_timeline_thread ()
+{
+	timeline_thread_t *th;
+
+
+	th = g_private_get (&curthread);
+	if (th != NULL)
+		return th;
+
+	th = g_new0 (timeline_thread_t, 1);
+	th->events = g_array_sized_new (FALSE, FALSE, sizeof (timeline_event_t), 4096);
+
+	g_mutex_lock (&threadmutex);
+	if (threads == NULL) {
+		g_mutex_unlock (&threadmutex);
+		g_array_free (th->events, TRUE);
+		g_free (th);
+		return NULL;
+	}
+	th->tid = threads->len + 1;
+	g_ptr_array_add (threads, th);
+	g_mutex_unlock (&threadmutex);
+
+	g_private_set (&curthread, th);
+
+	return th;
+}
+
+
+/** \brief Release the buffer of an exiting thread.
+ *  \param data The timeline_thread_t of the thread.
+ *
+ * Before grig_timeline_close() the buffer is only marked so that its
+ * events are written; afterwards nobody else refers to it.
+ */
+static void
+grig_timeline_thread_exit (gpointer data)
+{
+	timeline_thread_t *th = (timeline_thread_t *) data;
+
+
+	g_mutex_lock (&threadmutex);
+
+	if (threads != NULL) {
+		th->exited = TRUE;
+		th = NULL;
+	}
+
+	g_mutex_unlock (&threadmutex);
+
+	if (th != NULL) {
+		g_array_free (th->events, TRUE);
+		g_free (th->name);
+		g_free (th);
+	}
+}
+
+
+/** \brief Append a string as JSON string contents.
+ *  \param json The output.
+ *  \param str The string.
+ */
+static void
+grig_timeline_escape (GString *json, const gchar *str)
+{
+	for (; *str; str++) {
+		if ((*str == '"') || (*str == '\\'))
+			g_string_append_c (json, '\\');
+
+		if ((guchar) *str < 0x20)
+			g_string_append_printf (json, "\\u%04x", *str);
+		else
+			g_string_append_c (json, *str);
+	}
+}
@@ -0,0 +1,50 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+#ifndef GRIG_TIMELINE_H
+#define GRIG_TIMELINE_H 1
+
+#include <glib.h>
+
+
+#define C_TIMELINE_MAX_EVENTS  1000000   /*!< Events kept per thread; later ones are dropped. */
+
+
+gboolean  grig_timeline_init        (const gchar *filename);
+gboolean  grig_timeline_close       (GError **error);
+gboolean  grig_timeline_enabled     (void);
+void      grig_timeline_thread_name (const gchar *name);
+gint64    grig_timeline_begin       (void);
+void      grig_timeline_end         (const gchar *cat, const gchar *name, gint64 start,
+				     const gchar *argname, gint64 arg);
+
+#endif
@@ -0,0 +1,707 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+/** \file    grig-trace.c
+ *  \brief   Binary debug trace files.
+ *
+ * Instead of text, the debug handler can write the log file as a binary
+ * trace (see grig_debug_set_binary()). A trace starts with a
+ * grig_trace_header_t followed by blocks. Each block has a
+ * grig_trace_block_t header with the number and size of its records, the
+ * time range they cover and bit masks of their levels, sources and
+ * commands. The records follow as a grig_trace_rec_t header and the
+ * message text.
+ *
+ * When the file is closed, an index of all blocks is appended, see
+ * grig_trace_index_t. A reader filtering by level, source, time or command
+ * walks the index and only maps in the blocks that can match. A trace
+ * without index, e.g. after a crash, is read block by block instead; the
+ * headers still let the reader skip the records of blocks that can not
+ * match. Appending to a trace rebuilds the index from the block headers,
+ * so that the index written at the end covers the whole file.
+ *
+ * All numbers are written in the byte order of the writer; the header
+ * carries a byte order mark and traces from a machine with the other byte
+ * order are rejected.
+ *
+ * grig_trace_to_text() converts a trace back to the text format, which is
+ * what "grig --log-to-text" and the message window use.
+ */
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <hamlib/rig.h>
+#include "grig-debug.h"
+#include "grig-trace.h"
+
+
+/* the structures are written as they are, so they must not have padding */
+G_STATIC_ASSERT (sizeof (grig_trace_header_t) == 16);
+G_STATIC_ASSERT (sizeof (grig_trace_block_t) == 40);
+G_STATIC_ASSERT (sizeof (grig_trace_rec_t) == 16);
+G_STATIC_ASSERT (sizeof (grig_trace_index_t) == 40);
+G_STATIC_ASSERT (sizeof (grig_trace_trailer_t) == 16);
+
+
+static gboolean trace_header_check (const gchar *contents, gsize length,
+				    const gchar *filename, GError **error);
+static gsize    trace_block_read  (const gchar *contents, gsize length,
+				   gsize pos, grig_trace_block_t *blk);
+static gboolean trace_index_read  (const gchar *contents, gsize length,
+				   grig_trace_trailer_t *trailer);
+static gboolean trace_block_foreach (const gchar *contents, gsize pos,
+				     gsize end,
+				     const grig_trace_filter_t *filter,
+				     grig_trace_func_t func,
+				     gpointer data);
+static gboolean trace_block_match (const grig_trace_block_t *blk,
+				   const grig_trace_filter_t *filter);
+static gboolean trace_rec_match   (const grig_trace_rec_t *rec,
+				   const grig_trace_filter_t *filter);
+static gboolean trace_text_line   (const grig_trace_rec_t *rec,
+				   const gchar *text,
+				   gpointer data);
+
+
+/** \brief Text conversion state. */
+typedef struct {
+	FILE               *out;
+	GString            *buf;
+	grig_debug_stamp_t *stamp;
+} trace_text_t;
+
+
+/** \brief Initialise a filter that matches everything. */
+void
+grig_trace_filter_all (grig_trace_filter_t *filter)
+{
+	filter->levels = 0xff;
+	filter->sources = 0xff;
+	filter->from = 0;
+	filter->to = 0;
+	filter->cmd = -1;
+}
+
+
+/** \brief Write the file header.
+ *  \param writer The writer; its index is reset.
+ *  \param file The trace file, positioned at the start.
+ *  \return The number of bytes written.
+ */
+gsize
+grig_trace_write_header (grig_trace_writer_t *writer, FILE *file)
+{
+	grig_trace_header_t hdr;
+
+	memcpy (hdr.magic, GRIG_TRACE_MAGIC, sizeof (hdr.magic));
+	hdr.bom = GRIG_TRACE_BOM;
+	hdr.version = GRIG_TRACE_VERSION;
+
+	if (writer->index == NULL) {
+		writer->index = g_array_new (FALSE, FALSE, sizeof (grig_trace_index_t));
+	}
+	g_array_set_size (writer->index, 0);
+	writer->offset = fwrite (&hdr, 1, sizeof (hdr), file);
+
+	return writer->offset;
+}
+
+
+/** \brief Prepare to append to an existing trace.
+ *  \param writer The writer.
+ *  \param filename The trace file.
+ *  \return TRUE if the file is a trace that can be appended to.
+ *
+ * The index of the blocks already in the file is rebuilt from their
+ * headers; the old index is dropped and written anew when the file is
+ * closed. Nothing but the block headers is read.
+ */
+gboolean
+grig_trace_resume (grig_trace_writer_t *writer, const gchar *filename)
+{
+	GMappedFile         *map;
+	const gchar         *contents;
+	gsize                length;
+	gsize                pos;
+	gsize                hdrsize;
+	grig_trace_block_t   blk;
+	grig_trace_index_t   entry;
+
+
+	map = g_mapped_file_new (filename, FALSE, NULL);
+	if (map == NULL) {
+		return FALSE;
+	}
+
+	contents = g_mapped_file_get_contents (map);
+	length = g_mapped_file_get_length (map);
+
+	if (!trace_header_check (contents, length, filename, NULL)) {
+		g_mapped_file_unref (map);
+		return FALSE;
+	}
+
+	if (writer->index == NULL) {
+		writer->index = g_array_new (FALSE, FALSE, sizeof (grig_trace_index_t));
+	}
+	g_array_set_size (writer->index, 0);
+
+	pos = sizeof (grig_trace_header_t);
+
+	while ((hdrsize = trace_block_read (contents, length, pos, &blk)) > 0) {
+
+		if (blk.magic != GRIG_TRACE_INDEX_MAGIC) {
+			entry.offset = pos;
+			entry.first = blk.first;
+			entry.last = blk.last;
+			entry.cmds = blk.cmds;
+			entry.count = blk.count;
+			entry.levels = blk.levels;
+			entry.sources = blk.sources;
+			entry.reserved = 0;
+			g_array_append_val (writer->index, entry);
+		}
+
+		pos += hdrsize + blk.size;
+	}
+
+	writer->offset = length;
+	g_mapped_file_unref (map);
+
+	return TRUE;
+}
+
+
+/** \brief Add a record to the current block.
+ *  \param writer The block being built.
+ *  \param time Wall clock time in usec.
+ *  \param source The source of the message.
+ *  \param level The debug level.
+ *  \param cmd The command being executed or GRIG_DEBUG_NO_CMD.
+ *  \param text The message.
+ *  \param len The length of the message.
+ */
+void
+grig_trace_add (grig_trace_writer_t *writer,
+		gint64 time,
+		debug_msg_src_t source,
+		enum rig_debug_level_e level,
+		gint cmd,
+		const gchar *text,
+		gsize len)
+{
+	grig_trace_rec_t rec;
+
+
+	if (writer->data == NULL) {
+		writer->data = g_byte_array_sized_new (GRIG_TRACE_BLOCK_SIZE + 1024);
+	}
+
+	if (writer->hdr.count == 0) {
+		writer->hdr.first = time;
+	}
+
+	rec.time = time;
+	rec.source = source;
+	rec.level = level;
+	rec.cmd = cmd;
+	rec.len = len;
+
+	g_byte_array_append (writer->data, (const guint8 *) &rec, sizeof (rec));
+	g_byte_array_append (writer->data, (const guint8 *) text, len);
+
+	writer->hdr.count++;
+	writer->hdr.last = time;
+	writer->hdr.levels |= 1 << level;
+	writer->hdr.sources |= 1 << source;
+	writer->hdr.cmds |= G_GUINT64_CONSTANT (1) << ((guint) cmd % 64);
+}
+
+
+/** \brief Write the current block.
+ *  \param writer The block being built.
+ *  \param file The trace file.
+ *  \return The number of bytes written.
+ *
+ * Nothing is written if the block is empty. The block is added to the
+ * index and the writer is ready for the next block afterwards.
+ */
+gsize
+grig_trace_flush (grig_trace_writer_t *writer, FILE *file)
+{
+	grig_trace_index_t entry;
+	gsize              bytes;
+
+
+	if (writer->hdr.count == 0) {
+		return 0;
+	}
+
+	writer->hdr.magic = GRIG_TRACE_BLOCK2_MAGIC;
+	writer->hdr.size = writer->data->len;
+	writer->hdr.reserved = 0;
+
+	if (writer->index == NULL) {
+		writer->index = g_array_new (FALSE, FALSE, sizeof (grig_trace_index_t));
+	}
+
+	entry.offset = writer->offset;
+	entry.first = writer->hdr.first;
+	entry.last = writer->hdr.last;
+	entry.cmds = writer->hdr.cmds;
+	entry.count = writer->hdr.count;
+	entry.levels = writer->hdr.levels;
+	entry.sources = writer->hdr.sources;
+	entry.reserved = 0;
+	g_array_append_val (writer->index, entry);
+
+	bytes = fwrite (&writer->hdr, 1, sizeof (writer->hdr), file);
+	bytes += fwrite (writer->data->data, 1, writer->data->len, file);
+	writer->offset += bytes;
+
+	memset (&writer->hdr, 0, sizeof (writer->hdr));
+	g_byte_array_set_size (writer->data, 0);
+
+	return bytes;
+}
+
+
+/** \brief Write the current block and the block index.
+ *  \param writer The writer.
+ *  \param file The trace file.
+ *  \return The number of bytes written.
+ *
+ * This is called before the file is closed. The index is written as a
+ * block that readers without index support skip, followed by the entries
+ * and the trailer at the very end of the file.
+ */
+gsize
+grig_trace_write_index (grig_trace_writer_t *writer, FILE *file)
+{
+	grig_trace_block_t   blk;
+	grig_trace_trailer_t trailer;
+	gsize                bytes;
+	guint                count;
+
+
+	bytes = grig_trace_flush (writer, file);
+
+	count = (writer->index != NULL) ? writer->index->len : 0;
+	if (count == 0) {
+		return bytes;
+	}
+
+	memset (&blk, 0, sizeof (blk));
+	blk.magic = GRIG_TRACE_INDEX_MAGIC;
+	blk.count = count;
+	blk.size = count * sizeof (grig_trace_index_t) + sizeof (trailer);
+
+	trailer.magic = GRIG_TRACE_INDEX_MAGIC;
+	trailer.count = count;
+	trailer.offset = writer->offset + sizeof (blk);
+
+	bytes += fwrite (&blk, 1, sizeof (blk), file);
+	bytes += fwrite (writer->index->data, sizeof (grig_trace_index_t), count, file) *
+		sizeof (grig_trace_index_t);
+	bytes += fwrite (&trailer, 1, sizeof (trailer), file);
+
+	writer->offset += bytes;
+	g_array_set_size (writer->index, 0);
+
+	return bytes;
+}
+
+
+/** \brief Check whether a file is a binary trace.
+ *  \param filename The file.
+ *  \return TRUE if the file starts with the trace magic.
+ */
+gboolean
+grig_trace_is_binary (const gchar *filename)
+{
+	FILE     *file;
+	gchar     magic[8];
+	gboolean  binary = FALSE;
+
+
+	file = g_fopen (filename, "rb");
+	if (file != NULL) {
+		binary = (fread (magic, 1, sizeof (magic), file) == sizeof (magic)) &&
+			!memcmp (magic, GRIG_TRACE_MAGIC, sizeof (magic));
+		fclose (file);
+	}
+
+	return binary;
+}
+
+
+/** \brief Call a function for each matching record of a trace.
+ *  \param filename The trace file.
+ *  \param filter The filter.
+ *  \param func The function to call; the text is not NUL terminated.
+ *  \param data User data passed to \a func.
+ *  \param error Location to store the error or NULL.
+ *  \return TRUE if the file has been read, FALSE on error.
+ *
+ * If the trace has a block index, only the blocks whose index entry
+ * matches are read. Otherwise the blocks are read one after the other and
+ * those that can not contain a matching record are skipped using their
+ * header alone. A truncated last block, e.g. after a crash, ends the
+ * trace silently.
+ */
+gboolean
+grig_trace_foreach (const gchar *filename,
+		    const grig_trace_filter_t *filter,
+		    grig_trace_func_t func,
+		    gpointer data,
+		    GError **error)
+{
+	GMappedFile          *map;
+	const gchar          *contents;
+	gsize                 length;
+	gsize                 pos;
+	gsize                 hdrsize;
+	grig_trace_block_t    blk;
+	grig_trace_index_t    entry;
+	grig_trace_trailer_t  trailer;
+	gboolean              more = TRUE;
+	guint                 i;
+
+
+	map = g_mapped_file_new (filename, FALSE, error);
+	if (map == NULL) {
+		return FALSE;
+	}
+
+	contents = g_mapped_file_get_contents (map);
+	length = g_mapped_file_get_length (map);
+
+	if (!trace_header_check (contents, length, filename, error)) {
+		g_mapped_file_unref (map);
+		return FALSE;
+	}
+
+	if (trace_index_read (contents, length, &trailer)) {
+		for (i = 0; more && (i < trailer.count); i++) {
+			/* entries may be unaligned; copy them */
+			memcpy (&entry, contents + trailer.offset + i * sizeof (entry),
+				sizeof (entry));
+
+			blk.levels = entry.levels;
+			blk.sources = entry.sources;
+			blk.first = entry.first;
+			blk.last = entry.last;
+			blk.cmds = entry.cmds;
+
+			if (!trace_block_match (&blk, filter))
+				continue;
+
+			hdrsize = trace_block_read (contents, length, entry.offset, &blk);
+			if ((hdrsize == 0) || (blk.magic == GRIG_TRACE_INDEX_MAGIC))
+				continue;
+
+			pos = entry.offset + hdrsize;
+			more = trace_block_foreach (contents, pos, pos + blk.size,
+						    filter, func, data);
+		}
+	}
+	else {
+		pos = sizeof (grig_trace_header_t);
+
+		while (more && ((hdrsize = trace_block_read (contents, length, pos, &blk)) > 0)) {
+			pos += hdrsize;
+
+			if ((blk.magic != GRIG_TRACE_INDEX_MAGIC) &&
+			    trace_block_match (&blk, filter)) {
+				more = trace_block_foreach (contents, pos, pos + blk.size,
+							    filter, func, data);
+			}
+
+			pos += blk.size;
+		}
+	}
+
+	g_mapped_file_unref (map);
+
+	return TRUE;
+}
+
+
+/** \brief Convert a trace to the text log format.
+ *  \param filename The trace file.
+ *  \param filter The records to convert or NULL for all.
+ *  \param out Where to write the text.
+ *  \param error Location to store the error or NULL.
+ *  \return TRUE on success.
+ *
+ * The output is the same as the text log written by the debug handler,
+ * one line per line of each message.
+ */
+gboolean
+grig_trace_to_text (const gchar *filename,
+		    const grig_trace_filter_t *filter,
+		    FILE *out,
+		    GError **error)
+{
+	grig_trace_filter_t  all;
+	grig_debug_stamp_t   stamp = { -1, NULL };
+	trace_text_t         conv;
+	gboolean             ok;
+
+
+	if (filter == NULL) {
+		grig_trace_filter_all (&all);
+		filter = &all;
+	}
+
+	conv.out = out;
+	conv.buf = g_string_sized_new (1024);
+	conv.stamp = &stamp;
+
+	ok = grig_trace_foreach (filename, filter, trace_text_line, &conv, error);
+
+	g_string_free (conv.buf, TRUE);
+	g_free (stamp.str);
+
+	return ok;
+}
+
+
+/** \brief Check the file header.
+ *  \return TRUE if the file is a trace this machine can read.
+ */
+static gboolean
+trace_header_check (const gchar *contents, gsize length,
+		    const gchar *filename, GError **error)
+{
+	grig_trace_header_t hdr;
+
+
+	if (length >= sizeof (hdr)) {
+		memcpy (&hdr, contents, sizeof (hdr));
+	}
+	if ((length < sizeof (hdr)) ||
+	    memcmp (hdr.magic, GRIG_TRACE_MAGIC, sizeof (hdr.magic)) ||
+	    (hdr.bom != GRIG_TRACE_BOM) ||
+	    (hdr.version < 1) || (hdr.version > GRIG_TRACE_VERSION)) {
+
+		g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+			     _("%s is not a grig trace file from this kind of machine"),
+			     filename);
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/** \brief Read a block header.
+ *  \param contents The file.
+ *  \param length The length of the file.
+ *  \param pos The offset of the header.
+ *  \param blk Where to store the header.
+ *  \return The size of the header or 0 if there is no complete block.
+ *
+ * A version 1 header gets a command mask that matches every command.
+ */
+static gsize
+trace_block_read (const gchar *contents, gsize length, gsize pos,
+		  grig_trace_block_t *blk)
+{
+	gsize hdrsize;
+
+
+	if (pos + sizeof (guint32) > length) {
+		return 0;
+	}
+
+	/* records may be unaligned; copy the headers */
+	memcpy (&blk->magic, contents + pos, sizeof (guint32));
+
+	switch (blk->magic) {
+
+	case GRIG_TRACE_BLOCK_MAGIC:
+		hdrsize = GRIG_TRACE_BLOCK1_HDR;
+		break;
+
+	case GRIG_TRACE_BLOCK2_MAGIC:
+	case GRIG_TRACE_INDEX_MAGIC:
+		hdrsize = sizeof (grig_trace_block_t);
+		break;
+
+	default:
+		return 0;
+	}
+
+	if (pos + hdrsize > length) {
+		return 0;
+	}
+
+	memcpy (blk, contents + pos, hdrsize);
+	if (hdrsize == GRIG_TRACE_BLOCK1_HDR) {
+		blk->cmds = G_MAXUINT64;
+	}
+
+	if (pos + hdrsize + blk->size > length) {
+		return 0;
+	}
+
+	return hdrsize;
+}
+
+
+/** \brief Find the block index at the end of the file.
+ *  \return TRUE if the file ends with a valid index.
+ */
+static gboolean
+trace_index_read (const gchar *contents, gsize length,
+		  grig_trace_trailer_t *trailer)
+{
+	if (length < sizeof (grig_trace_header_t) + sizeof (*trailer)) {
+		return FALSE;
+	}
+
+	memcpy (trailer, contents + length - sizeof (*trailer), sizeof (*trailer));
+
+	return (trailer->magic == GRIG_TRACE_INDEX_MAGIC) &&
+		(trailer->offset >= sizeof (grig_trace_header_t)) &&
+		(trailer->offset + (guint64) trailer->count * sizeof (grig_trace_index_t) +
+		 sizeof (*trailer) == length);
+}
+
+
+/** \brief Call a function for each matching record of a block.
+ *  \return FALSE if the function asked to stop.
+ */
+static gboolean
+trace_block_foreach (const gchar *contents, gsize pos, gsize end,
+		     const grig_trace_filter_t *filter,
+		     grig_trace_func_t func,
+		     gpointer data)
+{
+	grig_trace_rec_t rec;
+	gboolean         more = TRUE;
+
+
+	while (more && (pos + sizeof (rec) <= end)) {
+		memcpy (&rec, contents + pos, sizeof (rec));
+		pos += sizeof (rec);
+
+		if (pos + rec.len > end)
+			break;
+
+		if (trace_rec_match (&rec, filter))
+			more = func (&rec, contents + pos, data);
+
+		pos += rec.len;
+	}
+
+	return more;
+}
+
+
+/** \brief Check whether a block may contain matching records. */
+static gboolean
+trace_block_match (const grig_trace_block_t *blk,
+		   const grig_trace_filter_t *filter)
+{
+	if (!(blk->levels & filter->levels) || !(blk->sources & filter->sources))
+		return FALSE;
+
+	if ((filter->from != 0) && (blk->last < filter->from))
+		return FALSE;
+
+	if ((filter->to != 0) && (blk->first > filter->to))
+		return FALSE;
+
+	if ((filter->cmd >= 0) &&
+	    !(blk->cmds & (G_GUINT64_CONSTANT (1) << ((guint) filter->cmd % 64))))
+		return FALSE;
+
+	return TRUE;
+}
+
+
+/** \brief Check whether a record matches the filter. */
+static gboolean
+trace_rec_match (const grig_trace_rec_t *rec,
+		 const grig_trace_filter_t *filter)
+{
+	/* ignore garbage */
+	if ((rec->source > MSG_SRC_GRIG) || (rec->level > RIG_DEBUG_TRACE))
+		return FALSE;
+
+	if (!((1 << rec->level) & filter->levels) ||
+	    !((1 << rec->source) & filter->sources))
+		return FALSE;
+
+	if ((filter->from != 0) && (rec->time < filter->from))
+		return FALSE;
+
+	if ((filter->to != 0) && (rec->time > filter->to))
+		return FALSE;
+
+	if ((filter->cmd >= 0) && (rec->cmd != filter->cmd))
+		return FALSE;
+
+	return TRUE;
+}
+
+
+/** \brief Write one record as text lines. */
+static gboolean
+trace_text_line (const grig_trace_rec_t *rec, const gchar *text, gpointer data)
+{
+	trace_text_t *conv = (trace_text_t *) data;
+	gchar       **lines;
+	gchar        *msg;
+	guint         i;
+
+
+	msg = g_strndup (text, rec->len);
+	g_strchomp (msg);
+	lines = g_strsplit (msg, "\n", 0);
+
+	g_string_truncate (conv->buf, 0);
+	for (i = 0; lines[i] != NULL; i++) {
+		grig_debug_format_line (conv->buf, conv->stamp, rec->time,
+					rec->source, rec->level, lines[i]);
+	}
+	fwrite (conv->buf->str, 1, conv->buf->len, conv->out);
+
+	g_strfreev (lines);
+	g_free (msg);
+
+	return TRUE;
+}
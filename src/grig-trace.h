@@ -0,0 +1,172 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+#ifndef GRIG_TRACE_H
+#define GRIG_TRACE_H 1
+
+#include <stdio.h>
+#include <glib.h>
+#include <hamlib/rig.h>
+#include "grig-debug.h"
+
+
+#define GRIG_TRACE_MAGIC       "GRIGTRC1"   /*!< First bytes of a binary trace file. */
+#define GRIG_TRACE_BOM         0x01020304   /*!< Byte order mark. */
+#define GRIG_TRACE_VERSION     2            /*!< Format version written. */
+#define GRIG_TRACE_BLOCK_MAGIC 0x4b4c4247   /*!< Start of a version 1 block without command mask ("GBLK"). */
+#define GRIG_TRACE_BLOCK2_MAGIC 0x324b4247  /*!< Start of a block ("GBK2"). */
+#define GRIG_TRACE_INDEX_MAGIC 0x58444947   /*!< Start and end of the block index ("GIDX"). */
+#define GRIG_TRACE_BLOCK_SIZE  65536        /*!< Payload size after which a block is written. */
+#define GRIG_TRACE_BLOCK1_HDR  32           /*!< Size of a version 1 block header. */
+
+
+/** \brief File header of a binary trace file. */
+typedef struct {
+	gchar    magic[8];   /*!< GRIG_TRACE_MAGIC */
+	guint32  bom;        /*!< GRIG_TRACE_BOM in the byte order of the writer. */
+	guint32  version;    /*!< Format version, 1 or 2. */
+} grig_trace_header_t;
+
+
+/** \brief Block header.
+ *
+ * The header summarises the records of the block so that a reader can skip
+ * blocks without looking at the records. Version 1 blocks
+ * (GRIG_TRACE_BLOCK_MAGIC) end before \a cmds.
+ */
+typedef struct {
+	guint32  magic;      /*!< GRIG_TRACE_BLOCK2_MAGIC */
+	guint32  count;      /*!< Number of records in the block. */
+	guint32  size;       /*!< Size of the records in bytes. */
+	guint8   levels;     /*!< Bit mask of the debug levels in the block. */
+	guint8   sources;    /*!< Bit mask of the sources in the block. */
+	guint16  reserved;
+	gint64   first;      /*!< Time of the first record in usec. */
+	gint64   last;       /*!< Time of the last record in usec. */
+	guint64  cmds;       /*!< Bit (cmd % 64) of each command in the block. */
+} grig_trace_block_t;
+
+
+/** \brief Entry of the block index.
+ *
+ * When a trace is closed, the index of all its blocks is written at the
+ * end as a block with GRIG_TRACE_INDEX_MAGIC, the entries and a
+ * grig_trace_trailer_t. A reader filtering the trace only touches the
+ * blocks whose entry matches.
+ */
+typedef struct {
+	guint64  offset;     /*!< File offset of the block header. */
+	gint64   first;      /*!< Time of the first record in usec. */
+	gint64   last;       /*!< Time of the last record in usec. */
+	guint64  cmds;       /*!< Command mask of the block. */
+	guint32  count;      /*!< Number of records in the block. */
+	guint8   levels;     /*!< Level mask of the block. */
+	guint8   sources;    /*!< Source mask of the block. */
+	guint16  reserved;
+} grig_trace_index_t;
+
+
+/** \brief Last bytes of a trace with a block index. */
+typedef struct {
+	guint32  magic;      /*!< GRIG_TRACE_INDEX_MAGIC */
+	guint32  count;      /*!< Number of index entries. */
+	guint64  offset;     /*!< File offset of the first entry. */
+} grig_trace_trailer_t;
+
+
+/** \brief Record header; followed by \a len bytes of text. */
+typedef struct {
+	gint64   time;       /*!< Wall clock time in usec. */
+	guint8   source;     /*!< debug_msg_src_t */
+	guint8   level;      /*!< enum rig_debug_level_e */
+	guint16  cmd;        /*!< rig_cmd_t being executed or GRIG_DEBUG_NO_CMD. */
+	guint32  len;        /*!< Length of the text, which may span several lines. */
+} grig_trace_rec_t;
+
+
+/** \brief Record filter.
+ *
+ * A record matches if its level and source bits are set in the masks, its
+ * time is within [from, to] and its command matches. Use 0 for \a from and
+ * \a to and -1 for \a cmd to leave them open.
+ */
+typedef struct {
+	guint8   levels;     /*!< Bit mask of wanted debug levels. */
+	guint8   sources;    /*!< Bit mask of wanted sources. */
+	gint64   from;       /*!< Earliest time in usec or 0. */
+	gint64   to;         /*!< Latest time in usec or 0. */
+	gint     cmd;        /*!< Wanted command or -1. */
+} grig_trace_filter_t;
+
+
+/** \brief Record callback; return FALSE to stop. */
+typedef gboolean (*grig_trace_func_t) (const grig_trace_rec_t *rec,
+				       const gchar *text,
+				       gpointer data);
+
+
+/** \brief Block being built by the writer. */
+typedef struct {
+	grig_trace_block_t  hdr;    /*!< Header of the block. */
+	GByteArray         *data;   /*!< The records. */
+	GArray             *index;  /*!< grig_trace_index_t of the blocks written. */
+	guint64             offset; /*!< Current size of the file. */
+} grig_trace_writer_t;
+
+
+void      grig_trace_filter_all   (grig_trace_filter_t *filter);
+
+gsize     grig_trace_write_header (grig_trace_writer_t *writer, FILE *file);
+gboolean  grig_trace_resume       (grig_trace_writer_t *writer,
+				   const gchar *filename);
+void      grig_trace_add          (grig_trace_writer_t *writer,
+				   gint64 time,
+				   debug_msg_src_t source,
+				   enum rig_debug_level_e level,
+				   gint cmd,
+				   const gchar *text,
+				   gsize len);
+gsize     grig_trace_flush        (grig_trace_writer_t *writer, FILE *file);
+gsize     grig_trace_write_index  (grig_trace_writer_t *writer, FILE *file);
+
+gboolean  grig_trace_is_binary    (const gchar *filename);
+gboolean  grig_trace_foreach      (const gchar *filename,
+				   const grig_trace_filter_t *filter,
+				   grig_trace_func_t func,
+				   gpointer data,
+				   GError **error);
+gboolean  grig_trace_to_text      (const gchar *filename,
+				   const grig_trace_filter_t *filter,
+				   FILE *out,
+				   GError **error);
+
+#endif
@@ -75,6 +75,7 @@ snooper (GtkWidget *grab_widget, GdkEventKey *event, gpointer func_data)
 {
     gint stop_processing = FALSE;
     freq_t freq;
+    grig_settings_t snap;
 
 
     switch (event->keyval) {
@@ -83,7 +84,8 @@ snooper (GtkWidget *grab_widget, GdkEventKey *event, gpointer func_data)
     case GDK_Right:
 
         if (event->type == GDK_KEY_PRESS) {
-            freq = rig_data_get_freq (1) + rig_data_get_fstep ();
+            rig_data_snapshot (&snap);
+            freq = snap.freq1 + snap.fstep;
             rig_data_set_freq (1, freq);
             rig_gui_lcd_set_freq_digits(freq);
         }
@@ -96,7 +98,8 @@ snooper (GtkWidget *grab_widget, GdkEventKey *event, gpointer func_data)
     case GDK_Left:
 
         if (event->type == GDK_KEY_PRESS) {
-            freq = rig_data_get_freq (1) - rig_data_get_fstep ();
+            rig_data_snapshot (&snap);
+            freq = snap.freq1 - snap.fstep;
             rig_data_set_freq (1, freq);
             rig_gui_lcd_set_freq_digits(freq);
         }
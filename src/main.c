@@ -39,7 +39,9 @@
  *      overwritten if used on rpcrig.
  */
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
+#include <glib-unix.h>
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 #include <hamlib/rig.h>
@@ -53,10 +55,18 @@
 #include "grig-config.h"
 #include "rig-gui.h"
 #include "grig-debug.h"
+#include "grig-startup.h"
+#include "grig-cmdrec.h"
+#include "grig-timeline.h"
+#include "grig-trace.h"
 #include "rig-gui-message-window.h"
 #include "rig-daemon.h"
+#include "rig-daemon-prof.h"
 #include "rig-data.h"
 #include "rig-selector.h"
+#include "rig-server.h"
+#include "rig-shm.h"
+#include "rig-sim.h"
 #include "key-press-handler.h"
 
 
@@ -69,24 +79,37 @@ GtkWidget    *grigapp;
 /* FIXME: These need not be global!
     not in this baseline anyway.
  */
-static gint     rignum    = 0;       /*!< Flag indicating which radio to use.*/
-static gchar   *rigfile   = NULL;    /*!< The port where the rig is attached. */
-static gchar   *civaddr   = NULL;    /*!< CI-V address for ICOM rig. */
-static gchar   *rigconf   = NULL;    /*!< Configuration parameter. */
-static gint     rigspeed  = 0;       /*!< Optional serial speed. */
+static gint     rignum[C_MAX_RIGS];   /*!< Flag indicating which radio to use.*/
+static gchar   *rigfile[C_MAX_RIGS];  /*!< The port where the rig is attached. */
+static gchar   *civaddr[C_MAX_RIGS];  /*!< CI-V address for ICOM rig. */
+static gchar   *rigconf[C_MAX_RIGS];  /*!< Configuration parameter. */
+static gint     rigspeed[C_MAX_RIGS]; /*!< Optional serial speed. */
+static gint     rigdebug[C_MAX_RIGS]; /*!< Hamlib debug level of each rig. */
+static gboolean nothread[C_MAX_RIGS]; /*!< Don't use threads, just a regular gtk-timeout. */
+static gboolean pstat[C_MAX_RIGS];    /*!< Enable power status button. */
+static gboolean ptt[C_MAX_RIGS];      /*!< Enable PTT button. */
+static gint     nrigs     = 1;       /*!< Number of rigs given on the command line. */
 static gboolean listrigs  = FALSE;   /*!< List supported radios and exit. */ 
-gint debug     = RIG_DEBUG_NONE; /*!< Hamlib debug level. Note: not static since menubar.c needs access. */
+gint debug     = RIG_DEBUG_NONE; /*!< Highest hamlib debug level of all rigs. Note: not static since menubar.c needs access. */
 static gint     delay     = 0;       /*!< Command delay. */
-static gboolean nothread  = FALSE;   /*!< Don't use threads, just a regular gtk-timeout. */
-static gboolean pstat     = FALSE;   /*!< Enable power status button. */
-static gboolean ptt       = FALSE;   /*!< Enable PTT button. */
 static gboolean version   = FALSE;   /*!< Show version and exit. */
 static gboolean help      = FALSE;   /*!< Show help and exit. */
+static gchar   *logfile   = NULL;    /*!< Debug log file. */
+static gboolean logzip    = FALSE;   /*!< Compress rotated log files. */
+static gboolean logbinary = FALSE;   /*!< Write log file as binary trace. */
+static gchar   *totext    = NULL;    /*!< Convert this trace to text and exit. */
+static gchar   *recfile   = NULL;    /*!< Record the daemon commands to this file. */
+static gchar   *timeline  = NULL;    /*!< Write a timeline of commands and callbacks to this file. */
+static gchar   *server    = NULL;    /*!< Address of the rigctld compatible server. */
+static gboolean shm       = FALSE;   /*!< Publish the rig state in shared memory. */
+static gboolean headless  = FALSE;   /*!< Run the daemons without GUI. */
+static gboolean profile   = FALSE;   /*!< Print the start-up phases. */
+static gint64   mapstart  = 0;       /*!< Time when the main window was shown. */
 //static gchar    *rigcfg   = NULL;    /*!< .radio file name. */
 
 /* group those which take no arg */
 /** \brief Short options. */
-#define SHORT_OPTIONS "m:r:s:c:C:d:D:nlpPhv"  
+#define SHORT_OPTIONS "m:r:s:c:C:d:D:L:zBT:R:t:S:MHunlpPhv"  
 
 /** \brief Table of command line options. */
 static struct option long_options[] =
@@ -98,6 +121,16 @@ static struct option long_options[] =
 	{"set-conf",     1, 0, 'C'},
 	{"debug",        1, 0, 'd'},
 	{"delay",        1, 0, 'D'},
+	{"log-file",     1, 0, 'L'},
+	{"log-compress", 0, 0, 'z'},
+	{"log-binary",   0, 0, 'B'},
+	{"log-to-text",  1, 0, 'T'},
+	{"record",       1, 0, 'R'},
+	{"timeline",     1, 0, 't'},
+	{"server",       1, 0, 'S'},
+	{"shm",          0, 0, 'M'},
+	{"headless",     0, 0, 'H'},
+	{"startup-profile", 0, 0, 'u'},
 	{"nothread",     0, 0, 'n'},
 	{"list",         0, 0, 'l'},
 	{"enable-ptt",   0, 0, 'p'},
@@ -128,6 +161,14 @@ static void        grig_show_version   (void);
 static gint        grig_list_add       (const struct rig_caps *, void *);
 static gint        grig_list_compare   (gconstpointer, gconstpointer);
 static void        grig_sig_handler    (int sig);
+static gboolean    grig_sig_dump       (gpointer);
+static gboolean    grig_sig_record     (gpointer);
+static gchar      *grig_server_address (gint);
+static gint        grig_log_to_text    (const gchar *);
+static void        grig_app_stop       (void);
+static gint        grig_headless_run   (void);
+static gboolean    grig_sig_quit       (gpointer);
+static gboolean    grig_app_mapped     (GtkWidget *, GdkEvent *, gpointer);
 
 
 /** \bief Main program execution entry.
@@ -143,7 +184,14 @@ static void        grig_sig_handler    (int sig);
 int
 main (int argc, char *argv[])
 {
-	gchar *fname;
+	gchar   *fname;
+	gint64   start;
+	gint     cur = 0;          /* rig spec the -r -s -c -C -d -n -p -P options apply to */
+	gboolean model = FALSE;    /* whether -m has been seen */
+	gint     i;
+
+	/* the start-up is measured from here */
+	grig_startup_init ();
 
 	/* Initialize NLS support */
 #ifdef ENABLE_NLS
@@ -153,29 +201,12 @@ main (int argc, char *argv[])
 #endif
 
 	gtk_set_locale ();
-	gtk_init (&argc, &argv);
-/* 	setlocale (LCNUMERIC, "C"); */
 
-	
-	/* check whether installation is complete
-	   by looking for some pixmps. This way we
-	   can avoid surprises later on, when exit
-	   is not an option anymore.
+	/* remove the Gtk+ options but do not open the display yet;
+	   it is not needed with --headless
 	*/
-	//fname = g_strconcat (PACKAGE_PIXMAPS_DIR, G_DIR_SEPARATOR_S, "smeter.png", NULL);
-	fname = pixmap_file_name ("smeter.png");
-	if (!g_file_test (fname, G_FILE_TEST_EXISTS)) {
-
-		g_print ("\n\n");
-		g_print (_("Grig can not find some necessary data files.\n"));
-		g_print (_("This usually means that your installation is incomplete.\n"));
-		g_print (_("Sorry... but I can not continue..."));
-		g_print ("\n\n");
-		g_print ("%s\n\n",fname);
-		return 1;
-	}
-
-	g_free (fname);
+	gtk_parse_args (&argc, &argv);
+/* 	setlocale (LCNUMERIC, "C"); */
 
 
 #if !GLIB_CHECK_VERSION(2,32,0)
@@ -187,6 +218,9 @@ main (int argc, char *argv[])
 		g_thread_init (NULL);
 #endif
 
+	/* make the simulated rig available as a Hamlib model */
+	rig_sim_register ();
+
 
 	/* decode command line arguments; this part of the code only sets the
 	   global flags and variables, whereafter we check each variable in
@@ -212,7 +246,17 @@ main (int argc, char *argv[])
 				help = TRUE;
 			}
 			else {
-				rignum = atoi (optarg);
+				/* every -m after the first one starts a new rig */
+				if (model) {
+					if (nrigs == C_MAX_RIGS) {
+						g_print (_("Too many rigs; at most %d are supported\n"),
+							 C_MAX_RIGS);
+						return 1;
+					}
+					cur = nrigs++;
+				}
+				rignum[cur] = atoi (optarg);
+				model = TRUE;
 			}
 			break;
 
@@ -222,7 +266,7 @@ main (int argc, char *argv[])
 				help = TRUE;
 			}
 			else {
-				rigfile = optarg;
+				rigfile[cur] = optarg;
 			}
 			break;
 
@@ -232,7 +276,7 @@ main (int argc, char *argv[])
 				help = TRUE;
 			}
 			else {
-				rigspeed = atoi (optarg);
+				rigspeed[cur] = atoi (optarg);
 			}
 			break;
 
@@ -242,7 +286,7 @@ main (int argc, char *argv[])
 				help = TRUE;
 			}
 			else {
-				civaddr = optarg;
+				civaddr[cur] = optarg;
 			}
 			break;
 
@@ -252,7 +296,7 @@ main (int argc, char *argv[])
 				help = TRUE;
 			}
 			else {
-				rigconf = optarg;
+				rigconf[cur] = optarg;
 			}
 			break;
 
@@ -267,7 +311,8 @@ main (int argc, char *argv[])
 				help = TRUE;
 			}
 			else {
-				debug = atoi (optarg);
+				rigdebug[cur] = atoi (optarg);
+				debug = MAX (debug, rigdebug[cur]);
 			}
 			break;
 
@@ -281,19 +326,94 @@ main (int argc, char *argv[])
 			}
 			break;
 
+			/* debug log file */
+		case 'L':
+			if (!optarg) {
+				help = TRUE;
+			}
+			else {
+				logfile = optarg;
+			}
+			break;
+
+			/* compress rotated log files */
+		case 'z':
+			logzip = TRUE;
+			break;
+
+			/* binary log file */
+		case 'B':
+			logbinary = TRUE;
+			break;
+
+			/* convert binary log file */
+		case 'T':
+			if (!optarg) {
+				help = TRUE;
+			}
+			else {
+				totext = optarg;
+			}
+			break;
+
+			/* command record */
+		case 'R':
+			if (!optarg) {
+				help = TRUE;
+			}
+			else {
+				recfile = optarg;
+			}
+			break;
+
+			/* timeline */
+		case 't':
+			if (!optarg) {
+				help = TRUE;
+			}
+			else {
+				timeline = optarg;
+			}
+			break;
+
+			/* rigctld server */
+		case 'S':
+			if (!optarg) {
+				help = TRUE;
+			}
+			else {
+				server = optarg;
+			}
+			break;
+
+			/* shared memory */
+		case 'M':
+			shm = TRUE;
+			break;
+
+			/* no GUI */
+		case 'H':
+			headless = TRUE;
+			break;
+
+			/* start-up phases */
+		case 'u':
+			profile = TRUE;
+			break;
+
 			/* no threads */
 		case 'n':
-			nothread = TRUE;
+			nothread[cur] = TRUE;
 			break;
 
 			/* enable PTT button */
 		case 'p':
-			ptt = TRUE;
+			ptt[cur] = TRUE;
 			break;
 
 			/* enable POWER button */
 		case 'P':
-			pstat = TRUE;
+			pstat[cur] = TRUE;
 			break;
 
 			/* show help */
@@ -332,6 +452,44 @@ main (int argc, char *argv[])
 		return 0;
 	}
 
+	if (totext) {
+		return grig_log_to_text (totext);
+	}
+
+	grig_startup_set_report (headless ? "headless" : "GUI", profile);
+
+	if (!headless) {
+		start = grig_startup_begin ();
+
+		if (!gtk_init_check (&argc, &argv)) {
+			g_printerr (_("Can not open display; use --headless "\
+				      "to run grig without GUI.\n"));
+			return 1;
+		}
+
+		grig_startup_end ("display", -1, start);
+
+		/* check whether installation is complete
+		   by looking for some pixmps. This way we
+		   can avoid surprises later on, when exit
+		   is not an option anymore.
+		*/
+		//fname = g_strconcat (PACKAGE_PIXMAPS_DIR, G_DIR_SEPARATOR_S, "smeter.png", NULL);
+		fname = pixmap_file_name ("smeter.png");
+		if (!g_file_test (fname, G_FILE_TEST_EXISTS)) {
+
+			g_print ("\n\n");
+			g_print (_("Grig can not find some necessary data files.\n"));
+			g_print (_("This usually means that your installation is incomplete.\n"));
+			g_print (_("Sorry... but I can not continue..."));
+			g_print ("\n\n");
+			g_print ("%s\n\n",fname);
+			return 1;
+		}
+
+		g_free (fname);
+	}
+
 
 	/* we set hamlib debug level to TRACE while we fire up the daemon;
 	   it will be reset when we create the menubar
@@ -339,7 +497,14 @@ main (int argc, char *argv[])
 	grig_debug_set_level (RIG_DEBUG_TRACE);
 
 	/* initialise debug handler */
-	grig_debug_init (NULL);
+	grig_debug_set_compress (logzip);
+	grig_debug_set_binary (logbinary);
+	grig_debug_init (logfile);
+
+	/* the main thread becomes the first thread of the timeline */
+	if (timeline != NULL) {
+		grig_timeline_init (timeline);
+	}
 
 	/* check configuration */
 	if (!grig_config_check ()) {
@@ -364,25 +529,73 @@ main (int argc, char *argv[])
     /* 3. prio: run rig-selector */
     //g_print ("SELECT: %s\n", rig_selector_execute ());
 
-	/* launch rig daemon and pass the relevant
+	/* launch one rig daemon per rig and pass the relevant
 	   command line options
 	*/
-	if (rig_daemon_start (rignum,
-						  rigfile,
-						  rigspeed,
-						  civaddr,
-						  rigconf,
-						  delay,
-						  nothread,
-						  ptt,
-						  pstat))
-	{
+	for (i = 0; i < nrigs; i++) {
+		rig_data_select (i);
 
-		return 1;
+		/* the first rig records to FILE, the others to FILE.N */
+		if (recfile != NULL) {
+			gchar *fname;
+
+			fname = i ? g_strdup_printf ("%s.%d", recfile, i) : g_strdup (recfile);
+			rig_daemon_set_record (fname, 0);
+			g_free (fname);
+		}
+
+		if (rig_daemon_start (rignum[i],
+				      rigfile[i],
+				      rigspeed[i],
+				      civaddr[i],
+				      rigconf[i],
+				      delay,
+				      nothread[i],
+				      ptt[i],
+				      pstat[i]))
+		{
+			/* stop the rigs that have already been started */
+			while (i-- > 0) {
+				rig_data_select (i);
+				rig_daemon_stop ();
+			}
+
+			return 1;
+		}
 	}
 
-    /* install key press event handler */
-    key_press_handler_init ();
+	/* a server that can not listen is not fatal */
+	for (i = 0; (server != NULL) && (i < nrigs); i++) {
+		GError *error = NULL;
+		gchar  *addr;
+
+		rig_data_select (i);
+		addr = grig_server_address (i);
+
+		if (!rig_server_start (addr, &error)) {
+			grig_debug_local (RIG_DEBUG_ERR,
+					  _("Could not start server on %s:\n%s"),
+					  addr, error->message);
+			g_clear_error (&error);
+		}
+
+		g_free (addr);
+	}
+
+	/* readers can do without grig's state; not fatal either */
+	for (i = 0; shm && (i < nrigs); i++) {
+		GError *error = NULL;
+
+		rig_data_select (i);
+
+		if (!rig_shm_open (&error)) {
+			grig_debug_local (RIG_DEBUG_ERR, "%s", error->message);
+			g_clear_error (&error);
+		}
+	}
+
+	/* the GUI starts with the first rig */
+	rig_data_select (0);
 
 	/* check whether the debug level is something meaningful
 	   (it could be set to something junk by user); if yes, set
@@ -395,11 +608,37 @@ main (int argc, char *argv[])
 		grig_debug_set_level (RIG_DEBUG_WARN);
 	}
 
+	/* the daemon threads log with the level of their own rig */
+	for (i = 0; i < nrigs; i++) {
+		if ((rigdebug[i] >= RIG_DEBUG_NONE) && (rigdebug[i] <= RIG_DEBUG_TRACE)) {
+			grig_debug_set_rig_level (i, rigdebug[i]);
+		}
+		else {
+			grig_debug_set_rig_level (i, RIG_DEBUG_WARN);
+		}
+	}
+
+	if (headless) {
+		return grig_headless_run ();
+	}
+
+    /* install key press event handler */
+    key_press_handler_init ();
+
 	/* create application */
-	grigapp = grig_app_create (rignum);
+	grigapp = grig_app_create (rignum[0]);
 
 	/* add contents */
+	start = grig_startup_begin ();
 	gtk_container_add (GTK_CONTAINER (grigapp), rig_gui_create ());
+	grig_startup_end ("widgets", -1, start);
+
+	/* the start-up is complete when the window is on the screen and
+	   the daemons have read the initial values
+	*/
+	g_signal_connect (G_OBJECT (grigapp), "map-event",
+			  G_CALLBACK (grig_app_mapped), NULL);
+	mapstart = grig_startup_begin ();
 	gtk_widget_show (grigapp);
     
 	gtk_main ();
@@ -465,6 +704,12 @@ grig_app_create       (gint rignum)
 	signal (SIGINT,  (void *) grig_sig_handler);
 	signal (SIGABRT, (void *) grig_sig_handler);
 
+	/* SIGUSR1 dumps the daemon profiles; dispatched from the main loop */
+	g_unix_signal_add (SIGUSR1, grig_sig_dump, NULL);
+
+	/* SIGUSR2 saves the command records */
+	g_unix_signal_add (SIGUSR2, grig_sig_record, NULL);
+
 	return app;
 }
 
@@ -489,6 +734,109 @@ static void grig_sig_handler (int sig)
 }
 
 
+/** \brief Dump the daemon profiles.
+ *  \param data Unused.
+ *  \return Always TRUE to keep the handler installed.
+ *
+ * This function is called from the main loop when SIGUSR1 has been
+ * received. It prints the timing statistics of each rig to stderr,
+ * see rig-daemon-prof.c.
+ */
+static gboolean
+grig_sig_dump (gpointer data)
+{
+	GString *out;
+	RIG     *myrig;
+	gint     prev;
+	gint     i;
+
+
+	out = g_string_new (NULL);
+
+	for (i = 0; i < nrigs; i++) {
+		prev = rig_data_bind (i);
+
+		myrig = rig_daemon_get_rig ();
+		if (myrig != NULL) {
+			g_string_append_printf (out, _("Rig %d: %s %s\n"), i,
+						myrig->caps->mfg_name,
+						myrig->caps->model_name);
+			rig_daemon_prof_dump (out);
+			rig_server_dump (out);
+			g_string_append_c (out, '\n');
+		}
+
+		rig_data_bind (prev);
+	}
+
+	g_printerr ("%s", out->str);
+	g_string_free (out, TRUE);
+
+	return TRUE;
+}
+
+
+/** \brief Save the command records.
+ *  \param data Unused.
+ *  \return Always TRUE to keep the handler installed.
+ *
+ * This function is called from the main loop when SIGUSR2 has been
+ * received. It saves the commands recorded so far by each rig daemon,
+ * see the --record option.
+ */
+static gboolean
+grig_sig_record (gpointer data)
+{
+	GError *error = NULL;
+	gint    prev;
+	gint    i;
+
+
+	for (i = 0; i < nrigs; i++) {
+		prev = rig_data_bind (i);
+
+		if (!rig_daemon_save_record (&error)) {
+			grig_debug_local (RIG_DEBUG_ERR,
+					  _("%s: Could not save command record:\n%s"),
+					  __FUNCTION__, error->message);
+			g_clear_error (&error);
+		}
+
+		rig_data_bind (prev);
+	}
+
+	return TRUE;
+}
+
+
+/** \brief Get the server address of a rig.
+ *  \param rig The rig.
+ *  \return The address given with --server for the first rig; the
+ *          following rigs use the next ports or PATH.N (g_free it).
+ */
+static gchar *
+grig_server_address (gint rig)
+{
+	const gchar *port;
+
+
+	if (rig == 0) {
+		return g_strdup (server);
+	}
+
+	if (g_str_has_prefix (server, "unix:")) {
+		return g_strdup_printf ("%s.%d", server, rig);
+	}
+
+	port = strrchr (server, ':');
+	if (port == NULL) {
+		return g_strdup_printf ("%d", atoi (server) + rig);
+	}
+
+	return g_strdup_printf ("%.*s:%d", (int) (port - server), server, atoi (port + 1) + rig);
+}
+
+
 /** \brief Handle delete events.
  *  \param widget The widget which received the delete event signal.
  *  \param event  Data structure describing the event.
@@ -526,15 +874,46 @@ static void
 grig_app_destroy    (GtkWidget *widget,
 		     gpointer   data)
 {
+    /* remove key press event handler */
+    key_press_handler_close ();
+
+	grig_app_stop ();
+
+	/* exit Gtk+ */
+	gtk_main_quit ();
+}
+
+
+/** \brief Stop the daemons and the debug handler.
+ *
+ * This function is used by both the GUI and the headless mode to shut down
+ * the servers, the daemons and the shared memory of each rig before
+ * writing the timeline and closing the debug handler.
+ */
+static void
+grig_app_stop    ()
+{
+	GError *error = NULL;
+	gint    i;
 
 	/* set debug level to TRACE */
 	grig_debug_set_level (RIG_DEBUG_TRACE);
 
-    /* remove key press event handler */
-    key_press_handler_close ();
-    
-	/* stop daemons */
-	rig_daemon_stop ();
+	/* stop servers and daemons */
+	for (i = 0; i < nrigs; i++) {
+		rig_data_select (i);
+		rig_server_stop ();
+		rig_daemon_stop ();
+		rig_shm_close ();
+	}
+
+	/* the daemon threads have finished; write the timeline */
+	if (!grig_timeline_close (&error)) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s: Could not write timeline:\n%s"),
+				  __FUNCTION__, error->message);
+		g_clear_error (&error);
+	}
 
 	/* GUI timers are stopped automatically */
 
@@ -542,9 +921,80 @@ grig_app_destroy    (GtkWidget *widget,
 
 	/* shut down debug handler */
     grig_debug_close ();
-    
-	/* exit Gtk+ */
-	gtk_main_quit ();
+}
+
+
+/** \brief Run the daemons without GUI.
+ *  \return The exit status of grig.
+ *
+ * This function is used instead of the Gtk+ main loop with --headless. The
+ * display is never opened and neither widgets nor pixmaps are created; a
+ * plain main loop runs the daemons, the servers and the dispatch of the
+ * rig data until SIGTERM, SIGINT or SIGHUP is received.
+ *
+ * Note that grig is still linked against Gtk+, so the libraries are loaded
+ * in this mode too, and gtk_parse_args() has run to strip the Gtk+
+ * options; gtk_init() is not called.
+ */
+static gint
+grig_headless_run ()
+{
+	GMainLoop *loop;
+
+
+	loop = g_main_loop_new (NULL, FALSE);
+
+	g_unix_signal_add (SIGTERM, grig_sig_quit, loop);
+	g_unix_signal_add (SIGINT,  grig_sig_quit, loop);
+	g_unix_signal_add (SIGHUP,  grig_sig_quit, loop);
+	g_unix_signal_add (SIGUSR1, grig_sig_dump, NULL);
+	g_unix_signal_add (SIGUSR2, grig_sig_record, NULL);
+
+	grig_startup_release ();
+
+	g_main_loop_run (loop);
+	g_main_loop_unref (loop);
+
+	grig_app_stop ();
+
+	return 0;
+}
+
+
+/** \brief Stop the headless main loop.
+ *  \param loop The main loop.
+ *  \return Always FALSE to remove the handler.
+ */
+static gboolean
+grig_sig_quit (gpointer loop)
+{
+	grig_debug_local (RIG_DEBUG_ERR,
+			  _("Received signal\n"\
+			    "Trying clean exit..."));
+
+	g_main_loop_quit ((GMainLoop *) loop);
+
+	return FALSE;
+}
+
+
+/** \brief Handle the first map event of the main window.
+ *  \param widget The main window.
+ *  \param event The event.
+ *  \param data Unused.
+ *  \return Always FALSE to propagate the event.
+ */
+static gboolean
+grig_app_mapped     (GtkWidget *widget,
+		     GdkEvent  *event,
+		     gpointer   data)
+{
+	g_signal_handlers_disconnect_by_func (widget, grig_app_mapped, data);
+
+	grig_startup_end ("map window", -1, mapstart);
+	grig_startup_release ();
+
+	return FALSE;
 }
 
 
@@ -560,6 +1010,8 @@ grig_show_help      ()
 	g_print (_("Usage: grig [OPTION]...\n\n"));
 	g_print (_("  -m, --model=ID              "\
 		   "select radio model number; see --list\n"));
+	g_print (_("                              "\
+		   "repeat to control up to %d rigs\n"), C_MAX_RIGS);
 	g_print (_("  -r, --rig-file=DEVICE       "\
 		   "set device of the radio, eg. /dev/ttyS0\n"));
 	g_print (_("  -s, --speed=BAUD            "\
@@ -572,6 +1024,26 @@ grig_show_help      ()
 		   "set hamlib debug level (0..5)\n"));
 	g_print (_("  -D, --delay=val             "\
 		   "set delay between commands in msec\n"));
+	g_print (_("  -L, --log-file=FILE         "\
+		   "save debug messages to FILE (rotated)\n"));
+	g_print (_("  -z, --log-compress          "\
+		   "gzip rotated log files\n"));
+	g_print (_("  -B, --log-binary            "\
+		   "write the log file as binary trace\n"));
+	g_print (_("  -T, --log-to-text=FILE      "\
+		   "print binary trace FILE as text and exit\n"));
+	g_print (_("  -R, --record=FILE           "\
+		   "record the executed commands to FILE\n"));
+	g_print (_("  -t, --timeline=FILE         "\
+		   "write a timeline of commands and redraws to FILE\n"));
+	g_print (_("  -S, --server=ADDR           "\
+		   "accept rigctld clients on [HOST:]PORT or unix:PATH\n"));
+	g_print (_("  -M, --shm                   "\
+		   "publish the rig state in shared memory\n"));
+	g_print (_("  -H, --headless              "\
+		   "run without GUI, e.g. together with --server\n"));
+	g_print (_("  -u, --startup-profile       "\
+		   "print the time spent in each start-up phase\n"));
 	g_print (_("  -n, --nothread              "\
 		   "start daemon without using threads\n"));
 	g_print (_("  -l, --list                  "\
@@ -601,6 +1073,54 @@ grig_show_help      ()
 	g_print (_("It is usually enough to specify the model "\
 		   "ID and the DEVICE."));
 	g_print ("\n\n");
+	g_print (_("To control several rigs, repeat -m; the -r, -s, -c, "\
+		   "-C, -d, -n, -p and -P options that follow apply to that rig:"));
+	g_print ("\n\n");
+	g_print ("     grig -m 1016 -r /dev/ttyS0 -m 3073 -r /dev/ttyUSB0");
+	g_print ("\n\n");
+	g_print (_("Model %d is a simulated rig which answers with a "\
+		   "configurable delay and error rate, see the latency, jitter, "\
+		   "timeouts, rejects and simfile conf parameters:"), C_RIG_SIM_MODEL);
+	g_print ("\n\n");
+	g_print ("     grig -m %d -s 4800 -C latency=10,timeouts=1", C_RIG_SIM_MODEL);
+	g_print ("\n\n");
+	g_print (_("Sending SIGUSR1 to grig prints the command timing "\
+		   "statistics of each rig to stderr."));
+	g_print ("\n\n");
+	g_print (_("With --record, grig keeps the latest %d commands of "\
+		   "each rig and saves them on exit or when it receives "\
+		   "SIGUSR2. Further rigs record to FILE.1, FILE.2 etc. "\
+		   "Use grig-replay to analyse the record."), C_CMDREC_DEF_SIZE);
+	g_print ("\n\n");
+	g_print (_("The --timeline file is written on exit in the Trace Event "\
+		   "Format and can be opened with chrome://tracing or "\
+		   "https://ui.perfetto.dev."));
+	g_print ("\n\n");
+	g_print (_("With --server, programs using Hamlib's NET rigctl model "\
+		   "(2) or the rigctld protocol share the rig with grig. "\
+		   "Without HOST only local clients can connect. Further rigs "\
+		   "use the following ports or PATH.1, PATH.2 etc.:"));
+	g_print ("\n\n");
+	g_print ("     grig -m 1016 -r /dev/ttyS0 --server=%d", C_SERVER_DEF_PORT);
+	g_print ("\n\n");
+	g_print (_("With --shm, the state of rig N is published in the shared "\
+		   "memory segment /grig-rigN. Programs on the same machine "\
+		   "read it without copying or system calls using the "\
+		   "libgrigshm library, see grig-shm.h."));
+	g_print ("\n\n");
+	g_print (_("With --headless, grig does not open a window and keeps "\
+		   "polling the rigs for the --server and --shm clients until "\
+		   "it receives SIGTERM, SIGINT or SIGHUP. The Gtk+ libraries "\
+		   "are still loaded but Gtk+ is not initialised:"));
+	g_print ("\n\n");
+	g_print ("     grig -m 1016 -r /dev/ttyS0 --headless --server=%d", C_SERVER_DEF_PORT);
+	g_print ("\n\n");
+	g_print (_("At debug level 4 grig logs the time it took to start "\
+		   "and the memory used at that point, so that both modes "\
+		   "can be compared. --startup-profile also prints each phase "\
+		   "to stderr once the window is shown and the initial values "\
+		   "have been read."));
+	g_print ("\n\n");
 	g_print (_("If you start grig without any options it "\
 		   "will use the Dummy backend "\
 		   "and set the debug level to RIG_DEBUG_NONE. "\
@@ -781,3 +1301,24 @@ grig_list_compare  (gconstpointer a, gconstpointer b)
 	}
 
 }
+
+
+/** \brief Print a binary trace as text.
+ *  \param filename The trace file.
+ *  \return Exit status.
+ *
+ * The text is written to stdout in the same format as the text log file.
+ */
+static gint
+grig_log_to_text (const gchar *filename)
+{
+	GError *error = NULL;
+
+	if (!grig_trace_to_text (filename, NULL, stdout, &error)) {
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+		return 1;
+	}
+
+	return 0;
+}
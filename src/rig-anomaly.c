@@ -42,13 +42,34 @@
  * Furthermore, in order to know about the various rig commands, this object needs
  * access to the rig-daemon data types as well.
  *
+ * A disabled command is enabled again after C_ANOMALY_REPROBE_DELAY seconds.
+ * If it fails on the first attempt, it is disabled again right away and the
+ * delay is doubled, up to C_ANOMALY_MAX_BACKOFF times. A successful execution
+ * resets the delay.
+ *
+ * Commands sent on user request (SET commands and VFO operations) are
+ * counted but never disabled, since their errors may be caused by the
+ * value the user has chosen. The cached capabilities are only removed when
+ * a command is disabled because the rig rejects it; timeouts and I/O errors
+ * are considered transient.
+ *
+ * The rig-daemon calls rig_anomaly_raise() and rig_anomaly_done() from its
+ * own thread while the GUI reads the statistics, so all data is protected
+ * by a mutex. There is one state table per rig; all functions refer to the
+ * current rig, see rig_data_current().
+ *
  * \bug File includes gtk.h but not really needed?
  */
+#include <stdlib.h>
+#include <string.h>
 #include <gtk/gtk.h>
+#include <glib/gi18n.h>
 #include <hamlib/rig.h>
+#include "grig-debug.h"
 #include "rig-data.h"
 #include "rig-daemon.h"
 #include "rig-anomaly.h"
+#include "rig-daemon-cache.h"
 
 
 
@@ -58,164 +79,401 @@
  * within a certain period, the
  * corresponding command is disabled. This table lists
  * the allowed number of erroneous executions within the time
- * specified in the ANOMALY_COUNT_PERIOD array.
+ * specified in the ANOMALY_COUNT_PERIOD array. Commands not
+ * listed use C_ANOMALY_DEF_COUNT_MAX.
  */ 
 static const anomaly_count_t ANOMALY_COUNT_MAX = {
-	0,      /*  RIG_CMD_NONE          */
-	0,      /*  RIG_CMD_GET_FREQ_1    */
-	0,      /*  RIG_CMD_SET_FREQ_1    */
-	0,      /*  RIG_CMD_GET_FREQ_2    */
-	0,      /*  RIG_CMD_SET_FREQ_2    */
- 	0,      /*  RIG_CMD_GET_RIT       */
-	0,      /*  RIG_CMD_SET_RIT       */
-	0,      /*  RIG_CMD_GET_XIT       */
-	0,      /*  RIG_CMD_SET_XIT       */
-	0,      /*  RIG_CMD_GET_VFO       */
-	0,      /*  RIG_CMD_SET_VFO       */
-	0,      /*  RIG_CMD_GET_PSTAT     */
-	0,      /*  RIG_CMD_SET_PSTAT     */
-	0,      /*  RIG_CMD_GET_PTT       */
-	0,      /*  RIG_CMD_SET_PTT       */
-	0,      /*  RIG_CMD_GET_MODE      */
-	0,      /*  RIG_CMD_SET_MODE      */
-	0,      /*  RIG_CMD_GET_STRENGTH  */
-	0       /*  RIG_CMD_GET_PWR       */
+	[RIG_CMD_GET_PSTAT]    = 10,
+	[RIG_CMD_GET_PTT]      = 10,
+	[RIG_CMD_GET_STRENGTH] = 10
 };
 
 
 /** \brief Anomaly count periods.
  *
  * This table defines the periods in seconds during which
- * anomalies are accumulated.
+ * anomalies are accumulated. Commands not listed use
+ * C_ANOMALY_DEF_PERIOD.
  */
 static const anomaly_period_t ANOMALY_COUNT_PERIOD = {
-	0.00,      /*  RIG_CMD_NONE          */
-	2.00,      /*  RIG_CMD_GET_FREQ_1    */
-	2.00,      /*  RIG_CMD_SET_FREQ_1    */
-	2.00,      /*  RIG_CMD_GET_FREQ_2    */
-	2.00,      /*  RIG_CMD_SET_FREQ_2    */
- 	5.00,      /*  RIG_CMD_GET_RIT       */
-	5.00,      /*  RIG_CMD_SET_RIT       */
-	5.00,      /*  RIG_CMD_GET_XIT       */
-	5.00,      /*  RIG_CMD_SET_XIT       */
-	10.0,      /*  RIG_CMD_GET_VFO       */
-	10.0,      /*  RIG_CMD_SET_VFO       */
-	10.0,      /*  RIG_CMD_GET_PSTAT     */
-	10.0,      /*  RIG_CMD_SET_PSTAT     */
-	10.0,      /*  RIG_CMD_GET_PTT       */
-	10.0,      /*  RIG_CMD_SET_PTT       */
-	10.0,      /*  RIG_CMD_GET_MODE      */
-	10.0,      /*  RIG_CMD_SET_MODE      */
-	10.0,      /*  RIG_CMD_GET_STRENGTH  */
-	10.0       /*  RIG_CMD_GET_PWR       */
+	[RIG_CMD_GET_FREQ_1]   = 2.0,
+	[RIG_CMD_SET_FREQ_1]   = 2.0,
+	[RIG_CMD_GET_FREQ_2]   = 2.0,
+	[RIG_CMD_SET_FREQ_2]   = 2.0,
+	[RIG_CMD_GET_RIT]      = 5.0,
+	[RIG_CMD_SET_RIT]      = 5.0,
+	[RIG_CMD_GET_XIT]      = 5.0,
+	[RIG_CMD_SET_XIT]      = 5.0,
+	[RIG_CMD_GET_STRENGTH] = 5.0
 };
 
 
-/** \brief The anomaly occurrence table.
- *
- * This table holds the accumulated number of anomalies
- * that have occurred within a certain time period.
- */
-static anomaly_count_t ANOMALY_COUNT = {
-	0,      /*  RIG_CMD_NONE          */
-	0,      /*  RIG_CMD_GET_FREQ_1    */
-	0,      /*  RIG_CMD_SET_FREQ_1    */
-	0,      /*  RIG_CMD_GET_FREQ_2    */
-	0,      /*  RIG_CMD_SET_FREQ_2    */
- 	0,      /*  RIG_CMD_GET_RIT       */
-	0,      /*  RIG_CMD_SET_RIT       */
-	0,      /*  RIG_CMD_GET_XIT       */
-	0,      /*  RIG_CMD_SET_XIT       */
-	0,      /*  RIG_CMD_GET_VFO       */
-	0,      /*  RIG_CMD_SET_VFO       */
-	0,      /*  RIG_CMD_GET_PSTAT     */
-	0,      /*  RIG_CMD_SET_PSTAT     */
-	0,      /*  RIG_CMD_GET_PTT       */
-	0,      /*  RIG_CMD_SET_PTT       */
-	0,      /*  RIG_CMD_GET_MODE      */
-	0,      /*  RIG_CMD_SET_MODE      */
-	0,      /*  RIG_CMD_GET_STRENGTH  */
-	0       /*  RIG_CMD_GET_PWR       */
-};
+/** \brief Anomaly state of a command. */
+typedef struct {
+	gint64    times[C_ANOMALY_MAX_COUNT];  /*!< Times of the most recent errors (ring buffer). */
+	guint     head;       /*!< Index of the next entry in times. */
+	guint     count;      /*!< Number of valid entries in times. */
+	guint     total;      /*!< Total number of errors. */
+	guint     disabled;   /*!< Number of times the command has been disabled. */
+	guint     backoff;    /*!< Number of times the re-probe delay has been doubled. */
+	gboolean  off;        /*!< The command is disabled. */
+	gboolean  probing;    /*!< The command has been re-enabled and not yet succeeded. */
+	gboolean  failed;     /*!< An error has been raised during the current execution. */
+	gint64    reprobe;    /*!< When to enable the command again [usec]. */
+} anomaly_state_t;
+
+
+/** \brief The anomaly state table of each rig. */
+static anomaly_state_t anomaly[C_MAX_RIGS][RIG_CMD_NUMBER];
 
+/** \brief Earliest pending re-probe of each rig (G_MAXINT64 if none). */
+static gint64 nextreprobe[C_MAX_RIGS];
 
+/** \brief Mutex protecting the anomaly data. */
+static GMutex anomalymutex;
 
-/** \brief First occurrence of an anomaly.
+
+static guint  rig_anomaly_count_max  (rig_cmd_t);
+static gint64 rig_anomaly_period     (rig_cmd_t);
+static guint  rig_anomaly_recent     (anomaly_state_t *, rig_cmd_t, gint64);
+static gboolean rig_anomaly_transient (gint);
+static void   rig_anomaly_disable    (anomaly_state_t *, rig_cmd_t, gint64);
+
+
+
+/** \brief Reset the anomaly manager.
  *
- * This table holds the time of the first occurrence of a given anomaly.
+ * This function clears all statistics. It is called by the rig-daemon
+ * when a new rig has been opened.
  */
-static anomaly_time_t FIRST_ANOMALY = {
-	0,      /*  RIG_CMD_NONE          */
-	0,      /*  RIG_CMD_GET_FREQ_1    */
-	0,      /*  RIG_CMD_SET_FREQ_1    */
-	0,      /*  RIG_CMD_GET_FREQ_2    */
-	0,      /*  RIG_CMD_SET_FREQ_2    */
- 	0,      /*  RIG_CMD_GET_RIT       */
-	0,      /*  RIG_CMD_SET_RIT       */
-	0,      /*  RIG_CMD_GET_XIT       */
-	0,      /*  RIG_CMD_SET_XIT       */
-	0,      /*  RIG_CMD_GET_VFO       */
-	0,      /*  RIG_CMD_SET_VFO       */
-	0,      /*  RIG_CMD_GET_PSTAT     */
-	0,      /*  RIG_CMD_SET_PSTAT     */
-	0,      /*  RIG_CMD_GET_PTT       */
-	0,      /*  RIG_CMD_SET_PTT       */
-	0,      /*  RIG_CMD_GET_MODE      */
-	0,      /*  RIG_CMD_SET_MODE      */
-	0,      /*  RIG_CMD_GET_STRENGTH  */
-	0       /*  RIG_CMD_GET_PWR       */
-};
+void
+rig_anomaly_init ()
+{
+	gint rig = rig_data_current ();
 
 
+	g_mutex_lock (&anomalymutex);
+
+	memset (anomaly[rig], 0, sizeof (anomaly[rig]));
+	nextreprobe[rig] = G_MAXINT64;
+
+	g_mutex_unlock (&anomalymutex);
+}
 
 
 /** \brief Raise an anomaly.
  *  \param cmd The command which is the source of the anomaly.
+ *  \param retcode The error code returned by Hamlib.
  *
- * This function increments the anomaly counter of the specified
- * command. Furthermore, if the command disabling threshold is exceeded
- * within a specific time period, it disables the command.
- *
- * The anomaly counter is reset if a command is disabled or if the
- * time elapsed since the first anomaly has exceeded the given
- * count period.
+ * This function records the error in the sliding window of the
+ * specified command. If the number of errors within the count period
+ * reaches the threshold, the command is disabled. A command which has
+ * just been re-enabled is disabled again on the first error. User
+ * commands are never disabled, see rig_daemon_cmd_is_user().
  *
+ * Several errors raised during the same execution of a command (e.g.
+ * one per function in RIG_CMD_GET_FUNC) are counted once.
  */
 void
-rig_anomaly_raise (rig_cmd_t cmd)
+rig_anomaly_raise (rig_cmd_t cmd, gint retcode)
+{
+	gint             rig = rig_data_current ();
+	anomaly_state_t *a;
+	gint64           now;
+	gboolean         disable = FALSE;
+	gboolean         invalidate = FALSE;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return;
+	}
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (&anomalymutex);
+
+	a = &anomaly[rig][cmd];
+	a->total++;
+
+	if (!a->failed) {
+		a->failed = TRUE;
+
+		/* store the time in the sliding window */
+		a->times[a->head] = now;
+		a->head = (a->head + 1) % C_ANOMALY_MAX_COUNT;
+		if (a->count < C_ANOMALY_MAX_COUNT)
+			a->count++;
+
+		/* test whether number of anomalies exceeds the threshold */
+		if (!a->off && !rig_daemon_cmd_is_user (cmd) &&
+		    (a->probing || (rig_anomaly_recent (a, cmd, now) >= rig_anomaly_count_max (cmd)))) {
+
+			rig_anomaly_disable (a, cmd, now);
+			disable = TRUE;
+
+			/* a rejected command may not be supported after all */
+			invalidate = !rig_anomaly_transient (retcode);
+		}
+	}
+
+	g_mutex_unlock (&anomalymutex);
+
+	/* the daemon takes its own mutex; not while holding ours */
+	if (disable) {
+		rig_daemon_cmd_enable (cmd, FALSE);
+	}
+
+	/* file I/O; not while holding the mutex */
+	if (invalidate) {
+		rig_daemon_cache_invalidate ();
+	}
+}
+
+
+/** \brief Notify the anomaly manager that a command has been executed.
+ *  \param cmd The command.
+ *  \return TRUE if an anomaly has been raised during the execution.
+ *
+ * This function is called by the rig-daemon after each execution of a
+ * command. If no anomaly has been raised during the execution, the
+ * command is considered healthy and its re-probe delay is reset.
+ */
+gboolean
+rig_anomaly_done (rig_cmd_t cmd)
 {
+	gint             rig = rig_data_current ();
+	anomaly_state_t *a;
+	gboolean         failed;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return FALSE;
+	}
+
+	g_mutex_lock (&anomalymutex);
+
+	a = &anomaly[rig][cmd];
+	failed = a->failed;
+
+	if (a->failed) {
+		a->failed = FALSE;
+	}
+	else if (a->probing) {
+		a->probing = FALSE;
+		a->backoff = 0;
+
+		grig_debug_local (RIG_DEBUG_VERBOSE,
+				  _("%s: %s works again"),
+				  __FUNCTION__, rig_daemon_cmd_to_str (cmd));
+	}
+
+	g_mutex_unlock (&anomalymutex);
 
-	/* check whether it is the first occurrence */
-	if ((ANOMALY_COUNT[cmd] == 0) || (FIRST_ANOMALY[cmd] == 0)) {
+	return failed;
+}
+
+
+/** \brief Re-enable disabled commands.
+ *  \param now The current monotonic time [usec].
+ *
+ * This function is called by the rig-daemon before each polling step.
+ * Commands whose re-probe time has passed are enabled again and will be
+ * executed at the next opportunity.
+ */
+void
+rig_anomaly_reprobe (gint64 now)
+{
+	gint             rig = rig_data_current ();
+	anomaly_state_t *a;
+	gboolean         enable[RIG_CMD_NUMBER] = { FALSE };
+	guint            n = 0;
+	guint            i;
 
-		/* first occurrence */
 
-		/* store the time */
+	g_mutex_lock (&anomalymutex);
 
+	/* nothing to do */
+	if (now < nextreprobe[rig]) {
+		g_mutex_unlock (&anomalymutex);
+		return;
 	}
-	else {
 
-		/* check whether the time elapsed since the
-		   first anomaly of this kind is longer than
-		   the accumulating period.
-		*/
-		if (TRUE) {
+	nextreprobe[rig] = G_MAXINT64;
 
-			/* elapsed time is longer; reset the counter
-			   to 1 and store the new time.
-			*/
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+		a = &anomaly[rig][i];
 
+		if (!a->off)
+			continue;
+
+		if (a->reprobe <= now) {
+			a->off = FALSE;
+			a->probing = TRUE;
+			a->reprobe = 0;
+
+			grig_debug_local (RIG_DEBUG_VERBOSE,
+					  _("%s: Trying %s again"),
+					  __FUNCTION__, rig_daemon_cmd_to_str (i));
+
+			enable[i] = TRUE;
+			n++;
+		}
+		else if (a->reprobe < nextreprobe[rig]) {
+			nextreprobe[rig] = a->reprobe;
 		}
+	}
+
+	g_mutex_unlock (&anomalymutex);
 
+	/* the daemon takes its own mutex; not while holding ours */
+	for (i = RIG_CMD_NONE + 1; n && (i < RIG_CMD_NUMBER); i++) {
+		if (enable[i]) {
+			rig_daemon_cmd_enable (i, TRUE);
+			n--;
+		}
 	}
+}
 
-	/* test whether number of anomalies exceeds the threshold */
-	if (++ANOMALY_COUNT[cmd] >= ANOMALY_COUNT_MAX[cmd]) {
 
-		/* disable the command */
+/** \brief Get the error statistics of a command.
+ *  \param cmd The command.
+ *  \param stats Pointer to a structure where the statistics will be stored.
+ *  \return TRUE if the statistics have been copied, FALSE if cmd is invalid.
+ */
+gboolean
+rig_anomaly_get_stats (rig_cmd_t cmd, rig_anomaly_stats_t *stats)
+{
+	gint             rig = rig_data_current ();
+	anomaly_state_t *a;
 
-		/* reset the time and the counter */
 
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER) || (stats == NULL)) {
+		return FALSE;
 	}
 
+	g_mutex_lock (&anomalymutex);
+
+	a = &anomaly[rig][cmd];
+
+	stats->total    = a->total;
+	stats->recent   = rig_anomaly_recent (a, cmd, g_get_monotonic_time ());
+	stats->disabled = a->disabled;
+	stats->off      = a->off;
+	stats->reprobe  = a->off ? a->reprobe : 0;
+
+	g_mutex_unlock (&anomalymutex);
+
+	return TRUE;
+}
+
+
+/** \brief Get the error threshold of a command. */
+static guint
+rig_anomaly_count_max (rig_cmd_t cmd)
+{
+	guint max = ANOMALY_COUNT_MAX[cmd];
+
+	if (max == 0)
+		max = C_ANOMALY_DEF_COUNT_MAX;
+
+	return MIN (max, C_ANOMALY_MAX_COUNT);
+}
+
+
+/** \brief Get the length of the counting window of a command [usec]. */
+static gint64
+rig_anomaly_period (rig_cmd_t cmd)
+{
+	gfloat period = ANOMALY_COUNT_PERIOD[cmd];
+
+	if (period <= 0.0)
+		period = C_ANOMALY_DEF_PERIOD;
+
+	return (gint64) (period * G_USEC_PER_SEC);
+}
+
+
+/** \brief Count the errors within the counting window.
+ *
+ * Must be called with the mutex held.
+ */
+static guint
+rig_anomaly_recent (anomaly_state_t *a, rig_cmd_t cmd, gint64 now)
+{
+	gint64 start;
+	guint  i;
+	guint  num = 0;
+
+
+	start = now - rig_anomaly_period (cmd);
+
+	for (i = 0; i < a->count; i++) {
+		if (a->times[i] >= start)
+			num++;
+	}
+
+	return num;
+}
+
+
+/** \brief Check whether an error is expected to go away by itself.
+ *  \param retcode The error code returned by Hamlib.
+ *  \return TRUE for timeouts and communication errors, FALSE if the rig
+ *          or the backend has refused the command.
+ */
+static gboolean
+rig_anomaly_transient (gint retcode)
+{
+	switch (abs (retcode)) {
+
+	case RIG_ETIMEOUT:
+	case RIG_EIO:
+	case RIG_EPROTO:
+	case RIG_BUSERROR:
+	case RIG_BUSBUSY:
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+}
+
+
+/** \brief Disable a command and schedule the re-probe.
+ *
+ * Must be called with the mutex held. The caller disables the command in
+ * the daemon with rig_daemon_cmd_enable() after releasing the mutex, since
+ * the daemon takes its command mutex and may call into the anomaly
+ * manager while holding it.
+ */
+static void
+rig_anomaly_disable (anomaly_state_t *a, rig_cmd_t cmd, gint64 now)
+{
+	gint   rig = rig_data_current ();
+	gint64 delay;
+
+
+	/* a failed re-probe doubles the delay */
+	if (a->probing && (a->backoff < C_ANOMALY_MAX_BACKOFF)) {
+		a->backoff++;
+	}
+
+	delay = (gint64) (C_ANOMALY_REPROBE_DELAY << a->backoff) * G_USEC_PER_SEC;
+
+	a->off = TRUE;
+	a->probing = FALSE;
+	a->disabled++;
+	a->reprobe = now + delay;
+
+	/* reset the window */
+	a->head = 0;
+	a->count = 0;
+
+	if (a->reprobe < nextreprobe[rig])
+		nextreprobe[rig] = a->reprobe;
+
+	grig_debug_local (RIG_DEBUG_ERR,
+			  _("%s: Too many errors; %s disabled for %d sec"),
+			  __FUNCTION__, rig_daemon_cmd_to_str (cmd),
+			  (gint) (delay / G_USEC_PER_SEC));
 }
@@ -34,12 +34,15 @@
 #define RIG_ANOMALY_H 1
 
 
-#include <time.h>
 #include "rig-daemon.h"
 
 
-/** \brief Type used to hold system times vs. rig command. */
-typedef time_t anomaly_time_t[RIG_CMD_NUMBER];
+#define C_ANOMALY_DEF_COUNT_MAX   5      /*!< Default number of errors before a command is disabled */
+#define C_ANOMALY_DEF_PERIOD      10.0   /*!< Default length of the error counting window [sec] */
+#define C_ANOMALY_MAX_COUNT       16     /*!< Upper limit for the error threshold (size of the window) */
+#define C_ANOMALY_REPROBE_DELAY   30     /*!< Time before a disabled command is tried again [sec] */
+#define C_ANOMALY_MAX_BACKOFF     5      /*!< Max number of times the re-probe delay is doubled */
+
 
 /** \brief Type used to hold periods in seconds vs. rig command. */
 typedef gfloat anomaly_period_t[RIG_CMD_NUMBER];
@@ -47,7 +50,22 @@ typedef gfloat anomaly_period_t[RIG_CMD_NUMBER];
 /** \brief Type used to hold anomaly occurrences vs. rig command. */
 typedef guint8 anomaly_count_t[RIG_CMD_NUMBER];
 
-void rig_anomaly_raise (rig_cmd_t);
+
+/** \brief Error statistics of a command. */
+typedef struct {
+	guint     total;      /*!< Total number of errors. */
+	guint     recent;     /*!< Errors within the current counting window. */
+	guint     disabled;   /*!< Number of times the command has been disabled. */
+	gboolean  off;        /*!< The command is currently disabled. */
+	gint64    reprobe;    /*!< Monotonic time of the next re-probe [usec]; 0 if not disabled. */
+} rig_anomaly_stats_t;
+
+
+void     rig_anomaly_init      (void);
+void     rig_anomaly_raise     (rig_cmd_t, gint);
+gboolean rig_anomaly_done      (rig_cmd_t);
+void     rig_anomaly_reprobe   (gint64);
+gboolean rig_anomaly_get_stats (rig_cmd_t, rig_anomaly_stats_t *);
 
 
 #endif
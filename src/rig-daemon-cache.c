@@ -0,0 +1,413 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file rig-daemon-cache.c
+ *  \ingroup rigd
+ *  \brief Cache of the capabilities detected at start-up.
+ *
+ * The capabilities found by the rig_daemon_check_xxx() functions are saved
+ * in $HOME/.grig/caps/<model>-<port>.conf, where <port> is a hash of the
+ * port name, so that two rigs of the same model have their own file. When
+ * the rig is started again with the same Hamlib version, port and
+ * configuration, the capabilities are taken from the file instead of
+ * testing each command. The current values are still read at start-up,
+ * see rig_daemon_post_init().
+ *
+ * The file is removed when the anomaly manager disables a command that the
+ * rig keeps rejecting, since the capabilities may no longer match the rig;
+ * transient errors like timeouts do not remove it. The next start probes
+ * the rig again.
+ *
+ * Programs that must not touch the user's files, like grig-bench, disable
+ * the cache with rig_daemon_cache_set_enabled(); the rig is then probed at
+ * every start and nothing is saved.
+ *
+ * All functions refer to the current rig, see rig_data_current().
+ */
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+#include <errno.h>
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <hamlib/rig.h>
+#include "compat.h"
+#include "grig-debug.h"
+#include "rig-data.h"
+#include "rig-daemon.h"
+#include "rig-daemon-cache.h"
+
+
+#define GROUP_CACHE      "Cache"
+#define KEY_KEY          "Key"
+#define KEY_HAS_GET      "HasGet"
+#define KEY_HAS_SET      "HasSet"
+#define KEY_VFOS         "Vfos"
+#define KEY_ATT          "Att"
+#define KEY_PREAMP       "Preamp"
+#define KEY_MAX_POWER    "MaxPower"
+#define KEY_LIMITS       "Limits"
+#define KEY_MODES        "Modes"
+#define KEY_ANTENNAS     "Antennas"
+
+#define C_CACHE_NLIMITS     9    /*!< Number of values in the Limits list. */
+
+/** \brief Number of integers in grig_cmd_avail_t. */
+#define C_CACHE_AVAIL_SIZE  (sizeof (grig_cmd_avail_t) / sizeof (gint))
+
+G_STATIC_ASSERT (sizeof (grig_cmd_avail_t) % sizeof (gint) == 0);
+
+
+static gchar *cachefile[C_MAX_RIGS];   /*!< Cache file in use or NULL. */
+static gboolean cacheon = TRUE;        /*!< Whether the cache is used at all. */
+
+
+static gchar *rig_daemon_cache_file (RIG *);
+
+
+
+/** \brief Build the key of a rig configuration.
+ *  \param myrig The radio handle, configured but not necessarily open.
+ *  \param civaddr The CI-V address or NULL.
+ *  \param rigconf The conf parameters or NULL.
+ *  \param ptt Whether PTT is enabled.
+ *  \param pstat Whether POWER is enabled.
+ *  \return The key (g_free it).
+ *
+ * A cached capability set is only used if its key is the same. Besides the
+ * port settings, the key contains the grig version since the layout of
+ * grig_cmd_avail_t is stored as is.
+ */
+gchar *
+rig_daemon_cache_key (RIG         *myrig,
+		      const gchar *civaddr,
+		      const gchar *rigconf,
+		      gboolean     ptt,
+		      gboolean     pstat)
+{
+	return g_strdup_printf ("%s;%s;%s;%d;%s;%s;%d;%d",
+				VERSION, hamlib_version,
+				myrig->state.rigport.pathname,
+				myrig->state.rigport.parm.serial.rate,
+				civaddr ? civaddr : "",
+				rigconf ? rigconf : "",
+				ptt ? 1 : 0, pstat ? 1 : 0);
+}
+
+
+/** \brief Load the cached capabilities.
+ *  \param myrig The radio handle.
+ *  \param key The key of the configuration, see rig_daemon_cache_key().
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *  \param has_set Pointer to shared data 'has_set'.
+ *  \return TRUE if the capabilities have been loaded.
+ *
+ * Besides the capabilities, the VFO list, the ATT and preamp tables, the
+ * max RF power and the RIT, XIT and IF shift limits are restored. Nothing
+ * is changed unless the whole cache entry is valid.
+ */
+gboolean
+rig_daemon_cache_load (RIG              *myrig,
+		       const gchar      *key,
+		       grig_settings_t  *get,
+		       grig_cmd_avail_t *has_get,
+		       grig_cmd_avail_t *has_set)
+{
+	GKeyFile *cfg;
+	GError   *error = NULL;
+	gchar    *fname;
+	gchar    *cached;
+	gint     *hget = NULL;
+	gint     *hset = NULL;
+	gint     *att = NULL;
+	gint     *preamp = NULL;
+	gdouble  *limits = NULL;
+	gsize     nget = 0, nset = 0, natt = 0, npreamp = 0, nlimits = 0;
+	gboolean  ok = FALSE;
+	gsize     i;
+
+
+	if (!cacheon) {
+		return FALSE;
+	}
+
+	fname = rig_daemon_cache_file (myrig);
+
+	if (!g_file_test (fname, G_FILE_TEST_EXISTS)) {
+		g_free (fname);
+		return FALSE;
+	}
+
+	cfg = g_key_file_new ();
+
+	if (!g_key_file_load_from_file (cfg, fname, G_KEY_FILE_NONE, &error)) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s: Could not load %s: %s"),
+				  __FUNCTION__, fname, error->message);
+		g_clear_error (&error);
+		g_key_file_free (cfg);
+		g_free (fname);
+		return FALSE;
+	}
+
+	cached = g_key_file_get_string (cfg, GROUP_CACHE, KEY_KEY, NULL);
+
+	if (g_strcmp0 (cached, key) != 0) {
+		grig_debug_local (RIG_DEBUG_VERBOSE,
+				  _("%s: %s is for another configuration"),
+				  __FUNCTION__, fname);
+		goto out;
+	}
+
+	hget = g_key_file_get_integer_list (cfg, GROUP_CACHE, KEY_HAS_GET, &nget, NULL);
+	hset = g_key_file_get_integer_list (cfg, GROUP_CACHE, KEY_HAS_SET, &nset, NULL);
+	att = g_key_file_get_integer_list (cfg, GROUP_CACHE, KEY_ATT, &natt, NULL);
+	preamp = g_key_file_get_integer_list (cfg, GROUP_CACHE, KEY_PREAMP, &npreamp, NULL);
+	limits = g_key_file_get_double_list (cfg, GROUP_CACHE, KEY_LIMITS, &nlimits, NULL);
+
+	if ((nget != C_CACHE_AVAIL_SIZE) || (nset != C_CACHE_AVAIL_SIZE) ||
+	    (natt > HAMLIB_MAXDBLSTSIZ) || (npreamp > HAMLIB_MAXDBLSTSIZ) ||
+	    (nlimits != C_CACHE_NLIMITS) ||
+	    !g_key_file_has_key (cfg, GROUP_CACHE, KEY_VFOS, NULL) ||
+	    !g_key_file_has_key (cfg, GROUP_CACHE, KEY_MAX_POWER, NULL) ||
+	    !g_key_file_has_key (cfg, GROUP_CACHE, KEY_MODES, NULL) ||
+	    !g_key_file_has_key (cfg, GROUP_CACHE, KEY_ANTENNAS, NULL)) {
+
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s: %s is incomplete"),
+				  __FUNCTION__, fname);
+		goto out;
+	}
+
+	memcpy (has_get, hget, sizeof (grig_cmd_avail_t));
+	memcpy (has_set, hset, sizeof (grig_cmd_avail_t));
+
+	rig_data_set_vfos (g_key_file_get_integer (cfg, GROUP_CACHE, KEY_VFOS, NULL));
+	rig_data_set_max_rfpwr (g_key_file_get_double (cfg, GROUP_CACHE, KEY_MAX_POWER, NULL));
+
+	for (i = 0; i < natt; i++)
+		rig_data_set_att_data (i, att[i]);
+
+	for (i = 0; i < npreamp; i++)
+		rig_data_set_preamp_data (i, preamp[i]);
+
+	get->fmin        = limits[0];
+	get->fmax        = limits[1];
+	get->fstep       = limits[2];
+	get->ritmax      = limits[3];
+	get->ritstep     = limits[4];
+	get->xitmax      = limits[5];
+	get->xitstep     = limits[6];
+	get->ifsmax      = limits[7];
+	get->ifsstep     = limits[8];
+	get->allmodes    = g_key_file_get_uint64 (cfg, GROUP_CACHE, KEY_MODES, NULL);
+	get->allantennas = g_key_file_get_uint64 (cfg, GROUP_CACHE, KEY_ANTENNAS, NULL);
+
+	g_free (cachefile[rig_data_current ()]);
+	cachefile[rig_data_current ()] = g_strdup (fname);
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Using capabilities from %s"),
+			  __FUNCTION__, fname);
+
+	ok = TRUE;
+
+ out:
+	g_free (hget);
+	g_free (hset);
+	g_free (att);
+	g_free (preamp);
+	g_free (limits);
+	g_free (cached);
+	g_key_file_free (cfg);
+	g_free (fname);
+
+	return ok;
+}
+
+
+/** \brief Save the detected capabilities.
+ *  \param myrig The radio handle.
+ *  \param key The key of the configuration, see rig_daemon_cache_key().
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *  \param has_set Pointer to shared data 'has_set'.
+ *
+ * This function is called after the rig_daemon_check_xxx() functions.
+ */
+void
+rig_daemon_cache_save (RIG              *myrig,
+		       const gchar      *key,
+		       grig_settings_t  *get,
+		       grig_cmd_avail_t *has_get,
+		       grig_cmd_avail_t *has_set)
+{
+	GKeyFile *cfg;
+	GError   *error = NULL;
+	gchar    *dir;
+	gchar    *fname;
+	gchar    *data;
+	gsize     len;
+	gint      att[HAMLIB_MAXDBLSTSIZ];
+	gint      preamp[HAMLIB_MAXDBLSTSIZ];
+	gdouble   limits[C_CACHE_NLIMITS];
+	gsize     natt, npreamp;
+
+
+	if (!cacheon) {
+		return;
+	}
+
+	dir = get_conf_dir ("caps");
+	g_mkdir_with_parents (dir, 0700);
+	g_free (dir);
+
+	fname = rig_daemon_cache_file (myrig);
+
+	for (natt = 0; (natt < HAMLIB_MAXDBLSTSIZ) && (myrig->state.attenuator[natt] != 0); natt++)
+		att[natt] = myrig->state.attenuator[natt];
+
+	for (npreamp = 0; (npreamp < HAMLIB_MAXDBLSTSIZ) && (myrig->state.preamp[npreamp] != 0); npreamp++)
+		preamp[npreamp] = myrig->state.preamp[npreamp];
+
+	limits[0]  = get->fmin;
+	limits[1]  = get->fmax;
+	limits[2]  = get->fstep;
+	limits[3]  = get->ritmax;
+	limits[4]  = get->ritstep;
+	limits[5]  = get->xitmax;
+	limits[6]  = get->xitstep;
+	limits[7]  = get->ifsmax;
+	limits[8]  = get->ifsstep;
+
+	cfg = g_key_file_new ();
+
+	g_key_file_set_string (cfg, GROUP_CACHE, KEY_KEY, key);
+	g_key_file_set_integer_list (cfg, GROUP_CACHE, KEY_HAS_GET, (gint *) has_get, C_CACHE_AVAIL_SIZE);
+	g_key_file_set_integer_list (cfg, GROUP_CACHE, KEY_HAS_SET, (gint *) has_set, C_CACHE_AVAIL_SIZE);
+	g_key_file_set_integer (cfg, GROUP_CACHE, KEY_VFOS, rig_data_get_vfos ());
+	g_key_file_set_integer_list (cfg, GROUP_CACHE, KEY_ATT, att, natt);
+	g_key_file_set_integer_list (cfg, GROUP_CACHE, KEY_PREAMP, preamp, npreamp);
+	g_key_file_set_double (cfg, GROUP_CACHE, KEY_MAX_POWER, rig_data_get_max_rfpwr ());
+	g_key_file_set_double_list (cfg, GROUP_CACHE, KEY_LIMITS, limits, G_N_ELEMENTS (limits));
+	g_key_file_set_uint64 (cfg, GROUP_CACHE, KEY_MODES, (guint) get->allmodes);
+	g_key_file_set_uint64 (cfg, GROUP_CACHE, KEY_ANTENNAS, (guint) get->allantennas);
+
+	data = g_key_file_to_data (cfg, &len, NULL);
+
+	if (!g_file_set_contents (fname, data, len, &error)) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s: Could not save %s: %s"),
+				  __FUNCTION__, fname, error->message);
+		g_clear_error (&error);
+	}
+	else {
+		g_free (cachefile[rig_data_current ()]);
+		cachefile[rig_data_current ()] = g_strdup (fname);
+	}
+
+	g_free (data);
+	g_key_file_free (cfg);
+	g_free (fname);
+}
+
+
+/** \brief Remove the cached capabilities of the current rig.
+ *
+ * This function is called when the anomaly manager disables a command
+ * because the rig rejects it. The capabilities are detected again at the
+ * next start.
+ */
+void
+rig_daemon_cache_invalidate ()
+{
+	gint rig = rig_data_current ();
+
+
+	if (cachefile[rig] == NULL)
+		return;
+
+	if ((g_unlink (cachefile[rig]) != 0) && (errno != ENOENT)) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s: Could not remove %s: %s"),
+				  __FUNCTION__, cachefile[rig], g_strerror (errno));
+	}
+	else {
+		grig_debug_local (RIG_DEBUG_VERBOSE,
+				  _("%s: Capabilities will be detected at next start"),
+				  __FUNCTION__);
+	}
+
+	g_free (cachefile[rig]);
+	cachefile[rig] = NULL;
+}
+
+
+/** \brief Enable or disable the capability cache.
+ *  \param enabled FALSE to neither load nor save the capabilities.
+ *
+ * This must be called before the rigs are started.
+ */
+void
+rig_daemon_cache_set_enabled (gboolean enabled)
+{
+	cacheon = enabled;
+}
+
+
+/** \brief Get the cache file of a rig.
+ *
+ * The file is named after the rig model and a hash of the port, so that
+ * rigs of the same model on different ports do not share a file.
+ */
+static gchar *
+rig_daemon_cache_file (RIG *myrig)
+{
+	gchar *dir;
+	gchar *port;
+	gchar *fname;
+
+
+	port = g_compute_checksum_for_string (G_CHECKSUM_SHA1,
+					      myrig->state.rigport.pathname, -1);
+	port[12] = '\0';
+
+	dir = get_conf_dir ("caps");
+	fname = g_strdup_printf ("%s%s%d-%s.conf", dir, G_DIR_SEPARATOR_S,
+				 myrig->caps->rig_model, port);
+	g_free (dir);
+	g_free (port);
+
+	return fname;
+}
@@ -37,6 +37,13 @@
  * This file contains various supporting functions which are executed
  * after the radio has been initialized.
  *
+ * The rig_daemon_check_xxx() functions find out which settings the rig
+ * supports. They only look at the capabilities published by the backend
+ * and do not talk to the rig. The current values are read afterwards by
+ * the rig_daemon_read_xxx() functions, which run in the daemon thread while
+ * the GUI is being built and store each value under the sequence lock of
+ * rig-data.
+ *
  * \bug File includes gtk.h but not really needed?
  */
 #include <gtk/gtk.h>
@@ -47,6 +54,14 @@
 #include "rig-daemon-check.h"
 
 
+/** \brief Store a value read from the rig in 'get'. */
+#define CHECK_STORE(field,value) do {		\
+		rig_data_write_begin ();	\
+		get->field = (value);		\
+		rig_data_write_end ();		\
+	} while (0)
+
+
 
 
 /** \brief Check availability of power status.
@@ -125,10 +140,6 @@ rig_daemon_check_vfo     (RIG               *myrig,
 			  grig_cmd_avail_t  *has_set)
 
 {
-	int               retcode;                 /* Hamlib status code */
-	vfo_t             vfo = RIG_VFO_NONE;      /* current VFO */
-
-
 	/* check whether we can get/set VFO */
 	has_get->vfo = (myrig->caps->get_vfo != NULL) ? TRUE : FALSE;
 	has_set->vfo = (myrig->caps->set_vfo != NULL) ? TRUE : FALSE;
@@ -159,17 +170,6 @@ rig_daemon_check_vfo     (RIG               *myrig,
 					  __FUNCTION__);
 		}
 	}
-
-	/* try to get current VFO */
-	if (has_get->vfo) {
-		retcode = rig_get_vfo (myrig, &vfo);
-		if (retcode == RIG_OK) {
-			get->vfo = vfo;
-		}
-		else {
-			get->vfo = RIG_VFO_NONE;
-		}
-	}
 }
 
 
@@ -183,8 +183,7 @@ rig_daemon_check_vfo     (RIG               *myrig,
  *
  * This function tests whether the rig is capable to get/set the frequency. 
  * The test is done by checking the get_freq and set_freq pointers in the
- * rig_caps structure. Furthermore, if the rig is capable of getting the
- * frequency, the current frequency is read.
+ * rig_caps structure.
  */
 void
 rig_daemon_check_freq     (RIG               *myrig,
@@ -193,28 +192,11 @@ rig_daemon_check_freq     (RIG               *myrig,
 			   grig_cmd_avail_t  *has_set)
 
 {
-	int               retcode;                 /* Hamlib status code */
-	freq_t            freq;                    /* current frequency */
-
-
 	/* check get/set freq availabilities */
 	has_get->freq1 = (myrig->caps->get_freq != NULL) ? TRUE : FALSE;
 	has_set->freq1 = (myrig->caps->set_freq != NULL) ? TRUE : FALSE;
-	
 
-	if (has_get->freq1) {
-		/* try to obtain current frequency */
-		retcode = rig_get_freq (myrig, RIG_VFO_CURR, &freq);
-		if (retcode == RIG_OK) {
-			get->freq1 = freq;
-		}
-		else {
-			get->freq1 = 0.0;
-		}
-	}
-	else {
-		get->freq1 = 0.0;
-	}
+	get->freq1 = 0.0;
 }
 
 
@@ -226,7 +208,6 @@ rig_daemon_check_freq     (RIG               *myrig,
  *
  * This function check the availability of the RIT value. The test is done
  * by checking the get_rit and set-rit pointers in the rig_caps structure.
- * Furthermore, if get_rit is available the current value is read and stored.
  *
  * \bug The code sets the ritstep to 10Hz.
  */
@@ -237,27 +218,11 @@ rig_daemon_check_rit      (RIG               *myrig,
 			   grig_cmd_avail_t  *has_set)
 
 {
-
-	int               retcode;                 /* Hamlib status code */
-	shortfreq_t       sfreq;                   /* current RIT setting */
-
 	/* checkfor RIT availability */
 	has_get->rit = (myrig->caps->get_rit != NULL && myrig->state.max_rit) ? TRUE : FALSE;
 	has_set->rit = (myrig->caps->set_rit != NULL && myrig->state.max_rit) ? TRUE : FALSE;
 
-	if (has_get->rit) {
-		/* try to get RIT setting */
-		retcode = rig_get_rit (myrig, RIG_VFO_CURR, &sfreq);
-		if (retcode == RIG_OK) {
-			get->rit = sfreq;
-		}
-		else {
-			get->rit = s_kHz(0.00);
-		}
-	}
-	else {
-		get->rit = s_kHz(0.00);
-	}
+	get->rit = s_kHz(0.00);
 
 	if (has_get->rit || has_set->rit) {
 		/* get RIT range and tuning step */
@@ -282,7 +247,6 @@ rig_daemon_check_rit      (RIG               *myrig,
  *
  * This function check the availability of the XIT value. The test is done
  * by checking the get_xit and set-xit pointers in the rig_caps structure.
- * Furthermore, if get_xit is available the current value is read and stored.
  *
  * \bug The code sets the xitstep to 10Hz.
  */
@@ -293,27 +257,11 @@ rig_daemon_check_xit      (RIG               *myrig,
 			   grig_cmd_avail_t  *has_set)
 
 {
-
-	int               retcode;                 /* Hamlib status code */
-	shortfreq_t       sfreq;                   /* current XIT setting */
-
 	/* checkfor XIT availability */
 	has_get->xit = (myrig->caps->get_xit != NULL && myrig->state.max_xit) ? TRUE : FALSE;
 	has_set->xit = (myrig->caps->set_xit != NULL && myrig->state.max_xit) ? TRUE : FALSE;
 
-	if (has_get->xit) {
-		/* try to get RIT setting */
-		retcode = rig_get_xit (myrig, RIG_VFO_CURR, &sfreq);
-		if (retcode == RIG_OK) {
-			get->xit = sfreq;
-		}
-		else {
-			get->xit = s_kHz(0.00);
-		}
-	}
-	else {
-		get->xit = s_kHz(0.00);
-	}
+	get->xit = s_kHz(0.00);
 
 	if (has_get->xit || has_set->xit) {
 		/* get XIT range and tuning step */
@@ -339,10 +287,9 @@ rig_daemon_check_xit      (RIG               *myrig,
  * settings. These are checked together because this is the way hamlib
  * manages them.
  *
- * This function also checks for the frequency range and resolution for
- * the current mode and also builds the global list of available modes.
- *
- * \bug much of the freq. range code is similar to ode in the RIG_CMD_GET_MODE code
+ * This function also builds the global list of available modes. The
+ * frequency range and resolution for the current mode are found when the
+ * mode is read, see rig_daemon_read_mode().
  */
 void
 rig_daemon_check_mode     (RIG               *myrig,
@@ -351,11 +298,7 @@ rig_daemon_check_mode     (RIG               *myrig,
 			   grig_cmd_avail_t  *has_set)
 
 {
-	int               retcode;                 /* Hamlib status code */
-	rmode_t           mode;                    /* current mode */
-	pbwidth_t         pbw;                     /* current passband width */
 	int               i = 0;                   /* iterator */
-	int               found_mode = 0;          /* flag to indicate found mode */
 
 
 	has_get->mode = (myrig->caps->get_mode != NULL) ? TRUE : FALSE;
@@ -364,89 +307,20 @@ rig_daemon_check_mode     (RIG               *myrig,
 	has_get->pbw = has_get->mode;
 	has_set->pbw = has_set->mode;
 
-	/* try to get mode and passband width */
-	retcode = rig_get_mode (myrig, RIG_VFO_CURR, &mode, &pbw);
-	if (retcode == RIG_OK) {
-		get->mode     = mode;
-
-		/* convert and store the new passband width */
-		if (pbw == rig_passband_wide (myrig, mode)) {
-			get->pbw = RIG_DATA_PB_WIDE;
-		}
-		else if (pbw == rig_passband_narrow (myrig, mode)) {
-			get->pbw  = RIG_DATA_PB_NARROW;
-		}
-		else {
-			get->pbw  = RIG_DATA_PB_NORMAL;
-		}
-		
-		/* initialize the frequency range and tuning step
-		   note: we loop through *all* ranges so that we can create
-		   a list of supported modes as well
-		*/
-		while (!RIG_IS_FRNG_END(myrig->state.rx_range_list[i])) {
-					       
-			/* store modes */
-			get->allmodes |= myrig->state.rx_range_list[i].modes;
-
-			/* store antennas */
-			get->allantennas |= myrig->state.rx_range_list[i].ant;
-
-			/* if we have not yet found a mode      AND
-			   this list is good for current mode   AND
-			   the current frequency is within this range
-			*/
-			if (!found_mode &&
-			    ((mode & myrig->state.rx_range_list[i].modes) == mode) &&
-			    (get->freq1 >= myrig->state.rx_range_list[i].startf)   &&
-			    (get->freq1 <= myrig->state.rx_range_list[i].endf)) {
-
-				found_mode = 1;
-				get->fmin = myrig->state.rx_range_list[i].startf;
-				get->fmax = myrig->state.rx_range_list[i].endf;
-
-				grig_debug_local (RIG_DEBUG_VERBOSE,
-						  _("%s: Found frequency range for mode %d"),
-						  __FUNCTION__, mode);
-				grig_debug_local (RIG_DEBUG_VERBOSE,
-						  _("%s: %.0f...(%.0f)...%.0f kHz"),
-						  __FUNCTION__,
-						  get->fmin / 1.0e3,
-						  get->freq1 / 1.0e3,
-						  get->fmax / 1.0e3);
-
-			}
-			else {
-				i++;
-			}
-			
-		}
-
-		/* if we did not find any suitable range there could be a bug
-		   in the backend!
-		*/
-		if (!found_mode) {
-			grig_debug_local (RIG_DEBUG_BUG,
-					  _("%s: Can not find frequency range for this "\
-					    "mode (%d)! Bug in backend?"),
-					  __FUNCTION__, mode);
-		}
-
-		/* get the smallest tuning step */
-		get->fstep = rig_get_resolution (myrig, mode);
-
+	/* store modes and antennas of all ranges */
+	while (!RIG_IS_FRNG_END(myrig->state.rx_range_list[i])) {
+		get->allmodes |= myrig->state.rx_range_list[i].modes;
+		get->allantennas |= myrig->state.rx_range_list[i].ant;
+		i++;
 	}
 
-	else {
-		get->mode     = RIG_MODE_NONE;
-		get->pbw      = RIG_PASSBAND_NORMAL;
-
-		/* initialize frequency range and tuning step to what? */
-		get->fmin  = kHz(30);
-		get->fmax  = GHz(1);
-		get->fstep = Hz(10);
-	}
+	get->mode     = RIG_MODE_NONE;
+	get->pbw      = RIG_PASSBAND_NORMAL;
 
+	/* initialize frequency range and tuning step to what? */
+	get->fmin  = kHz(30);
+	get->fmax  = GHz(1);
+	get->fstep = Hz(10);
 }
 
 
@@ -468,9 +342,7 @@ rig_daemon_check_level     (RIG               *myrig,
 			    grig_cmd_avail_t  *has_set)
 
 {
-	int               retcode;                 /* Hamlib status code */
 	setting_t         haslevel;                /* available level settings */
-	value_t           val;                     /* generic value */
 	int               i = 0;
 	float             maxpwr = 0.0;
 
@@ -506,20 +378,8 @@ rig_daemon_check_level     (RIG               *myrig,
 	has_get->micg     = ((haslevel & RIG_LEVEL_MICGAIN) ? 1 : 0);
 	has_get->comp     = ((haslevel & RIG_LEVEL_COMP) ? 1 : 0);
 
-	/* read values */
+	/* find and store max RF power */
 	if (has_get->power) {
-		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_RFPOWER, &val);
-		if (retcode == RIG_OK) {
-			get->power = val.f;
-		}
-		else {
-			/* send an error report */
-			grig_debug_local (RIG_DEBUG_ERR,
-					  _("%s: Could not get RF power"),
-					  __FUNCTION__);
-		}
-
-		/* find and store max RF power */
 		while (!RIG_IS_FRNG_END(myrig->state.tx_range_list[i])) {
 					       
 			if ((myrig->state.tx_range_list[i].high_power / 1000.0) > maxpwr) {
@@ -534,10 +394,364 @@ rig_daemon_check_level     (RIG               *myrig,
 				  __FUNCTION__, maxpwr);
 	}
 
+	if (has_get->ifs) {
+		get->ifsmax = myrig->state.max_ifshift;
+		get->ifsstep = s_Hz(10);
+	}
+
+	/* get available write levels */
+	haslevel = rig_has_set_level (myrig, GRIG_LEVEL_WR);
+
+	/* we don't perform explicit testing of set levels
+	   (like we did with the get levels) since we might
+	   not have any good values to send
+	*/
+	has_set->power  = ((haslevel & RIG_LEVEL_RFPOWER) ? 1 : 0);
+	has_set->agc    = ((haslevel & RIG_LEVEL_AGC) ? 1 : 0);
+	has_set->att    = ((haslevel & RIG_LEVEL_ATT) ? 1 : 0);
+	has_set->preamp = ((haslevel & RIG_LEVEL_PREAMP) ? 1 : 0);
+	has_set->afg      = ((haslevel & RIG_LEVEL_AF) ? 1 : 0);
+	has_set->rfg      = ((haslevel & RIG_LEVEL_RF) ? 1 : 0);
+	has_set->sql      = ((haslevel & RIG_LEVEL_SQL) ? 1 : 0);
+	has_set->ifs      = ((haslevel & RIG_LEVEL_IF) ? 1 : 0);
+	has_set->apf      = ((haslevel & RIG_LEVEL_APF) ? 1 : 0);
+	has_set->nr       = ((haslevel & RIG_LEVEL_NR) ? 1 : 0);
+	has_set->notch    = ((haslevel & RIG_LEVEL_NOTCHF) ? 1 : 0);
+	has_set->pbtin    = ((haslevel & RIG_LEVEL_PBT_IN) ? 1 : 0);
+	has_set->pbtout   = ((haslevel & RIG_LEVEL_PBT_OUT) ? 1 : 0);
+	has_set->cwpitch  = ((haslevel & RIG_LEVEL_CWPITCH) ? 1 : 0);
+	has_set->keyspd   = ((haslevel & RIG_LEVEL_KEYSPD) ? 1 : 0);
+	has_set->bkindel  = ((haslevel & RIG_LEVEL_BKINDL) ? 1 : 0);
+	has_set->balance  = ((haslevel & RIG_LEVEL_BALANCE) ? 1 : 0);
+	has_set->voxdel   = ((haslevel & RIG_LEVEL_VOXDELAY) ? 1 : 0);
+	has_set->voxg     = ((haslevel & RIG_LEVEL_VOXGAIN) ? 1 : 0);
+	has_set->antivox  = ((haslevel & RIG_LEVEL_ANTIVOX) ? 1 : 0);
+	has_set->micg     = ((haslevel & RIG_LEVEL_MICGAIN) ? 1 : 0);
+	has_set->comp     = ((haslevel & RIG_LEVEL_COMP) ? 1 : 0);
+
+	/* initialise preamp and att arrays in rig-data */
+	if (has_get->att || has_set->att) {
+		int i = 0;
+
+		while ((i < HAMLIB_MAXDBLSTSIZ) && (myrig->state.attenuator[i] != 0)) {
+			rig_data_set_att_data (i, myrig->state.attenuator[i]);
+			i++;
+		}
+		
+	}
+		
+
+	if (has_get->preamp || has_set->preamp) {
+		int i = 0;
+
+		while ((i < HAMLIB_MAXDBLSTSIZ) && (myrig->state.preamp[i] != 0)) {
+			rig_data_set_preamp_data (i, myrig->state.preamp[i]);
+			i++;
+		}
+	}
+
+	/* FIXME: AGC ARRAY? */
+}
+
+
+
+/** \brief Check FUNC setting and reading availabilities.
+ *  \param rig The radio handle.
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *  \param has_set Pointer to shared data 'has_set'.
+ *
+ * This function tests the availability of various special functions,
+ * which are available through the rig_setfunc and rig_get_func API calls.
+ * Only the functions supported by grig are tested.
+ */
+void
+rig_daemon_check_func     (RIG               *myrig,
+			   grig_settings_t   *get,
+			   grig_cmd_avail_t  *has_get,
+			   grig_cmd_avail_t  *has_set)
+
+{
+	setting_t         hasfunc;                 /* available func settings */
+	int               i;                       /* setting index */
+	setting_t         func;                    /* setting iterated */
+
+
+	/* get available read funcs
+	 */
+	hasfunc = rig_has_get_func (myrig, GRIG_FUNC_RD);
+
+	/* unmask bits */
+	has_get->lock    = ((hasfunc & RIG_FUNC_LOCK) ? 1 : 0);
+
+	for (i=0; i < RIG_SETTING_MAX; i++) {
+		func = rig_idx2setting(i);
+		has_get->funcs[i]  = rig_has_get_func(myrig, func) ? 1 : 0;
+	}
+
+	/* get available write funcs */
+	hasfunc = rig_has_set_func (myrig, GRIG_FUNC_WR);
+
+	/* we don't perform explicit testing of set functions
+	   (like we did with the get levels) since we might
+	   not have any good values to send
+	*/
+	has_set->lock  = ((hasfunc & RIG_FUNC_LOCK) ? 1 : 0);
+
+	for (i=0; i < RIG_SETTING_MAX; i++) {
+		func = rig_idx2setting(i);
+		has_set->funcs[i]  = rig_has_set_func(myrig, func) ? 1 : 0;
+	}
+}
+
+
+
+/** \brief Read the current VFO.
+ *  \param rig The radio handle.
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *
+ * This function reads the current VFO if the rig can tell it.
+ */
+void
+rig_daemon_read_vfo       (RIG               *myrig,
+			   grig_settings_t   *get,
+			   grig_cmd_avail_t  *has_get)
+
+{
+	int               retcode;                 /* Hamlib status code */
+	vfo_t             vfo = RIG_VFO_NONE;      /* current VFO */
+
+
+	if (has_get->vfo) {
+		retcode = rig_get_vfo (myrig, &vfo);
+		if (retcode == RIG_OK) {
+			CHECK_STORE (vfo, vfo);
+		}
+		else {
+			CHECK_STORE (vfo, RIG_VFO_NONE);
+		}
+	}
+}
+
+
+
+/** \brief Read the current frequency.
+ *  \param rig The radio handle.
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *
+ * This function reads the primary frequency if the rig can tell it.
+ */
+void
+rig_daemon_read_freq      (RIG               *myrig,
+			   grig_settings_t   *get,
+			   grig_cmd_avail_t  *has_get)
+
+{
+	int               retcode;                 /* Hamlib status code */
+	freq_t            freq;                    /* current frequency */
+
+
+	if (has_get->freq1) {
+		/* try to obtain current frequency */
+		retcode = rig_get_freq (myrig, RIG_VFO_CURR, &freq);
+		if (retcode == RIG_OK) {
+			CHECK_STORE (freq1, freq);
+		}
+	}
+}
+
+
+
+/** \brief Read the current RIT value.
+ *  \param rig The radio handle.
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *
+ * This function reads the RIT setting if the rig can tell it.
+ */
+void
+rig_daemon_read_rit       (RIG               *myrig,
+			   grig_settings_t   *get,
+			   grig_cmd_avail_t  *has_get)
+
+{
+	int               retcode;                 /* Hamlib status code */
+	shortfreq_t       sfreq;                   /* current RIT setting */
+
+
+	if (has_get->rit) {
+		/* try to get RIT setting */
+		retcode = rig_get_rit (myrig, RIG_VFO_CURR, &sfreq);
+		if (retcode == RIG_OK) {
+			CHECK_STORE (rit, sfreq);
+		}
+	}
+}
+
+
+
+/** \brief Read the current XIT value.
+ *  \param rig The radio handle.
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *
+ * This function reads the XIT setting if the rig can tell it.
+ */
+void
+rig_daemon_read_xit       (RIG               *myrig,
+			   grig_settings_t   *get,
+			   grig_cmd_avail_t  *has_get)
+
+{
+	int               retcode;                 /* Hamlib status code */
+	shortfreq_t       sfreq;                   /* current XIT setting */
+
+
+	if (has_get->xit) {
+		/* try to get XIT setting */
+		retcode = rig_get_xit (myrig, RIG_VFO_CURR, &sfreq);
+		if (retcode == RIG_OK) {
+			CHECK_STORE (xit, sfreq);
+		}
+	}
+}
+
+
+
+/** \brief Read the current mode and passband width.
+ *  \param rig The radio handle.
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *
+ * This function reads the mode and passband width and looks up the
+ * frequency range and the resolution for the current mode.
+ *
+ * \bug much of the freq. range code is similar to ode in the RIG_CMD_GET_MODE code
+ */
+void
+rig_daemon_read_mode      (RIG               *myrig,
+			   grig_settings_t   *get,
+			   grig_cmd_avail_t  *has_get)
+
+{
+	int               retcode;                 /* Hamlib status code */
+	rmode_t           mode;                    /* current mode */
+	pbwidth_t         pbw;                     /* current passband width */
+	int               i = 0;                   /* iterator */
+	rig_data_pbw_t    width;                   /* converted passband width */
+	freq_t            fmin, fmax;              /* frequency range */
+
+
+	if (!has_get->mode) {
+		return;
+	}
+
+	/* try to get mode and passband width */
+	retcode = rig_get_mode (myrig, RIG_VFO_CURR, &mode, &pbw);
+	if (retcode != RIG_OK) {
+		return;
+	}
+
+	/* convert the passband width */
+	if (pbw == rig_passband_wide (myrig, mode)) {
+		width = RIG_DATA_PB_WIDE;
+	}
+	else if (pbw == rig_passband_narrow (myrig, mode)) {
+		width = RIG_DATA_PB_NARROW;
+	}
+	else {
+		width = RIG_DATA_PB_NORMAL;
+	}
+
+	/* find the frequency range of the current mode */
+	fmin = get->fmin;
+	fmax = get->fmax;
+
+	while (!RIG_IS_FRNG_END(myrig->state.rx_range_list[i])) {
+
+		/* this list is good for current mode AND
+		   the current frequency is within this range
+		*/
+		if (((mode & myrig->state.rx_range_list[i].modes) == mode) &&
+		    (get->freq1 >= myrig->state.rx_range_list[i].startf)   &&
+		    (get->freq1 <= myrig->state.rx_range_list[i].endf)) {
+
+			fmin = myrig->state.rx_range_list[i].startf;
+			fmax = myrig->state.rx_range_list[i].endf;
+
+			grig_debug_local (RIG_DEBUG_VERBOSE,
+					  _("%s: Found frequency range for mode %d"),
+					  __FUNCTION__, mode);
+			grig_debug_local (RIG_DEBUG_VERBOSE,
+					  _("%s: %.0f...(%.0f)...%.0f kHz"),
+					  __FUNCTION__,
+					  fmin / 1.0e3,
+					  get->freq1 / 1.0e3,
+					  fmax / 1.0e3);
+			break;
+		}
+
+		i++;
+	}
+
+	/* if we did not find any suitable range there could be a bug
+	   in the backend!
+	*/
+	if (RIG_IS_FRNG_END(myrig->state.rx_range_list[i])) {
+		grig_debug_local (RIG_DEBUG_BUG,
+				  _("%s: Can not find frequency range for this "\
+				    "mode (%d)! Bug in backend?"),
+				  __FUNCTION__, mode);
+	}
+
+	rig_data_write_begin ();
+	get->mode  = mode;
+	get->pbw   = width;
+	get->fmin  = fmin;
+	get->fmax  = fmax;
+	get->fstep = rig_get_resolution (myrig, mode);
+	rig_data_write_end ();
+}
+
+
+
+/** \brief Read the current levels.
+ *  \param rig The radio handle.
+ *  \param get Pointer to shared data 'get'.
+ *  \param has_get Pointer to shared data 'has_get'.
+ *
+ * This function reads each level which has been found readable by
+ * rig_daemon_check_level().
+ */
+void
+rig_daemon_read_level     (RIG               *myrig,
+			   grig_settings_t   *get,
+			   grig_cmd_avail_t  *has_get)
+
+{
+	int               retcode;                 /* Hamlib status code */
+	value_t           val;                     /* generic value */
+
+
+	if (has_get->power) {
+		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_RFPOWER, &val);
+		if (retcode == RIG_OK) {
+			CHECK_STORE (power, val.f);
+		}
+		else {
+			/* send an error report */
+			grig_debug_local (RIG_DEBUG_ERR,
+					  _("%s: Could not get RF power"),
+					  __FUNCTION__);
+		}
+	}
+
 	if (has_get->strength) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_STRENGTH, &val);
 		if (retcode == RIG_OK) {
-			get->strength = val.i;
+			CHECK_STORE (strength, val.i);
 		}
 		else {
 			/* send an error report */
@@ -545,14 +759,14 @@ rig_daemon_check_level     (RIG               *myrig,
 					  _("%s: Could not get signal strength"),
 					  __FUNCTION__);
 
-			get->strength = -54;
+			CHECK_STORE (strength, -54);
 		}
 	}
 
 	if (has_get->swr) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_SWR, &val);
 		if (retcode == RIG_OK) {
-			get->swr = val.f;
+			CHECK_STORE (swr, val.f);
 		}
 		else {
 			/* send an error report */
@@ -565,7 +779,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->alc) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ALC, &val);
 		if (retcode == RIG_OK) {
-			get->alc = val.f;
+			CHECK_STORE (alc, val.f);
 		}
 		else {
 			/* send an error report */
@@ -578,7 +792,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->agc) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_AGC, &val);
 		if (retcode == RIG_OK) {
-			get->agc = val.i;
+			CHECK_STORE (agc, val.i);
 		}
 		else {
 			/* send an error report */
@@ -591,7 +805,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->att) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ATT, &val);
 		if (retcode == RIG_OK) {
-			get->att = val.i;
+			CHECK_STORE (att, val.i);
 		}
 		else {
 			/* send an error report */
@@ -604,7 +818,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->preamp) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PREAMP, &val);
 		if (retcode == RIG_OK) {
-			get->preamp = val.i;
+			CHECK_STORE (preamp, val.i);
 		}
 		else {
 			/* send an error report */
@@ -617,7 +831,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->afg) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_AF, &val);
 		if (retcode == RIG_OK) {
-			get->afg = val.f;
+			CHECK_STORE (afg, val.f);
 		}
 		else {
 			/* send an error report */
@@ -630,7 +844,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->rfg) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_RF, &val);
 		if (retcode == RIG_OK) {
-			get->rfg = val.f;
+			CHECK_STORE (rfg, val.f);
 		}
 		else {
 			/* send an error report */
@@ -643,7 +857,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->sql) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_SQL, &val);
 		if (retcode == RIG_OK) {
-			get->sql = val.f;
+			CHECK_STORE (sql, val.f);
 		}
 		else {
 			/* send an error report */
@@ -656,9 +870,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->ifs) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_IF, &val);
 		if (retcode == RIG_OK) {
-			get->ifs = val.i;
-			get->ifsmax = myrig->state.max_ifshift;
-			get->ifsstep = s_Hz(10);
+			CHECK_STORE (ifs, val.i);
 		}
 		else {
 			/* send an error report */
@@ -671,7 +883,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->apf) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_APF, &val);
 		if (retcode == RIG_OK) {
-			get->apf = val.f;
+			CHECK_STORE (apf, val.f);
 		}
 		else {
 			/* send an error report */
@@ -684,7 +896,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->nr) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_NR, &val);
 		if (retcode == RIG_OK) {
-			get->nr = val.f;
+			CHECK_STORE (nr, val.f);
 		}
 		else {
 			/* send an error report */
@@ -697,7 +909,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->notch) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_NOTCHF, &val);
 		if (retcode == RIG_OK) {
-			get->notch = val.i;
+			CHECK_STORE (notch, val.i);
 		}
 		else {
 			/* send an error report */
@@ -710,7 +922,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->pbtin) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PBT_IN, &val);
 		if (retcode == RIG_OK) {
-			get->pbtin = val.f;
+			CHECK_STORE (pbtin, val.f);
 		}
 		else {
 			/* send an error report */
@@ -723,7 +935,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->pbtout) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PBT_OUT, &val);
 		if (retcode == RIG_OK) {
-			get->pbtout = val.f;
+			CHECK_STORE (pbtout, val.f);
 		}
 		else {
 			/* send an error report */
@@ -736,7 +948,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->cwpitch) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_CWPITCH, &val);
 		if (retcode == RIG_OK) {
-			get->cwpitch = val.i;
+			CHECK_STORE (cwpitch, val.i);
 		}
 		else {
 			/* send an error report */
@@ -749,7 +961,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->keyspd) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_KEYSPD, &val);
 		if (retcode == RIG_OK) {
-			get->keyspd = val.i;
+			CHECK_STORE (keyspd, val.i);
 		}
 		else {
 			/* send an error report */
@@ -762,7 +974,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->bkindel) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_BKINDL, &val);
 		if (retcode == RIG_OK) {
-			get->bkindel = val.i;
+			CHECK_STORE (bkindel, val.i);
 		}
 		else {
 			/* send an error report */
@@ -775,7 +987,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->balance) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_BALANCE, &val);
 		if (retcode == RIG_OK) {
-			get->balance = val.f;
+			CHECK_STORE (balance, val.f);
 		}
 		else {
 			/* send an error report */
@@ -788,7 +1000,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->voxdel) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_VOXDELAY, &val);
 		if (retcode == RIG_OK) {
-			get->voxdel = val.i;
+			CHECK_STORE (voxdel, val.i);
 		}
 		else {
 			/* send an error report */
@@ -801,7 +1013,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->voxg) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_VOXGAIN, &val);
 		if (retcode == RIG_OK) {
-			get->voxg = val.f;
+			CHECK_STORE (voxg, val.f);
 		}
 		else {
 			/* send an error report */
@@ -814,7 +1026,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->antivox) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ANTIVOX, &val);
 		if (retcode == RIG_OK) {
-			get->antivox = val.f;
+			CHECK_STORE (antivox, val.f);
 		}
 		else {
 			/* send an error report */
@@ -827,7 +1039,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->comp) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_COMP, &val);
 		if (retcode == RIG_OK) {
-			get->comp = val.f;
+			CHECK_STORE (comp, val.f);
 		}
 		else {
 			/* send an error report */
@@ -840,7 +1052,7 @@ rig_daemon_check_level     (RIG               *myrig,
 	if (has_get->micg) {
 		retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_MICGAIN, &val);
 		if (retcode == RIG_OK) {
-			get->micg = val.f;
+			CHECK_STORE (micg, val.f);
 		}
 		else {
 			/* send an error report */
@@ -849,104 +1061,34 @@ rig_daemon_check_level     (RIG               *myrig,
 					  __FUNCTION__);
 		}
 	}
-
-	/* get available write levels */
-	haslevel = rig_has_set_level (myrig, GRIG_LEVEL_WR);
-
-	/* we don't perform explicit testing of set levels
-	   (like we did with the get levels) since we might
-	   not have any good values to send
-	*/
-	has_set->power  = ((haslevel & RIG_LEVEL_RFPOWER) ? 1 : 0);
-	has_set->agc    = ((haslevel & RIG_LEVEL_AGC) ? 1 : 0);
-	has_set->att    = ((haslevel & RIG_LEVEL_ATT) ? 1 : 0);
-	has_set->preamp = ((haslevel & RIG_LEVEL_PREAMP) ? 1 : 0);
-	has_set->afg      = ((haslevel & RIG_LEVEL_AF) ? 1 : 0);
-	has_set->rfg      = ((haslevel & RIG_LEVEL_RF) ? 1 : 0);
-	has_set->sql      = ((haslevel & RIG_LEVEL_SQL) ? 1 : 0);
-	has_set->ifs      = ((haslevel & RIG_LEVEL_IF) ? 1 : 0);
-	has_set->apf      = ((haslevel & RIG_LEVEL_APF) ? 1 : 0);
-	has_set->nr       = ((haslevel & RIG_LEVEL_NR) ? 1 : 0);
-	has_set->notch    = ((haslevel & RIG_LEVEL_NOTCHF) ? 1 : 0);
-	has_set->pbtin    = ((haslevel & RIG_LEVEL_PBT_IN) ? 1 : 0);
-	has_set->pbtout   = ((haslevel & RIG_LEVEL_PBT_OUT) ? 1 : 0);
-	has_set->cwpitch  = ((haslevel & RIG_LEVEL_CWPITCH) ? 1 : 0);
-	has_set->keyspd   = ((haslevel & RIG_LEVEL_KEYSPD) ? 1 : 0);
-	has_set->bkindel  = ((haslevel & RIG_LEVEL_BKINDL) ? 1 : 0);
-	has_set->balance  = ((haslevel & RIG_LEVEL_BALANCE) ? 1 : 0);
-	has_set->voxdel   = ((haslevel & RIG_LEVEL_VOXDELAY) ? 1 : 0);
-	has_set->voxg     = ((haslevel & RIG_LEVEL_VOXGAIN) ? 1 : 0);
-	has_set->antivox  = ((haslevel & RIG_LEVEL_ANTIVOX) ? 1 : 0);
-	has_set->micg     = ((haslevel & RIG_LEVEL_MICGAIN) ? 1 : 0);
-	has_set->comp     = ((haslevel & RIG_LEVEL_COMP) ? 1 : 0);
-
-	/* initialise preamp and att arrays in rig-data */
-	if (has_get->att || has_set->att) {
-		int i = 0;
-
-		while ((i < HAMLIB_MAXDBLSTSIZ) && (myrig->state.attenuator[i] != 0)) {
-			rig_data_set_att_data (i, myrig->state.attenuator[i]);
-			i++;
-		}
-		
-	}
-		
-
-	if (has_get->preamp || has_set->preamp) {
-		int i = 0;
-
-		while ((i < HAMLIB_MAXDBLSTSIZ) && (myrig->state.preamp[i] != 0)) {
-			rig_data_set_preamp_data (i, myrig->state.preamp[i]);
-			i++;
-		}
-	}
-
-	/* FIXME: AGC ARRAY? */
 }
 
 
 
-/** \brief Check FUNC setting and reading availabilities.
+/** \brief Read the current special functions.
  *  \param rig The radio handle.
  *  \param get Pointer to shared data 'get'.
  *  \param has_get Pointer to shared data 'has_get'.
- *  \param has_set Pointer to shared data 'has_set'.
  *
- * This function tests the availability of various special functions,
- * which are available through the rig_setfunc and rig_get_func API calls.
- * Only the functions supported by grig are tested.
+ * This function reads the LOCK status and each function which has been
+ * found readable by rig_daemon_check_func().
  */
 void
-rig_daemon_check_func     (RIG               *myrig,
+rig_daemon_read_func      (RIG               *myrig,
 			   grig_settings_t   *get,
-			   grig_cmd_avail_t  *has_get,
-			   grig_cmd_avail_t  *has_set)
+			   grig_cmd_avail_t  *has_get)
 
 {
 	int               retcode;                 /* Hamlib status code */
-	setting_t         hasfunc;                 /* available func settings */
 	int               val;                     /* generic value */
 	int               i;                       /* setting index */
 	setting_t         func;                    /* setting iterated */
 
 
-	/* get available read funcs
-	 */
-	hasfunc = rig_has_get_func (myrig, GRIG_FUNC_RD);
-
-	/* unmask bits */
-	has_get->lock    = ((hasfunc & RIG_FUNC_LOCK) ? 1 : 0);
-
-	for (i=0; i < RIG_SETTING_MAX; i++) {
-		func = rig_idx2setting(i);
-		has_get->funcs[i]  = rig_has_get_func(myrig, func) ? 1 : 0;
-	}
-
-	/* read values */
 	if (has_get->lock) {
 		retcode = rig_get_func (myrig, RIG_VFO_CURR, RIG_FUNC_LOCK, &val);
 		if (retcode == RIG_OK) {
-			get->lock = val;
+			CHECK_STORE (lock, val);
 		}
 		else {
 			/* send an error report */
@@ -961,7 +1103,7 @@ rig_daemon_check_func     (RIG               *myrig,
 		if (has_get->funcs[i]) {
 			retcode = rig_get_func (myrig, RIG_VFO_CURR, func, &val);
 			if (retcode == RIG_OK) {
-				get->funcs[i] = val;
+				CHECK_STORE (funcs[i], val);
 			}
 			else {
 				/* send an error report */
@@ -972,18 +1114,4 @@ rig_daemon_check_func     (RIG               *myrig,
 			}
 		}
 	}
-
-	/* get available write funcs */
-	hasfunc = rig_has_set_func (myrig, GRIG_FUNC_WR);
-
-	/* we don't perform explicit testing of set functions
-	   (like we did with the get levels) since we might
-	   not have any good values to send
-	*/
-	has_set->lock  = ((hasfunc & RIG_FUNC_LOCK) ? 1 : 0);
-
-	for (i=0; i < RIG_SETTING_MAX; i++) {
-		func = rig_idx2setting(i);
-		has_set->funcs[i]  = rig_has_set_func(myrig, func) ? 1 : 0;
-	}
 }
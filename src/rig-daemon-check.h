@@ -44,4 +44,12 @@ void rig_daemon_check_mode    (RIG *, grig_settings_t *, grig_cmd_avail_t *, gri
 void rig_daemon_check_level   (RIG *, grig_settings_t *, grig_cmd_avail_t *, grig_cmd_avail_t *);
 void rig_daemon_check_func    (RIG *, grig_settings_t *, grig_cmd_avail_t *, grig_cmd_avail_t *);
 
+void rig_daemon_read_vfo      (RIG *, grig_settings_t *, grig_cmd_avail_t *);
+void rig_daemon_read_freq     (RIG *, grig_settings_t *, grig_cmd_avail_t *);
+void rig_daemon_read_rit      (RIG *, grig_settings_t *, grig_cmd_avail_t *);
+void rig_daemon_read_xit      (RIG *, grig_settings_t *, grig_cmd_avail_t *);
+void rig_daemon_read_mode     (RIG *, grig_settings_t *, grig_cmd_avail_t *);
+void rig_daemon_read_level    (RIG *, grig_settings_t *, grig_cmd_avail_t *);
+void rig_daemon_read_func     (RIG *, grig_settings_t *, grig_cmd_avail_t *);
+
 #endif
@@ -0,0 +1,803 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+/** \file rig-daemon-poll.c
+ *  \ingroup rigd
+ *  \brief Adaptive polling scheduler.
+ *
+ * This file implements the scheduler which decides which 'get' command the
+ * daemon should execute next. Each command has a polling period for RX and
+ * TX mode and a priority. When several commands are due at the same time
+ * the one with the highest priority is executed first.
+ *
+ * When consecutive reads return the same value, the period of the command
+ * is doubled until it reaches the upper limit. As soon as a change is seen
+ * or the user touches the corresponding control, the command goes back to
+ * its base period.
+ *
+ * The default rates can be overridden for each rig model by creating a
+ * file $HOME/.grig/poll/<model>.conf with one group per command, eg.
+ *
+ * \code
+ * [GET_CW_PITCH]
+ * RxPeriod=2000
+ * MaxPeriod=30000
+ * Priority=1
+ * \endcode
+ *
+ * The group names are the command names without the RIG_CMD_ prefix.
+ * Missing groups and keys keep their default values.
+ *
+ * Some commands, like RIG_CMD_GET_FUNC, read one of several values each
+ * time they are executed. For these the configured periods apply to a
+ * complete sweep over all values and each execution is scheduled at a
+ * fraction of the period, see rig_daemon_poll_set_parts().
+ *
+ * Each rig has its own scheduler state; all functions refer to the
+ * current rig, see rig_data_current().
+ */
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <hamlib/rig.h>
+#include "compat.h"
+#include "grig-debug.h"
+#include "rig-data.h"
+#include "rig-daemon.h"
+#include "rig-daemon-poll.h"
+
+
+#define KEY_RX_PERIOD    "RxPeriod"
+#define KEY_TX_PERIOD    "TxPeriod"
+#define KEY_MAX_PERIOD   "MaxPeriod"
+#define KEY_PRIORITY     "Priority"
+
+#define C_POLL_MAX_BACKOFF  16   /*!< Max number of times the period can be doubled. */
+#define C_POLL_BOOST_PRIO   5    /*!< Priority added to boosted commands. */
+
+
+/** \brief Default polling rates.
+ *
+ * The defaults correspond to the number of times each command appeared in
+ * the old RX and TX cycle tables using the default command delay.
+ * Commands which are not listed are not polled.
+ */
+static const rig_daemon_poll_rate_t DEF_POLL_RATES[RIG_CMD_NUMBER] = {
+	/*                         RX    TX     MAX  PRIO */
+	[RIG_CMD_GET_STRENGTH] = {  110,    0,   110,  9 },
+	[RIG_CMD_GET_FREQ_1]   = {  110, 1400,   500,  9 },
+	[RIG_CMD_GET_PTT]      = {  500,  320,   500, 10 },
+	[RIG_CMD_GET_POWER]    = {    0,  320,   320,  8 },
+	[RIG_CMD_GET_SWR]      = {    0,  320,   320,  8 },
+	[RIG_CMD_GET_ALC]      = {    0,  360,   360,  8 },
+	[RIG_CMD_GET_AF]       = {  250,    0,  2000,  5 },
+	[RIG_CMD_GET_VFO]      = {  500,    0,  2000,  6 },
+	[RIG_CMD_GET_MODE]     = { 1000,    0,  4000,  6 },
+	[RIG_CMD_GET_PSTAT]    = { 1000,    0,  4000,  5 },
+	[RIG_CMD_GET_SPLIT]    = { 1000,    0,  4000,  4 },
+	[RIG_CMD_GET_LOCK]     = { 1000,    0,  4000,  4 },
+	[RIG_CMD_GET_RIT]      = { 1000,    0,  8000,  4 },
+	[RIG_CMD_GET_RF]       = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_SQL]      = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_AGC]      = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_ATT]      = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_PREAMP]   = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_IFS]      = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_PBT_IN]   = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_PBT_OUT]  = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_FUNC]     = { 1000,    0,  8000,  3 },
+	[RIG_CMD_GET_MICGAIN]  = { 1000, 1400,  8000,  2 },
+	[RIG_CMD_GET_COMP]     = { 1000, 2900,  8000,  2 },
+	[RIG_CMD_GET_APF]      = { 1000,    0,  8000,  2 },
+	[RIG_CMD_GET_NR]       = { 1000,    0,  8000,  2 },
+	[RIG_CMD_GET_NOTCH]    = { 1000,    0,  8000,  2 },
+	[RIG_CMD_GET_KEYSPD]   = { 1000,    0, 16000,  1 },
+	[RIG_CMD_GET_BKINDEL]  = { 1000,    0, 16000,  1 },
+	[RIG_CMD_GET_CW_PITCH] = { 1000,    0, 16000,  1 },
+	[RIG_CMD_GET_BALANCE]  = { 1000,    0, 16000,  1 },
+	[RIG_CMD_GET_VOXDEL]   = { 1000,    0, 16000,  1 },
+	[RIG_CMD_GET_VOXGAIN]  = { 1000,    0, 16000,  1 },
+	[RIG_CMD_GET_ANTIVOX]  = { 1000,    0, 16000,  1 }
+};
+
+
+/** \brief Location of the value read by a command. */
+typedef struct {
+	glong    offset;   /*!< Offset of the value in grig_settings_t. */
+	gsize    size;     /*!< Size of the value. */
+	guint64  dirty;    /*!< Fields to notify when the value changes. */
+} poll_value_t;
+
+#define POLL_VALUE(field,id) { G_STRUCT_OFFSET (grig_settings_t, field),	\
+			       sizeof (((grig_settings_t *) 0)->field),	\
+			       RIG_DATA_DIRTY (RIG_DATA_FIELD_##id) }
+
+
+/* RIG_CMD_GET_MODE hashes mode and passband width as one range */
+G_STATIC_ASSERT (G_STRUCT_OFFSET (grig_settings_t, pbw) ==
+		 G_STRUCT_OFFSET (grig_settings_t, mode) + sizeof (rmode_t));
+G_STATIC_ASSERT (sizeof (((grig_settings_t *) 0)->mode) == sizeof (rmode_t));
+G_STATIC_ASSERT (sizeof (((grig_settings_t *) 0)->pbw) == sizeof (rig_data_pbw_t));
+
+
+/** \brief Values read by each 'get' command.
+ *
+ * Used to detect whether a read returned a new value. Mode and passband
+ * width are adjacent in grig_settings_t, without padding in between, and
+ * are read by the same command, which also updates the frequency limits.
+ */
+static const poll_value_t POLL_VALUES[RIG_CMD_NUMBER] = {
+	[RIG_CMD_GET_FREQ_1]   = POLL_VALUE (freq1, FREQ1),
+	[RIG_CMD_GET_FREQ_2]   = POLL_VALUE (freq2, FREQ2),
+	[RIG_CMD_GET_RIT]      = POLL_VALUE (rit, RIT),
+	[RIG_CMD_GET_XIT]      = POLL_VALUE (xit, XIT),
+	[RIG_CMD_GET_VFO]      = POLL_VALUE (vfo, VFO),
+	[RIG_CMD_GET_PSTAT]    = POLL_VALUE (pstat, PSTAT),
+	[RIG_CMD_GET_PTT]      = POLL_VALUE (ptt, PTT),
+	[RIG_CMD_GET_MODE]     = { G_STRUCT_OFFSET (grig_settings_t, mode),
+				   sizeof (rmode_t) + sizeof (rig_data_pbw_t),
+				   RIG_DATA_DIRTY (RIG_DATA_FIELD_MODE) |
+				   RIG_DATA_DIRTY (RIG_DATA_FIELD_PBW) |
+				   RIG_DATA_DIRTY (RIG_DATA_FIELD_FLIMITS) },
+	[RIG_CMD_GET_AGC]      = POLL_VALUE (agc, AGC),
+	[RIG_CMD_GET_ATT]      = POLL_VALUE (att, ATT),
+	[RIG_CMD_GET_PREAMP]   = POLL_VALUE (preamp, PREAMP),
+	[RIG_CMD_GET_SPLIT]    = POLL_VALUE (split, SPLIT),
+	[RIG_CMD_GET_AF]       = POLL_VALUE (afg, AFG),
+	[RIG_CMD_GET_RF]       = POLL_VALUE (rfg, RFG),
+	[RIG_CMD_GET_SQL]      = POLL_VALUE (sql, SQL),
+	[RIG_CMD_GET_IFS]      = POLL_VALUE (ifs, IFS),
+	[RIG_CMD_GET_APF]      = POLL_VALUE (apf, APF),
+	[RIG_CMD_GET_NR]       = POLL_VALUE (nr, NR),
+	[RIG_CMD_GET_NOTCH]    = POLL_VALUE (notch, NOTCH),
+	[RIG_CMD_GET_PBT_IN]   = POLL_VALUE (pbtin, PBTIN),
+	[RIG_CMD_GET_PBT_OUT]  = POLL_VALUE (pbtout, PBTOUT),
+	[RIG_CMD_GET_CW_PITCH] = POLL_VALUE (cwpitch, CWPITCH),
+	[RIG_CMD_GET_KEYSPD]   = POLL_VALUE (keyspd, KEYSPD),
+	[RIG_CMD_GET_BKINDEL]  = POLL_VALUE (bkindel, BKINDEL),
+	[RIG_CMD_GET_BALANCE]  = POLL_VALUE (balance, BALANCE),
+	[RIG_CMD_GET_VOXDEL]   = POLL_VALUE (voxdel, VOXDEL),
+	[RIG_CMD_GET_VOXGAIN]  = POLL_VALUE (voxg, VOXG),
+	[RIG_CMD_GET_ANTIVOX]  = POLL_VALUE (antivox, ANTIVOX),
+	[RIG_CMD_GET_MICGAIN]  = POLL_VALUE (micg, MICG),
+	[RIG_CMD_GET_COMP]     = POLL_VALUE (comp, COMP),
+	[RIG_CMD_GET_STRENGTH] = POLL_VALUE (strength, STRENGTH),
+	[RIG_CMD_GET_POWER]    = POLL_VALUE (power, POWER),
+	[RIG_CMD_GET_SWR]      = POLL_VALUE (swr, SWR),
+	[RIG_CMD_GET_ALC]      = POLL_VALUE (alc, ALC),
+	[RIG_CMD_GET_LOCK]     = POLL_VALUE (lock, LOCK),
+	[RIG_CMD_GET_FUNC]     = POLL_VALUE (funcs, FUNCS)
+};
+
+
+/** \brief The 'get' command reading back the value of a 'set' command. */
+static const rig_cmd_t SET_TO_GET[RIG_CMD_NUMBER] = {
+	[RIG_CMD_SET_FREQ_1]   = RIG_CMD_GET_FREQ_1,
+	[RIG_CMD_SET_FREQ_2]   = RIG_CMD_GET_FREQ_2,
+	[RIG_CMD_SET_RIT]      = RIG_CMD_GET_RIT,
+	[RIG_CMD_SET_XIT]      = RIG_CMD_GET_XIT,
+	[RIG_CMD_SET_VFO]      = RIG_CMD_GET_VFO,
+	[RIG_CMD_SET_PSTAT]    = RIG_CMD_GET_PSTAT,
+	[RIG_CMD_SET_PTT]      = RIG_CMD_GET_PTT,
+	[RIG_CMD_SET_MODE]     = RIG_CMD_GET_MODE,
+	[RIG_CMD_SET_AGC]      = RIG_CMD_GET_AGC,
+	[RIG_CMD_SET_ATT]      = RIG_CMD_GET_ATT,
+	[RIG_CMD_SET_PREAMP]   = RIG_CMD_GET_PREAMP,
+	[RIG_CMD_SET_SPLIT]    = RIG_CMD_GET_SPLIT,
+	[RIG_CMD_SET_AF]       = RIG_CMD_GET_AF,
+	[RIG_CMD_SET_RF]       = RIG_CMD_GET_RF,
+	[RIG_CMD_SET_SQL]      = RIG_CMD_GET_SQL,
+	[RIG_CMD_SET_IFS]      = RIG_CMD_GET_IFS,
+	[RIG_CMD_SET_APF]      = RIG_CMD_GET_APF,
+	[RIG_CMD_SET_NR]       = RIG_CMD_GET_NR,
+	[RIG_CMD_SET_NOTCH]    = RIG_CMD_GET_NOTCH,
+	[RIG_CMD_SET_PBT_IN]   = RIG_CMD_GET_PBT_IN,
+	[RIG_CMD_SET_PBT_OUT]  = RIG_CMD_GET_PBT_OUT,
+	[RIG_CMD_SET_CW_PITCH] = RIG_CMD_GET_CW_PITCH,
+	[RIG_CMD_SET_KEYSPD]   = RIG_CMD_GET_KEYSPD,
+	[RIG_CMD_SET_BKINDEL]  = RIG_CMD_GET_BKINDEL,
+	[RIG_CMD_SET_BALANCE]  = RIG_CMD_GET_BALANCE,
+	[RIG_CMD_SET_VOXDEL]   = RIG_CMD_GET_VOXDEL,
+	[RIG_CMD_SET_VOXGAIN]  = RIG_CMD_GET_VOXGAIN,
+	[RIG_CMD_SET_ANTIVOX]  = RIG_CMD_GET_ANTIVOX,
+	[RIG_CMD_SET_MICGAIN]  = RIG_CMD_GET_MICGAIN,
+	[RIG_CMD_SET_COMP]     = RIG_CMD_GET_COMP,
+	[RIG_CMD_SET_POWER]    = RIG_CMD_GET_POWER,
+	[RIG_CMD_SET_ALC]      = RIG_CMD_GET_ALC,
+	[RIG_CMD_SET_LOCK]     = RIG_CMD_GET_LOCK,
+	[RIG_CMD_VFO_TOGGLE]   = RIG_CMD_GET_FREQ_1,
+	[RIG_CMD_VFO_COPY]     = RIG_CMD_GET_FREQ_1,
+	[RIG_CMD_VFO_XCHG]     = RIG_CMD_GET_FREQ_1,
+	[RIG_CMD_SET_FUNC]     = RIG_CMD_GET_FUNC
+};
+
+
+/** \brief Run-time polling state of a command. */
+typedef struct {
+	rig_daemon_poll_rate_t rate;   /*!< Polling parameters. */
+	gboolean  enabled;             /*!< Whether the command is polled at all. */
+	guint     backoff;             /*!< Number of times the period has been doubled. */
+	gint64    due;                 /*!< Time when the command is due [usec]. */
+	guint     parts;               /*!< Number of executions per sweep. */
+	gboolean  boost;               /*!< Polled at base rate and higher priority. */
+	guint32   hash;                /*!< Hash of the latest value. */
+	gboolean  valid;               /*!< Whether hash is valid. */
+} poll_state_t;
+
+
+static poll_state_t pollstate[C_MAX_RIGS][RIG_CMD_NUMBER];  /*!< Polling state of each command per rig. */
+static GMutex       pollmutex;                  /*!< Protects pollstate. */
+
+
+static void    rig_daemon_poll_load   (gint);
+static guint   rig_daemon_poll_period (poll_state_t *, gboolean);
+static guint32 rig_daemon_poll_hash   (const guint8 *, gsize);
+
+
+
+/** \brief Initialise the polling scheduler.
+ *  \param rigid The hamlib ID of the rig model.
+ *
+ * This function resets the scheduler and loads the default polling rates
+ * followed by the rates configured for the rig model, if any. All commands
+ * are disabled; the daemon enables the ones supported by the rig using
+ * rig_daemon_poll_enable().
+ */
+void
+rig_daemon_poll_init     (gint rigid)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	gint64 now;
+	guint  i;
+
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (&pollmutex);
+
+	for (i = 0; i < RIG_CMD_NUMBER; i++) {
+		ps[i].rate = DEF_POLL_RATES[i];
+		ps[i].enabled = FALSE;
+		ps[i].backoff = 0;
+		ps[i].due = now;
+		ps[i].parts = 1;
+		ps[i].boost = FALSE;
+		ps[i].valid = FALSE;
+	}
+
+	rig_daemon_poll_load (rigid);
+
+	g_mutex_unlock (&pollmutex);
+}
+
+
+/** \brief Enable or disable polling of a command.
+ *  \param cmd The command.
+ *  \param enable Whether the command should be polled.
+ *
+ * Commands which have neither RX nor TX period can not be enabled.
+ */
+void
+rig_daemon_poll_enable   (rig_cmd_t cmd, gboolean enable)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return;
+	}
+
+	g_mutex_lock (&pollmutex);
+
+	ps[cmd].enabled = enable &&
+		(ps[cmd].rate.rxperiod || ps[cmd].rate.txperiod);
+
+	g_mutex_unlock (&pollmutex);
+}
+
+
+/** \brief Set the number of executions per sweep.
+ *  \param cmd The command.
+ *  \param parts The number of values read by cmd, one per execution.
+ *
+ * The polling periods of cmd are divided by parts so that every value is
+ * read once per configured period while each execution stays short.
+ */
+void
+rig_daemon_poll_set_parts (rig_cmd_t cmd, guint parts)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return;
+	}
+
+	g_mutex_lock (&pollmutex);
+	ps[cmd].parts = MAX (1, parts);
+	g_mutex_unlock (&pollmutex);
+}
+
+
+/** \brief Boost polling of a command.
+ *  \param cmd The command.
+ *  \param boost TRUE to boost the command, FALSE to go back to normal.
+ *
+ * A boosted command is polled at its base period without backing off and
+ * wins over other due commands of up to C_POLL_BOOST_PRIO lower priority.
+ * This is used while a window showing the value is open.
+ */
+void
+rig_daemon_poll_boost    (rig_cmd_t cmd, gboolean boost)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return;
+	}
+
+	g_mutex_lock (&pollmutex);
+
+	ps[cmd].boost = boost;
+
+	/* refresh right away */
+	if (boost) {
+		ps[cmd].backoff = 0;
+		ps[cmd].due = g_get_monotonic_time ();
+	}
+
+	g_mutex_unlock (&pollmutex);
+}
+
+
+/** \brief Get the next command to poll.
+ *  \param tx TRUE if the rig is in TX mode.
+ *  \param now The current monotonic time [usec].
+ *  \return The command to execute or RIG_CMD_NONE if nothing is due.
+ *
+ * Of all the commands which are due, the one with the highest priority is
+ * returned. Commands with equal priority are returned in the order they
+ * became due.
+ */
+rig_cmd_t
+rig_daemon_poll_next     (gboolean tx, gint64 now)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	rig_cmd_t     cmd = RIG_CMD_NONE;
+	gint          prio = 0;
+	gint          pprio;
+	poll_state_t *p;
+	guint         i;
+
+
+	g_mutex_lock (&pollmutex);
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		p = &ps[i];
+
+		if (!p->enabled || (p->due > now))
+			continue;
+
+		if ((tx ? p->rate.txperiod : p->rate.rxperiod) == 0)
+			continue;
+
+		pprio = p->rate.priority + (p->boost ? C_POLL_BOOST_PRIO : 0);
+
+		if ((cmd == RIG_CMD_NONE) || (pprio > prio) ||
+		    ((pprio == prio) && (p->due < ps[cmd].due))) {
+			cmd = i;
+			prio = pprio;
+		}
+	}
+
+	g_mutex_unlock (&pollmutex);
+
+	return cmd;
+}
+
+
+/** \brief Get the time when the next command becomes due.
+ *  \param tx TRUE if the rig is in TX mode.
+ *  \return The monotonic time [usec] or G_MAXINT64 if nothing is polled.
+ */
+gint64
+rig_daemon_poll_next_due (gboolean tx)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	gint64        due = G_MAXINT64;
+	poll_state_t *p;
+	guint         i;
+
+
+	g_mutex_lock (&pollmutex);
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		p = &ps[i];
+
+		if (p->enabled && (tx ? p->rate.txperiod : p->rate.rxperiod) &&
+		    (p->due < due)) {
+			due = p->due;
+		}
+	}
+
+	g_mutex_unlock (&pollmutex);
+
+	return due;
+}
+
+
+/** \brief Reschedule a command after it has been polled.
+ *  \param cmd The command.
+ *  \param exec Whether the command has actually been executed.
+ *  \param tx TRUE if the rig is in TX mode.
+ *  \param get Pointer to shared data 'get' holding the new value.
+ *
+ *  \return The fields that have changed, see RIG_DATA_DIRTY().
+ *
+ * If the value read by the command is the same as last time the polling
+ * period is doubled, up to the configured limit. If the value has changed
+ * the command goes back to its base period. The first value read by a
+ * command always counts as a change.
+ */
+guint64
+rig_daemon_poll_done     (rig_cmd_t cmd, gboolean exec, gboolean tx,
+			  grig_settings_t *get)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	poll_state_t *p;
+	guint32       hash;
+	guint         period;
+	guint64       changed = 0;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return 0;
+	}
+
+	g_mutex_lock (&pollmutex);
+
+	p = &ps[cmd];
+
+	if (exec && POLL_VALUES[cmd].size) {
+
+		hash = rig_daemon_poll_hash (G_STRUCT_MEMBER_P (get, POLL_VALUES[cmd].offset),
+					     POLL_VALUES[cmd].size);
+
+		if (p->valid && (hash == p->hash)) {
+			if (p->backoff < C_POLL_MAX_BACKOFF)
+				p->backoff++;
+		}
+		else {
+			if (p->backoff) {
+				grig_debug_local (RIG_DEBUG_TRACE,
+						  _("%s: %s changed; back to base rate"),
+						  __FUNCTION__, rig_daemon_cmd_to_str (cmd));
+			}
+			p->backoff = 0;
+			changed = POLL_VALUES[cmd].dirty;
+		}
+
+		p->hash = hash;
+		p->valid = TRUE;
+	}
+
+	period = rig_daemon_poll_period (p, tx);
+	p->due = g_get_monotonic_time () + 1000 * (gint64) period;
+
+	g_mutex_unlock (&pollmutex);
+
+	return changed;
+}
+
+
+/** \brief Get the fields affected by a command.
+ *  \param cmd The command.
+ *  \return The fields updated by cmd, see RIG_DATA_DIRTY().
+ *
+ * For 'set' commands this returns the fields of the corresponding 'get'
+ * command, since the daemon copies the commanded value to 'get' once it
+ * has been accepted by the rig.
+ */
+guint64
+rig_daemon_poll_fields   (rig_cmd_t cmd)
+{
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return 0;
+	}
+
+	if (SET_TO_GET[cmd] != RIG_CMD_NONE) {
+		cmd = SET_TO_GET[cmd];
+	}
+
+	return POLL_VALUES[cmd].dirty;
+}
+
+
+/** \brief Get the raw value of a command.
+ *  \param cmd The command.
+ *  \param data The settings holding the value, 'set' or 'get'.
+ *  \param value Where to store the first 8 bytes of the value.
+ *  \return TRUE if the command carries a value.
+ *
+ * Used by the command recorder. 'set' commands are mapped to the field of
+ * the corresponding 'get' command. Unused bytes of the value are zero.
+ */
+gboolean
+rig_daemon_poll_value    (rig_cmd_t cmd, const grig_settings_t *data, guint64 *value)
+{
+	*value = 0;
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return FALSE;
+	}
+
+	if (SET_TO_GET[cmd] != RIG_CMD_NONE) {
+		cmd = SET_TO_GET[cmd];
+	}
+
+	if (POLL_VALUES[cmd].size == 0) {
+		return FALSE;
+	}
+
+	memcpy (value, G_STRUCT_MEMBER_P (data, POLL_VALUES[cmd].offset),
+		MIN (POLL_VALUES[cmd].size, sizeof (*value)));
+
+	return TRUE;
+}
+
+
+/** \brief Notify the scheduler that the user has changed a setting.
+ *  \param cmd The 'set' command which has been posted.
+ *
+ * The 'get' command reading back the same value goes back to its base
+ * period, so that changes made by the user on the rig itself are picked
+ * up quickly while the control is being used.
+ */
+void
+rig_daemon_poll_touch    (rig_cmd_t cmd)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	poll_state_t *p;
+	gint64        due;
+	guint         period;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER) ||
+	    (SET_TO_GET[cmd] == RIG_CMD_NONE)) {
+		return;
+	}
+
+	g_mutex_lock (&pollmutex);
+
+	p = &ps[SET_TO_GET[cmd]];
+	p->backoff = 0;
+
+	period = (p->rate.rxperiod ? p->rate.rxperiod : p->rate.txperiod) / p->parts;
+	due = g_get_monotonic_time () + 1000 * (gint64) period;
+
+	if (due < p->due) {
+		p->due = due;
+	}
+
+	g_mutex_unlock (&pollmutex);
+}
+
+
+/** \brief Get the polling parameters of a command.
+ *  \param cmd The command.
+ *  \param rate Pointer to a structure where the parameters will be stored.
+ *  \return TRUE if the command is polled, FALSE otherwise.
+ */
+gboolean
+rig_daemon_poll_get_rate (rig_cmd_t cmd, rig_daemon_poll_rate_t *rate)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	gboolean enabled;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER) || (rate == NULL)) {
+		return FALSE;
+	}
+
+	g_mutex_lock (&pollmutex);
+	*rate = ps[cmd].rate;
+	enabled = ps[cmd].enabled;
+	g_mutex_unlock (&pollmutex);
+
+	return enabled;
+}
+
+
+/** \brief Get the nominal polling load.
+ *  \param tx TRUE to get the load in TX mode.
+ *  \return The number of commands per second at the base rates.
+ */
+gdouble
+rig_daemon_poll_get_load (gboolean tx)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	gdouble load = 0.0;
+	guint   period;
+	guint   i;
+
+
+	g_mutex_lock (&pollmutex);
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		period = tx ? ps[i].rate.txperiod : ps[i].rate.rxperiod;
+
+		if (ps[i].enabled && period) {
+			load += 1000.0 * ps[i].parts / period;
+		}
+	}
+
+	g_mutex_unlock (&pollmutex);
+
+	return load;
+}
+
+
+/** \brief Load polling rates for a rig model.
+ *  \param rigid The hamlib ID of the rig model.
+ *
+ * \note Must be called with pollmutex held.
+ */
+static void
+rig_daemon_poll_load     (gint rigid)
+{
+	poll_state_t *ps = pollstate[rig_data_current ()];
+	GKeyFile    *cfg;
+	GError      *error = NULL;
+	gchar       *dir;
+	gchar       *fname;
+	const gchar *group;
+	guint        i;
+
+
+	dir = get_conf_dir ("poll");
+	fname = g_strdup_printf ("%s%s%d.conf", dir, G_DIR_SEPARATOR_S, rigid);
+	g_free (dir);
+
+	if (!g_file_test (fname, G_FILE_TEST_EXISTS)) {
+		g_free (fname);
+		return;
+	}
+
+	cfg = g_key_file_new ();
+
+	if (!g_key_file_load_from_file (cfg, fname, G_KEY_FILE_NONE, &error)) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s: Could not load %s: %s"),
+				  __FUNCTION__, fname, error->message);
+		g_clear_error (&error);
+		g_key_file_free (cfg);
+		g_free (fname);
+		return;
+	}
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		/* skip the RIG_CMD_ prefix */
+		group = rig_daemon_cmd_to_str (i) + 8;
+
+		if (!g_key_file_has_group (cfg, group))
+			continue;
+
+		if (POLL_VALUES[i].size == 0) {
+			grig_debug_local (RIG_DEBUG_WARN,
+					  _("%s: %s can not be polled"),
+					  __FUNCTION__, group);
+			continue;
+		}
+
+		if (g_key_file_has_key (cfg, group, KEY_RX_PERIOD, NULL))
+			ps[i].rate.rxperiod = MAX (0, g_key_file_get_integer (cfg, group, KEY_RX_PERIOD, NULL));
+
+		if (g_key_file_has_key (cfg, group, KEY_TX_PERIOD, NULL))
+			ps[i].rate.txperiod = MAX (0, g_key_file_get_integer (cfg, group, KEY_TX_PERIOD, NULL));
+
+		if (g_key_file_has_key (cfg, group, KEY_MAX_PERIOD, NULL))
+			ps[i].rate.maxperiod = MAX (0, g_key_file_get_integer (cfg, group, KEY_MAX_PERIOD, NULL));
+
+		if (g_key_file_has_key (cfg, group, KEY_PRIORITY, NULL))
+			ps[i].rate.priority = g_key_file_get_integer (cfg, group, KEY_PRIORITY, NULL);
+	}
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Loaded polling rates from %s"),
+			  __FUNCTION__, fname);
+
+	g_key_file_free (cfg);
+	g_free (fname);
+}
+
+
+/** \brief Get the current polling period of a command.
+ *  \param p The polling state of the command.
+ *  \param tx TRUE if the rig is in TX mode.
+ *  \return The period in milliseconds including backoff.
+ *
+ * The period is that of a single execution, ie. the configured period
+ * divided by the number of parts.
+ */
+static guint
+rig_daemon_poll_period   (poll_state_t *p, gboolean tx)
+{
+	guint base;
+	guint maxperiod;
+	guint period;
+	guint i;
+
+
+	base = tx ? p->rate.txperiod : p->rate.rxperiod;
+
+	/* command not polled in this mode; check again after the other period */
+	if (base == 0) {
+		return MAX (p->rate.rxperiod, p->rate.txperiod) / p->parts;
+	}
+
+	base = MAX (1, base / p->parts);
+	maxperiod = p->rate.maxperiod / p->parts;
+
+	if (p->boost) {
+		return base;
+	}
+
+	period = base;
+
+	for (i = 0; (i < p->backoff) && (period < maxperiod); i++) {
+		period *= 2;
+	}
+
+	return MAX (base, MIN (period, maxperiod));
+}
+
+
+/** \brief Hash a value (FNV-1a). */
+static guint32
+rig_daemon_poll_hash     (const guint8 *data, gsize size)
+{
+	guint32 hash = 2166136261U;
+	gsize   i;
+
+
+	for (i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
@@ -0,0 +1,65 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+#ifndef RIG_DAEMON_POLL_H
+#define RIG_DAEMON_POLL_H 1
+
+#include "rig-data.h"
+#include "rig-daemon.h"
+
+
+/** \brief Polling parameters of a command.
+ *
+ * All periods are in milliseconds. A period of 0 means that the command
+ * is not polled in that mode.
+ */
+typedef struct {
+	guint    rxperiod;    /*!< Polling period in RX mode. */
+	guint    txperiod;    /*!< Polling period in TX mode. */
+	guint    maxperiod;   /*!< Upper limit for the period when backing off. */
+	gint     priority;    /*!< Priority; higher value wins when several commands are due. */
+} rig_daemon_poll_rate_t;
+
+
+void      rig_daemon_poll_init     (gint);
+void      rig_daemon_poll_enable   (rig_cmd_t, gboolean);
+void      rig_daemon_poll_set_parts (rig_cmd_t, guint);
+void      rig_daemon_poll_boost    (rig_cmd_t, gboolean);
+rig_cmd_t rig_daemon_poll_next     (gboolean, gint64);
+gint64    rig_daemon_poll_next_due (gboolean);
+guint64   rig_daemon_poll_done     (rig_cmd_t, gboolean, gboolean, grig_settings_t *);
+guint64   rig_daemon_poll_fields   (rig_cmd_t);
+gboolean  rig_daemon_poll_value    (rig_cmd_t, const grig_settings_t *, guint64 *);
+void      rig_daemon_poll_touch    (rig_cmd_t);
+gboolean  rig_daemon_poll_get_rate (rig_cmd_t, rig_daemon_poll_rate_t *);
+gdouble   rig_daemon_poll_get_load (gboolean);
+
+#endif
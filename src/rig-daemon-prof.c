@@ -0,0 +1,384 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+/** \file    rig-daemon-prof.c
+ *  \ingroup rigd
+ *  \brief   Daemon profiler.
+ *
+ * This file collects timing statistics of the rig-daemon. The execution
+ * time of every command is recorded in a log-linear histogram from which
+ * the percentiles can be estimated with a relative error of at most
+ * 1/C_PROF_SUB, without having to keep the individual samples. The daemon
+ * also reports the duration of each cycle and the time it sleeps between
+ * commands.
+ *
+ * The rig-daemon records the samples from its own thread while the GUI and
+ * the SIGUSR1 handler read them, so all data is protected by a mutex. There
+ * is one set of statistics per rig; all functions refer to the current rig,
+ * see rig_data_current().
+ */
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <hamlib/rig.h>
+#include "rig-data.h"
+#include "rig-daemon.h"
+#include "rig-daemon-prof.h"
+
+
+/** \brief Profiler state of a rig. */
+typedef struct {
+	rig_daemon_hist_t cmd[RIG_CMD_NUMBER];  /*!< Execution time per command. */
+	rig_daemon_hist_t cycle;                /*!< Cycle time. */
+	gint64    start;      /*!< When the statistics have been reset. */
+	gint64    busy;       /*!< Time spent executing commands. */
+	gint64    idle;       /*!< Time spent sleeping. */
+	guint     commands;   /*!< Number of executed commands. */
+	gint64    winstart;   /*!< Start of the current rate window. */
+	gint64    winbusy;    /*!< Time spent executing commands within the window. */
+	guint     wincount;   /*!< Commands executed within the window. */
+	gdouble   rate;       /*!< Commands per second within the last window. */
+	gdouble   load;       /*!< Bus utilisation within the last window. */
+} prof_state_t;
+
+
+/** \brief The profiler state of each rig. */
+static prof_state_t prof[C_MAX_RIGS];
+
+/** \brief Mutex protecting the profiler data. */
+static GMutex profmutex;
+
+
+static guint  rig_daemon_prof_bucket (gint64);
+static gint64 rig_daemon_prof_value  (guint);
+static void   rig_daemon_prof_line   (GString *, const gchar *, const rig_daemon_hist_t *);
+
+
+
+/** \brief Reset the profiler.
+ *
+ * This function clears all statistics. It is called by the rig-daemon
+ * when a new rig has been opened.
+ */
+void
+rig_daemon_prof_init ()
+{
+	prof_state_t *p = &prof[rig_data_current ()];
+
+
+	g_mutex_lock (&profmutex);
+
+	memset (p, 0, sizeof (prof_state_t));
+	p->start = g_get_monotonic_time ();
+	p->winstart = p->start;
+
+	g_mutex_unlock (&profmutex);
+}
+
+
+/** \brief Record the execution of a command.
+ *  \param cmd The command.
+ *  \param usec The execution time [usec].
+ *  \param error TRUE if the command has failed.
+ */
+void
+rig_daemon_prof_cmd (rig_cmd_t cmd, gint64 usec, gboolean error)
+{
+	prof_state_t *p = &prof[rig_data_current ()];
+	gint64        now;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return;
+	}
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (&profmutex);
+
+	rig_daemon_prof_add (&p->cmd[cmd], usec, error);
+	p->busy += usec;
+	p->commands++;
+
+	p->winbusy += usec;
+	p->wincount++;
+
+	if (now - p->winstart >= 1000 * C_PROF_WINDOW) {
+		p->rate = 1.0e6 * p->wincount / (now - p->winstart);
+		p->load = (gdouble) p->winbusy / (now - p->winstart);
+		p->winstart = now;
+		p->winbusy = 0;
+		p->wincount = 0;
+	}
+
+	g_mutex_unlock (&profmutex);
+}
+
+
+/** \brief Record the duration of a daemon cycle.
+ *  \param usec The cycle time [usec].
+ */
+void
+rig_daemon_prof_cycle (gint64 usec)
+{
+	prof_state_t *p = &prof[rig_data_current ()];
+
+
+	g_mutex_lock (&profmutex);
+	rig_daemon_prof_add (&p->cycle, usec, FALSE);
+	g_mutex_unlock (&profmutex);
+}
+
+
+/** \brief Record time spent sleeping between commands.
+ *  \param usec The sleep time [usec].
+ */
+void
+rig_daemon_prof_idle (gint64 usec)
+{
+	prof_state_t *p = &prof[rig_data_current ()];
+
+
+	g_mutex_lock (&profmutex);
+	p->idle += usec;
+	g_mutex_unlock (&profmutex);
+}
+
+
+/** \brief Get the execution time histogram of a command.
+ *  \param cmd The command.
+ *  \param hist Pointer to a structure where the histogram will be stored.
+ *  \return TRUE if the histogram has been copied, FALSE if cmd is invalid.
+ */
+gboolean
+rig_daemon_prof_get_cmd (rig_cmd_t cmd, rig_daemon_hist_t *hist)
+{
+	prof_state_t *p = &prof[rig_data_current ()];
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER) || (hist == NULL)) {
+		return FALSE;
+	}
+
+	g_mutex_lock (&profmutex);
+	*hist = p->cmd[cmd];
+	g_mutex_unlock (&profmutex);
+
+	return TRUE;
+}
+
+
+/** \brief Get the overall daemon statistics.
+ *  \param totals Pointer to a structure where the statistics will be stored.
+ */
+void
+rig_daemon_prof_get_totals (rig_daemon_prof_totals_t *totals)
+{
+	prof_state_t *p = &prof[rig_data_current ()];
+
+
+	g_mutex_lock (&profmutex);
+
+	totals->elapsed  = (p->start != 0) ? g_get_monotonic_time () - p->start : 0;
+	totals->busy     = p->busy;
+	totals->idle     = p->idle;
+	totals->commands = p->commands;
+	totals->rate     = p->rate;
+	totals->load     = p->load;
+	totals->cycle    = p->cycle;
+
+	g_mutex_unlock (&profmutex);
+}
+
+
+/** \brief Estimate a percentile.
+ *  \param hist The histogram.
+ *  \param pct The percentile (0..1).
+ *  \return The estimated value [usec] or 0 if the histogram is empty.
+ *
+ * The value returned is the centre of the bucket containing the
+ * percentile, limited to the largest sample.
+ */
+gint64
+rig_daemon_prof_percentile (const rig_daemon_hist_t *hist, gdouble pct)
+{
+	guint64 rank;
+	guint64 sum = 0;
+	guint   i;
+
+
+	if (hist->count == 0) {
+		return 0;
+	}
+
+	rank = (guint64) (pct * hist->count + 0.5);
+	rank = CLAMP (rank, 1, hist->count);
+
+	for (i = 0; i < C_PROF_BUCKETS; i++) {
+		sum += hist->buckets[i];
+
+		if (sum >= rank) {
+			return MIN (rig_daemon_prof_value (i), hist->max);
+		}
+	}
+
+	return hist->max;
+}
+
+
+/** \brief Add a sample to a histogram.
+ *  \param hist The histogram.
+ *  \param usec The sample [usec].
+ *  \param error TRUE if the sample is a failed execution.
+ *
+ * This function can be used to collect other timings in the same
+ * format; it does not lock.
+ */
+void
+rig_daemon_prof_add (rig_daemon_hist_t *hist, gint64 usec, gboolean error)
+{
+	usec = MAX (usec, 0);
+
+	hist->count++;
+	hist->total += usec;
+	hist->buckets[rig_daemon_prof_bucket (usec)]++;
+
+	if (usec > hist->max)
+		hist->max = usec;
+
+	if (error)
+		hist->errors++;
+}
+
+
+/** \brief Print the statistics as text.
+ *  \param out The string to which the text is appended.
+ *
+ * This function prints the overall statistics followed by one line for
+ * each command that has been executed at least once.
+ */
+void
+rig_daemon_prof_dump (GString *out)
+{
+	rig_daemon_prof_totals_t totals;
+	rig_daemon_hist_t        hist;
+	guint                    i;
+
+
+	rig_daemon_prof_get_totals (&totals);
+
+	g_string_append_printf (out,
+				_("%.1f sec, %u cmds, %.1f cmds/sec, bus %.0f%%, "\
+				  "sleeping %.0f%%\n"),
+				totals.elapsed / 1.0e6, totals.commands, totals.rate,
+				100.0 * totals.load,
+				totals.elapsed ? 100.0 * totals.idle / totals.elapsed : 0.0);
+
+	g_string_append_printf (out, "%-24s %8s %8s %9s %9s %9s %9s\n",
+				_("Command"), _("Count"), _("Errors"),
+				_("p50 ms"), _("p90 ms"), _("p99 ms"), _("max ms"));
+
+	rig_daemon_prof_line (out, _("(cycle)"), &totals.cycle);
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		if (rig_daemon_prof_get_cmd (i, &hist) && hist.count) {
+			rig_daemon_prof_line (out, rig_daemon_cmd_to_str (i), &hist);
+		}
+	}
+}
+
+
+/** \brief Print one histogram.
+ *  \param out The string to which the line is appended.
+ *  \param name The name of the histogram.
+ *  \param hist The histogram.
+ */
+static void
+rig_daemon_prof_line (GString *out, const gchar *name, const rig_daemon_hist_t *hist)
+{
+	g_string_append_printf (out, "%-24s %8u %8u %9.1f %9.1f %9.1f %9.1f\n",
+				name, hist->count, hist->errors,
+				rig_daemon_prof_percentile (hist, 0.50) / 1000.0,
+				rig_daemon_prof_percentile (hist, 0.90) / 1000.0,
+				rig_daemon_prof_percentile (hist, 0.99) / 1000.0,
+				hist->max / 1000.0);
+}
+
+
+
+
+/** \brief Find the histogram bucket of a value.
+ *  \param usec The value [usec], >= 0.
+ *  \return The bucket index.
+ *
+ * The index consists of the position of the most significant bit and
+ * the C_PROF_SUB_BITS bits below it.
+ */
+static guint
+rig_daemon_prof_bucket (gint64 usec)
+{
+	guint msb;
+
+
+	if (usec < C_PROF_SUB) {
+		return (guint) usec;
+	}
+
+	usec = MIN (usec, (G_GINT64_CONSTANT (1) << C_PROF_MAX_BITS) - 1);
+	msb = g_bit_nth_msf ((gulong) usec, -1);
+
+	return (msb - C_PROF_SUB_BITS + 1) * C_PROF_SUB +
+		((usec >> (msb - C_PROF_SUB_BITS)) & (C_PROF_SUB - 1));
+}
+
+
+/** \brief Get the centre of a histogram bucket.
+ *  \param idx The bucket index.
+ *  \return The value in the middle of the bucket [usec].
+ */
+static gint64
+rig_daemon_prof_value (guint idx)
+{
+	guint  shift;
+	gint64 lower;
+
+
+	if (idx < C_PROF_SUB) {
+		return idx;
+	}
+
+	shift = idx / C_PROF_SUB - 1;
+	lower = (gint64) (C_PROF_SUB + idx % C_PROF_SUB) << shift;
+
+	return lower + ((G_GINT64_CONSTANT (1) << shift) >> 1);
+}
@@ -0,0 +1,83 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+#ifndef RIG_DAEMON_PROF_H
+#define RIG_DAEMON_PROF_H 1
+
+#include "rig-daemon.h"
+
+
+#define C_PROF_SUB_BITS   3      /*!< Sub-buckets per power of two = 2^C_PROF_SUB_BITS */
+#define C_PROF_SUB        (1 << C_PROF_SUB_BITS)
+#define C_PROF_MAX_BITS   27     /*!< Largest recorded time is 2^C_PROF_MAX_BITS usec (134 sec) */
+#define C_PROF_BUCKETS    ((C_PROF_MAX_BITS - C_PROF_SUB_BITS + 1) * C_PROF_SUB)
+#define C_PROF_WINDOW     5000   /*!< Length of the rate and utilisation window [msec] */
+
+
+/** \brief Log-linear histogram of execution times.
+ *
+ * Times below C_PROF_SUB usec have a bucket each; above that every power
+ * of two is split into C_PROF_SUB buckets, ie. the relative resolution
+ * is 1/C_PROF_SUB.
+ */
+typedef struct {
+	guint    count;      /*!< Number of samples. */
+	guint    errors;     /*!< Number of samples which failed. */
+	gint64   total;      /*!< Sum of all samples [usec]. */
+	gint64   max;        /*!< Largest sample [usec]. */
+	guint32  buckets[C_PROF_BUCKETS];  /*!< Number of samples per bucket. */
+} rig_daemon_hist_t;
+
+
+/** \brief Overall daemon statistics. */
+typedef struct {
+	gint64   elapsed;    /*!< Time since the statistics have been reset [usec]. */
+	gint64   busy;       /*!< Time spent executing commands [usec]. */
+	gint64   idle;       /*!< Time spent sleeping between commands [usec]. */
+	guint    commands;   /*!< Number of executed commands. */
+	gdouble  rate;       /*!< Commands per second within the last window. */
+	gdouble  load;       /*!< Bus utilisation within the last window (0..1). */
+	rig_daemon_hist_t cycle;  /*!< Cycle time histogram. */
+} rig_daemon_prof_totals_t;
+
+
+void     rig_daemon_prof_init       (void);
+void     rig_daemon_prof_cmd        (rig_cmd_t, gint64, gboolean);
+void     rig_daemon_prof_cycle      (gint64);
+void     rig_daemon_prof_idle       (gint64);
+gboolean rig_daemon_prof_get_cmd    (rig_cmd_t, rig_daemon_hist_t *);
+void     rig_daemon_prof_get_totals (rig_daemon_prof_totals_t *);
+void     rig_daemon_prof_add        (rig_daemon_hist_t *, gint64, gboolean);
+gint64   rig_daemon_prof_percentile (const rig_daemon_hist_t *, gdouble);
+void     rig_daemon_prof_dump       (GString *);
+
+
+#endif
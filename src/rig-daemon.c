@@ -51,346 +51,23 @@
 #include <string.h>
 #include <stdlib.h>
 #include "grig-config.h"
+#include "grig-cmdrec.h"
 #include "grig-debug.h"
+#include "grig-startup.h"
+#include "grig-timeline.h"
 #include "rig-anomaly.h"
 #include "rig-data.h"
 #include "rig-gui-smeter.h"
+#include "rig-daemon-cache.h"
 #include "rig-daemon-check.h"
+#include "rig-daemon-poll.h"
+#include "rig-daemon-prof.h"
 #include "rig-daemon.h"
 
 
 
-RIG *myrig;  /*!< The rig structure. We keep this public so GUI can access the info fields. */
-
 //#define GRIG_DEBUG 1
 
-#ifdef GRIG_DEBUG
-
-
-static const rig_cmd_t DEF_RX_CYCLE[C_MAX_CMD_PER_CYCLE] = {
-	RIG_CMD_VFO_TOGGLE,
-	RIG_CMD_VFO_COPY,
-	RIG_CMD_VFO_XCHG,
-	RIG_CMD_SET_SPLIT,
-	RIG_CMD_GET_SPLIT,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE
-};
-
-#else
-
-/** \brief Matrix defining the default RX cycle.
- *
- * More description of the idea.
- *
- */
-static const rig_cmd_t DEF_RX_CYCLE[C_MAX_CMD_PER_CYCLE] = {
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_PSTAT,
-	RIG_CMD_GET_PSTAT,
-	RIG_CMD_SET_KEYSPD,
-	RIG_CMD_GET_KEYSPD,
-	RIG_CMD_SET_LOCK,
-	RIG_CMD_SET_AF,
-	RIG_CMD_GET_AF,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_BKINDEL,
-	RIG_CMD_GET_BKINDEL,
-	RIG_CMD_SET_ATT,
-	RIG_CMD_GET_ATT,
-	RIG_CMD_SET_RIT,
-	RIG_CMD_GET_RIT,
-	RIG_CMD_SET_RF,
-	RIG_CMD_GET_RF,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_GET_LOCK,
-	RIG_CMD_SET_VFO,
-	RIG_CMD_GET_VFO,
-	RIG_CMD_SET_VOXDEL,
-	RIG_CMD_GET_VOXDEL,
-	RIG_CMD_SET_PTT,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_SET_IFS,
-	RIG_CMD_GET_IFS,
-	RIG_CMD_SET_AF,
-	RIG_CMD_GET_AF,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_VOXGAIN,
-	RIG_CMD_GET_VOXGAIN,
-	RIG_CMD_SET_AGC,
-	RIG_CMD_GET_AGC,
-	RIG_CMD_SET_SQL,
-	RIG_CMD_GET_SQL,
-	RIG_CMD_VFO_TOGGLE,
-	RIG_CMD_VFO_COPY,
-	RIG_CMD_VFO_XCHG,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_ANTIVOX,
-	RIG_CMD_GET_ANTIVOX,
-	RIG_CMD_SET_PBT_IN,
-	RIG_CMD_GET_PBT_IN,
-	RIG_CMD_SET_PBT_OUT,
-	RIG_CMD_GET_PBT_OUT,
-	RIG_CMD_SET_AF,
-	RIG_CMD_GET_AF,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_CW_PITCH,
-	RIG_CMD_GET_CW_PITCH,
-	RIG_CMD_SET_PREAMP,
-	RIG_CMD_GET_PREAMP,
-	RIG_CMD_SET_SPLIT,
-	RIG_CMD_GET_SPLIT,
-	RIG_CMD_SET_MICGAIN,
-	RIG_CMD_GET_MICGAIN,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_MODE,
-	RIG_CMD_GET_MODE,
-	RIG_CMD_SET_BALANCE,
-	RIG_CMD_GET_BALANCE,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_VFO,
-	RIG_CMD_GET_VFO,
-	RIG_CMD_SET_PTT,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_SET_COMP,
-	RIG_CMD_GET_COMP,
-	RIG_CMD_VFO_TOGGLE,
-	RIG_CMD_VFO_COPY,
-	RIG_CMD_VFO_XCHG,
-	RIG_CMD_SET_AF,
-	RIG_CMD_GET_AF,
-	RIG_CMD_GET_STRENGTH,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_SET_APF,
-	RIG_CMD_GET_APF,
-	RIG_CMD_SET_NR,
-	RIG_CMD_GET_NR,
-	RIG_CMD_SET_NOTCH,
-	RIG_CMD_GET_NOTCH,
-	RIG_CMD_SET_FUNC,
-	RIG_CMD_GET_FUNC
-};
-
-#endif
-
-
-/** \brief Matrix defining the default TX cycle.
- *
- * More description.
- *
- * \note Some radios do not like being polled while in TX mode so
- *       we make TX cycle easy...
- *
- */
-static const rig_cmd_t DEF_TX_CYCLE[C_MAX_CMD_PER_CYCLE] = {
-	RIG_CMD_SET_PTT,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_SET_POWER,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_LOCK,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_POWER,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_ALC,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_POWER,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_PTT,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_PTT,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_MICGAIN,
-	RIG_CMD_GET_MICGAIN,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_FREQ_1,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_PTT,
-	RIG_CMD_SET_POWER,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_FREQ_1,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_GET_ALC,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_MICGAIN,
-	RIG_CMD_GET_MICGAIN,
-	RIG_CMD_GET_PTT,
-	RIG_CMD_GET_POWER,
-	RIG_CMD_GET_SWR,
-	RIG_CMD_NONE,
-	RIG_CMD_NONE,
-	RIG_CMD_SET_COMP,
-	RIG_CMD_GET_COMP
-};
-
 
 /** \brief Conversion table to convert rig error to string */
 static const gchar *ERR_TO_STR[] = {
@@ -415,24 +92,280 @@ static const gchar *ERR_TO_STR[] = {
 };
 
 
-static gboolean stopdaemon   = FALSE;   /*!< Used to signal the daemon thread that it should stop */
-static gboolean daemonclear  = FALSE;   /*!< Used to signal back when daemon is finished */
-static gint     cmd_delay    = 0;       /*!< Delay between two RX commands TX = 3*RX */
-static gint     timeoutid    = -1;      /*!< The ID of the timeout callback when we don't use threads. */
-static gboolean timeout_busy = FALSE;   /*!< Flag used to avoid to callbacks at the same time. */
-static gboolean suspended    = FALSE;   /*!< Flag indicating whether the daemon is susended or not. */
+/** \brief Conversion table to convert rig command to string */
+static const gchar *CMD_TO_STR[RIG_CMD_NUMBER] = {
+	"RIG_CMD_NONE",
+	"RIG_CMD_GET_FREQ_1",
+	"RIG_CMD_SET_FREQ_1",
+	"RIG_CMD_GET_FREQ_2",
+	"RIG_CMD_SET_FREQ_2",
+	"RIG_CMD_GET_RIT",
+	"RIG_CMD_SET_RIT",
+	"RIG_CMD_GET_XIT",
+	"RIG_CMD_SET_XIT",
+	"RIG_CMD_GET_VFO",
+	"RIG_CMD_SET_VFO",
+	"RIG_CMD_GET_PSTAT",
+	"RIG_CMD_SET_PSTAT",
+	"RIG_CMD_GET_PTT",
+	"RIG_CMD_SET_PTT",
+	"RIG_CMD_GET_MODE",
+	"RIG_CMD_SET_MODE",
+	"RIG_CMD_GET_AGC",
+	"RIG_CMD_SET_AGC",
+	"RIG_CMD_GET_ATT",
+	"RIG_CMD_SET_ATT",
+	"RIG_CMD_GET_PREAMP",
+	"RIG_CMD_SET_PREAMP",
+	"RIG_CMD_SET_SPLIT",
+	"RIG_CMD_GET_SPLIT",
+	"RIG_CMD_SET_AF",
+	"RIG_CMD_GET_AF",
+	"RIG_CMD_SET_RF",
+	"RIG_CMD_GET_RF",
+	"RIG_CMD_SET_SQL",
+	"RIG_CMD_GET_SQL",
+	"RIG_CMD_SET_IFS",
+	"RIG_CMD_GET_IFS",
+	"RIG_CMD_SET_APF",
+	"RIG_CMD_GET_APF",
+	"RIG_CMD_SET_NR",
+	"RIG_CMD_GET_NR",
+	"RIG_CMD_SET_NOTCH",
+	"RIG_CMD_GET_NOTCH",
+	"RIG_CMD_SET_PBT_IN",
+	"RIG_CMD_GET_PBT_IN",
+	"RIG_CMD_SET_PBT_OUT",
+	"RIG_CMD_GET_PBT_OUT",
+	"RIG_CMD_SET_CW_PITCH",
+	"RIG_CMD_GET_CW_PITCH",
+	"RIG_CMD_SET_KEYSPD",
+	"RIG_CMD_GET_KEYSPD",
+	"RIG_CMD_SET_BKINDEL",
+	"RIG_CMD_GET_BKINDEL",
+	"RIG_CMD_SET_BALANCE",
+	"RIG_CMD_GET_BALANCE",
+	"RIG_CMD_SET_VOXDEL",
+	"RIG_CMD_GET_VOXDEL",
+	"RIG_CMD_SET_VOXGAIN",
+	"RIG_CMD_GET_VOXGAIN",
+	"RIG_CMD_SET_ANTIVOX",
+	"RIG_CMD_GET_ANTIVOX",
+	"RIG_CMD_SET_MICGAIN",
+	"RIG_CMD_GET_MICGAIN",
+	"RIG_CMD_SET_COMP",
+	"RIG_CMD_GET_COMP",
+	"RIG_CMD_GET_STRENGTH",
+	"RIG_CMD_SET_POWER",
+	"RIG_CMD_GET_POWER",
+	"RIG_CMD_GET_SWR",
+	"RIG_CMD_SET_ALC",
+	"RIG_CMD_GET_ALC",
+	"RIG_CMD_GET_LOCK",
+	"RIG_CMD_SET_LOCK",
+	"RIG_CMD_VFO_TOGGLE",
+	"RIG_CMD_VFO_COPY",
+	"RIG_CMD_VFO_XCHG",
+	"RIG_CMD_SET_FUNC",
+	"RIG_CMD_GET_FUNC"
+};
+
+
+/** \brief Capability flag of a command.
+ *
+ * This structure links a command to the flag in grig_cmd_avail_t which
+ * tells whether the current rig supports the command.
+ */
+typedef struct {
+	gboolean  set;     /*!< TRUE if the flag is in has_set, FALSE if it is in has_get. */
+	glong     offset;  /*!< Offset of the flag in grig_cmd_avail_t, -1 if special. */
+} cmd_avail_t;
+
+#define CMD_AVAIL_GET(field) { FALSE, G_STRUCT_OFFSET (grig_cmd_avail_t, field) }
+#define CMD_AVAIL_SET(field) { TRUE,  G_STRUCT_OFFSET (grig_cmd_avail_t, field) }
+#define CMD_AVAIL_SPECIAL    { FALSE, -1 }
+
+
+/** \brief Table of command capabilities.
+ *
+ * Commands marked special are checked by rig_daemon_cmd_avail() since
+ * they depend on more than one flag.
+ */
+static const cmd_avail_t CMD_AVAIL[RIG_CMD_NUMBER] = {
+	[RIG_CMD_NONE]         = CMD_AVAIL_SPECIAL,
+	[RIG_CMD_GET_FREQ_1]   = CMD_AVAIL_GET (freq1),
+	[RIG_CMD_SET_FREQ_1]   = CMD_AVAIL_SET (freq1),
+	[RIG_CMD_GET_FREQ_2]   = CMD_AVAIL_GET (freq2),
+	[RIG_CMD_SET_FREQ_2]   = CMD_AVAIL_SET (freq2),
+	[RIG_CMD_GET_RIT]      = CMD_AVAIL_GET (rit),
+	[RIG_CMD_SET_RIT]      = CMD_AVAIL_SET (rit),
+	[RIG_CMD_GET_XIT]      = CMD_AVAIL_GET (xit),
+	[RIG_CMD_SET_XIT]      = CMD_AVAIL_SET (xit),
+	[RIG_CMD_GET_VFO]      = CMD_AVAIL_GET (vfo),
+	[RIG_CMD_SET_VFO]      = CMD_AVAIL_SET (vfo),
+	[RIG_CMD_GET_PSTAT]    = CMD_AVAIL_GET (pstat),
+	[RIG_CMD_SET_PSTAT]    = CMD_AVAIL_SET (pstat),
+	[RIG_CMD_GET_PTT]      = CMD_AVAIL_GET (ptt),
+	[RIG_CMD_SET_PTT]      = CMD_AVAIL_SET (ptt),
+	[RIG_CMD_GET_MODE]     = CMD_AVAIL_SPECIAL,
+	[RIG_CMD_SET_MODE]     = CMD_AVAIL_SPECIAL,
+	[RIG_CMD_GET_AGC]      = CMD_AVAIL_GET (agc),
+	[RIG_CMD_SET_AGC]      = CMD_AVAIL_SET (agc),
+	[RIG_CMD_GET_ATT]      = CMD_AVAIL_GET (att),
+	[RIG_CMD_SET_ATT]      = CMD_AVAIL_SET (att),
+	[RIG_CMD_GET_PREAMP]   = CMD_AVAIL_GET (preamp),
+	[RIG_CMD_SET_PREAMP]   = CMD_AVAIL_SET (preamp),
+	[RIG_CMD_SET_SPLIT]    = CMD_AVAIL_SET (split),
+	[RIG_CMD_GET_SPLIT]    = CMD_AVAIL_GET (split),
+	[RIG_CMD_SET_AF]       = CMD_AVAIL_SET (afg),
+	[RIG_CMD_GET_AF]       = CMD_AVAIL_GET (afg),
+	[RIG_CMD_SET_RF]       = CMD_AVAIL_SET (rfg),
+	[RIG_CMD_GET_RF]       = CMD_AVAIL_GET (rfg),
+	[RIG_CMD_SET_SQL]      = CMD_AVAIL_SET (sql),
+	[RIG_CMD_GET_SQL]      = CMD_AVAIL_GET (sql),
+	[RIG_CMD_SET_IFS]      = CMD_AVAIL_SET (ifs),
+	[RIG_CMD_GET_IFS]      = CMD_AVAIL_GET (ifs),
+	[RIG_CMD_SET_APF]      = CMD_AVAIL_SET (apf),
+	[RIG_CMD_GET_APF]      = CMD_AVAIL_GET (apf),
+	[RIG_CMD_SET_NR]       = CMD_AVAIL_SET (nr),
+	[RIG_CMD_GET_NR]       = CMD_AVAIL_GET (nr),
+	[RIG_CMD_SET_NOTCH]    = CMD_AVAIL_SET (notch),
+	[RIG_CMD_GET_NOTCH]    = CMD_AVAIL_GET (notch),
+	[RIG_CMD_SET_PBT_IN]   = CMD_AVAIL_SET (pbtin),
+	[RIG_CMD_GET_PBT_IN]   = CMD_AVAIL_GET (pbtin),
+	[RIG_CMD_SET_PBT_OUT]  = CMD_AVAIL_SET (pbtout),
+	[RIG_CMD_GET_PBT_OUT]  = CMD_AVAIL_GET (pbtout),
+	[RIG_CMD_SET_CW_PITCH] = CMD_AVAIL_SET (cwpitch),
+	[RIG_CMD_GET_CW_PITCH] = CMD_AVAIL_GET (cwpitch),
+	[RIG_CMD_SET_KEYSPD]   = CMD_AVAIL_SET (keyspd),
+	[RIG_CMD_GET_KEYSPD]   = CMD_AVAIL_GET (keyspd),
+	[RIG_CMD_SET_BKINDEL]  = CMD_AVAIL_SET (bkindel),
+	[RIG_CMD_GET_BKINDEL]  = CMD_AVAIL_GET (bkindel),
+	[RIG_CMD_SET_BALANCE]  = CMD_AVAIL_SET (balance),
+	[RIG_CMD_GET_BALANCE]  = CMD_AVAIL_GET (balance),
+	[RIG_CMD_SET_VOXDEL]   = CMD_AVAIL_SET (voxdel),
+	[RIG_CMD_GET_VOXDEL]   = CMD_AVAIL_GET (voxdel),
+	[RIG_CMD_SET_VOXGAIN]  = CMD_AVAIL_SET (voxg),
+	[RIG_CMD_GET_VOXGAIN]  = CMD_AVAIL_GET (voxg),
+	[RIG_CMD_SET_ANTIVOX]  = CMD_AVAIL_SET (antivox),
+	[RIG_CMD_GET_ANTIVOX]  = CMD_AVAIL_GET (antivox),
+	[RIG_CMD_SET_MICGAIN]  = CMD_AVAIL_SET (micg),
+	[RIG_CMD_GET_MICGAIN]  = CMD_AVAIL_GET (micg),
+	[RIG_CMD_SET_COMP]     = CMD_AVAIL_SPECIAL,
+	[RIG_CMD_GET_COMP]     = CMD_AVAIL_GET (comp),
+	[RIG_CMD_GET_STRENGTH] = CMD_AVAIL_GET (strength),
+	[RIG_CMD_SET_POWER]    = CMD_AVAIL_SET (power),
+	[RIG_CMD_GET_POWER]    = CMD_AVAIL_GET (power),
+	[RIG_CMD_GET_SWR]      = CMD_AVAIL_GET (swr),
+	[RIG_CMD_SET_ALC]      = CMD_AVAIL_SET (alc),
+	[RIG_CMD_GET_ALC]      = CMD_AVAIL_GET (alc),
+	[RIG_CMD_GET_LOCK]     = CMD_AVAIL_GET (lock),
+	[RIG_CMD_SET_LOCK]     = CMD_AVAIL_SET (lock),
+	[RIG_CMD_VFO_TOGGLE]   = CMD_AVAIL_SET (vfo_op_toggle),
+	[RIG_CMD_VFO_COPY]     = CMD_AVAIL_SET (vfo_op_copy),
+	[RIG_CMD_VFO_XCHG]     = CMD_AVAIL_SET (vfo_op_xchg),
+	[RIG_CMD_SET_FUNC]     = CMD_AVAIL_SPECIAL,
+	[RIG_CMD_GET_FUNC]     = CMD_AVAIL_SPECIAL
+};
+
+/** \brief Steps of the timeout callback. */
+typedef enum {
+	CB_STEP_QUEUE = 0,     /*!< Execute a queued user command, or poll if the queue is empty. */
+	CB_STEP_POLL,          /*!< Execute a polling command. */
+	CB_STEP_PSTAT          /*!< Rig is off; read back the power status. */
+} cb_step_t;
+
+
+/** \brief State of the daemon controlling one rig. */
+typedef struct {
+	RIG      *rig;                 /*!< The hamlib rig structure. */
+
+	gboolean  stopdaemon;          /*!< Used to signal the daemon thread that it should stop */
+	gboolean  daemonclear;         /*!< Used to signal back when daemon is finished */
+	gint      cmd_delay;           /*!< Delay between two RX commands TX = 3*RX */
+	gboolean  usetimeout;          /*!< TRUE when the daemon runs as a timeout callback instead of a thread. */
+	guint     timeoutid;           /*!< The ID of the timeout callback when we don't use threads. */
+	gboolean  timeout_busy;        /*!< Flag indicating that the timeout callback is executing. */
+	gboolean  suspended;           /*!< Flag indicating whether the daemon is susended or not. */
+	gboolean  probe;               /*!< The initial values have not been read yet. */
+
+	GMutex    cmdmutex;            /*!< Mutex protecting the command queue and latency data. */
+	GCond     daemoncond;          /*!< Wakes up the daemon thread or signals its termination; used with cmdmutex. */
+	GThread  *daemonthread;        /*!< The daemon thread. */
+	GQueue    cmdqueue;            /*!< Queue of user commands waiting for execution. */
+	gint64    cmdposted[RIG_CMD_NUMBER];  /*!< Time when a queued command was posted (0 if not queued). */
+	gint64    cmdtaken[RIG_CMD_NUMBER];   /*!< Post time of a command taken from the queue and being executed (0 if none). */
+	rig_daemon_latency_t cmdlatency[RIG_CMD_NUMBER]; /*!< Set-to-apply latency per command. */
+
+	grig_cmd_avail_t origget;      /*!< Get capabilities detected at start-up. */
+	grig_cmd_avail_t origset;      /*!< Set capabilities detected at start-up. */
+
+	cb_step_t cbstep;              /*!< Next step of the timeout callback. */
+	gint64    cbnext;              /*!< Time when the timeout callback is due. */
+	gint64    cbearliest;          /*!< Earliest time for the next command in timeout mode. */
+	rig_daemon_latency_t cbstall;  /*!< Time spent in the timeout callback (blocking the GUI). */
+	gint64    cbprev;              /*!< Start of the previous callback; 0 after a suspension. */
+	gint64    cbprobe;             /*!< Start of the initial polling pass in timeout mode. */
+
+	guint     getfuncidx;          /*!< Next function to read with RIG_CMD_GET_FUNC. */
+	guint     setfuncidx;          /*!< Next function to send with RIG_CMD_SET_FUNC. */
+
+	guint     ratecount;           /*!< Commands executed since ratestart. */
+	gint64    ratestart;           /*!< Start of the current rate measurement. */
+	gint64    sweeptime;           /*!< Time of the last sweep for unsent values. */
+
+	grig_cmdrec_ring_t *cmdrec;    /*!< Command recorder or NULL if not recording. */
+	gchar    *recfile;             /*!< File to which the recorded commands are saved. */
+} rig_daemon_ctx_t;
+
+
+/** \brief The daemon of each rig. */
+static rig_daemon_ctx_t daemons[C_MAX_RIGS];
+
+/** \brief Get the daemon of the current rig. */
+#define RIG_DAEMON_CUR() (&daemons[rig_data_current ()])
 
 /* private function prototypes */
-static void     rig_daemon_post_init (gboolean, gboolean);
+static void     rig_daemon_post_init (gboolean, gboolean, const gchar *);
+static void     rig_daemon_probe     (void);
+static void     rig_daemon_queue_unpolled (void);
 static gpointer rig_daemon_cycle     (gpointer);
 static gint     rig_daemon_cycle_cb  (gpointer);
+static void     rig_daemon_cb_arm    (guint);
+static void     rig_daemon_cb_probed (void);
+static void     rig_daemon_cb_stall  (gint64);
 static gint     rig_daemon_exec_cmd  (rig_cmd_t,
 				      grig_settings_t  *,
 				      grig_settings_t  *,
 				      grig_cmd_avail_t *,
 				      grig_cmd_avail_t *,
 				      grig_cmd_avail_t *);
-
+static guint    rig_daemon_flush_queue (gulong,
+					guint,
+					grig_settings_t  *,
+					grig_settings_t  *,
+					grig_cmd_avail_t *,
+					grig_cmd_avail_t *,
+					grig_cmd_avail_t *);
+static void     rig_daemon_cmd_applied (rig_cmd_t);
+static void     rig_daemon_wait        (gulong, gboolean);
+static void     rig_daemon_dump_latency (void);
+static gboolean rig_daemon_cmd_avail   (rig_cmd_t,
+					grig_cmd_avail_t *,
+					grig_cmd_avail_t *);
+static gboolean rig_daemon_claim_cmd   (rig_cmd_t,
+					grig_cmd_avail_t *,
+					grig_cmd_avail_t *);
+static gboolean rig_daemon_poll_step   (gboolean,
+					grig_settings_t  *,
+					grig_settings_t  *,
+					grig_cmd_avail_t *,
+					grig_cmd_avail_t *,
+					grig_cmd_avail_t *);
+static void     rig_daemon_report_rate (void);
+static void     rig_daemon_sweep_set   (grig_cmd_avail_t *);
+static gint     rig_daemon_next_func   (const int *, guint *);
+static gboolean rig_daemon_cmd_pending (rig_cmd_t, grig_cmd_avail_t *);
 
 
 /** \brief Start radio control daemon.
@@ -446,7 +379,8 @@ static gint     rig_daemon_exec_cmd  (rig_cmd_t,
  *  \return 0 if the daemon has been initialized correctly.
  *
  * This function initializes the radio and starts the control daemon. The rignum
- * parameter is the rig ID in hamlib.
+ * parameter is the rig ID in hamlib. The daemon is started for the current
+ * rig slot, i.e. the one selected with rig_data_select().
  *
  * The \a rigconf parameter contains one or more configuration options that are
  * necessary for some rigs. The syntax is param=value and if more than one config
@@ -466,15 +400,14 @@ rig_daemon_start       (int          rigid,
 			gboolean     ptt,
 			gboolean     pstat)
 {
-
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
 	gchar  *rigport;
 	gint    retcode;
 	gchar **confvec;   
 	gchar **confent;
+	gchar  *cachekey;
+	gint64  start;
 	GError *err = NULL;  /* used when starting daemon thread */
-#if GLIB_CHECK_VERSION(2,32,0)
-  GThread* thread = NULL;
-#endif
 
 
 	grig_debug_local (RIG_DEBUG_TRACE,
@@ -485,15 +418,15 @@ rig_daemon_start       (int          rigid,
 	   we set it already here
 	*/
 	if (cmddel > 0) {
-		cmd_delay = cmddel;
+		ctx->cmd_delay = cmddel;
 	}
 	else {
-		cmd_delay = C_DEF_RX_CMD_DELAY;
+		ctx->cmd_delay = C_DEF_RX_CMD_DELAY;
 	}
 
 
 	/* check if rig is already initialized */
-	if (myrig != NULL) {
+	if (ctx->rig != NULL) {
 		return 1;
 	}
 
@@ -523,10 +456,12 @@ rig_daemon_start       (int          rigid,
 			  _("%s: Initializing rig (id=%d)"),
 			  __FUNCTION__, rigid);
 
-	/* initialize rig */
-	myrig = rig_init (rigid);
+	/* initialize rig; loads the backend */
+	start = grig_startup_begin ();
+	ctx->rig = rig_init (rigid);
+	grig_startup_end ("init", rig_data_current (), start);
 
-	if (myrig == NULL) {
+	if (ctx->rig == NULL) {
 
 		grig_debug_local (RIG_DEBUG_ERR,
 				  _("%s: Init failed; Hamlib returned NULL!"),
@@ -537,16 +472,16 @@ rig_daemon_start       (int          rigid,
 	}
 
 	/* configure and open rig device */
-	strncpy (myrig->state.rigport.pathname, rigport, HAMLIB_FILPATHLEN-1);
+	strncpy (ctx->rig->state.rigport.pathname, rigport, HAMLIB_FILPATHLEN-1);
 	g_free (rigport);
 
 	/* set speed if any special whishes */
 	if (speed) {
-		myrig->state.rigport.parm.serial.rate = speed;
+		ctx->rig->state.rigport.parm.serial.rate = speed;
 	}
 
 	if (civaddr) {
-		retcode = rig_set_conf (myrig, rig_token_lookup (myrig, "civaddr"), civaddr);
+		retcode = rig_set_conf (ctx->rig, rig_token_lookup (ctx->rig, "civaddr"), civaddr);
 	}
 
 	/* split conf parameter string; */
@@ -566,8 +501,8 @@ rig_daemon_start       (int          rigid,
 					  _("%s: Setting conf param (%s,%s)..."),
 					  __FUNCTION__, confent[0], confent[1]);
 
-			retcode = rig_set_conf (myrig,
-						rig_token_lookup (myrig, confent[0]),
+			retcode = rig_set_conf (ctx->rig,
+						rig_token_lookup (ctx->rig, confent[0]),
 						confent[1]);
 
 			if (retcode == RIG_OK) {
@@ -592,17 +527,20 @@ rig_daemon_start       (int          rigid,
 
 #ifndef DISABLE_HW
 	/* open rig */
-	retcode = rig_open (myrig);
+	start = grig_startup_begin ();
+	retcode = rig_open (ctx->rig);
+	grig_startup_end ("open", rig_data_current (), start);
 	if (retcode != RIG_OK) {
 
 		/* send error report */
 		grig_debug_local (RIG_DEBUG_ERR,
 				  _("%s: Failed to open rig port %s: %s (permissions?)"),
 				  __FUNCTION__,
-				  myrig->state.rigport.pathname,
+				  ctx->rig->state.rigport.pathname,
 				  rigerror(retcode));
 
-		rig_cleanup (myrig);
+		rig_cleanup (ctx->rig);
+		ctx->rig = NULL;
 		return 1;
 	}
 #endif
@@ -612,7 +550,11 @@ rig_daemon_start       (int          rigid,
 			  __FUNCTION__);
 
 	/* get capabilities and settings  */
-	rig_daemon_post_init (ptt, pstat);
+	start = grig_startup_begin ();
+	cachekey = rig_daemon_cache_key (ctx->rig, civaddr, rigconf, ptt, pstat);
+	rig_daemon_post_init (ptt, pstat, cachekey);
+	g_free (cachekey);
+	grig_startup_end ("capabilities", rig_data_current (), start);
 
 	grig_debug_local (RIG_DEBUG_TRACE,
 			  _("%s: Starting rig daemon"),
@@ -625,28 +567,44 @@ rig_daemon_start       (int          rigid,
 	*/
 	if (nothread == TRUE) {
 
-		/* we start a regular g_timeout;
-		   we use C_MAX_CYCLES * C_MAX_CMD_PER_CYCLE * cmd_delay
-		   for delay.
+		/* we start a regular g_timeout; the callback executes
+		   one command at a time and re-arms itself with the
+		   appropriate delay.
 		*/
-		timeoutid = g_timeout_add (2 * C_MAX_CYCLES * C_MAX_CMD_PER_CYCLE * cmd_delay,
-					   rig_daemon_cycle_cb,
-					   NULL);
+		ctx->usetimeout = TRUE;
+		ctx->cbstep = CB_STEP_QUEUE;
+		memset (&ctx->cbstall, 0, sizeof (ctx->cbstall));
+		ctx->cbprev = 0;
+
+		/* reading all values at once would block the GUI; the first
+		   polling pass reads them one command per callback instead
+		*/
+		if (ctx->probe) {
+			ctx->cbprobe = grig_startup_begin ();
+			grig_startup_hold ();
+			rig_daemon_queue_unpolled ();
+		}
+
+		rig_daemon_cb_arm (ctx->cmd_delay);
 
 		grig_debug_local (RIG_DEBUG_VERBOSE,
 				  _("%s: Daemon timeout started, ID: %d"),
-				  __FUNCTION__, timeoutid);
+				  __FUNCTION__, ctx->timeoutid);
 
 	}
 	else {
-#if !GLIB_CHECK_VERSION(2,32,0)
-		g_thread_create (rig_daemon_cycle, NULL, FALSE, &err);
-#else
-    thread = g_thread_try_new ("daemon thread", rig_daemon_cycle, NULL, &err);
-    if (thread != NULL) {
-      g_thread_unref(thread);
-    }
-#endif
+		ctx->stopdaemon = FALSE;
+		ctx->daemonclear = FALSE;
+
+		/* the thread reads the initial values while the GUI starts */
+		if (ctx->probe) {
+			grig_startup_hold ();
+		}
+
+		/* keep the thread joinable so that rig_daemon_stop() can wait for it */
+		ctx->daemonthread = g_thread_try_new ("daemon thread", rig_daemon_cycle,
+						      GINT_TO_POINTER (rig_data_current ()),
+						      &err);
 
 		/* check whether any error occurred when starting the daemon
 		   thread; if yes, close rig and return with error code
@@ -661,8 +619,13 @@ rig_daemon_start       (int          rigid,
 					  _("%s: Error %d: %s"),
 					    __FUNCTION__, err->code, err->message);
 
-			rig_close (myrig);
-			rig_cleanup (myrig);
+			if (ctx->probe) {
+				grig_startup_release ();
+			}
+
+			rig_close (ctx->rig);
+			rig_cleanup (ctx->rig);
+			ctx->rig = NULL;
 
 			return err->code;
 		}
@@ -689,9 +652,16 @@ rig_daemon_start       (int          rigid,
 void
 rig_daemon_stop  ()
 {
-	guint i = 0;
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gint64   end;
+	gboolean clear;
 
 
+	/* nothing to do if this rig has not been started */
+	if (ctx->rig == NULL) {
+		return;
+	}
+
 	/* send a debug message */
 	grig_debug_local (RIG_DEBUG_TRACE,
 			  _("%s: Sending stop signal to rig daemon"),
@@ -700,30 +670,72 @@ rig_daemon_stop  ()
 
 	/* if we are running in time-out mode
 	   we can remove the callback directly here;
-	   otherwise, send stop signal to daemon and
-	   wait until 'daemonclear' flag is TRUE or
+	   otherwise, wake up the daemon with the stop signal
+	   and wait until 'daemonclear' flag is TRUE or
 	   we time out (in case of time out we also send
 	   and error message
 	*/
-	if (timeoutid != -1) {
-		g_source_remove (timeoutid);
+	if (ctx->usetimeout) {
+		if (ctx->timeoutid > 0) {
+			g_source_remove (ctx->timeoutid);
+			ctx->timeoutid = 0;
+		}
+		ctx->usetimeout = FALSE;
+
+		if (ctx->cbstall.count) {
+			grig_debug_local (RIG_DEBUG_VERBOSE,
+					  _("%s: %u callbacks, GUI blocked for "\
+					    "mean %.1f ms, max %.1f ms"),
+					  __FUNCTION__, ctx->cbstall.count,
+					  ctx->cbstall.total / (1000.0 * ctx->cbstall.count),
+					  ctx->cbstall.max / 1000.0);
+		}
 	}
-	else {
-		stopdaemon = TRUE;
+	else if (ctx->daemonthread != NULL) {
+		end = g_get_monotonic_time () + 1000 * C_RIG_DAEMON_STOP_TIMEOUT;
 
-		/* wait until flag is clear or we time out */
-		while ((daemonclear == FALSE) &&
-		       (i*C_RIG_DAEMON_STOP_SLEEP_TIME < C_RIG_DAEMON_STOP_TIMEOUT)) {
+		g_mutex_lock (&ctx->cmdmutex);
+		ctx->stopdaemon = TRUE;
+		g_cond_broadcast (&ctx->daemoncond);
 
-			i++;
-			g_usleep (C_RIG_DAEMON_STOP_SLEEP_TIME * 1000);
+		/* wait until flag is clear or we time out */
+		while (!ctx->daemonclear) {
+			if (!g_cond_wait_until (&ctx->daemoncond, &ctx->cmdmutex, end))
+				break;
 		}
+		clear = ctx->daemonclear;
+		g_mutex_unlock (&ctx->cmdmutex);
 
-		/* print an error message if the flag has not been cleared */
-		if (daemonclear == FALSE) {
+		if (clear) {
+			g_thread_join (ctx->daemonthread);
+		}
+		else {
+			/* print an error message if the flag has not been cleared */
 			g_print ("\n\nCRITICAL: Daemon process has not been shut down properly. "\
 				 "You may have a zombie hanging around :-(\n\n");
+			g_thread_unref (ctx->daemonthread);
+		}
+
+		ctx->daemonthread = NULL;
+	}
+
+	rig_daemon_dump_latency ();
+
+	/* the daemon is no longer running; save and drop the recording */
+	if (ctx->cmdrec != NULL) {
+		GError *error = NULL;
+
+		if (!rig_daemon_save_record (&error)) {
+			grig_debug_local (RIG_DEBUG_ERR,
+					  _("%s: Could not save command record:\n%s"),
+					  __FUNCTION__, error->message);
+			g_clear_error (&error);
 		}
+
+		grig_cmdrec_ring_free (ctx->cmdrec);
+		ctx->cmdrec = NULL;
+		g_free (ctx->recfile);
+		ctx->recfile = NULL;
 	}
 
 	/* send a debug message */
@@ -733,33 +745,43 @@ rig_daemon_stop  ()
 
 #ifndef DISABLE_HW
 	/* close radio device */
-	rig_close (myrig);
+	rig_close (ctx->rig);
 #endif
 
 	/* clean up hamlib */
-	rig_cleanup (myrig);
+	rig_cleanup (ctx->rig);
 
-	myrig = NULL;
+	ctx->rig = NULL;
 }
 
 
 /** \brief Execute post initialization tasks.
  *  \param ptt Flag indicating whether to enable PTT.
  *  \param pstat Flag indicting whether to enable POWER.
+ *  \param cachekey Key of the rig configuration, see rig_daemon_cache_key().
  *
  * This function executes some tasks after initialization of the radio
  * hardware. These include testing the radio capabilities and obtaining
  * the current settings. The test results are communicated to the user
  * via the rig_debug() Hamlib function.
  *
+ * The current settings are read later by rig_daemon_probe() in the daemon
+ * thread, or by the first polling pass of the timeout callback. If the
+ * capabilities of the same configuration have been cached, only the tests
+ * are skipped, see rig-daemon-cache.c; the current settings are read all
+ * the same, since some of them, like the secondary frequency, are not
+ * polled.
  */
 static void
-rig_daemon_post_init (gboolean ptt, gboolean pstat)
+rig_daemon_post_init (gboolean ptt, gboolean pstat, const gchar *cachekey)
 {
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
 	grig_settings_t  *get;        /* pointer to shared data 'get' */
 	grig_settings_t  *set;        /* pointer to shared data 'set' */
 	grig_cmd_avail_t *has_get;    /* pointer to shared data 'has_get' */
 	grig_cmd_avail_t *has_set;    /* pointer to shared data 'has_set' */
+	guint             i;
+	guint             nfuncs;
 
 
 	/* get pointers to shared data */
@@ -770,33 +792,77 @@ rig_daemon_post_init (gboolean ptt, gboolean pstat)
 
 
 	/* check command availabilities */
-	if (pstat == TRUE) {
-		rig_daemon_check_pwrstat (myrig, get, has_get, has_set);
-	}
-	else {
-		has_get->pstat = FALSE;
-		has_set->pstat = FALSE;
+	if (rig_daemon_cache_load (ctx->rig, cachekey, get, has_get, has_set)) {
+		/* PTT and POWER are part of the key */
 		get->pstat = RIG_POWER_ON;
 		set->pstat = RIG_POWER_ON;
+		get->ptt = RIG_PTT_OFF;
+		set->ptt = RIG_PTT_OFF;
+	}
+	else {
+		if (pstat == TRUE) {
+			rig_daemon_check_pwrstat (ctx->rig, get, has_get, has_set);
+		}
+		else {
+			has_get->pstat = FALSE;
+			has_set->pstat = FALSE;
+			get->pstat = RIG_POWER_ON;
+			set->pstat = RIG_POWER_ON;
+		}
+
+		if (ptt == TRUE) {
+			rig_daemon_check_ptt     (ctx->rig, get, has_get, has_set);
+		}
+		else {
+			has_get->ptt = FALSE;
+			has_set->ptt = FALSE;
+			get->ptt = RIG_PTT_OFF;
+			set->ptt = RIG_PTT_OFF;
+		}
+
+		rig_daemon_check_vfo     (ctx->rig, get, has_get, has_set);
+		rig_daemon_check_freq    (ctx->rig, get, has_get, has_set);
+		rig_daemon_check_rit     (ctx->rig, get, has_get, has_set);
+		rig_daemon_check_xit     (ctx->rig, get, has_get, has_set);
+		rig_daemon_check_mode    (ctx->rig, get, has_get, has_set);
+		rig_daemon_check_level   (ctx->rig, get, has_get, has_set);
+		rig_daemon_check_func    (ctx->rig, get, has_get, has_set);
+
+		rig_daemon_cache_save (ctx->rig, cachekey, get, has_get, has_set);
 	}
 
-	if (ptt == TRUE) {
-		rig_daemon_check_ptt     (myrig, get, has_get, has_set);
+	/* read the current settings in any case */
+	ctx->probe = TRUE;
+
+	/* remember the capabilities so that commands disabled by the
+	   anomaly manager can be restored later
+	*/
+	ctx->origget = *has_get;
+	ctx->origset = *has_set;
+	rig_anomaly_init ();
+	rig_daemon_prof_init ();
+
+	/* set up the polling scheduler for this rig */
+	rig_daemon_poll_init (ctx->rig->caps->rig_model);
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+		rig_daemon_poll_enable (i, rig_daemon_cmd_avail (i, has_get, has_set));
 	}
-	else {
-		has_get->ptt = FALSE;
-		has_set->ptt = FALSE;
-		get->ptt = RIG_PTT_OFF;
-		set->ptt = RIG_PTT_OFF;
+
+	/* RIG_CMD_GET_FUNC reads one function per execution */
+	for (i = 0, nfuncs = 0; i < RIG_SETTING_MAX; i++) {
+		if (has_get->funcs[i])
+			nfuncs++;
 	}
+	rig_daemon_poll_set_parts (RIG_CMD_GET_FUNC, nfuncs);
+	ctx->getfuncidx = 0;
+	ctx->setfuncidx = 0;
 
-	rig_daemon_check_vfo     (myrig, get, has_get, has_set);
-	rig_daemon_check_freq    (myrig, get, has_get, has_set);
-	rig_daemon_check_rit     (myrig, get, has_get, has_set);
-	rig_daemon_check_xit     (myrig, get, has_get, has_set);
-	rig_daemon_check_mode    (myrig, get, has_get, has_set);
-	rig_daemon_check_level   (myrig, get, has_get, has_set);
-	rig_daemon_check_func    (myrig, get, has_get, has_set);
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Nominal polling load RX: %.1f cmds/sec, TX: %.1f cmds/sec"),
+			  __FUNCTION__,
+			  rig_daemon_poll_get_load (FALSE),
+			  rig_daemon_poll_get_load (TRUE));
 
 	/* debug info about detected has-get caps */
 	grig_debug_local (RIG_DEBUG_TRACE,
@@ -849,24 +915,124 @@ rig_daemon_post_init (gboolean ptt, gboolean pstat)
 
 
 
+/** \brief Read the initial values.
+ *
+ * This function reads the current settings after the capabilities have
+ * been detected. It is the first thing the daemon thread does, so that the
+ * main window is shown meanwhile and each group of values appears as soon
+ * as it has been read. Without threads the first polling pass is used
+ * instead, see rig_daemon_cb_probed().
+ */
+static void
+rig_daemon_probe ()
+{
+	static void (*const readers[]) (RIG *, grig_settings_t *, grig_cmd_avail_t *) = {
+		rig_daemon_read_vfo,
+		rig_daemon_read_freq,
+		rig_daemon_read_rit,
+		rig_daemon_read_xit,
+		rig_daemon_read_mode,    /* needs the frequency */
+		rig_daemon_read_level,
+		rig_daemon_read_func
+	};
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	grig_settings_t  *get;
+	grig_cmd_avail_t *has_get;
+	gint64            start;
+	guint             i;
+
+
+	if (!ctx->probe) {
+		return;
+	}
+
+	ctx->probe = FALSE;
+
+	get     = rig_data_get_get_addr ();
+	has_get = rig_data_get_has_get_addr ();
+
+	start = grig_startup_begin ();
+
+	for (i = 0; (i < G_N_ELEMENTS (readers)) && !ctx->stopdaemon; i++) {
+		readers[i] (ctx->rig, get, has_get);
+		rig_data_mark_dirty (RIG_DATA_DIRTY_ALL);
+	}
+
+	grig_startup_end ("probe", rig_data_current (), start);
+}
+
+
+
+/** \brief Queue the 'get' commands that are not polled.
+ *
+ * Without threads the initial values are read by the first polling pass,
+ * which does not include commands like RIG_CMD_GET_FREQ_2 that are never
+ * polled. Those are put into the command queue instead, so that they are
+ * executed one per callback as well. They are not marked as posted and do
+ * not count in the set-to-apply statistics.
+ */
+static void
+rig_daemon_queue_unpolled ()
+{
+	rig_daemon_ctx_t       *ctx = RIG_DAEMON_CUR ();
+	rig_daemon_poll_rate_t  rate;
+	grig_cmd_avail_t       *has_get;
+	grig_cmd_avail_t       *has_set;
+	rig_cmd_t               cmd;
+
+
+	has_get = rig_data_get_has_get_addr ();
+	has_set = rig_data_get_has_set_addr ();
+
+	g_mutex_lock (&ctx->cmdmutex);
+
+	for (cmd = RIG_CMD_NONE + 1; cmd < RIG_CMD_NUMBER; cmd++) {
+
+		if (CMD_AVAIL[cmd].set || !rig_daemon_cmd_avail (cmd, has_get, has_set))
+			continue;
+
+		/* FALSE if the command is not polled */
+		if (!rig_daemon_poll_get_rate (cmd, &rate)) {
+			g_queue_push_tail (&ctx->cmdqueue, GINT_TO_POINTER (cmd));
+		}
+	}
+
+	g_mutex_unlock (&ctx->cmdmutex);
+}
+
+
 /** \brief Radio control daemon main cycle (threaded version).
  *  \param data Unused.
  *  \return Always NULL.
  *
  * This function implements the main cycle of the radio control daemon. The executed
- * commands are defined in the DEF_RX_CYCLE and DEF_TX_CYCLE constant arrays.
+ * commands are selected by the polling scheduler (see rig-daemon-poll.c); user
+ * commands are executed before each polling step.
+ *
+ * The thread binds itself to the rig passed in data, so that the rig-data,
+ * scheduler and anomaly functions it calls refer to that rig.
  */
 static gpointer
 rig_daemon_cycle     (gpointer data)
 {
+	rig_daemon_ctx_t *ctx;
 	grig_settings_t  *get;             /* pointer to shared data 'get' */
 	grig_settings_t  *set;             /* pointer to shared data 'set' */
 	grig_cmd_avail_t *new;             /* pointer to shared data 'new' */
 	grig_cmd_avail_t *has_get;         /* pointer to shared data 'has_get' */
 	grig_cmd_avail_t *has_set;         /* pointer to shared data 'has_set' */
+	gint64            cyclestart;
 
-	guint step;    /* step counter */
 
+	rig_data_bind (GPOINTER_TO_INT (data));
+	ctx = RIG_DAEMON_CUR ();
+
+	if (grig_timeline_enabled ()) {
+		gchar *name = g_strdup_printf ("rig %d daemon", GPOINTER_TO_INT (data));
+
+		grig_timeline_thread_name (name);
+		g_free (name);
+	}
 
 	/* get pointers to shared data */
 	get     = rig_data_get_get_addr ();
@@ -879,8 +1045,17 @@ rig_daemon_cycle     (gpointer data)
 	/* send a debug message */
 	grig_debug_local (RIG_DEBUG_TRACE, _("%s started."), __FUNCTION__);
 
+	/* read the initial values while the GUI starts */
+	if (ctx->probe) {
+		rig_daemon_probe ();
+		grig_startup_release ();
+	}
+
 	/* loop forever until reception of STOP signal */
-	while (stopdaemon == FALSE) {
+	while (ctx->stopdaemon == FALSE) {
+
+		/* a cycle spent waiting for resume is not measured */
+		cyclestart = ctx->suspended ? 0 : g_get_monotonic_time ();
 
 		/* first we check whether rig is powered ON since some rigs
 		   will not talk to us in power-off tate.
@@ -890,51 +1065,66 @@ rig_daemon_cycle     (gpointer data)
 		*/
 		if (get->pstat == RIG_POWER_ON) {
 
-			/* execute one cylce; note that the switch between the
-			   RX and TX tables can happen within a cycle :-)
+			/* only execute commands if the daemon is not
+			   suspended; sleep until resumed or stopped.
 			*/
-			for (step = 0; step < C_MAX_CMD_PER_CYCLE; step++) {
-				
-				/* only execute commands if the daemon is not
-				   suspended.
-				*/
-				if (!suspended) {
-
-					/* check whether we are in RX or TX mode; */
-					if (get->ptt == RIG_PTT_OFF) {
-
-						/* Execute a receiver command */
-						rig_daemon_exec_cmd (DEF_RX_CYCLE[step],
-								     get,
-								     set,
-								     new,
-								     has_get,
-								     has_set);
-/* slow motion in debug mode */
+			if (ctx->suspended) {
+				g_mutex_lock (&ctx->cmdmutex);
+				while (ctx->suspended && !ctx->stopdaemon)
+					g_cond_wait (&ctx->daemoncond, &ctx->cmdmutex);
+				g_mutex_unlock (&ctx->cmdmutex);
+			}
+
+			/* check whether we are in RX or TX mode */
+			else if (get->ptt == RIG_PTT_OFF) {
+
+				/* user commands go out before the next polling step */
 #ifdef GRIG_DEBUG
-						g_usleep (5000 * cmd_delay);
+				rig_daemon_flush_queue (5000 * ctx->cmd_delay, 0,
+							get, set, new,
+							has_get, has_set);
 #else
-						g_usleep (1000 * cmd_delay);
+				rig_daemon_flush_queue (1000 * ctx->cmd_delay, 0,
+							get, set, new,
+							has_get, has_set);
 #endif
-					}
-					else {
-
-						/* Execute transmitter command */
-						rig_daemon_exec_cmd (DEF_TX_CYCLE[step],
-								     get,
-								     set,
-								     new,
-								     has_get,
-								     has_set);
+
+				/* Execute a receiver command */
+				if (rig_daemon_poll_step (FALSE,
+							  get, set, new,
+							  has_get, has_set)) {
 /* slow motion in debug mode */
 #ifdef GRIG_DEBUG
-						g_usleep (15000 * cmd_delay);
+					rig_daemon_wait (5000 * ctx->cmd_delay, TRUE);
 #else
-						g_usleep (3000 * cmd_delay);
+					rig_daemon_wait (1000 * ctx->cmd_delay, TRUE);
 #endif
-					}
 				}
+			}
+			else {
 
+				/* user commands go out before the next polling step */
+#ifdef GRIG_DEBUG
+				rig_daemon_flush_queue (15000 * ctx->cmd_delay, 0,
+							get, set, new,
+							has_get, has_set);
+#else
+				rig_daemon_flush_queue (3000 * ctx->cmd_delay, 0,
+							get, set, new,
+							has_get, has_set);
+#endif
+
+				/* Execute transmitter command */
+				if (rig_daemon_poll_step (TRUE,
+							  get, set, new,
+							  has_get, has_set)) {
+/* slow motion in debug mode */
+#ifdef GRIG_DEBUG
+					rig_daemon_wait (15000 * ctx->cmd_delay, TRUE);
+#else
+					rig_daemon_wait (3000 * ctx->cmd_delay, TRUE);
+#endif
+				}
 			}
 
 		}
@@ -942,7 +1132,7 @@ rig_daemon_cycle     (gpointer data)
 		/* otherwise check the power status, but only if daemon
 		   is not suspended */
 		else {
-			if (!suspended) {
+			if (!ctx->suspended) {
 				rig_daemon_exec_cmd (RIG_CMD_SET_PSTAT,
 						     get, set, new,
 						     has_get, has_set);
@@ -965,52 +1155,83 @@ rig_daemon_cycle     (gpointer data)
 
 /* slow motion in debug mode */
 #ifdef GRIG_DEBUG
-			g_usleep (15000 * cmd_delay);
+			rig_daemon_wait (15000 * ctx->cmd_delay, TRUE);
 #else
-			g_usleep (3000 * cmd_delay);
+			rig_daemon_wait (3000 * ctx->cmd_delay, TRUE);
 #endif
 
 		}
 
+		if (cyclestart != 0) {
+			rig_daemon_prof_cycle (g_get_monotonic_time () - cyclestart);
+		}
 	}
 
 	/* send a debug message */
 	grig_debug_local (RIG_DEBUG_TRACE, _("%s stopped"), __FUNCTION__);
 
 	/* set clear flag to indicate that daemon terminated */
-	daemonclear = TRUE;
+	g_mutex_lock (&ctx->cmdmutex);
+	ctx->daemonclear = TRUE;
+	g_cond_broadcast (&ctx->daemoncond);
+	g_mutex_unlock (&ctx->cmdmutex);
 
 	return NULL;
 }
 
 
 /** \brief Radio control daemon main cycle (callback version).
- *  \param data Unused.
- *  \return Always TRUE.
+ *  \param data The rig.
+ *  \return Always FALSE; the callback re-arms itself.
  *
- * This function implements the main cycle of the radio control daemon. The executed
- * commands are defined in the DEF_RX_CYCLE and DEF_TX_CYCLE constant arrays.
+ * This function implements the main cycle of the radio control daemon when
+ * running without threads. Since it runs in the GTK main loop it executes
+ * at most one command per call and then re-arms itself with the delay that
+ * the thread version would sleep after that command, or with the time until
+ * the next polling command is due. Queued user commands and polling steps
+ * are executed alternately so that neither can starve the other.
  */
 static gint
 rig_daemon_cycle_cb  (gpointer data)
 {
-
+	rig_daemon_ctx_t *ctx;
 	grig_settings_t  *get;             /* pointer to shared data 'get' */
 	grig_settings_t  *set;             /* pointer to shared data 'set' */
 	grig_cmd_avail_t *new;             /* pointer to shared data 'new' */
 	grig_cmd_avail_t *has_get;         /* pointer to shared data 'has_get' */
 	grig_cmd_avail_t *has_set;         /* pointer to shared data 'has_set' */
 
-	guint step;        /* step counter */
+	gboolean tx;
+	gint64   start;
+	gint64   due;
+	guint    delay = 0;   /* delay until the next call [msec] */
+	gint     prev;
 
-	/* check whether the previous callback has terminated.
-	   if not, skip this cycle.
-	*/
-	if (timeout_busy == TRUE) {
-		return TRUE;
+
+	/* run with the main thread bound to our rig */
+	prev = rig_data_bind (GPOINTER_TO_INT (data));
+	ctx = RIG_DAEMON_CUR ();
+
+	/* this was a one-shot source */
+	ctx->timeoutid = 0;
+
+	/* stay disarmed while suspended; rig_daemon_set_suspend() re-arms us */
+	if (ctx->suspended) {
+		ctx->cbprev = 0;
+		rig_data_bind (prev);
+		return FALSE;
 	}
 
-	timeout_busy = TRUE;
+	ctx->timeout_busy = TRUE;
+	start = g_get_monotonic_time ();
+
+	/* one callback is one cycle; the time between the end of the
+	   previous callback and now has been spent idle */
+	if (ctx->cbprev != 0) {
+		rig_daemon_prof_cycle (start - ctx->cbprev);
+		rig_daemon_prof_idle (start - ctx->cbprev - ctx->cbstall.last);
+	}
+	ctx->cbprev = start;
 
 	/* get pointers to shared data */
 	get     = rig_data_get_get_addr ();
@@ -1020,10 +1241,6 @@ rig_daemon_cycle_cb  (gpointer data)
 	has_set = rig_data_get_has_set_addr ();
 
 
-	/* send a debug message */
-	grig_debug_local (RIG_DEBUG_TRACE, _("%s called."), __FUNCTION__);
-
-
 	/* first we check whether rig is powered ON since some rigs
 	   will not talk to us in power-off state.
 	   NOTE: code should be safe even if rig does not support
@@ -1032,72 +1249,571 @@ rig_daemon_cycle_cb  (gpointer data)
 	*/
 	if (get->pstat == RIG_POWER_ON) {
 
-		for (step = 0; step < C_MAX_CMD_PER_CYCLE; step++) {
+		/* check whether we are in RX or TX mode; */
+		tx = (get->ptt != RIG_PTT_OFF);
+
+		if (ctx->cbstep == CB_STEP_PSTAT) {
+			ctx->cbstep = CB_STEP_QUEUE;
+		}
 
-			/* check whether we are in RX or TX mode; */
-			if (get->ptt == RIG_PTT_OFF) {
+		/* execute one user command, if any */
+		if ((ctx->cbstep == CB_STEP_QUEUE) &&
+		    rig_daemon_flush_queue (0, 1, get, set, new, has_get, has_set)) {
 
-				/* Execute receiver command;
-				   sleep for cmd_delay ms if command has been executed
-				*/
-				if (rig_daemon_exec_cmd (DEF_RX_CYCLE[step],
-							 get,
-							 set,
-							 new,
-							 has_get,
-							 has_set)) {
 /* slow motion in debug mode */
 #ifdef GRIG_DEBUG
-					g_usleep (5000 * cmd_delay);
+			delay = (tx ? 10 : 5) * ctx->cmd_delay;
 #else
-					g_usleep (1000 * cmd_delay);
+			delay = (tx ? 2 : 1) * ctx->cmd_delay;
 #endif
-				}
+			ctx->cbstep = CB_STEP_POLL;
+		}
+
+		/* otherwise execute one polling command if due */
+		else {
+			ctx->cbstep = CB_STEP_QUEUE;
 
+			due = rig_daemon_poll_next_due (tx);
+
+			if (due > start) {
+				/* the initial values have been read */
+				rig_daemon_cb_probed ();
+
+				/* nothing due; sleep until it is, but wake up
+				   in time to notice RX/TX changes and re-probes */
+				delay = MIN ((due - start + 999) / 1000,
+					     C_RIG_DAEMON_MAX_IDLE);
 			}
-			else {
-				
-				/* Execute transmitter command;
-				   sleep for cmd_delay ms if command has been executed
-				*/
-				if (rig_daemon_exec_cmd (DEF_TX_CYCLE[step],
-							 get,
-							 set,
-							 new,
-							 has_get,
-							 has_set)) {
+			else if (rig_daemon_poll_step (tx, get, set, new,
+						       has_get, has_set)) {
 /* slow motion in debug mode */
 #ifdef GRIG_DEBUG
-					g_usleep (10000 * cmd_delay);
+				delay = (tx ? 10 : 5) * ctx->cmd_delay;
 #else
-					g_usleep (2000 * cmd_delay);
+				delay = (tx ? 2 : 1) * ctx->cmd_delay;
 #endif
-				}
 			}
 		}
 
 	}
 
-	/* otherwise check the power status only */
-	else {
+	/* otherwise check the power status only; alternate between
+	   trying to switch the rig on and reading back the status */
+	else if (ctx->cbstep != CB_STEP_PSTAT) {
+		/* nothing more to read while the rig is off */
+		rig_daemon_cb_probed ();
+
+		ctx->cbstep = CB_STEP_PSTAT;
+
 		if (rig_daemon_exec_cmd (RIG_CMD_SET_PSTAT, get, set, new, has_get, has_set)) {
 
 /* slow motion in debug mode */
 #ifdef GRIG_DEBUG
-			g_usleep (15000 * cmd_delay);
+			delay = 15 * ctx->cmd_delay;
 #else
-			g_usleep (3000 * cmd_delay);
+			delay = 3 * ctx->cmd_delay;
 #endif
 		}
+	}
+	else {
+		ctx->cbstep = CB_STEP_QUEUE;
 
 		rig_daemon_exec_cmd (RIG_CMD_GET_PSTAT, get, set, new, has_get, has_set);
+
+#ifdef GRIG_DEBUG
+		delay = 15 * ctx->cmd_delay;
+#else
+		delay = 3 * ctx->cmd_delay;
+#endif
 	}
 
+	rig_daemon_cb_stall (g_get_monotonic_time () - start);
+	grig_timeline_end ("timer", __FUNCTION__, start, "rig", GPOINTER_TO_INT (data));
 
-	timeout_busy = FALSE;
+	ctx->timeout_busy = FALSE;
 
+	/* user commands posted from here on must respect the delay */
+	ctx->cbearliest = g_get_monotonic_time () + 1000 * (gint64) delay;
+	rig_daemon_cb_arm (delay);
 
-	return TRUE;
+	rig_data_bind (prev);
+
+	return FALSE;
+}
+
+
+/** \brief Arm the daemon callback.
+ *  \param delay The delay before the next call [msec].
+ *
+ * This function (re)schedules rig_daemon_cycle_cb(), replacing any pending
+ * call. It is only used when the daemon runs without threads.
+ */
+static void
+rig_daemon_cb_arm           (guint delay)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	if (ctx->timeoutid > 0) {
+		g_source_remove (ctx->timeoutid);
+	}
+
+	ctx->cbnext = g_get_monotonic_time () + 1000 * (gint64) delay;
+	ctx->timeoutid = g_timeout_add (delay, rig_daemon_cycle_cb,
+					GINT_TO_POINTER (rig_data_current ()));
+}
+
+
+/** \brief Finish the initial polling pass.
+ *
+ * When the daemon runs without threads, the initial values are not read
+ * in one go by rig_daemon_probe() but by the first polling pass, one
+ * command per callback, since every command is due at start-up. This
+ * function is called once nothing is due any more and ends the "probe"
+ * start-up phase.
+ */
+static void
+rig_daemon_cb_probed        ()
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	if (!ctx->probe) {
+		return;
+	}
+
+	ctx->probe = FALSE;
+
+	grig_startup_end ("probe", rig_data_current (), ctx->cbprobe);
+	grig_startup_release ();
+}
+
+
+/** \brief Update the UI stall statistics.
+ *  \param stall The time spent in one call of rig_daemon_cycle_cb() [usec].
+ *
+ * When the daemon runs without threads, each callback blocks the GTK main
+ * loop. The duration of the callbacks is recorded in order to be able to
+ * verify that the GUI stays responsive.
+ */
+static void
+rig_daemon_cb_stall         (gint64 stall)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	ctx->cbstall.count++;
+	ctx->cbstall.last = stall;
+	ctx->cbstall.total += stall;
+	if (stall > ctx->cbstall.max) {
+		ctx->cbstall.max = stall;
+	}
+}
+
+
+/** \brief Check whether a command is supported by the rig.
+ *  \param cmd The command.
+ *  \param has_get Pointer to get capabilities record.
+ *  \param has_set Pointer to set capabilities record.
+ *  \return TRUE if the command is supported, FALSE otherwise.
+ */
+static gboolean
+rig_daemon_cmd_avail        (rig_cmd_t cmd,
+			     grig_cmd_avail_t *has_get,
+			     grig_cmd_avail_t *has_set)
+{
+	grig_cmd_avail_t *has;
+	gboolean          avail = FALSE;
+	guint             i;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return FALSE;
+	}
+
+	if (CMD_AVAIL[cmd].offset >= 0) {
+		has = CMD_AVAIL[cmd].set ? has_set : has_get;
+
+		return G_STRUCT_MEMBER (int, has, CMD_AVAIL[cmd].offset) ? TRUE : FALSE;
+	}
+
+	switch (cmd) {
+
+	case RIG_CMD_GET_MODE:
+		avail = has_get->mode || has_get->pbw;
+		break;
+
+	case RIG_CMD_SET_MODE:
+		avail = has_set->mode || has_set->pbw;
+		break;
+
+	case RIG_CMD_GET_FUNC:
+		for (i = 0; !avail && (i < RIG_SETTING_MAX); i++)
+			avail = has_get->funcs[i];
+		break;
+
+	case RIG_CMD_SET_FUNC:
+		for (i = 0; !avail && (i < RIG_SETTING_MAX); i++)
+			avail = has_set->funcs[i];
+		break;
+
+		/* not implemented */
+	case RIG_CMD_SET_COMP:
+	default:
+		break;
+	}
+
+	return avail ? TRUE : FALSE;
+}
+
+
+/** \brief Copy the capability flags of a command.
+ *  \param cmd The command.
+ *  \param dst The capabilities record to modify.
+ *  \param src The capabilities record to copy from or NULL to clear the flags.
+ */
+static void
+rig_daemon_cmd_copy_avail   (rig_cmd_t cmd,
+			     grig_cmd_avail_t *dst,
+			     const grig_cmd_avail_t *src)
+{
+	guint i;
+
+
+	if (CMD_AVAIL[cmd].offset >= 0) {
+		G_STRUCT_MEMBER (int, dst, CMD_AVAIL[cmd].offset) =
+			src ? G_STRUCT_MEMBER (int, src, CMD_AVAIL[cmd].offset) : 0;
+
+		return;
+	}
+
+	switch (cmd) {
+
+	case RIG_CMD_GET_MODE:
+	case RIG_CMD_SET_MODE:
+		dst->mode = src ? src->mode : 0;
+		dst->pbw  = src ? src->pbw  : 0;
+		break;
+
+	case RIG_CMD_GET_FUNC:
+	case RIG_CMD_SET_FUNC:
+		for (i = 0; i < RIG_SETTING_MAX; i++)
+			dst->funcs[i] = src ? src->funcs[i] : 0;
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+/** \brief Check whether a command is only executed on user request.
+ *  \param cmd The command.
+ *  \return TRUE for SET commands and VFO operations, FALSE for the
+ *          polling commands.
+ *
+ * User commands are queued by the GUI and never polled. Their errors
+ * may be caused by the requested value, so the anomaly manager does not
+ * disable them.
+ */
+gboolean
+rig_daemon_cmd_is_user      (rig_cmd_t cmd)
+{
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return FALSE;
+	}
+
+	return CMD_AVAIL[cmd].set ||
+		(cmd == RIG_CMD_SET_MODE) || (cmd == RIG_CMD_SET_FUNC) ||
+		(cmd == RIG_CMD_SET_COMP);
+}
+
+
+/** \brief Enable or disable a command.
+ *  \param cmd The command.
+ *  \param enable TRUE to restore the command, FALSE to disable it.
+ *
+ * This function is used by the anomaly manager to take a command out of
+ * service when the rig keeps rejecting it. Disabling a command clears its
+ * flags in has_get or has_set; enabling it restores the capabilities that
+ * have been detected at start-up.
+ */
+void
+rig_daemon_cmd_enable       (rig_cmd_t cmd, gboolean enable)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	grig_cmd_avail_t *has_get;
+	grig_cmd_avail_t *has_set;
+	gboolean          isset;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return;
+	}
+
+	has_get = rig_data_get_has_get_addr ();
+	has_set = rig_data_get_has_set_addr ();
+
+	isset = rig_daemon_cmd_is_user (cmd);
+
+	if (isset) {
+		rig_daemon_cmd_copy_avail (cmd, has_set, enable ? &ctx->origset : NULL);
+	}
+	else {
+		rig_daemon_cmd_copy_avail (cmd, has_get, enable ? &ctx->origget : NULL);
+	}
+
+	rig_daemon_poll_enable (cmd, rig_daemon_cmd_avail (cmd, has_get, has_set));
+}
+
+
+/** \brief Claim the pending flags of a command.
+ *  \param cmd The command.
+ *  \param new Pointer to the shared 'new' flags.
+ *  \param claimed Pointer to a structure where the claimed flags are stored.
+ *  \return TRUE if any flag has been claimed.
+ *
+ * This function atomically moves the 'new' flags used by a 'set' command
+ * from the shared structure to a private one. All other flags in the
+ * private structure are cleared.
+ *
+ * For RIG_CMD_SET_FUNC only one function is claimed, in round-robin order,
+ * so that a single execution never sends more than one command to the rig.
+ */
+static gboolean
+rig_daemon_claim_cmd        (rig_cmd_t cmd,
+			     grig_cmd_avail_t *new,
+			     grig_cmd_avail_t *claimed)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gboolean any = FALSE;
+	guint    i;
+	guint    j;
+
+
+	memset (claimed, 0, sizeof (grig_cmd_avail_t));
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return FALSE;
+	}
+
+	if (CMD_AVAIL[cmd].set && (CMD_AVAIL[cmd].offset >= 0)) {
+		any = rig_data_claim_new (&G_STRUCT_MEMBER (int, new, CMD_AVAIL[cmd].offset));
+		G_STRUCT_MEMBER (int, claimed, CMD_AVAIL[cmd].offset) = any;
+
+		return any;
+	}
+
+	switch (cmd) {
+
+	case RIG_CMD_SET_MODE:
+		claimed->mode = rig_data_claim_new (&new->mode);
+		claimed->pbw  = rig_data_claim_new (&new->pbw);
+		any = claimed->mode || claimed->pbw;
+		break;
+
+	case RIG_CMD_SET_FUNC:
+		/* one function per execution; the others stay pending */
+		for (j = 0; !any && (j < RIG_SETTING_MAX); j++) {
+			i = (ctx->setfuncidx + j) % RIG_SETTING_MAX;
+
+			if (rig_data_claim_new (&new->funcs[i])) {
+				claimed->funcs[i] = TRUE;
+				ctx->setfuncidx = (i + 1) % RIG_SETTING_MAX;
+				any = TRUE;
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return any;
+}
+
+
+/** \brief Execute the next due polling command.
+ *  \param tx TRUE if the rig is in TX mode.
+ *  \param get Pointer to the 'get' command buffer.
+ *  \param set Pointer to the 'set' command buffer.
+ *  \param new Pointer to the 'new' command buffer.
+ *  \param has_get Pointer to get capabilities record.
+ *  \param has_set Pointer to set capabilities record.
+ *  \return TRUE if the caller should sleep before the next step.
+ *
+ * This function asks the polling scheduler for the next due command and
+ * executes it. The caller should sleep if the command has been sent to the
+ * rig or if no command is due yet.
+ */
+static gboolean
+rig_daemon_poll_step        (gboolean tx,
+			     grig_settings_t  *get,
+			     grig_settings_t  *set,
+			     grig_cmd_avail_t *new,
+			     grig_cmd_avail_t *has_get,
+			     grig_cmd_avail_t *has_set)
+{
+	rig_cmd_t cmd;
+	gboolean  exec;
+	gint64    now;
+
+
+	rig_daemon_report_rate ();
+
+	/* values are only sent through the queue; catch any missed post */
+	rig_daemon_sweep_set (new);
+
+	/* give commands disabled after repeated errors another chance */
+	now = g_get_monotonic_time ();
+	rig_anomaly_reprobe (now);
+
+	cmd = rig_daemon_poll_next (tx, now);
+
+	/* nothing to do yet */
+	if (cmd == RIG_CMD_NONE) {
+		return TRUE;
+	}
+
+	exec = rig_daemon_exec_cmd (cmd, get, set, new, has_get, has_set);
+
+	/* wake up the GUI only if something has actually changed */
+	rig_data_mark_dirty (rig_daemon_poll_done (cmd, exec, tx, get));
+
+	return exec;
+}
+
+
+/** \brief Report the effective command rate.
+ *
+ * This function prints the number of commands per second sent to the
+ * rig, averaged over C_RIG_DAEMON_RATE_INTERVAL.
+ */
+static void
+rig_daemon_report_rate      ()
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gint64 now;
+	gint64 elapsed;
+
+
+	now = g_get_monotonic_time ();
+	elapsed = now - ctx->ratestart;
+
+	if (elapsed < 1000 * C_RIG_DAEMON_RATE_INTERVAL) {
+		return;
+	}
+
+	if (ctx->ratestart != 0) {
+		grig_debug_local (RIG_DEBUG_TRACE,
+				  _("%s: %d cmds in %.1f sec (%.1f cmds/sec)"),
+				  __FUNCTION__, ctx->ratecount, elapsed / 1.0e6,
+				  1.0e6 * ctx->ratecount / elapsed);
+	}
+
+	ctx->ratestart = now;
+	ctx->ratecount = 0;
+}
+
+
+/** \brief Queue the set commands whose value has not been sent.
+ *  \param new Pointer to the shared 'new' flags.
+ *
+ * The 'set' commands are not polled; a changed value is sent when its
+ * command is taken from the queue. As a safety net, this function looks
+ * for 'new' flags without queued command every
+ * C_RIG_DAEMON_SWEEP_INTERVAL and posts the command. It is called by the
+ * daemon between two commands, so no command is being executed.
+ */
+static void
+rig_daemon_sweep_set        (grig_cmd_avail_t *new)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	rig_cmd_t cmd;
+	gint64    now;
+
+
+	now = g_get_monotonic_time ();
+
+	if (now - ctx->sweeptime < 1000 * C_RIG_DAEMON_SWEEP_INTERVAL) {
+		return;
+	}
+
+	ctx->sweeptime = now;
+
+	for (cmd = RIG_CMD_NONE + 1; cmd < RIG_CMD_NUMBER; cmd++) {
+
+		if (rig_daemon_cmd_pending (cmd, new) && !rig_daemon_cmd_queued (cmd)) {
+			grig_debug_local (RIG_DEBUG_VERBOSE,
+					  _("%s: %s has an unsent value; queued"),
+					  __FUNCTION__, CMD_TO_STR[cmd]);
+			rig_daemon_post_cmd (cmd);
+		}
+	}
+}
+
+
+/** \brief Find the next function in round-robin order.
+ *  \param flags Array of RIG_SETTING_MAX flags, eg. has_get->funcs.
+ *  \param next Pointer to the index where the search starts; updated.
+ *  \return The index of the next function with its flag set or -1.
+ */
+static gint
+rig_daemon_next_func        (const int *flags, guint *next)
+{
+	guint i;
+	guint j;
+
+
+	for (j = 0; j < RIG_SETTING_MAX; j++) {
+		i = (*next + j) % RIG_SETTING_MAX;
+
+		if (flags[i]) {
+			*next = (i + 1) % RIG_SETTING_MAX;
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+
+/** \brief Check whether a set command has a value waiting to be sent.
+ *  \param cmd The command.
+ *  \param new Pointer to the shared 'new' flags.
+ *  \return TRUE if at least one flag of the command is set.
+ *
+ * For RIG_CMD_SET_FUNC, any function flag counts.
+ */
+static gboolean
+rig_daemon_cmd_pending      (rig_cmd_t cmd, grig_cmd_avail_t *new)
+{
+	guint i;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return FALSE;
+	}
+
+	if (CMD_AVAIL[cmd].set && (CMD_AVAIL[cmd].offset >= 0)) {
+		return g_atomic_int_get (&G_STRUCT_MEMBER (int, new, CMD_AVAIL[cmd].offset));
+	}
+
+	switch (cmd) {
+
+	case RIG_CMD_SET_MODE:
+		return g_atomic_int_get (&new->mode) || g_atomic_int_get (&new->pbw);
+
+	case RIG_CMD_SET_FUNC:
+		for (i = 0; i < RIG_SETTING_MAX; i++) {
+			if (g_atomic_int_get (&new->funcs[i]))
+				return TRUE;
+		}
+		return FALSE;
+
+	default:
+		return FALSE;
+	}
 }
 
 
@@ -1121,6 +1837,10 @@ rig_daemon_cycle_cb  (gpointer data)
  * \note The 'get' commands use local buffers for the acquired value and do not
  *       write directly to the shared memory. This way the contents of the shared memory
  *       do not get corrupted if the command execution was erroneous.
+ *
+ * \note A 'set' command does not copy the value it has sent to 'get' if the
+ *       user has changed the value again during the execution; the newer
+ *       value is pending and will be sent by the next execution.
  */
 static gint
 rig_daemon_exec_cmd         (rig_cmd_t cmd,
@@ -1131,10 +1851,33 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			     grig_cmd_avail_t *has_set)
 
 {
-	int  retcode;
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	int  retcode = RIG_OK;
 	gint status = 0;
 	setting_t func;
 	int i;
+	grig_settings_t  setcopy;   /* consistent copy of 'set' */
+	grig_cmd_avail_t claimed;   /* 'new' flags claimed for this command */
+	grig_cmd_avail_t *pending;  /* the shared 'new' flags */
+	gint64 start;
+	gboolean failed;
+
+
+	start = g_get_monotonic_time ();
+
+	/* claim the pending flags before reading the new values; a value
+	   written by the user after this point raises the flag again and
+	   will be sent next time.
+	*/
+	if (rig_daemon_claim_cmd (cmd, new, &claimed)) {
+		rig_data_snapshot_set (&setcopy);
+		set = &setcopy;
+	}
+	pending = new;
+	new = &claimed;
+
+	/* tag the debug messages of this command */
+	grig_debug_set_cmd (cmd);
 
 
 	switch (cmd) {
@@ -1151,18 +1894,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			freq_t freq;
 
 			/* try to execute command */
-			retcode = rig_get_freq (myrig, RIG_VFO_CURR, &freq);
+			retcode = rig_get_freq (ctx->rig, RIG_VFO_CURR, &freq);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_FREQ_1:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_FREQ_1:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_FREQ_1);
+				rig_anomaly_raise (RIG_CMD_GET_FREQ_1, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->freq1 = freq;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1178,20 +1923,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		if (has_set->freq1 && new->freq1) {
 
 			/* try to execute command */
-			retcode = rig_set_freq (myrig, RIG_VFO_CURR, set->freq1);
+			retcode = rig_set_freq (ctx->rig, RIG_VFO_CURR, set->freq1);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_FREQ_1:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_FREQ_1:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_FREQ_1);
+				rig_anomaly_raise (RIG_CMD_SET_FREQ_1, retcode);
 			}
 
                         /* reset flag */
 			new->freq1 = FALSE;
-			get->freq1 = set->freq1;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->freq1))
+				get->freq1 = set->freq1;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1248,18 +1996,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			}
 
 			/* try to execute command */
-			retcode = rig_get_freq (myrig, vfo, &freq);
+			retcode = rig_get_freq (ctx->rig, vfo, &freq);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_FREQ_2:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_FREQ_2:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_FREQ_2);
+				rig_anomaly_raise (RIG_CMD_GET_FREQ_2, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->freq2 = freq;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1316,20 +2066,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			}
 
 			/* try to execute command */
-			retcode = rig_set_freq (myrig, vfo, set->freq2);
+			retcode = rig_set_freq (ctx->rig, vfo, set->freq2);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_FREQ_2:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_FREQ_2:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_FREQ_2);
+				rig_anomaly_raise (RIG_CMD_SET_FREQ_2, retcode);
 			}
 
 			/* reset flag */
 			new->freq2 = FALSE;
-			get->freq2 = set->freq2;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->freq2))
+				get->freq2 = set->freq2;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1345,18 +2098,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			shortfreq_t rit;
 
 			/* try to execute command */
-			retcode = rig_get_rit (myrig, RIG_VFO_CURR, &rit);
+			retcode = rig_get_rit (ctx->rig, RIG_VFO_CURR, &rit);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_RIT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_RIT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_RIT);
+				rig_anomaly_raise (RIG_CMD_GET_RIT, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->rit = rit;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1372,20 +2127,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		if (has_set->rit && new->rit) {
 
 			/* try to execute command */
-			retcode = rig_set_rit (myrig, RIG_VFO_CURR, set->rit);
+			retcode = rig_set_rit (ctx->rig, RIG_VFO_CURR, set->rit);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_RIT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_RIT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_RIT);
+				rig_anomaly_raise (RIG_CMD_SET_RIT, retcode);
 			}
 
 			/* reset flag */
 			new->rit = FALSE;
-			get->rit = set->rit;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->rit))
+				get->rit = set->rit;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1401,18 +2159,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			shortfreq_t xit;
 
 			/* try to execute command */
-			retcode = rig_get_xit (myrig, RIG_VFO_CURR, &xit);
+			retcode = rig_get_xit (ctx->rig, RIG_VFO_CURR, &xit);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_XIT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_XIT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_XIT);
+				rig_anomaly_raise (RIG_CMD_GET_XIT, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->xit = xit;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1428,20 +2188,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		if (has_set->xit && new->xit) {
 
 			/* try to execute command */
-			retcode = rig_set_xit (myrig, RIG_VFO_CURR, set->xit);
+			retcode = rig_set_xit (ctx->rig, RIG_VFO_CURR, set->xit);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_XIT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_XIT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_XIT);
+				rig_anomaly_raise (RIG_CMD_SET_XIT, retcode);
 			}
 
 			/* reset flag */
 			new->xit = FALSE;
-			get->xit = set->xit;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->xit))
+				get->xit = set->xit;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1457,18 +2220,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			vfo_t vfo;
 
 			/* try to execute command */
-			retcode = rig_get_vfo (myrig, &vfo);
+			retcode = rig_get_vfo (ctx->rig, &vfo);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_VFO:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_VFO:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_VFO);
+				rig_anomaly_raise (RIG_CMD_GET_VFO, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->vfo = vfo;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1484,20 +2249,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		if (has_set->vfo && new->vfo) {
 
 			/* try to execute command */
-			retcode = rig_set_vfo (myrig, set->vfo);
+			retcode = rig_set_vfo (ctx->rig, set->vfo);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_VFO:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_VFO:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_VFO);
+				rig_anomaly_raise (RIG_CMD_SET_VFO, retcode);
 			}
 
 			/* reset flag */
 			new->vfo = FALSE;
-			get->vfo = set->vfo;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->vfo))
+				get->vfo = set->vfo;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1513,18 +2281,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			powerstat_t pstat;
 
 			/* try to execute command */
-			retcode = rig_get_powerstat (myrig, &pstat);
+			retcode = rig_get_powerstat (ctx->rig, &pstat);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_PSTAT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_PSTAT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_PSTAT);
+				rig_anomaly_raise (RIG_CMD_GET_PSTAT, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->pstat = pstat;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1540,20 +2310,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		if (has_set->pstat && new->pstat) {
 
 			/* try to execute command */
-			retcode = rig_set_powerstat (myrig, set->pstat);
+			retcode = rig_set_powerstat (ctx->rig, set->pstat);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_PSTAT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_PSTAT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_PSTAT);
+				rig_anomaly_raise (RIG_CMD_SET_PSTAT, retcode);
 			}
 
 			/* reset flag */
 			new->pstat = FALSE;
-			get->pstat = set->pstat;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->pstat))
+				get->pstat = set->pstat;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1569,18 +2342,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			ptt_t ptt;
 
 			/* try to execute command */
-			retcode = rig_get_ptt (myrig, RIG_VFO_CURR, &ptt);
+			retcode = rig_get_ptt (ctx->rig, RIG_VFO_CURR, &ptt);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_PTT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_PTT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_PTT);
+				rig_anomaly_raise (RIG_CMD_GET_PTT, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->ptt = ptt;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1596,20 +2371,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		if (has_set->ptt && new->ptt) {
 
 			/* try to execute command */
-			retcode = rig_set_ptt (myrig, RIG_VFO_CURR, set->ptt);
+			retcode = rig_set_ptt (ctx->rig, RIG_VFO_CURR, set->ptt);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_PTT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_PTT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_PTT);
+				rig_anomaly_raise (RIG_CMD_SET_PTT, retcode);
 			}
 
 			/* reset flag */
 			new->ptt = FALSE;
-			get->ptt = set->ptt;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->ptt))
+				get->ptt = set->ptt;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1626,19 +2404,21 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			pbwidth_t pbw;
 
 			/* try to execute command */
-			retcode = rig_get_mode (myrig, RIG_VFO_CURR, &mode, &pbw);
+			retcode = rig_get_mode (ctx->rig, RIG_VFO_CURR, &mode, &pbw);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_MODE:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_MODE:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_MODE);
+				rig_anomaly_raise (RIG_CMD_GET_MODE, retcode);
 			}
 			else {
 				int i = 0;           /* iterator */
 				int found_mode = 0;  /* flag to indicate found mode */
+				rig_data_pbw_t pbwd; /* converted passband width */
+				shortfreq_t    step; /* tuning step for new mode */
 
 				/* convert and store the new passband width;
 				   note: RIG_PASSBAND_NORMAL = 0, which is also
@@ -1646,40 +2426,48 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 				   rig_passband_narrow if these passbands are not
 				   defined in the backend.
 				*/
-				if ((pbw == rig_passband_wide (myrig, mode)) &&
+				if ((pbw == rig_passband_wide (ctx->rig, mode)) &&
 				    (pbw > 0)) {
-					get->pbw = RIG_DATA_PB_WIDE;
+					pbwd = RIG_DATA_PB_WIDE;
 				}
-				else if ((pbw == rig_passband_narrow (myrig, mode)) &&
+				else if ((pbw == rig_passband_narrow (ctx->rig, mode)) &&
 					 (pbw > 0)) {
-					get->pbw  = RIG_DATA_PB_NARROW;
+					pbwd = RIG_DATA_PB_NARROW;
 				}
 				else {
-					get->pbw  = RIG_DATA_PB_NORMAL;
+					pbwd = RIG_DATA_PB_NORMAL;
 				}
 
+				rig_data_write_begin ();
+				get->pbw = pbwd;
+				rig_data_write_end ();
+
 				/* if mode has changed we need to update frequency limits */
 				if (get->mode != mode) {
 
+					rig_data_write_begin ();
 					get->mode = mode;
+					rig_data_write_end ();
 
 					/* FIXME: VY SIMILAR CODE IS PRESENT IN RIG_DAEMON_CHECK_MODE */
 
 					/* get frequency limits for this mode; we use the rx_range_list
 					   stored in the rig_state structure
 					*/
-					while (!RIG_IS_FRNG_END(myrig->state.rx_range_list[i]) && !found_mode) {
+					while (!RIG_IS_FRNG_END(ctx->rig->state.rx_range_list[i]) && !found_mode) {
 						
 						/* is this list good for current mode?
 						   is the current frequency within this range?
 						*/
-						if (((mode & myrig->state.rx_range_list[i].modes) == mode) &&
-						    (get->freq1 >= myrig->state.rx_range_list[i].startf)   &&
-						    (get->freq1 <= myrig->state.rx_range_list[i].endf)) {
+						if (((mode & ctx->rig->state.rx_range_list[i].modes) == mode) &&
+						    (get->freq1 >= ctx->rig->state.rx_range_list[i].startf)   &&
+						    (get->freq1 <= ctx->rig->state.rx_range_list[i].endf)) {
 
 							found_mode = 1;
-							get->fmin = myrig->state.rx_range_list[i].startf;
-							get->fmax = myrig->state.rx_range_list[i].endf;
+							rig_data_write_begin ();
+							get->fmin = ctx->rig->state.rx_range_list[i].startf;
+							get->fmax = ctx->rig->state.rx_range_list[i].endf;
+							rig_data_write_end ();
 				
 							grig_debug_local (RIG_DEBUG_VERBOSE,
 									  _("%s: Found frequency range for mode %d"),
@@ -1710,7 +2498,11 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 					}
 
 					/* get the smallest tuning step */
-					get->fstep = rig_get_resolution (myrig, mode);
+					step = rig_get_resolution (ctx->rig, mode);
+
+					rig_data_write_begin ();
+					get->fstep = step;
+					rig_data_write_end ();
 				}
 			}
 
@@ -1739,56 +2531,62 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			if (new->pbw) {
 				switch (set->pbw) {
 				case RIG_DATA_PB_WIDE:
-					pbw = rig_passband_wide (myrig, mode);
+					pbw = rig_passband_wide (ctx->rig, mode);
 					break;
 				case RIG_DATA_PB_NORMAL:
-					pbw = rig_passband_normal (myrig, mode);
+					pbw = rig_passband_normal (ctx->rig, mode);
 					break;
 				case RIG_DATA_PB_NARROW:
-					pbw = rig_passband_narrow (myrig, mode);
+					pbw = rig_passband_narrow (ctx->rig, mode);
 					break;
 				default:
 					/* we have no idea what to set! */
-					pbw = rig_passband_normal (myrig, mode);
+					pbw = rig_passband_normal (ctx->rig, mode);
 					break;
 				}
 			}
 			else {
 				switch (get->pbw) {
 				case RIG_DATA_PB_WIDE:
-					pbw = rig_passband_wide (myrig, mode);
+					pbw = rig_passband_wide (ctx->rig, mode);
 					break;
 				case RIG_DATA_PB_NORMAL:
-					pbw = rig_passband_normal (myrig, mode);
+					pbw = rig_passband_normal (ctx->rig, mode);
 					break;
 				case RIG_DATA_PB_NARROW:
-					pbw = rig_passband_narrow (myrig, mode);
+					pbw = rig_passband_narrow (ctx->rig, mode);
 					break;
 				default:
 					/* we have no idea what to set! */
-					pbw = rig_passband_normal (myrig, mode);
+					pbw = rig_passband_normal (ctx->rig, mode);
 					break;
 				}
 			}
 
 			/* try to execute command */
-			retcode = rig_set_mode (myrig, RIG_VFO_CURR, set->mode, pbw);
+			retcode = rig_set_mode (ctx->rig, RIG_VFO_CURR, set->mode, pbw);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_MODE:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_MODE:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_MODE);
+				rig_anomaly_raise (RIG_CMD_SET_MODE, retcode);
 			}
 
 			if (new->mode) {
-				get->mode = set->mode;
+				rig_data_write_begin ();
+				if (!g_atomic_int_get (&pending->mode))
+					get->mode = set->mode;
+				rig_data_write_end ();
 				new->mode = FALSE;
 			}
 			if (new->pbw) {
-				get->pbw  = set->pbw;
+				rig_data_write_begin ();
+				if (!g_atomic_int_get (&pending->pbw))
+					get->pbw  = set->pbw;
+				rig_data_write_end ();
 				new->pbw  = FALSE;
 			}
 			status = 1;
@@ -1806,18 +2604,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_AGC, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_AGC, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_AGC:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_AGC:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_AGC);
+				rig_anomaly_raise (RIG_CMD_GET_AGC, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->agc = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1836,19 +2636,22 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->agc;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_AGC, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_AGC, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_AGC:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_AGC:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_AGC);
+				rig_anomaly_raise (RIG_CMD_SET_AGC, retcode);
 			}
 			/* reset flag */
 			new->agc = FALSE;
-			get->agc = set->agc;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->agc))
+				get->agc = set->agc;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1864,18 +2667,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ATT, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_ATT, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_ATT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_ATT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_ATT);
+				rig_anomaly_raise (RIG_CMD_GET_ATT, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->att = val.i;
+				rig_data_write_end ();
 			}
 		}
 		
@@ -1892,19 +2697,22 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->att;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ATT, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_ATT, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_ATT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_ATT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_ATT);
+				rig_anomaly_raise (RIG_CMD_SET_ATT, retcode);
 			}
 			/* reset flag */
 			new->att = FALSE;
-			get->att = set->att;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->att))
+				get->att = set->att;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1920,18 +2728,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PREAMP, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_PREAMP, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_PREAMP:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_PREAMP:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_PREAMP);
+				rig_anomaly_raise (RIG_CMD_GET_PREAMP, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->preamp = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -1950,19 +2760,22 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->preamp;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PREAMP, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_PREAMP, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_PREAMP:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_PREAMP:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_PREAMP);
+				rig_anomaly_raise (RIG_CMD_SET_PREAMP, retcode);
 			}
 			/* reset flag */
 			new->preamp = FALSE;
-			get->preamp = set->preamp;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->preamp))
+				get->preamp = set->preamp;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -1978,18 +2791,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_STRENGTH, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_STRENGTH, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_STRENGTH:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_STRENGTH:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_STRENGTH);
+				rig_anomaly_raise (RIG_CMD_GET_STRENGTH, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->strength = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2007,20 +2822,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->power;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_RFPOWER, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_RFPOWER, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_POWER:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_POWER:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_POWER);
+				rig_anomaly_raise (RIG_CMD_SET_POWER, retcode);
 			}
 
 			/* reset flag */
 			new->power = FALSE;
-			get->power = set->power;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->power))
+				get->power = set->power;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2035,18 +2853,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_RFPOWER, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_RFPOWER, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_POWER:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_POWER:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_POWER);
+				rig_anomaly_raise (RIG_CMD_GET_POWER, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->power = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2062,18 +2882,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_SWR, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_SWR, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_SWR:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_SWR:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_SWR);
+				rig_anomaly_raise (RIG_CMD_GET_SWR, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->swr = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2089,18 +2911,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ALC, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_ALC, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_ALC:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_ALC:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_ALC);
+				rig_anomaly_raise (RIG_CMD_GET_ALC, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->alc = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2118,15 +2942,15 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->alc;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ALC, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_ALC, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_ALC:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_ALC:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_ALC);
+				rig_anomaly_raise (RIG_CMD_SET_ALC, retcode);
 			}
 
 			/* reset flag */
@@ -2141,20 +2965,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 	case RIG_CMD_SET_LOCK:
 
 		if (has_set->lock && new->lock) {
-			retcode = rig_set_func (myrig,
+			retcode = rig_set_func (ctx->rig,
 						RIG_VFO_CURR,
 						RIG_FUNC_LOCK,
 						set->lock);
 
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_LOCK:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_LOCK:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_LOCK);
+				rig_anomaly_raise (RIG_CMD_SET_LOCK, retcode);
 			}
 			
-			get->lock = set->lock;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->lock))
+				get->lock = set->lock;
+			rig_data_write_end ();
 			new->lock = 0;
 
 			status = 1;
@@ -2170,18 +2997,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			int lock;
 
 			/* try to execute command */
-			retcode = rig_get_func (myrig, RIG_VFO_CURR, RIG_FUNC_LOCK, &lock);
+			retcode = rig_get_func (ctx->rig, RIG_VFO_CURR, RIG_FUNC_LOCK, &lock);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_LOCK:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_LOCK:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_LOCK);
+				rig_anomaly_raise (RIG_CMD_GET_LOCK, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->lock = lock;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2194,15 +3023,15 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 
 		if (has_set->vfo_op_toggle && new->vfo_op_toggle) {
 
-			retcode = rig_vfo_op (myrig, RIG_VFO_CURR, RIG_OP_TOGGLE);
+			retcode = rig_vfo_op (ctx->rig, RIG_VFO_CURR, RIG_OP_TOGGLE);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_VFO_TOGGLE:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_VFO_TOGGLE:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_VFO_TOGGLE);
+				rig_anomaly_raise (RIG_CMD_VFO_TOGGLE, retcode);
 			}
 
 			new->vfo_op_toggle = 0;
@@ -2217,15 +3046,15 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 
 		if (has_set->vfo_op_copy && new->vfo_op_copy) {
 
-			retcode = rig_vfo_op (myrig, RIG_VFO_CURR, RIG_OP_CPY);
+			retcode = rig_vfo_op (ctx->rig, RIG_VFO_CURR, RIG_OP_CPY);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_VFO_COPY:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_VFO_COPY:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_VFO_COPY);
+				rig_anomaly_raise (RIG_CMD_VFO_COPY, retcode);
 			}
 
 			new->vfo_op_copy = 0;
@@ -2240,15 +3069,15 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 
 		if (has_set->vfo_op_xchg && new->vfo_op_xchg) {
 
-			retcode = rig_vfo_op (myrig, RIG_VFO_CURR, RIG_OP_XCHG);
+			retcode = rig_vfo_op (ctx->rig, RIG_VFO_CURR, RIG_OP_XCHG);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_VFO_XCHG:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_VFO_XCHG:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_VFO_XCHG);
+				rig_anomaly_raise (RIG_CMD_VFO_XCHG, retcode);
 			}
 
 			new->vfo_op_xchg = 0;
@@ -2262,15 +3091,15 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 	case RIG_CMD_SET_SPLIT:
 		if (has_set->split && new->split) {
 
-			retcode = rig_set_split_vfo (myrig, RIG_VFO_RX, set->split, RIG_VFO_TX);
+			retcode = rig_set_split_vfo (ctx->rig, RIG_VFO_RX, set->split, RIG_VFO_TX);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_SPLIT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_SPLIT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_SPLIT);
+				rig_anomaly_raise (RIG_CMD_SET_SPLIT, retcode);
 			}
 
 			new->split = 0;
@@ -2284,15 +3113,15 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		if (has_get->split) {
             vfo_t tx_vfo;
 
-			retcode = rig_get_split_vfo (myrig, RIG_VFO_RX, &get->split, &tx_vfo);
+			retcode = rig_get_split_vfo (ctx->rig, RIG_VFO_RX, &get->split, &tx_vfo);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_SPLIT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_SPLIT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_SPLIT);
+				rig_anomaly_raise (RIG_CMD_GET_SPLIT, retcode);
 			}
 
 			status = 1;
@@ -2309,20 +3138,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->afg;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_AF, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_AF, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_AF:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_AF:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_AF);
+				rig_anomaly_raise (RIG_CMD_SET_AF, retcode);
 			}
 
 			/* reset flag */
 			new->afg = FALSE;
-			get->afg = set->afg;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->afg))
+				get->afg = set->afg;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2334,18 +3166,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_AF, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_AF, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_AF:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_AF:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_AF);
+				rig_anomaly_raise (RIG_CMD_GET_AF, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->afg = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2360,20 +3194,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->rfg;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_RF, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_RF, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_RF:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_RF:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_RF);
+				rig_anomaly_raise (RIG_CMD_SET_RF, retcode);
 			}
 
 			/* reset flag */
 			new->rfg = FALSE;
-			get->rfg = set->rfg;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->rfg))
+				get->rfg = set->rfg;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2385,18 +3222,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_RF, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_RF, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_RF:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_RF:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_RF);
+				rig_anomaly_raise (RIG_CMD_GET_RF, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->rfg = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2411,20 +3250,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->sql;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_SQL, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_SQL, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_SQL:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_SQL:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_SQL);
+				rig_anomaly_raise (RIG_CMD_SET_SQL, retcode);
 			}
 
 			/* reset flag */
 			new->sql = FALSE;
-			get->sql = set->sql;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->sql))
+				get->sql = set->sql;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2436,18 +3278,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_SQL, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_SQL, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_SQL:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_SQL:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_SQL);
+				rig_anomaly_raise (RIG_CMD_GET_SQL, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->sql = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2462,20 +3306,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->ifs;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_IF, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_IF, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_IFS:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_IFS:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_IFS);
+				rig_anomaly_raise (RIG_CMD_SET_IFS, retcode);
 			}
 
 			/* reset flag */
 			new->ifs = FALSE;
-			get->ifs = set->ifs;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->ifs))
+				get->ifs = set->ifs;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2487,18 +3334,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_IF, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_IF, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_IFS:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_IFS:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_IFS);
+				rig_anomaly_raise (RIG_CMD_GET_IFS, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->ifs = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2513,20 +3362,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->apf;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_APF, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_APF, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_APF:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_APF:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_APF);
+				rig_anomaly_raise (RIG_CMD_SET_APF, retcode);
 			}
 
 			/* reset flag */
 			new->apf = FALSE;
-			get->apf = set->apf;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->apf))
+				get->apf = set->apf;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2538,18 +3390,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_APF, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_APF, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_APF:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_APF:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_APF);
+				rig_anomaly_raise (RIG_CMD_GET_APF, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->apf = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2564,20 +3418,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->nr;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_NR, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_NR, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_NR:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_NR:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_NR);
+				rig_anomaly_raise (RIG_CMD_SET_NR, retcode);
 			}
 
 			/* reset flag */
 			new->nr = FALSE;
-			get->nr = set->nr;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->nr))
+				get->nr = set->nr;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2589,18 +3446,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_NR, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_NR, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_NR:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_NR:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_NR);
+				rig_anomaly_raise (RIG_CMD_GET_NR, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->nr = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2615,20 +3474,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->notch;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_NOTCHF, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_NOTCHF, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_NOTCH:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_NOTCH:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_NOTCH);
+				rig_anomaly_raise (RIG_CMD_SET_NOTCH, retcode);
 			}
 
 			/* reset flag */
 			new->notch = FALSE;
-			get->notch = set->notch;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->notch))
+				get->notch = set->notch;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2640,18 +3502,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_NOTCHF, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_NOTCHF, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_NOTCH:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_NOTCH:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_NOTCH);
+				rig_anomaly_raise (RIG_CMD_GET_NOTCH, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->notch = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2666,20 +3530,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->pbtin;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PBT_IN, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_PBT_IN, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_PBT_IN:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_PBT_IN:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_PBT_IN);
+				rig_anomaly_raise (RIG_CMD_SET_PBT_IN, retcode);
 			}
 
 			/* reset flag */
 			new->pbtin = FALSE;
-			get->pbtin = set->pbtin;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->pbtin))
+				get->pbtin = set->pbtin;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2691,18 +3558,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PBT_IN, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_PBT_IN, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_PBT_IN:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_PBT_IN:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_PBT_IN);
+				rig_anomaly_raise (RIG_CMD_GET_PBT_IN, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->pbtin = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2717,20 +3586,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->pbtout;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PBT_OUT, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_PBT_OUT, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_PBT_OUT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_PBT_OUT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_PBT_OUT);
+				rig_anomaly_raise (RIG_CMD_SET_PBT_OUT, retcode);
 			}
 
 			/* reset flag */
 			new->pbtout = FALSE;
-			get->pbtout = set->pbtout;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->pbtout))
+				get->pbtout = set->pbtout;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2742,18 +3614,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_PBT_OUT, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_PBT_OUT, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_PBT_OUT:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_PBT_OUT:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_PBT_OUT);
+				rig_anomaly_raise (RIG_CMD_GET_PBT_OUT, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->pbtout = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2768,20 +3642,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->cwpitch;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_CWPITCH, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_CWPITCH, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_CW_PITCH:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_CW_PITCH:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_CW_PITCH);
+				rig_anomaly_raise (RIG_CMD_SET_CW_PITCH, retcode);
 			}
 
 			/* reset flag */
 			new->cwpitch = FALSE;
-			get->cwpitch = set->cwpitch;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->cwpitch))
+				get->cwpitch = set->cwpitch;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2793,18 +3670,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_CWPITCH, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_CWPITCH, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_CW_PITCH:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_CW_PITCH:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_CW_PITCH);
+				rig_anomaly_raise (RIG_CMD_GET_CW_PITCH, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->cwpitch = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2819,20 +3698,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->keyspd;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_KEYSPD, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_KEYSPD, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_KEYSPD:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_KEYSPD:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_KEYSPD);
+				rig_anomaly_raise (RIG_CMD_SET_KEYSPD, retcode);
 			}
 
 			/* reset flag */
 			new->keyspd = FALSE;
-			get->keyspd = set->keyspd;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->keyspd))
+				get->keyspd = set->keyspd;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2844,18 +3726,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_KEYSPD, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_KEYSPD, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_KEYSPD:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_KEYSPD:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_KEYSPD);
+				rig_anomaly_raise (RIG_CMD_GET_KEYSPD, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->keyspd = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2870,20 +3754,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->bkindel;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_BKINDL, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_BKINDL, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_BKINDEL:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_BKINDEL:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_BKINDEL);
+				rig_anomaly_raise (RIG_CMD_SET_BKINDEL, retcode);
 			}
 
 			/* reset flag */
 			new->bkindel = FALSE;
-			get->bkindel = set->bkindel;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->bkindel))
+				get->bkindel = set->bkindel;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2895,18 +3782,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_BKINDL, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_BKINDL, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_BKINDEL:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_BKINDEL:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_BKINDEL);
+				rig_anomaly_raise (RIG_CMD_GET_BKINDEL, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->bkindel = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2921,20 +3810,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->balance;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_BALANCE, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_BALANCE, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_BALANCE:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_BALANCE:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_BALANCE);
+				rig_anomaly_raise (RIG_CMD_SET_BALANCE, retcode);
 			}
 
 			/* reset flag */
 			new->balance = FALSE;
-			get->balance = set->balance;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->balance))
+				get->balance = set->balance;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2946,18 +3838,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_BALANCE, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_BALANCE, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_BALANCE:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_BALANCE:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_BALANCE);
+				rig_anomaly_raise (RIG_CMD_GET_BALANCE, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->balance = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -2972,20 +3866,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.i = set->voxdel;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_VOXDELAY, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_VOXDELAY, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_VOXDEL:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_VOXDEL:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_VOXDEL);
+				rig_anomaly_raise (RIG_CMD_SET_VOXDEL, retcode);
 			}
 
 			/* reset flag */
 			new->voxdel = FALSE;
-			get->voxdel = set->voxdel;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->voxdel))
+				get->voxdel = set->voxdel;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -2997,18 +3894,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_VOXDELAY, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_VOXDELAY, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_VOXDEL:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_VOXDEL:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_VOXDEL);
+				rig_anomaly_raise (RIG_CMD_GET_VOXDEL, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->voxdel = val.i;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -3023,20 +3922,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->voxg;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_VOXGAIN, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_VOXGAIN, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_VOXGAIN:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_VOXGAIN:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_VOXGAIN);
+				rig_anomaly_raise (RIG_CMD_SET_VOXGAIN, retcode);
 			}
 
 			/* reset flag */
 			new->voxg = FALSE;
-			get->voxg = set->voxg;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->voxg))
+				get->voxg = set->voxg;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -3048,18 +3950,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_VOXGAIN, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_VOXGAIN, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_VOXGAIN:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_VOXGAIN:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_VOXGAIN);
+				rig_anomaly_raise (RIG_CMD_GET_VOXGAIN, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->voxg = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -3074,20 +3978,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->antivox;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ANTIVOX, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_ANTIVOX, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_ANTIVOX:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_ANTIVOX:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_ANTIVOX);
+				rig_anomaly_raise (RIG_CMD_SET_ANTIVOX, retcode);
 			}
 
 			/* reset flag */
 			new->antivox = FALSE;
-			get->antivox = set->antivox;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->antivox))
+				get->antivox = set->antivox;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -3099,18 +4006,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_ANTIVOX, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_ANTIVOX, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_ANTIVOX:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_ANTIVOX:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_ANTIVOX);
+				rig_anomaly_raise (RIG_CMD_GET_ANTIVOX, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->antivox = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -3125,20 +4034,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			val.f = set->micg;
 
 			/* try to execute command */
-			retcode = rig_set_level (myrig, RIG_VFO_CURR, RIG_LEVEL_MICGAIN, val);
+			retcode = rig_set_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_MICGAIN, val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_SET_MICGAIN:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_SET_MICGAIN:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_SET_MICGAIN);
+				rig_anomaly_raise (RIG_CMD_SET_MICGAIN, retcode);
 			}
 
 			/* reset flag */
 			new->micg = FALSE;
-			get->micg = set->micg;
+			rig_data_write_begin ();
+			if (!g_atomic_int_get (&pending->micg))
+				get->micg = set->micg;
+			rig_data_write_end ();
 
 			status = 1;
 		}
@@ -3150,18 +4062,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_MICGAIN, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_MICGAIN, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_MICGAIN:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_MICGAIN:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_MICGAIN);
+				rig_anomaly_raise (RIG_CMD_GET_MICGAIN, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->micg = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -3177,18 +4091,20 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 			value_t val;
 
 			/* try to execute command */
-			retcode = rig_get_level (myrig, RIG_VFO_CURR, RIG_LEVEL_COMP, &val);
+			retcode = rig_get_level (ctx->rig, RIG_VFO_CURR, RIG_LEVEL_COMP, &val);
 
 			/* raise anomaly if execution did not succeed */
 			if (retcode != RIG_OK) {
-				grig_debug_local (RIG_DEBUG_ERR,
-						  _("%s: Failed to execute RIG_CMD_GET_COMP:\n%s"),
-						  __FUNCTION__, ERR_TO_STR[abs(retcode)]);
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_COMP:\n%s"),
+						    __FUNCTION__, ERR_TO_STR[abs(retcode)]);
 
-				rig_anomaly_raise (RIG_CMD_GET_COMP);
+				rig_anomaly_raise (RIG_CMD_GET_COMP, retcode);
 			}
 			else {
+				rig_data_write_begin ();
 				get->comp = val.f;
+				rig_data_write_end ();
 			}
 
 			status = 1;
@@ -3201,20 +4117,23 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 		for (i = 0; i < RIG_SETTING_MAX; i++) {
 			func = rig_idx2setting(i);
 			if (has_set->funcs[i] && new->funcs[i]) {
-				retcode = rig_set_func (myrig,
+				retcode = rig_set_func (ctx->rig,
 							RIG_VFO_CURR,
 							func,
 							set->funcs[i]);
 
 				if (retcode != RIG_OK) {
-					grig_debug_local (RIG_DEBUG_ERR,
-							  _("%s: Failed to execute RIG_CMD_SET_FUNC(%s):\n%s"),
-							  __FUNCTION__, rig_strfunc(func), ERR_TO_STR[abs(retcode)]);
+					grig_debug_limited (RIG_DEBUG_ERR,
+							    _("%s: Failed to execute RIG_CMD_SET_FUNC(%s):\n%s"),
+							    __FUNCTION__, rig_strfunc(func), ERR_TO_STR[abs(retcode)]);
 
-					rig_anomaly_raise (RIG_CMD_SET_FUNC);
+					rig_anomaly_raise (RIG_CMD_SET_FUNC, retcode);
 				}
 				
-				get->funcs[i] = set->funcs[i];
+				rig_data_write_begin ();
+				if (!g_atomic_int_get (&pending->funcs[i]))
+					get->funcs[i] = set->funcs[i];
+				rig_data_write_end ();
 				new->funcs[i] = 0;
 
 				status = 1;
@@ -3223,32 +4142,35 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 
 		break;
 
-		/* get FUNC's status */
+		/* get FUNC's status; one function per execution */
 	case RIG_CMD_GET_FUNC:
 
-		for (i = 0; i < RIG_SETTING_MAX; i++) {
-			func = rig_idx2setting(i);
-			/* check whether command is available */
-			if (has_get->funcs[i]) {
-				int func_status;
+		i = rig_daemon_next_func (has_get->funcs, &ctx->getfuncidx);
 
-				/* try to execute command */
-				retcode = rig_get_func (myrig, RIG_VFO_CURR, func, &func_status);
+		/* check whether command is available */
+		if (i >= 0) {
+			int func_status;
 
-				/* raise anomaly if execution did not succeed */
-				if (retcode != RIG_OK) {
-					grig_debug_local (RIG_DEBUG_ERR,
-							  _("%s: Failed to execute RIG_CMD_GET_FUNC(%s):\n%s"),
-							  __FUNCTION__, rig_strfunc(func), ERR_TO_STR[abs(retcode)]);
+			func = rig_idx2setting(i);
 
-					rig_anomaly_raise (RIG_CMD_GET_FUNC);
-				}
-				else {
-					get->funcs[i] = func_status;
-				}
+			/* try to execute command */
+			retcode = rig_get_func (ctx->rig, RIG_VFO_CURR, func, &func_status);
 
-				status = 1;
+			/* raise anomaly if execution did not succeed */
+			if (retcode != RIG_OK) {
+				grig_debug_limited (RIG_DEBUG_ERR,
+						    _("%s: Failed to execute RIG_CMD_GET_FUNC(%s):\n%s"),
+						    __FUNCTION__, rig_strfunc(func), ERR_TO_STR[abs(retcode)]);
+
+				rig_anomaly_raise (RIG_CMD_GET_FUNC, retcode);
 			}
+			else {
+				rig_data_write_begin ();
+				get->funcs[i] = func_status;
+				rig_data_write_end ();
+			}
+
+			status = 1;
 		}
 
 		break;
@@ -3263,24 +4185,447 @@ rig_daemon_exec_cmd         (rig_cmd_t cmd,
 
 	}
 
+	/* update set-to-apply statistics for user commands */
+	if (status) {
+		ctx->ratecount++;
+		rig_daemon_cmd_applied (cmd);
+		failed = rig_anomaly_done (cmd);
+		rig_daemon_prof_cmd (cmd, g_get_monotonic_time () - start, failed);
+		grig_timeline_end ("daemon", CMD_TO_STR[cmd], start, "rig", rig_data_current ());
+
+		if (ctx->cmdrec != NULL) {
+			grig_cmdrec_t rec;
+
+			rec.start = start;
+			rec.duration = (guint32) MIN (g_get_monotonic_time () - start, G_MAXUINT32);
+			rec.cmd = cmd;
+			rec.retcode = retcode;
+
+			/* 'set' commands have claimed their values */
+			rig_daemon_poll_value (cmd, (set == &setcopy) ? set : get, &rec.value);
+			grig_cmdrec_ring_add (ctx->cmdrec, &rec);
+		}
+	}
+
+	grig_debug_set_cmd (GRIG_DEBUG_NO_CMD);
+
 	return status;
 
 }
 
 
+/** \brief Execute pending user commands.
+ *  \param delay Time to sleep after each executed command [usec].
+ *  \param max The maximum number of commands to execute (0 for no limit).
+ *  \param get Pointer to the 'get' command buffer.
+ *  \param set Pointer to the 'set' command buffer.
+ *  \param new Pointer to the 'new' command buffer.
+ *  \param has_get Pointer to get capabilities record.
+ *  \param has_set Pointer to set capabilities record.
+ *  \return The number of commands that have been executed.
+ *
+ * This function executes the commands that have been posted via
+ * rig_daemon_post_cmd() since the last call. Only the commands that
+ * were queued when the function was called are executed; commands
+ * posted meanwhile (eg. while the user is spinning the dial) are left
+ * for the next call so that polling can not be starved.
+ */
+static guint
+rig_daemon_flush_queue      (gulong delay,
+			     guint  max,
+			     grig_settings_t  *get,
+			     grig_settings_t  *set,
+			     grig_cmd_avail_t *new,
+			     grig_cmd_avail_t *has_get,
+			     grig_cmd_avail_t *has_set)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	rig_cmd_t cmd;
+	guint     pending;
+	guint     num = 0;
+
+
+	g_mutex_lock (&ctx->cmdmutex);
+	pending = g_queue_get_length (&ctx->cmdqueue);
+	g_mutex_unlock (&ctx->cmdmutex);
+
+	if (max && (pending > max))
+		pending = max;
+
+	while (pending-- && !ctx->stopdaemon) {
+
+		/* the command is no longer queued once it has been taken; a
+		   change made by the user from now on queues it again, even
+		   while it is being executed
+		*/
+		g_mutex_lock (&ctx->cmdmutex);
+		cmd = GPOINTER_TO_INT (g_queue_pop_head (&ctx->cmdqueue));
+		if (cmd != RIG_CMD_NONE) {
+			ctx->cmdtaken[cmd] = ctx->cmdposted[cmd];
+			ctx->cmdposted[cmd] = 0;
+		}
+		g_mutex_unlock (&ctx->cmdmutex);
+
+		if (cmd == RIG_CMD_NONE)
+			break;
+
+		if (rig_daemon_exec_cmd (cmd, get, set, new, has_get, has_set)) {
+			num++;
+
+			/* accepted value has been copied to 'get' */
+			rig_data_mark_dirty (rig_daemon_poll_fields (cmd));
+
+			if (delay)
+				rig_daemon_wait (delay, FALSE);
+		}
+		else {
+			/* nothing to do; the value has already been sent
+			   by a polling slot or the command is not available.
+			*/
+			g_mutex_lock (&ctx->cmdmutex);
+			ctx->cmdtaken[cmd] = 0;
+			g_mutex_unlock (&ctx->cmdmutex);
+		}
+
+		/* a value still waiting to be sent, e.g. the other functions
+		   of SET_FUNC, which sends one function at a time, or a change
+		   the user made while the command was executing
+		*/
+		if (rig_daemon_cmd_pending (cmd, new)) {
+			rig_daemon_post_cmd (cmd);
+		}
+	}
+
+	return num;
+}
+
+
+/** \brief Pause the daemon thread.
+ *  \param delay The maximum time to wait in microseconds.
+ *  \param cmdwake Whether a queued user command should end the pause.
+ *
+ * This function is used instead of g_usleep() between commands. It returns
+ * early when the daemon is being stopped and, if cmdwake is TRUE, as soon
+ * as there is a user command waiting in the queue.
+ */
+static void
+rig_daemon_wait             (gulong delay, gboolean cmdwake)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gint64 start;
+	gint64 end;
+
+
+	start = g_get_monotonic_time ();
+	end = start + delay;
+
+	g_mutex_lock (&ctx->cmdmutex);
+
+	while (!ctx->stopdaemon && !(cmdwake && !g_queue_is_empty (&ctx->cmdqueue))) {
+		if (!g_cond_wait_until (&ctx->daemoncond, &ctx->cmdmutex, end))
+			break;
+	}
+
+	g_mutex_unlock (&ctx->cmdmutex);
+
+	rig_daemon_prof_idle (g_get_monotonic_time () - start);
+}
+
+
+/** \brief Update set-to-apply statistics.
+ *  \param cmd The command that has just been executed.
+ *
+ * This function is called after each successfully executed command.
+ * If the command has been posted by the user, the time elapsed since
+ * it was posted is added to the latency statistics of the command.
+ * A command that is still queued, i.e. executed by a polling slot before
+ * the queue got to it, stays queued; it finds nothing to send later.
+ */
+static void
+rig_daemon_cmd_applied      (rig_cmd_t cmd)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gint64 latency = -1;
+	gint64 posted;
+
+
+	g_mutex_lock (&ctx->cmdmutex);
+
+	posted = ctx->cmdtaken[cmd] ? ctx->cmdtaken[cmd] : ctx->cmdposted[cmd];
+
+	if (posted != 0) {
+
+		latency = g_get_monotonic_time () - posted;
+		ctx->cmdtaken[cmd] = 0;
+
+		ctx->cmdlatency[cmd].count++;
+		ctx->cmdlatency[cmd].last = latency;
+		ctx->cmdlatency[cmd].total += latency;
+		if (latency > ctx->cmdlatency[cmd].max) {
+			ctx->cmdlatency[cmd].max = latency;
+		}
+	}
+
+	g_mutex_unlock (&ctx->cmdmutex);
+
+	if (latency >= 0) {
+		grig_debug_local (RIG_DEBUG_TRACE,
+				  _("%s: %s applied after %.1f ms"),
+				  __FUNCTION__, CMD_TO_STR[cmd], latency / 1000.0);
+	}
+}
+
+
+/** \brief Print set-to-apply statistics.
+ *
+ * This function prints the set-to-apply latency statistics of every
+ * user command that has been executed at least once.
+ */
+static void
+rig_daemon_dump_latency     ()
+{
+	rig_daemon_latency_t lat;
+	guint i;
+
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		if (rig_daemon_get_latency (i, &lat) && lat.count) {
+			grig_debug_local (RIG_DEBUG_VERBOSE,
+					  _("%s: %s: %u cmds, last %.1f ms, "\
+					    "mean %.1f ms, max %.1f ms"),
+					  __FUNCTION__, CMD_TO_STR[i], lat.count,
+					  lat.last / 1000.0,
+					  lat.total / (1000.0 * lat.count),
+					  lat.max / 1000.0);
+		}
+	}
+}
+
+
+/** \brief Post a user command.
+ *  \param cmd The command to execute.
+ *
+ * This function is used by the rig-data API to tell the daemon that a new
+ * value is waiting to be sent to the radio. The command is put into a
+ * queue which the daemon empties before executing the next step of the
+ * polling cycle, ie. the command goes out within one command delay
+ * instead of waiting for the matching slot in the cycle tables.
+ *
+ * A command that is already waiting in the queue is not queued again; the
+ * latest value will be sent anyway since the daemon reads it from the
+ * 'set' buffer when the command is executed. A command that is being
+ * executed is no longer in the queue and is queued again, so that a value
+ * changed during the execution is sent as well.
+ */
+void
+rig_daemon_post_cmd (rig_cmd_t cmd)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gint64 now;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return;
+	}
+
+	g_mutex_lock (&ctx->cmdmutex);
+
+	if (ctx->cmdposted[cmd] == 0) {
+		ctx->cmdposted[cmd] = g_get_monotonic_time ();
+		g_queue_push_tail (&ctx->cmdqueue, GINT_TO_POINTER (cmd));
+
+		/* cut the current pause of the daemon short */
+		g_cond_signal (&ctx->daemoncond);
+	}
+
+	g_mutex_unlock (&ctx->cmdmutex);
+
+	/* same for the timeout callback, but keep the delay after
+	   the previous command */
+	if (ctx->usetimeout && (ctx->timeoutid > 0) && !ctx->timeout_busy) {
+		now = MAX (g_get_monotonic_time (), ctx->cbearliest);
+
+		if (ctx->cbnext > now) {
+			rig_daemon_cb_arm ((now - g_get_monotonic_time ()) / 1000);
+		}
+	}
+
+	/* poll the new value at full rate while the user is at it */
+	rig_daemon_poll_touch (cmd);
+}
+
+
+/** \brief Check whether a user command is waiting in the queue.
+ *  \param cmd The command.
+ *  \return TRUE if the command has been posted and not yet been taken from
+ *          the queue.
+ */
+gboolean
+rig_daemon_cmd_queued (rig_cmd_t cmd)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gboolean queued;
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return FALSE;
+	}
+
+	g_mutex_lock (&ctx->cmdmutex);
+	queued = (ctx->cmdposted[cmd] != 0);
+	g_mutex_unlock (&ctx->cmdmutex);
+
+	return queued;
+}
+
+
+/** \brief Record the executed commands.
+ *  \param filename The file to which the record is saved.
+ *  \param size The number of commands to keep; 0 uses C_CMDREC_DEF_SIZE.
+ *
+ * Every command executed by the daemon of the current rig is stored with
+ * its start time, duration, return code and value in a ring buffer. The
+ * buffer is saved with rig_daemon_save_record() and when the daemon stops.
+ * Call this before rig_daemon_start().
+ */
+void
+rig_daemon_set_record (const gchar *filename, guint size)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	g_return_if_fail (ctx->cmdrec == NULL);
+
+	ctx->recfile = g_strdup (filename);
+	ctx->cmdrec = grig_cmdrec_ring_new (size ? size : C_CMDREC_DEF_SIZE);
+}
+
+
+/** \brief Save the recorded commands.
+ *  \param error Location for the error or NULL.
+ *  \return TRUE if the record has been saved or nothing is recorded.
+ *
+ * The recording continues; a later call replaces the file.
+ */
+gboolean
+rig_daemon_save_record (GError **error)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+	gboolean ok;
+
+
+	if (ctx->cmdrec == NULL) {
+		return TRUE;
+	}
+
+	ok = grig_cmdrec_ring_save (ctx->cmdrec, ctx->recfile,
+				    CMD_TO_STR, RIG_CMD_NUMBER, error);
+
+	if (ok) {
+		grig_debug_local (RIG_DEBUG_VERBOSE,
+				  _("%s: Command record saved to %s"),
+				  __FUNCTION__, ctx->recfile);
+	}
+
+	return ok;
+}
+
+
+/** \brief Get set-to-apply latency of a command.
+ *  \param cmd The command.
+ *  \param lat Pointer to a structure where the statistics will be stored.
+ *  \return TRUE if the statistics have been copied, FALSE if cmd is invalid.
+ *
+ * This function can be used to obtain the measured time between posting a
+ * command via the rig-data API and executing it.
+ */
+gboolean
+rig_daemon_get_latency (rig_cmd_t cmd, rig_daemon_latency_t *lat)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	if ((cmd <= RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER) || (lat == NULL)) {
+		return FALSE;
+	}
+
+	g_mutex_lock (&ctx->cmdmutex);
+	*lat = ctx->cmdlatency[cmd];
+	g_mutex_unlock (&ctx->cmdmutex);
+
+	return TRUE;
+}
+
+
+/** \brief Get the time spent in the timeout callback.
+ *  \param stall Pointer to a structure where the statistics will be stored.
+ *  \return TRUE if the daemon runs without threads, FALSE otherwise.
+ *
+ * Without threads every call of the daemon callback blocks the GTK main
+ * loop. The statistics cover all calls since the daemon was started,
+ * including the initial polling pass.
+ */
+gboolean
+rig_daemon_get_stall   (rig_daemon_latency_t *stall)
+{
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	if (!ctx->usetimeout || (stall == NULL)) {
+		return FALSE;
+	}
+
+	*stall = ctx->cbstall;
+
+	return TRUE;
+}
+
+
+/** \brief Get the name of a command.
+ *  \param cmd The command.
+ *  \return A static string with the symbolic name of the command.
+ */
+const gchar *
+rig_daemon_cmd_to_str (rig_cmd_t cmd)
+{
+	if ((cmd < RIG_CMD_NONE) || (cmd >= RIG_CMD_NUMBER)) {
+		return "RIG_CMD_UNKNOWN";
+	}
+
+	return CMD_TO_STR[cmd];
+}
+
+
 /** \brief Get hamlib id of radio.
  *  \return The id of the rig
  */
 gint
 rig_daemon_get_rig_id ()
 {
-	if (myrig == NULL) {
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	if (ctx->rig == NULL) {
 		return -1;
 	}
 
-	return myrig->caps->rig_model;
+	return ctx->rig->caps->rig_model;
+}
+
+/** \brief Get the Hamlib handle of the current rig.
+ *  \return The RIG structure or NULL if the rig has not been started.
+ *
+ * The handle is owned by the daemon and may only be used to read the
+ * capabilities; all commands must go through the daemon.
+ */
+RIG *
+rig_daemon_get_rig ()
+{
+	return RIG_DAEMON_CUR ()->rig;
 }
 
+
 /** \brief Get radio brand.
  *  \return A character string containing the radio brand.
  *
@@ -3291,12 +4636,13 @@ rig_daemon_get_rig_id ()
 gchar *
 rig_daemon_get_brand ()
 {
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
 	gchar *text;
 
-	if (myrig == NULL) {
+	if (ctx->rig == NULL) {
 		return NULL;
 	}
-	text = g_strdup (myrig->caps->mfg_name);
+	text = g_strdup (ctx->rig->caps->mfg_name);
 
 	return text;
 }
@@ -3312,12 +4658,13 @@ rig_daemon_get_brand ()
 gchar *
 rig_daemon_get_model ()
 {
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
 	gchar *text;
 
-	if (myrig == NULL) {
+	if (ctx->rig == NULL) {
 		return NULL;
 	}
-	text = g_strdup (myrig->caps->model_name);
+	text = g_strdup (ctx->rig->caps->model_name);
 
 	return text;
 }
@@ -3333,7 +4680,10 @@ rig_daemon_get_model ()
 gint
 rig_daemon_get_delay ()
 {
-	return cmd_delay;
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	return ctx->cmd_delay;
 }
 
 
@@ -3342,13 +4692,24 @@ rig_daemon_get_delay ()
  *
  * This function can be used to suspend the daemon without shutting it down.
  * TRUE means suspend the daemon while FALSE means re-enable execution.
- * When in suspended mode, the daemon will keep on executing it's cycles,
- * but no commands will be sent to hamlib, as long as the daemon is suspended. 
+ * When in suspended mode, the daemon thread sleeps and no commands will be
+ * sent to hamlib, as long as the daemon is suspended. 
  */
 void
 rig_daemon_set_suspend (gboolean spnd)
 {
-	suspended = spnd;
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	g_mutex_lock (&ctx->cmdmutex);
+	ctx->suspended = spnd;
+	g_cond_broadcast (&ctx->daemoncond);
+	g_mutex_unlock (&ctx->cmdmutex);
+
+	/* the timeout callback disarms itself while suspended */
+	if (ctx->usetimeout && !spnd && (ctx->timeoutid == 0) && !ctx->timeout_busy) {
+		rig_daemon_cb_arm (0);
+	}
 
 	grig_debug_local (RIG_DEBUG_VERBOSE, _("%s: %d"), __FUNCTION__, spnd);
 }
@@ -3363,5 +4724,8 @@ rig_daemon_set_suspend (gboolean spnd)
 gboolean
 rig_daemon_get_suspend (void)
 {
-	return suspended;
+	rig_daemon_ctx_t *ctx = RIG_DAEMON_CUR ();
+
+
+	return ctx->suspended;
 }
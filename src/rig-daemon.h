@@ -40,9 +40,13 @@
 
 #define C_DEF_RX_CMD_DELAY    10   /*!< Default delay between two RX commands [msec] */
 
+#define C_MAX_RIGS            4    /*!< Max number of rigs controlled at the same time */
+
 
 #define C_RIG_DAEMON_STOP_TIMEOUT 10000  /*!< Timeout to let the daemon process stop [msec] */
-#define C_RIG_DAEMON_STOP_SLEEP_TIME 100 /*!< Time to sleep between successive attempts to cheack the clear flag. [msec] */
+#define C_RIG_DAEMON_RATE_INTERVAL 5000  /*!< Interval between two command rate reports [msec] */
+#define C_RIG_DAEMON_SWEEP_INTERVAL 1000 /*!< Interval between two sweeps for unsent values [msec] */
+#define C_RIG_DAEMON_MAX_IDLE     500    /*!< Max pause of the timeout callback when nothing is due [msec] */
 
 
 /** \brief List of available commands.
@@ -137,6 +141,19 @@ typedef enum {
 } rig_cmd_t;
 
 
+/** \brief Set-to-apply latency statistics.
+ *
+ * This structure holds the measured time between a value being written
+ * via the rig-data API and the corresponding command being executed by
+ * the daemon. All times are in microseconds.
+ */
+typedef struct {
+	guint    count;    /*!< Number of measured executions. */
+	gint64   last;     /*!< Latency of the latest execution. */
+	gint64   max;      /*!< Largest latency seen so far. */
+	gint64   total;    /*!< Sum of all latencies (use count to get the mean). */
+} rig_daemon_latency_t;
+
 
 int       rig_daemon_start       (int, const gchar *,
 				  int, const gchar *,
@@ -148,6 +165,17 @@ gboolean  rig_daemon_get_suspend (void);
 gchar    *rig_daemon_get_brand   (void);
 gchar    *rig_daemon_get_model   (void);
 gint      rig_daemon_get_rig_id  (void);
+RIG      *rig_daemon_get_rig     (void);
 gint      rig_daemon_get_delay   (void);
 
+void      rig_daemon_post_cmd    (rig_cmd_t);
+gboolean  rig_daemon_cmd_queued  (rig_cmd_t);
+gboolean  rig_daemon_get_latency (rig_cmd_t, rig_daemon_latency_t *);
+gboolean  rig_daemon_get_stall   (rig_daemon_latency_t *);
+const gchar *rig_daemon_cmd_to_str (rig_cmd_t);
+void      rig_daemon_cmd_enable  (rig_cmd_t, gboolean);
+gboolean  rig_daemon_cmd_is_user (rig_cmd_t);
+void      rig_daemon_set_record  (const gchar *, guint);
+gboolean  rig_daemon_save_record (GError **);
+
 #endif
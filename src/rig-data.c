@@ -45,35 +45,96 @@
  *       flipping to he current value (in case the daemon does not update the
  *       'get' variable before the GUI reads it again).
  * 
+ * \note Widgets are notified about changes through rig_data_add_listener().
+ *       The daemon marks the fields that have changed and the listeners are
+ *       called from the main loop, once per batch of changes.
+ *
+ * \note There is one set of shared data per rig, see C_MAX_RIGS. The API
+ *       functions refer to the rig the calling thread is bound to using
+ *       rig_data_bind(), which each daemon thread does, and otherwise to
+ *       the rig selected in the GUI using rig_data_select().
+ *
  * \bug Must add rig_data_has_get_xxx and rig_data_has_set_xxx functions.
  *
  * \bug File includes gtk.h but not really needed?
  */
 
+#include <string.h>
 #include <gtk/gtk.h>
 #include <hamlib/rig.h>
 #include <glib/gi18n.h>
 #include "rig-data.h"
+#include "grig-debug.h"
+#include "grig-timeline.h"
+#include "rig-daemon.h"
+#include "rig-shm.h"
+
+
+/** \brief Change notification listener. */
+typedef struct {
+	guint               id;        /*!< Listener ID. */
+	gint                rig;       /*!< Rig the listener is bound to or RIG_DATA_RIG_SELECTED. */
+	guint64             mask;      /*!< Fields the listener is interested in. */
+	rig_data_listener_t callback;  /*!< Callback function. */
+	gpointer            data;      /*!< User data. */
+} rig_data_listener_entry_t;
+
+
+/** \brief Shared data of one rig. */
+typedef struct {
+	grig_settings_t  set;      /*!< These values are sent to the radio. */
+	grig_settings_t  get;      /*!< These values are read from the radio. */
+	grig_cmd_avail_t new;      /*!< Flags to indicate whether new value is available. */
+	grig_cmd_avail_t has_set;  /*!< Flags to indicate writing capabilities. */
+	grig_cmd_avail_t has_get;  /*!< Flags to indicate reading capabilities. */
+
+	/** \brief Sequence counter protecting 'set' and 'get'.
+	 *
+	 * The counter is odd while a writer is updating the data. Readers retry
+	 * if the counter was odd or has changed while they were copying.
+	 */
+	volatile gint    datasequence;
+	GMutex           datamutex;    /*!< Serialises writers (the daemon and the GUI setters). */
+
+	guint64          dirtymask;    /*!< Fields changed since the last dispatch. */
+	guint            dirtyidle;    /*!< ID of the pending dispatch source (0 if none). */
+	GMutex           dirtymutex;   /*!< Protects dirtymask and dirtyidle. */
+
+	int              att[HAMLIB_MAXDBLSTSIZ];     /*!< List of attenuator values (absolute values). */
+	int              preamp[HAMLIB_MAXDBLSTSIZ];  /*!< List of preamp values. */
+	int              vfo_list;     /*!< Bit field of available VFO's */
+	float            maxpwr;       /*!< Maximum power in W */
+} rig_data_t;
+
+
+/** \brief The shared data of each rig. */
+static rig_data_t    rigdata[C_MAX_RIGS];
+
+/** \brief The rig used by the GUI. */
+static gint          selected = 0;
 
+/** \brief The rig a thread is bound to (rig + 1, NULL if not bound). */
+static GPrivate      boundrig = G_PRIVATE_INIT (NULL);
 
-grig_settings_t  set;      /*!< These values are sent to the radio. */
-grig_settings_t  get;      /*!< These values are read from the radio. */
-grig_cmd_avail_t new;      /*!< Flags to indicate whether new value is available. */
-grig_cmd_avail_t has_set;  /*!< Flags to indicate writing capabilities. */
-grig_cmd_avail_t has_get;  /*!< Flags to indicate reading capabilities. */
+/** \brief Registered listeners; only accessed from the main loop. */
+static GSList       *listeners = NULL;
 
+/** \brief Number of dispatches running; listeners are not unlinked meanwhile. */
+static guint         dispatching = 0;
 
-/** \brief List of attenuator values (absolute values). */
-static int att[HAMLIB_MAXDBLSTSIZ];
+/** \brief Whether removed listeners wait to be unlinked. */
+static gboolean      listenersdead = FALSE;
 
-/** \brief List of preamp values. */
-static int preamp[HAMLIB_MAXDBLSTSIZ];
+/** \brief Last assigned listener ID. */
+static guint         listenerid = 0;
 
-/** \brief Bit field of available VFO's */
-static int vfo_list;
 
-/** \brief Maximum power in W */
-static float maxpwr = 0.0;
+static gboolean rig_data_dispatch_dirty (gpointer);
+static void     rig_data_mark_dirty_rig (gint, guint64);
+
+
+/** \brief Get the shared data of the current rig. */
+#define RIG_DATA_CUR() (&rigdata[rig_data_current ()])
 
 
 /** \brief Getavailable VFOs.
@@ -87,7 +148,9 @@ static float maxpwr = 0.0;
 int
 rig_data_get_vfos         ()
 {
-	return vfo_list;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->vfo_list;
 }
 
 
@@ -100,7 +163,9 @@ rig_data_get_vfos         ()
 void
 rig_data_set_vfos         (int vfos)
 {
-	vfo_list = vfos;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rd->vfo_list = vfos;
 }
 
 
@@ -116,8 +181,10 @@ rig_data_set_vfos         (int vfos)
 void
 rig_data_set_att_data (int index, int data)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
+
 	if ((index >= 0) && (index < HAMLIB_MAXDBLSTSIZ))
-		att[index] = data;
+		rd->att[index] = data;
 }
 
 
@@ -132,8 +199,10 @@ rig_data_set_att_data (int index, int data)
 int
 rig_data_get_att_data (int index)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
+
 	if ((index >= 0) && (index < HAMLIB_MAXDBLSTSIZ)) {
-		return att[index];
+		return rd->att[index];
 	}
 	else {
 		return 0;
@@ -151,6 +220,7 @@ rig_data_get_att_data (int index)
 int
 rig_data_get_att_index    (int data)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
 	int i = 0;
 
 	/* invali att value */
@@ -158,8 +228,8 @@ rig_data_get_att_index    (int data)
 		return -1;
 
 	/* scan through the array */
-	while ((i < HAMLIB_MAXDBLSTSIZ) && (att[i] != 0)) {
-		if (att[i] == data) {
+	while ((i < HAMLIB_MAXDBLSTSIZ) && (rd->att[i] != 0)) {
+		if (rd->att[i] == data) {
 			return i;
 		}
 		i++;
@@ -182,8 +252,10 @@ rig_data_get_att_index    (int data)
 void
 rig_data_set_preamp_data (int index, int data)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
+
 	if ((index >= 0) && (index < HAMLIB_MAXDBLSTSIZ))
-		preamp[index] = data;
+		rd->preamp[index] = data;
 }
 
 
@@ -198,8 +270,10 @@ rig_data_set_preamp_data (int index, int data)
 int
 rig_data_get_preamp_data (int index)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
+
 	if ((index >= 0) && (index < HAMLIB_MAXDBLSTSIZ)) {
-		return preamp[index];
+		return rd->preamp[index];
 	}
 	else {
 		return 0;
@@ -218,6 +292,7 @@ rig_data_get_preamp_data (int index)
 int
 rig_data_get_preamp_index    (int data)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
 	int i = 0;
 
 	/* invalid preamp value */
@@ -225,8 +300,8 @@ rig_data_get_preamp_index    (int data)
 		return -1;
 
 	/* scan through the array */
-	while ((i < HAMLIB_MAXDBLSTSIZ) && (preamp[i] != 0)) {
-		if (preamp[i] == data) {
+	while ((i < HAMLIB_MAXDBLSTSIZ) && (rd->preamp[i] != 0)) {
+		if (rd->preamp[i] == data) {
 			return i;
 		}
 		i++;
@@ -245,9 +320,15 @@ rig_data_get_preamp_index    (int data)
 void 
 rig_data_set_pstat   (powerstat_t pwr)
 {
-	set.pstat = pwr;
-	get.pstat = pwr;
-	new.pstat = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.pstat = pwr;
+	rd->get.pstat = pwr;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_PSTAT));
+	g_atomic_int_set (&rd->new.pstat, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_PSTAT);
 }
 
 
@@ -260,9 +341,15 @@ rig_data_set_pstat   (powerstat_t pwr)
 void
 rig_data_set_ptt     (ptt_t ptt)
 {
-	set.ptt = ptt;
-	get.ptt = ptt;
-	new.ptt = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.ptt = ptt;
+	rd->get.ptt = ptt;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_PTT));
+	g_atomic_int_set (&rd->new.ptt, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_PTT);
 }
 
 
@@ -279,9 +366,15 @@ rig_data_set_ptt     (ptt_t ptt)
 void
 rig_data_set_power   (float power)
 {
-	set.power = power;
-	get.power = power;
-	new.power = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.power = power;
+	rd->get.power = power;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_POWER));
+	g_atomic_int_set (&rd->new.power, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_POWER);
 }
 
 
@@ -299,9 +392,15 @@ rig_data_set_power   (float power)
 void
 rig_data_set_mode    (rmode_t mode)
 {
-	set.mode = mode;
-	get.mode = mode;
-	new.mode = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.mode = mode;
+	rd->get.mode = mode;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_MODE));
+	g_atomic_int_set (&rd->new.mode, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_MODE);
 }
 
 
@@ -317,9 +416,15 @@ rig_data_set_mode    (rmode_t mode)
 void
 rig_data_set_pbwidth (rig_data_pbw_t pbw)
 {
-	set.pbw = pbw;
-	get.pbw = pbw;
-	new.pbw = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.pbw = pbw;
+	rd->get.pbw = pbw;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_PBW));
+	g_atomic_int_set (&rd->new.pbw, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_MODE);
 }
 
 
@@ -333,18 +438,28 @@ rig_data_set_pbwidth (rig_data_pbw_t pbw)
 void
 rig_data_set_freq    (int num, freq_t freq)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
+
 	switch (num) {
 
 		/* primary frequency */
-	case 1: set.freq1 = freq;
-		get.freq1 = freq;
-		new.freq1 = 1;
+	case 1: rig_data_write_begin ();
+		rd->set.freq1 = freq;
+		rd->get.freq1 = freq;
+		rig_data_write_end ();
+		rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_FREQ1));
+		g_atomic_int_set (&rd->new.freq1, 1);
+		rig_daemon_post_cmd (RIG_CMD_SET_FREQ_1);
 		break;
 
 		/* secondary frequency */
-	case 2: set.freq2 = freq;
-		get.freq2 = freq;
-		new.freq2 = 1;
+	case 2: rig_data_write_begin ();
+		rd->set.freq2 = freq;
+		rd->get.freq2 = freq;
+		rig_data_write_end ();
+		rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_FREQ2));
+		g_atomic_int_set (&rd->new.freq2, 1);
+		rig_daemon_post_cmd (RIG_CMD_SET_FREQ_2);
 		break;
 
 		/* this is a bug */
@@ -363,9 +478,15 @@ rig_data_set_freq    (int num, freq_t freq)
 void
 rig_data_set_rit     (shortfreq_t rit)
 {
-	set.rit = rit;
-	get.rit = rit;
-	new.rit = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.rit = rit;
+	rd->get.rit = rit;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_RIT));
+	g_atomic_int_set (&rd->new.rit, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_RIT);
 }
 
 
@@ -377,9 +498,15 @@ rig_data_set_rit     (shortfreq_t rit)
 void
 rig_data_set_xit     (shortfreq_t xit)
 {
-	set.xit = xit;
-	get.xit = xit;
-	new.xit = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.xit = xit;
+	rd->get.xit = xit;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_XIT));
+	g_atomic_int_set (&rd->new.xit, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_XIT);
 }
 
 
@@ -391,9 +518,15 @@ rig_data_set_xit     (shortfreq_t xit)
 void
 rig_data_set_agc     (int agc)
 {
-	set.agc = agc;
-	get.agc = agc;
-	new.agc = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.agc = agc;
+	rd->get.agc = agc;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_AGC));
+	g_atomic_int_set (&rd->new.agc, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_AGC);
 }
 
 
@@ -405,9 +538,15 @@ rig_data_set_agc     (int agc)
 void
 rig_data_set_att     (int att)
 {
-	set.att = att;
-	get.att = att;
-	new.att = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.att = att;
+	rd->get.att = att;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_ATT));
+	g_atomic_int_set (&rd->new.att, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_ATT);
 }
 
 
@@ -419,9 +558,15 @@ rig_data_set_att     (int att)
 void
 rig_data_set_preamp     (int preamp)
 {
-	set.preamp = preamp;
-	get.preamp = preamp;
-	new.preamp = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.preamp = preamp;
+	rd->get.preamp = preamp;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_PREAMP));
+	g_atomic_int_set (&rd->new.preamp, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_PREAMP);
 }
 
 
@@ -433,9 +578,14 @@ rig_data_set_preamp     (int preamp)
 void
 rig_data_set_antenna    (ant_t antenna)
 {
-	set.antenna = antenna;
-	get.antenna = antenna;
-	new.antenna = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.antenna = antenna;
+	rd->get.antenna = antenna;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_ANTENNA));
+	g_atomic_int_set (&rd->new.antenna, 1);
 }
 
 
@@ -447,7 +597,9 @@ rig_data_set_antenna    (ant_t antenna)
 powerstat_t
 rig_data_get_pstat   ()
 {
-	return get.pstat;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.pstat;
 }
 
 
@@ -459,7 +611,9 @@ rig_data_get_pstat   ()
 ptt_t
 rig_data_get_ptt     ()
 {
-	return get.ptt;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.ptt;
 }
 
 
@@ -467,28 +621,40 @@ rig_data_get_ptt     ()
 vfo_t
 rig_data_get_vfo     ()
 {
-	return get.vfo;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.vfo;
 }
 
 void
 rig_data_set_vfo     (vfo_t vfo)
 {
-	set.vfo = vfo;
-	get.vfo = vfo;
-	new.vfo = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.vfo = vfo;
+	rd->get.vfo = vfo;
+	rig_data_write_end ();
+	rig_data_mark_dirty (RIG_DATA_DIRTY (RIG_DATA_FIELD_VFO));
+	g_atomic_int_set (&rd->new.vfo, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_VFO);
 }
 
 int
 rig_data_has_get_vfo  ()
 {
-	return has_get.vfo;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.vfo;
 }
 
 
 int
 rig_data_has_set_vfo  ()
 {
-	return has_set.vfo;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.vfo;
 }
 
 
@@ -501,7 +667,9 @@ rig_data_has_set_vfo  ()
 rmode_t
 rig_data_get_mode    ()
 {
-	return get.mode;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.mode;
 }
 
 
@@ -514,7 +682,9 @@ rig_data_get_mode    ()
 rig_data_pbw_t
 rig_data_get_pbwidth ()
 {
-	return get.pbw;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.pbw;
 }
 
 
@@ -530,21 +700,23 @@ rig_data_get_pbwidth ()
 freq_t
 rig_data_get_freq    (int num)
 {
-	switch (num) {
-
-		/* primary frequency */
-	case 1: return get.freq1;
-		break;
-
-		/* secondary frequency */
-	case 2: return get.freq2;
-		break;
+	rig_data_t *rd = RIG_DATA_CUR ();
+	freq_t freq;
+	guint  seq;
 
+	if ((num != 1) && (num != 2)) {
 		/* bug */
-	default: g_warning (_("%s: Invalid target: %d\n"), __FUNCTION__, num);
-		return get.freq1;
-		break;
+		g_warning (_("%s: Invalid target: %d\n"), __FUNCTION__, num);
+		num = 1;
 	}
+
+	/* freq_t does not fit in one word on all platforms */
+	do {
+		seq = rig_data_read_begin ();
+		freq = (num == 2) ? rd->get.freq2 : rd->get.freq1;
+	} while (rig_data_read_retry (seq));
+
+	return freq;
 }
 
 
@@ -557,7 +729,16 @@ rig_data_get_freq    (int num)
 freq_t
 rig_data_get_fmin     ()
 {
-	return get.fmin;
+	rig_data_t *rd = RIG_DATA_CUR ();
+	freq_t freq;
+	guint  seq;
+
+	do {
+		seq = rig_data_read_begin ();
+		freq = rd->get.fmin;
+	} while (rig_data_read_retry (seq));
+
+	return freq;
 }
 
 
@@ -571,7 +752,16 @@ rig_data_get_fmin     ()
 freq_t
 rig_data_get_fmax     ()
 {
-	return get.fmax;
+	rig_data_t *rd = RIG_DATA_CUR ();
+	freq_t freq;
+	guint  seq;
+
+	do {
+		seq = rig_data_read_begin ();
+		freq = rd->get.fmax;
+	} while (rig_data_read_retry (seq));
+
+	return freq;
 }
 
 
@@ -585,7 +775,9 @@ rig_data_get_fmax     ()
 shortfreq_t
 rig_data_get_fstep    ()
 {
-	return get.fstep;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.fstep;
 }
 
 
@@ -598,7 +790,9 @@ rig_data_get_fstep    ()
 shortfreq_t
 rig_data_get_rit     ()
 {
-	return get.rit;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.rit;
 }
 
 
@@ -610,7 +804,9 @@ rig_data_get_rit     ()
 shortfreq_t
 rig_data_get_xit     ()
 {
-	return get.xit;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.xit;
 }
 
 
@@ -622,7 +818,9 @@ rig_data_get_xit     ()
 int
 rig_data_get_agc     ()
 {
-	return get.agc;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.agc;
 }
 
 
@@ -634,7 +832,9 @@ rig_data_get_agc     ()
 int
 rig_data_get_att     ()
 {
-	return get.att;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.att;
 }
 
 
@@ -646,7 +846,9 @@ rig_data_get_att     ()
 int
 rig_data_get_preamp     ()
 {
-	return get.preamp;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.preamp;
 }
 
 
@@ -658,7 +860,9 @@ rig_data_get_preamp     ()
 int
 rig_data_get_strength ()
 {
-	return get.strength;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.strength;
 }
 
 
@@ -670,7 +874,9 @@ rig_data_get_strength ()
 float
 rig_data_get_power    ()
 {
-	return get.power;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.power;
 }
 
 
@@ -682,7 +888,9 @@ rig_data_get_power    ()
 float
 rig_data_get_swr      ()
 {
-	return get.swr;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.swr;
 }
 
 
@@ -694,15 +902,22 @@ rig_data_get_swr      ()
 float
 rig_data_get_alc      ()
 {
-	return get.alc;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.alc;
 }
 
 
 void
 rig_data_set_alc      (float alc)
 {
-	set.alc = alc;
-	new.alc = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.alc = alc;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.alc, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_ALC);
 }
 
 /** \brief Get current antenna.
@@ -713,7 +928,9 @@ rig_data_set_alc      (float alc)
 ant_t
 rig_data_get_antenna    ()
 {
-	return get.antenna;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.antenna;
 }
 
 
@@ -725,7 +942,9 @@ rig_data_get_antenna    ()
 int
 rig_data_has_get_strength ()
 {
-	return has_get.strength;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.strength;
 }
 
 
@@ -739,7 +958,9 @@ rig_data_has_get_strength ()
 int
 rig_data_has_get_pstat ()
 {
-	return has_get.pstat;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.pstat;
 }
 
 
@@ -752,7 +973,9 @@ rig_data_has_get_pstat ()
 int
 rig_data_has_get_ptt ()
 {
-	return has_get.ptt;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.ptt;
 }
 
 
@@ -765,7 +988,9 @@ rig_data_has_get_ptt ()
 int
 rig_data_has_get_rit ()
 {
-	return has_get.rit;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.rit;
 }
 
 
@@ -778,7 +1003,9 @@ rig_data_has_get_rit ()
 int
 rig_data_has_get_xit ()
 {
-	return has_get.xit;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.xit;
 }
 
 
@@ -790,7 +1017,9 @@ rig_data_has_get_xit ()
 int
 rig_data_has_set_rit ()
 {
-	return has_set.rit;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.rit;
 }
 
 
@@ -803,7 +1032,9 @@ rig_data_has_set_rit ()
 int
 rig_data_has_set_xit ()
 {
-	return has_set.xit;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.xit;
 }
 
 
@@ -815,7 +1046,9 @@ rig_data_has_set_xit ()
 int
 rig_data_has_get_agc ()
 {
-	return has_get.agc;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.agc;
 }
 
 
@@ -828,7 +1061,9 @@ rig_data_has_get_agc ()
 int
 rig_data_has_get_att ()
 {
-	return has_get.att;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.att;
 }
 
 
@@ -841,7 +1076,9 @@ rig_data_has_get_att ()
 int
 rig_data_has_get_preamp ()
 {
-	return has_get.preamp;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.preamp;
 }
 
 
@@ -856,7 +1093,9 @@ rig_data_has_get_preamp ()
 int
 rig_data_has_get_freq1     ()
 {
-	return has_get.freq1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.freq1;
 }
 
 
@@ -870,7 +1109,9 @@ rig_data_has_get_freq1     ()
 int
 rig_data_has_get_freq2     ()
 {
-	return has_get.freq2;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.freq2;
 }
 
 
@@ -884,13 +1125,17 @@ rig_data_has_get_freq2     ()
 int
 rig_data_has_get_power    ()
 {
-	return has_get.power;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.power;
 }
 
 int
 rig_data_has_set_power    ()
 {
-	return has_set.power;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.power;
 }
 
 
@@ -904,7 +1149,9 @@ rig_data_has_set_power    ()
 int
 rig_data_has_get_swr      ()
 {
-	return has_get.swr;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.swr;
 }
 
 
@@ -917,14 +1164,18 @@ rig_data_has_get_swr      ()
 int
 rig_data_has_get_alc      ()
 {
-	return has_get.alc;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.alc;
 }
 
 
 int
 rig_data_has_set_alc      ()
 {
-	return has_set.alc;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.alc;
 }
 
 /** \brief Get availablility of power status.
@@ -935,7 +1186,9 @@ rig_data_has_set_alc      ()
 int
 rig_data_has_set_pstat ()
 {
-	return has_set.pstat;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.pstat;
 }
 
 
@@ -948,7 +1201,9 @@ rig_data_has_set_pstat ()
 int
 rig_data_has_set_ptt ()
 {
-	return has_set.ptt;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.ptt;
 }
 
 
@@ -965,7 +1220,9 @@ rig_data_has_set_ptt ()
 int
 rig_data_has_set_freq1     ()
 {
-	return has_set.freq1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.freq1;
 }
 
 
@@ -980,7 +1237,9 @@ rig_data_has_set_freq1     ()
 int
 rig_data_has_set_freq2     ()
 {
-	return has_set.freq2;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.freq2;
 }
 
 
@@ -995,7 +1254,9 @@ rig_data_has_set_freq2     ()
 int
 rig_data_has_set_att    ()
 {
-	return has_set.att;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.att;
 }
 
 
@@ -1011,7 +1272,9 @@ rig_data_has_set_att    ()
 int
 rig_data_has_set_preamp     ()
 {
-	return has_set.preamp;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.preamp;
 }
 
 
@@ -1025,7 +1288,9 @@ rig_data_has_set_preamp     ()
 shortfreq_t
 rig_data_get_ritmin     ()
 {
-	return -get.ritmax;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return -rd->get.ritmax;
 }
 
 
@@ -1039,7 +1304,9 @@ rig_data_get_ritmin     ()
 shortfreq_t
 rig_data_get_ritmax     ()
 {
-	return get.ritmax;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.ritmax;
 }
 
 
@@ -1053,7 +1320,9 @@ rig_data_get_ritmax     ()
 shortfreq_t
 rig_data_get_ritstep    ()
 {
-	return get.ritstep;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.ritstep;
 }
 
 
@@ -1067,7 +1336,9 @@ rig_data_get_ritstep    ()
 shortfreq_t
 rig_data_get_xitmin     ()
 {
-	return -get.xitmax;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return -rd->get.xitmax;
 }
 
 
@@ -1081,7 +1352,9 @@ rig_data_get_xitmin     ()
 shortfreq_t
 rig_data_get_xitmax     ()
 {
-	return get.xitmax;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.xitmax;
 }
 
 
@@ -1095,7 +1368,9 @@ rig_data_get_xitmax     ()
 shortfreq_t
 rig_data_get_xitstep    ()
 {
-	return get.xitstep;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.xitstep;
 }
 
 
@@ -1103,58 +1378,80 @@ rig_data_get_xitstep    ()
 int
 rig_data_has_set_func (setting_t func)
 {
-	return has_set.funcs[rig_setting2idx(func)];
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.funcs[rig_setting2idx(func)];
 }
 
 
 int
 rig_data_has_get_func (setting_t func)
 {
-	return has_get.funcs[rig_setting2idx(func)];
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.funcs[rig_setting2idx(func)];
 }
 
 
 void
 rig_data_set_func     (setting_t func, int status)
 {
-	set.funcs[rig_setting2idx(func)] = status;
-	new.funcs[rig_setting2idx(func)] = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.funcs[rig_setting2idx(func)] = status;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.funcs[rig_setting2idx(func)], 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_FUNC);
 }
 
 
 int
 rig_data_get_func     (setting_t func)
 {
-	return get.funcs[rig_setting2idx(func)];
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.funcs[rig_setting2idx(func)];
 }
 
 /***   LOCK  ***/
 int
 rig_data_has_set_lock ()
 {
-	return has_set.lock;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.lock;
 }
 
 
 int
 rig_data_has_get_lock ()
 {
-	return has_get.lock;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.lock;
 }
 
 
 void
 rig_data_set_lock     (int lock)
 {
-	set.lock = lock;
-	new.lock = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.lock = lock;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.lock, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_LOCK);
 }
 
 
 int
 rig_data_get_lock     ()
 {
-	return get.lock;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.lock;
 }
 
 
@@ -1162,15 +1459,22 @@ rig_data_get_lock     ()
 int
 rig_data_has_vfo_op_toggle ()
 {
-	return has_set.vfo_op_toggle;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.vfo_op_toggle;
 }
 
 
 void
 rig_data_vfo_op_toggle     ()
 {
-	set.vfo_op_toggle = 1;
-	new.vfo_op_toggle = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.vfo_op_toggle = 1;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.vfo_op_toggle, 1);
+	rig_daemon_post_cmd (RIG_CMD_VFO_TOGGLE);
 }
 
 
@@ -1178,15 +1482,22 @@ rig_data_vfo_op_toggle     ()
 int
 rig_data_has_vfo_op_copy ()
 {
-	return has_set.vfo_op_copy;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.vfo_op_copy;
 }
 
 
 void
 rig_data_vfo_op_copy     ()
 {
-	set.vfo_op_copy = 1;
-	new.vfo_op_copy = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.vfo_op_copy = 1;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.vfo_op_copy, 1);
+	rig_daemon_post_cmd (RIG_CMD_VFO_COPY);
 }
 
 
@@ -1194,15 +1505,22 @@ rig_data_vfo_op_copy     ()
 int
 rig_data_has_vfo_op_xchg ()
 {
-	return has_set.vfo_op_xchg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.vfo_op_xchg;
 }
 
 
 void
 rig_data_vfo_op_xchg     ()
 {
-	set.vfo_op_xchg = 1;
-	new.vfo_op_xchg = 1;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.vfo_op_xchg = 1;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.vfo_op_xchg, 1);
+	rig_daemon_post_cmd (RIG_CMD_VFO_XCHG);
 }
 
 
@@ -1210,30 +1528,444 @@ rig_data_vfo_op_xchg     ()
 int
 rig_data_has_set_split ()
 {
-	return has_set.split;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.split;
 }
 
 int
 rig_data_has_get_split ()
 {
-	return has_get.split;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.split;
 }
 
 void
 rig_data_set_split (int split)
 {
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
 	if (split)
-		set.split = RIG_SPLIT_ON;
+		rd->set.split = RIG_SPLIT_ON;
 	else
-		set.split = RIG_SPLIT_OFF;
+		rd->set.split = RIG_SPLIT_OFF;
+	rig_data_write_end ();
 
-	new.split = TRUE;
+	g_atomic_int_set (&rd->new.split, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_SPLIT);
 }
 
 int
 rig_data_get_split ()
 {
-	return (get.split == RIG_SPLIT_ON ? 1 : 0);
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return (rd->get.split == RIG_SPLIT_ON ? 1 : 0);
+}
+
+
+
+/** \brief Start updating the shared data.
+ *
+ * This function must be called before writing to 'set' or 'get' from
+ * outside of this module, ie. by the daemon. It must be followed by a call
+ * to rig_data_write_end() as soon as the new values have been stored.
+ *
+ * \note Never call a hamlib function between rig_data_write_begin() and
+ *       rig_data_write_end() since the readers spin while a write is in
+ *       progress.
+ */
+void
+rig_data_write_begin ()
+{
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	g_mutex_lock (&rd->datamutex);
+	g_atomic_int_inc (&rd->datasequence);
+}
+
+
+/** \brief Finish updating the shared data.
+ *
+ * \sa rig_data_write_begin()
+ */
+void
+rig_data_write_end   ()
+{
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	g_atomic_int_inc (&rd->datasequence);
+	g_mutex_unlock (&rd->datamutex);
+}
+
+
+/** \brief Start a consistent read of the shared data.
+ *  \return The sequence number to pass to rig_data_read_retry().
+ *
+ * Use this function together with rig_data_read_retry() to read one or
+ * more fields of 'set' or 'get' consistently:
+ *
+ * \code
+ * do {
+ *         seq = rig_data_read_begin ();
+ *         freq = get->freq1;
+ * } while (rig_data_read_retry (seq));
+ * \endcode
+ */
+guint
+rig_data_read_begin  ()
+{
+	rig_data_t *rd = RIG_DATA_CUR ();
+	guint seq;
+
+	while ((seq = g_atomic_int_get (&rd->datasequence)) & 1) {
+		/* writer active; it will be done in no time */
+	}
+
+	return seq;
+}
+
+
+/** \brief Check whether a consistent read has to be repeated.
+ *  \param seq The value returned by rig_data_read_begin().
+ *  \return TRUE if the data has been modified during the read.
+ */
+gboolean
+rig_data_read_retry  (guint seq)
+{
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return (guint) g_atomic_int_get (&rd->datasequence) != seq;
+}
+
+
+/** \brief Get a consistent copy of the current rig settings.
+ *  \param snap Pointer to a structure where the copy will be stored.
+ *
+ * This function copies the whole 'get' structure in one go. GUI code
+ * should use it once per refresh instead of calling the individual getter
+ * functions, since the returned values are guaranteed to belong together
+ * (eg. mode, passband width and frequency limits).
+ */
+void
+rig_data_snapshot    (grig_settings_t *snap)
+{
+	rig_data_t *rd = RIG_DATA_CUR ();
+	guint seq;
+
+	do {
+		seq = rig_data_read_begin ();
+		memcpy (snap, &rd->get, sizeof (grig_settings_t));
+	} while (rig_data_read_retry (seq));
+}
+
+
+/** \brief Get a consistent copy of the values commanded by the user.
+ *  \param snap Pointer to a structure where the copy will be stored.
+ *
+ * This function is used by the daemon before sending a new value to the
+ * rig.
+ */
+void
+rig_data_snapshot_set (grig_settings_t *snap)
+{
+	rig_data_t *rd = RIG_DATA_CUR ();
+	guint seq;
+
+	do {
+		seq = rig_data_read_begin ();
+		memcpy (snap, &rd->set, sizeof (grig_settings_t));
+	} while (rig_data_read_retry (seq));
+}
+
+
+/** \brief Claim a pending 'new' flag.
+ *  \param flag Pointer to the flag in the 'new' structure.
+ *  \return TRUE if the flag was set, FALSE otherwise.
+ *
+ * This function atomically clears the flag and returns its old value.
+ * The daemon claims the flag before reading the corresponding value from
+ * 'set', so that a value written by the user while the command is being
+ * executed raises the flag again instead of being lost.
+ */
+gboolean
+rig_data_claim_new   (int *flag)
+{
+	return g_atomic_int_compare_and_exchange ((volatile gint *) flag, 1, 0);
+}
+
+
+/** \brief Mark fields as changed.
+ *  \param mask The changed fields, see RIG_DATA_DIRTY().
+ *
+ * This function records the changed fields of the current rig and
+ * schedules a dispatch to the listeners in the main loop. It may be called
+ * from any thread; several calls before the main loop runs the dispatch are
+ * merged into a single notification. The new values are also published
+ * in shared memory, see rig_shm_publish().
+ */
+void
+rig_data_mark_dirty  (guint64 mask)
+{
+	rig_data_mark_dirty_rig (rig_data_current (), mask);
+	rig_shm_publish (mask);
+}
+
+
+/** \brief Mark fields of a specific rig as changed.
+ *  \param rig The rig.
+ *  \param mask The changed fields, see RIG_DATA_DIRTY().
+ */
+static void
+rig_data_mark_dirty_rig (gint rig, guint64 mask)
+{
+	rig_data_t *rd = &rigdata[rig];
+
+	if (mask == 0)
+		return;
+
+	g_mutex_lock (&rd->dirtymutex);
+	rd->dirtymask |= mask;
+	if (rd->dirtyidle == 0) {
+		rd->dirtyidle = g_idle_add (rig_data_dispatch_dirty, GINT_TO_POINTER (rig));
+	}
+	g_mutex_unlock (&rd->dirtymutex);
+}
+
+
+/** \brief Deliver pending change notifications.
+ *  \param data The rig whose fields have changed.
+ *  \return Always FALSE.
+ *
+ * This function is executed in the main loop. It takes the accumulated
+ * change mask of the rig and calls each listener interested in any of the
+ * changed fields. Listeners following the selected rig are only called if
+ * the rig is selected. While the listeners run, the main thread is bound
+ * to the rig so that they read its values.
+ */
+static gboolean
+rig_data_dispatch_dirty (gpointer data)
+{
+	rig_data_listener_entry_t *entry;
+	rig_data_t *rd;
+	GSList  *node;
+	GSList  *next;
+	guint64  mask;
+	gint     rig;
+	gint     prev;
+	gint64   start;
+
+	start = grig_timeline_begin ();
+	rig = GPOINTER_TO_INT (data);
+	rd = &rigdata[rig];
+
+	g_mutex_lock (&rd->dirtymutex);
+	mask = rd->dirtymask;
+	rd->dirtymask = 0;
+	rd->dirtyidle = 0;
+	g_mutex_unlock (&rd->dirtymutex);
+
+	prev = rig_data_bind (rig);
+
+	/* listeners may remove any listener from the callback; the entries
+	   are only marked while the list is walked and unlinked afterwards
+	*/
+	dispatching++;
+
+	for (node = listeners; node != NULL; node = node->next) {
+		entry = (rig_data_listener_entry_t *) node->data;
+
+		if (entry->callback == NULL)
+			continue;
+
+		if ((entry->rig != rig) &&
+		    ((entry->rig != RIG_DATA_RIG_SELECTED) || (rig != selected)))
+			continue;
+
+		if (entry->mask & mask) {
+			entry->callback (entry->mask & mask, entry->data);
+		}
+	}
+
+	dispatching--;
+
+	if ((dispatching == 0) && listenersdead) {
+		listenersdead = FALSE;
+
+		for (node = listeners; node != NULL; node = next) {
+			next = node->next;
+			entry = (rig_data_listener_entry_t *) node->data;
+
+			if (entry->callback == NULL) {
+				listeners = g_slist_delete_link (listeners, node);
+				g_free (entry);
+			}
+		}
+	}
+
+	rig_data_bind (prev);
+
+	/* covers the redraws done by the listeners */
+	grig_timeline_end ("gui", __FUNCTION__, start, "rig", rig);
+
+	return FALSE;
+}
+
+
+/** \brief Register a change notification listener.
+ *  \param mask The fields the listener is interested in.
+ *  \param callback The function to call when any of the fields change.
+ *  \param data User data passed to the callback.
+ *  \return The listener ID, to be used with rig_data_remove_listener().
+ *
+ * The callback is always executed in the main loop. A notification for
+ * all fields in mask is scheduled right away, so that the listener can
+ * use it to draw the initial values.
+ *
+ * The listener follows the rig selected with rig_data_select(); use
+ * rig_data_add_rig_listener() to bind it to a specific rig.
+ */
+guint
+rig_data_add_listener (guint64 mask, rig_data_listener_t callback, gpointer data)
+{
+	return rig_data_add_rig_listener (RIG_DATA_RIG_SELECTED, mask, callback, data);
+}
+
+
+/** \brief Register a change notification listener for a specific rig.
+ *  \param rig The rig or RIG_DATA_RIG_SELECTED to follow the selection.
+ *  \param mask The fields the listener is interested in.
+ *  \param callback The function to call when any of the fields change.
+ *  \param data User data passed to the callback.
+ *  \return The listener ID, to be used with rig_data_remove_listener().
+ *
+ * This function is used by windows that are bound to one rig regardless
+ * of the rig selected in the main window.
+ */
+guint
+rig_data_add_rig_listener (gint rig, guint64 mask,
+			   rig_data_listener_t callback, gpointer data)
+{
+	rig_data_listener_entry_t *entry;
+
+	if ((rig < RIG_DATA_RIG_SELECTED) || (rig >= C_MAX_RIGS)) {
+		return 0;
+	}
+
+	entry = g_new (rig_data_listener_entry_t, 1);
+	entry->id = ++listenerid;
+	entry->rig = rig;
+	entry->mask = mask;
+	entry->callback = callback;
+	entry->data = data;
+
+	listeners = g_slist_append (listeners, entry);
+
+	rig_data_mark_dirty_rig ((rig == RIG_DATA_RIG_SELECTED) ? selected : rig, mask);
+
+	return entry->id;
+}
+
+
+/** \brief Remove a change notification listener.
+ *  \param id The listener ID returned by rig_data_add_listener().
+ *
+ * The listener is not called any more. If a dispatch is running, i.e. a
+ * listener removes itself or another one, the entry is unlinked when the
+ * dispatch is done.
+ */
+void
+rig_data_remove_listener (guint id)
+{
+	GSList *node;
+
+	for (node = listeners; node != NULL; node = node->next) {
+		rig_data_listener_entry_t *entry = (rig_data_listener_entry_t *) node->data;
+
+		if ((entry->id == id) && (entry->callback != NULL)) {
+			if (dispatching) {
+				entry->callback = NULL;
+				listenersdead = TRUE;
+			}
+			else {
+				listeners = g_slist_delete_link (listeners, node);
+				g_free (entry);
+			}
+			return;
+		}
+	}
+}
+
+
+/** \brief Select the rig used by the GUI.
+ *  \param rig The rig.
+ *
+ * All rig-data API calls made from the main loop, outside of listeners
+ * bound to another rig, refer to the selected rig. Listeners following
+ * the selection are notified about all fields so that they can redraw.
+ */
+void
+rig_data_select      (gint rig)
+{
+	if ((rig < 0) || (rig >= C_MAX_RIGS) || (rig == selected)) {
+		return;
+	}
+
+	selected = rig;
+
+	rig_data_mark_dirty_rig (rig, RIG_DATA_DIRTY_ALL);
+}
+
+
+/** \brief Get the rig used by the GUI.
+ *  \return The selected rig.
+ */
+gint
+rig_data_get_selected (void)
+{
+	return selected;
+}
+
+
+/** \brief Bind the calling thread to a rig.
+ *  \param rig The rig or RIG_DATA_RIG_SELECTED to use the selected rig.
+ *  \return The previous binding, to be restored when done.
+ *
+ * Each daemon thread binds itself to its rig so that the shared rig-data,
+ * scheduler and anomaly functions refer to that rig. The debug messages
+ * of the thread are filtered with the debug level of the rig.
+ */
+gint
+rig_data_bind        (gint rig)
+{
+	gint prev;
+
+	prev = GPOINTER_TO_INT (g_private_get (&boundrig)) - 1;
+
+	if ((rig < 0) || (rig >= C_MAX_RIGS)) {
+		rig = RIG_DATA_RIG_SELECTED;
+	}
+
+	g_private_set (&boundrig, GINT_TO_POINTER (rig + 1));
+	grig_debug_set_rig (rig);
+
+	return prev;
+}
+
+
+/** \brief Get the current rig.
+ *  \return The rig the calling thread is bound to or the selected rig.
+ */
+gint
+rig_data_current     (void)
+{
+	gint rig;
+
+	rig = GPOINTER_TO_INT (g_private_get (&boundrig)) - 1;
+
+	return (rig >= 0) ? rig : selected;
 }
 
 
@@ -1248,7 +1980,9 @@ rig_data_get_split ()
 grig_settings_t  *
 rig_data_get_get_addr ()
 {
-	return &get;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return &rd->get;
 }
 
 
@@ -1263,7 +1997,9 @@ rig_data_get_get_addr ()
 grig_settings_t  *
 rig_data_get_set_addr ()
 {
-	return &set;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return &rd->set;
 }
 
 
@@ -1278,7 +2014,9 @@ rig_data_get_set_addr ()
 grig_cmd_avail_t *
 rig_data_get_new_addr ()
 {
-	return &new;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return &rd->new;
 }
 
 
@@ -1293,7 +2031,9 @@ rig_data_get_new_addr ()
 grig_cmd_avail_t *
 rig_data_get_has_set_addr ()
 {
-	return &has_set;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return &rd->has_set;
 }
 
 
@@ -1308,7 +2048,9 @@ rig_data_get_has_set_addr ()
 grig_cmd_avail_t *
 rig_data_get_has_get_addr ()
 {
-	return &has_get;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return &rd->has_get;
 }
 
 
@@ -1317,7 +2059,9 @@ rig_data_get_has_get_addr ()
 int
 rig_data_get_all_modes    ()
 {
-	return get.allmodes;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.allmodes;
 }
 
 
@@ -1325,7 +2069,9 @@ rig_data_get_all_modes    ()
 int
 rig_data_get_all_antennas    ()
 {
-	return get.allantennas;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.allantennas;
 }
 
 
@@ -1333,7 +2079,9 @@ rig_data_get_all_antennas    ()
 void
 rig_data_set_max_rfpwr (float maxpow)
 {
-	maxpwr = maxpow;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rd->maxpwr = maxpow;
 }
 
 
@@ -1341,7 +2089,9 @@ rig_data_set_max_rfpwr (float maxpow)
 float
 rig_data_get_max_rfpwr ()
 {
-	return maxpwr;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->maxpwr;
 }
 
 
@@ -1349,27 +2099,38 @@ rig_data_get_max_rfpwr ()
 int
 rig_data_has_get_afg (void)
 {
-	return has_get.afg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.afg;
 }
 
 int
 rig_data_has_set_afg (void)
 {
-	return has_set.afg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.afg;
 }
 
 float
 rig_data_get_afg     (void)
 {
-	return get.afg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.afg;
 }
 
 void
 rig_data_set_afg     (float afg)
 {
-	set.afg = afg;
-	get.afg = afg;
-	new.afg = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.afg = afg;
+	rd->get.afg = afg;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.afg, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_AF);
 }
 
 
@@ -1377,27 +2138,38 @@ rig_data_set_afg     (float afg)
 int
 rig_data_has_get_rfg (void)
 {
-	return has_get.rfg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.rfg;
 }
 
 int
 rig_data_has_set_rfg (void)
 {
-	return has_set.rfg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.rfg;
 }
 
 float
 rig_data_get_rfg     (void)
 {
-	return get.rfg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.rfg;
 }
 
 void
 rig_data_set_rfg     (float rfg)
 {
-	set.rfg = rfg;
-	get.rfg = rfg;
-	new.rfg = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.rfg = rfg;
+	rd->get.rfg = rfg;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.rfg, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_RF);
 }
 
 
@@ -1405,27 +2177,38 @@ rig_data_set_rfg     (float rfg)
 int
 rig_data_has_get_sql (void)
 {
-	return has_get.sql;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.sql;
 }
 
 int
 rig_data_has_set_sql (void)
 {
-	return has_set.sql;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.sql;
 }
 
 float
 rig_data_get_sql     (void)
 {
-	return get.sql;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.sql;
 }
 
 void
 rig_data_set_sql     (float sql)
 {
-	set.sql = sql;
-	get.sql = sql;
-	new.sql = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.sql = sql;
+	rd->get.sql = sql;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.sql, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_SQL);
 }
 
 
@@ -1433,39 +2216,54 @@ rig_data_set_sql     (float sql)
 int
 rig_data_has_get_ifs (void)
 {
-	return has_get.ifs;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.ifs;
 }
 
 int
 rig_data_has_set_ifs (void)
 {
-	return has_set.ifs;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.ifs;
 }
 
 int
 rig_data_get_ifs     (void)
 {
-	return get.ifs;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.ifs;
 }
 
 void
 rig_data_set_ifs     (int ifs)
 {
-	set.ifs = ifs;
-	get.ifs = ifs;
-	new.ifs = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.ifs = ifs;
+	rd->get.ifs = ifs;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.ifs, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_IFS);
 }
 
 shortfreq_t
 rig_data_get_ifsmax     ()
 {
-	return get.ifsmax;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.ifsmax;
 }
 
 shortfreq_t
 rig_data_get_ifsstep    ()
 {
-	return get.ifsstep;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.ifsstep;
 }
 
 
@@ -1473,27 +2271,38 @@ rig_data_get_ifsstep    ()
 int
 rig_data_has_get_apf (void)
 {
-	return has_get.apf;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.apf;
 }
 
 int
 rig_data_has_set_apf (void)
 {
-	return has_set.apf;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.apf;
 }
 
 float
 rig_data_get_apf     (void)
 {
-	return get.apf;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.apf;
 }
 
 void
 rig_data_set_apf     (float apf)
 {
-	set.apf = apf;
-	get.apf = apf;
-	new.apf = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.apf = apf;
+	rd->get.apf = apf;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.apf, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_APF);
 }
 
 
@@ -1501,25 +2310,36 @@ rig_data_set_apf     (float apf)
 int
 rig_data_has_get_nr (void)
 {
-	return has_get.nr;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.nr;
 }
 
 int
 rig_data_has_set_nr (void)
 {
-	return has_set.nr;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.nr;
 }
 
 float rig_data_get_nr     (void)
 {
-	return get.nr;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.nr;
 }
 
 void  rig_data_set_nr     (float nr)
 {
-	set.nr = nr;
-	get.nr = nr;
-	new.nr = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.nr = nr;
+	rd->get.nr = nr;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.nr, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_NR);
 }
 	
 
@@ -1527,27 +2347,38 @@ void  rig_data_set_nr     (float nr)
 int
 rig_data_has_get_notch (void)
 {
-	return has_get.notch;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.notch;
 }
 
 int
 rig_data_has_set_notch (void)
 {
-	return has_set.notch;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.notch;
 }
 
 int
 rig_data_get_notch     (void)
 {
-	return get.notch;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.notch;
 }
 
 void
 rig_data_set_notch     (int notch)
 {
-	set.notch = notch;
-	get.notch = notch;
-	new.notch = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.notch = notch;
+	rd->get.notch = notch;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.notch, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_NOTCH);
 }
 
 
@@ -1555,27 +2386,38 @@ rig_data_set_notch     (int notch)
 int
 rig_data_has_get_pbtin (void)
 {
-	return has_get.pbtin;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.pbtin;
 }
 
 int
 rig_data_has_set_pbtin (void)
 {
-	return has_set.pbtin;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.pbtin;
 }
 
 float
 rig_data_get_pbtin     (void)
 {
-	return get.pbtin;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.pbtin;
 }
 
 void
 rig_data_set_pbtin     (float pbt)
 {
-	set.pbtin = pbt;
-	get.pbtin = pbt;
-	new.pbtin = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.pbtin = pbt;
+	rd->get.pbtin = pbt;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.pbtin, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_PBT_IN);
 }
 
 
@@ -1583,54 +2425,76 @@ rig_data_set_pbtin     (float pbt)
 int
 rig_data_has_get_pbtout (void)
 {
-	return has_get.pbtout;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.pbtout;
 }
 
 int
 rig_data_has_set_pbtout (void)
 {
-	return has_set.pbtout;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.pbtout;
 }
 
 float
 rig_data_get_pbtout     (void)
 {
-	return get.pbtout;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.pbtout;
 }
 
 void
 rig_data_set_pbtout     (float pbt)
 {
-	set.pbtout = pbt;
-	get.pbtout = pbt;
-	new.pbtout = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.pbtout = pbt;
+	rd->get.pbtout = pbt;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.pbtout, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_PBT_OUT);
 }
 
 /* CW pitch */
 int
 rig_data_has_get_cwpitch (void)
 {
-	return has_get.cwpitch;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.cwpitch;
 }
 
 int
 rig_data_has_set_cwpitch (void)
 {
-	return has_set.cwpitch;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.cwpitch;
 }
 
 int
 rig_data_get_cwpitch     (void)
 {
-	return get.cwpitch;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.cwpitch;
 }
 
 void
 rig_data_set_cwpitch     (int cwp)
 {
-	set.cwpitch = cwp;
-	get.cwpitch = cwp;
-	new.cwpitch = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.cwpitch = cwp;
+	rd->get.cwpitch = cwp;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.cwpitch, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_CW_PITCH);
 }
 
 
@@ -1638,54 +2502,76 @@ rig_data_set_cwpitch     (int cwp)
 int
 rig_data_has_get_keyspd (void)
 {
-	return has_get.keyspd;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.keyspd;
 }
 
 int
 rig_data_has_set_keyspd (void)
 {
-	return has_set.keyspd;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.keyspd;
 }
 
 int
 rig_data_get_keyspd     (void)
 {
-	return get.keyspd;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.keyspd;
 }
 
 void
 rig_data_set_keyspd     (int keyspd)
 {
-	set.keyspd = keyspd;
-	get.keyspd = keyspd;
-	new.keyspd = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.keyspd = keyspd;
+	rd->get.keyspd = keyspd;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.keyspd, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_KEYSPD);
 }
 
 /* break-in delay */
 int
 rig_data_has_get_bkindel (void)
 {
-	return has_get.bkindel;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.bkindel;
 }
 
 int
 rig_data_has_set_bkindel (void)
 {
-	return has_set.bkindel;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.bkindel;
 }
 
 int
 rig_data_get_bkindel     (void)
 {
-	return get.bkindel;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.bkindel;
 }
 
 void
 rig_data_set_bkindel     (int bkindel)
 {
-	set.bkindel = bkindel;
-	get.bkindel = bkindel;
-	new.bkindel = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.bkindel = bkindel;
+	rd->get.bkindel = bkindel;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.bkindel, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_BKINDEL);
 }
 
 
@@ -1693,162 +2579,228 @@ rig_data_set_bkindel     (int bkindel)
 int
 rig_data_has_get_balance (void)
 {
-	return has_get.balance;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.balance;
 }
 
 int
 rig_data_has_set_balance (void)
 {
-	return has_set.balance;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.balance;
 }
 
 float
 rig_data_get_balance     (void)
 {
-	return get.balance;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.balance;
 }
 
 void
 rig_data_set_balance     (float bal)
 {
-	set.balance = bal;
-	get.balance = bal;
-	new.balance = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.balance = bal;
+	rd->get.balance = bal;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.balance, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_BALANCE);
 }
 
 /* VOX delay */
 int
 rig_data_has_get_voxdel (void)
 {
-	return has_get.voxdel;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.voxdel;
 }
 
 int
 rig_data_has_set_voxdel (void)
 {
-	return has_set.voxdel;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.voxdel;
 }
 
 int
 rig_data_get_voxdel     (void)
 {
-	return get.voxdel;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.voxdel;
 }
 
 void
 rig_data_set_voxdel     (int voxdel)
 {
-	set.voxdel = voxdel;
-	get.voxdel = voxdel;
-	new.voxdel = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.voxdel = voxdel;
+	rd->get.voxdel = voxdel;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.voxdel, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_VOXDEL);
 }
 
 /* VOX gain */
 int
 rig_data_has_get_voxg (void)
 {
-	return has_get.voxg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.voxg;
 }
 
 int
 rig_data_has_set_voxg (void)
 {
-	return has_set.voxg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.voxg;
 }
 
 float
 rig_data_get_voxg     (void)
 {
-	return get.voxg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.voxg;
 }
 
 void
 rig_data_set_voxg     (float voxg)
 {
-	set.voxg = voxg;
-	get.voxg = voxg;
-	new.voxg = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.voxg = voxg;
+	rd->get.voxg = voxg;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.voxg, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_VOXGAIN);
 }
 
 /* anti VOX */
 int
 rig_data_has_get_antivox (void)
 {
-	return has_get.antivox;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.antivox;
 }
 
 int
 rig_data_has_set_antivox (void)
 {
-	return has_set.antivox;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.antivox;
 }
 
 float
 rig_data_get_antivox     (void)
 {
-	return get.antivox;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.antivox;
 }
 
 void
 rig_data_set_antivox     (float antivox)
 {
-	set.antivox = antivox;
-	get.antivox = antivox;
-	new.antivox = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.antivox = antivox;
+	rd->get.antivox = antivox;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.antivox, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_ANTIVOX);
 }
 
 /* MIC gain */
 int
 rig_data_has_get_micg (void)
 {
-	return has_get.micg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.micg;
 }
 
 int
 rig_data_has_set_micg (void)
 {
-	return has_set.micg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.micg;
 }
 
 float
 rig_data_get_micg     (void)
 {
-	return get.micg;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.micg;
 }
 
 void
 rig_data_set_micg     (float micg)
 {
-	set.micg = micg;
-	get.micg = micg;
-	new.micg = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.micg = micg;
+	rd->get.micg = micg;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.micg, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_MICGAIN);
 }
 
 /* compression */
 int
 rig_data_has_get_comp (void)
 {
-	return has_get.comp;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_get.comp;
 }
 
 int
 rig_data_has_set_comp (void)
 {
-	return has_set.comp;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->has_set.comp;
 }
 
 float
 rig_data_get_comp     (void)
 {
-	return get.comp;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	return rd->get.comp;
 }
 
 void
 rig_data_set_comp     (float comp)
 {
-	set.comp = comp;
-	get.comp = comp;
-	new.comp = TRUE;
+	rig_data_t *rd = RIG_DATA_CUR ();
+
+	rig_data_write_begin ();
+	rd->set.comp = comp;
+	rd->get.comp = comp;
+	rig_data_write_end ();
+	g_atomic_int_set (&rd->new.comp, 1);
+	rig_daemon_post_cmd (RIG_CMD_SET_COMP);
 }
 
 
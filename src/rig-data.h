@@ -188,6 +188,70 @@ typedef struct {
 } grig_cmd_avail_t;
 
 
+/** \brief Fields of grig_settings_t used in change notifications.
+ *
+ * Each field corresponds to one bit in the change mask passed to
+ * the listeners registered with rig_data_add_listener().
+ */
+typedef enum {
+	RIG_DATA_FIELD_PSTAT = 0,
+	RIG_DATA_FIELD_PTT,
+	RIG_DATA_FIELD_LOCK,
+	RIG_DATA_FIELD_VFO,
+	RIG_DATA_FIELD_MODE,
+	RIG_DATA_FIELD_PBW,
+	RIG_DATA_FIELD_FREQ1,
+	RIG_DATA_FIELD_FREQ2,
+	RIG_DATA_FIELD_RIT,
+	RIG_DATA_FIELD_XIT,
+	RIG_DATA_FIELD_AGC,
+	RIG_DATA_FIELD_ATT,
+	RIG_DATA_FIELD_PREAMP,
+	RIG_DATA_FIELD_SPLIT,
+	RIG_DATA_FIELD_ANTENNA,
+	RIG_DATA_FIELD_AFG,
+	RIG_DATA_FIELD_RFG,
+	RIG_DATA_FIELD_SQL,
+	RIG_DATA_FIELD_IFS,
+	RIG_DATA_FIELD_APF,
+	RIG_DATA_FIELD_NR,
+	RIG_DATA_FIELD_NOTCH,
+	RIG_DATA_FIELD_PBTIN,
+	RIG_DATA_FIELD_PBTOUT,
+	RIG_DATA_FIELD_CWPITCH,
+	RIG_DATA_FIELD_KEYSPD,
+	RIG_DATA_FIELD_BKINDEL,
+	RIG_DATA_FIELD_BALANCE,
+	RIG_DATA_FIELD_VOXDEL,
+	RIG_DATA_FIELD_VOXG,
+	RIG_DATA_FIELD_ANTIVOX,
+	RIG_DATA_FIELD_MICG,
+	RIG_DATA_FIELD_COMP,
+	RIG_DATA_FIELD_POWER,
+	RIG_DATA_FIELD_STRENGTH,
+	RIG_DATA_FIELD_SWR,
+	RIG_DATA_FIELD_ALC,
+	RIG_DATA_FIELD_FUNCS,
+	RIG_DATA_FIELD_FLIMITS,   /*!< fmin, fmax and fstep */
+	RIG_DATA_FIELD_NUMBER
+} rig_data_field_t;
+
+/** \brief Convert a field to its bit in the change mask. */
+#define RIG_DATA_DIRTY(field) (G_GUINT64_CONSTANT (1) << (field))
+
+/** \brief Change mask matching every field. */
+#define RIG_DATA_DIRTY_ALL    (~G_GUINT64_CONSTANT (0))
+
+/** \brief Change notification callback.
+ *  \param changed The fields that have changed (and the listener is interested in).
+ *  \param data The user data passed to rig_data_add_listener().
+ */
+typedef void (*rig_data_listener_t) (guint64 changed, gpointer data);
+
+/** \brief Rig argument referring to the rig selected in the GUI. */
+#define RIG_DATA_RIG_SELECTED (-1)
+
+
 #define GRIG_LEVEL_RD (RIG_LEVEL_RFPOWER | RIG_LEVEL_AGC | RIG_LEVEL_SWR | RIG_LEVEL_ALC | \
                        RIG_LEVEL_STRENGTH | RIG_LEVEL_ATT | RIG_LEVEL_PREAMP | \
                        RIG_LEVEL_VOXDELAY | RIG_LEVEL_AF | RIG_LEVEL_RF | RIG_LEVEL_SQL | \
@@ -463,6 +527,27 @@ int   rig_data_has_set_vfo  (void);
 vfo_t rig_data_get_vfo      (void);
 void  rig_data_set_vfo      (vfo_t);
 
+/* consistent access to shared data */
+void      rig_data_write_begin  (void);
+void      rig_data_write_end    (void);
+guint     rig_data_read_begin   (void);
+gboolean  rig_data_read_retry   (guint);
+void      rig_data_snapshot     (grig_settings_t *);
+void      rig_data_snapshot_set (grig_settings_t *);
+gboolean  rig_data_claim_new    (int *);
+
+/* change notification */
+void      rig_data_mark_dirty      (guint64);
+guint     rig_data_add_listener    (guint64, rig_data_listener_t, gpointer);
+guint     rig_data_add_rig_listener (gint, guint64, rig_data_listener_t, gpointer);
+void      rig_data_remove_listener (guint);
+
+/* rig selection */
+void      rig_data_select       (gint);
+gint      rig_data_get_selected (void);
+gint      rig_data_bind         (gint);
+gint      rig_data_current      (void);
+
 /* address acquisition functions */
 grig_settings_t  *rig_data_get_get_addr     (void);
 grig_settings_t  *rig_data_get_set_addr     (void);
@@ -0,0 +1,201 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file rig-gui-anomaly.c
+ *  \ingroup info
+ *  \brief Command error statistics.
+ *
+ * This dialog lists the commands which have failed since the rig has been
+ * opened, together with the statistics collected by the anomaly manager
+ * (see rig-anomaly.c).
+ */
+#include <gtk/gtk.h>
+#include <hamlib/rig.h>
+#include <glib/gi18n.h>
+#include "rig-daemon.h"
+#include "rig-anomaly.h"
+#include "rig-gui-anomaly.h"
+
+extern GtkWidget   *grigapp;    /* defined in main.c */
+
+
+/** \brief Columns in the command list. */
+typedef enum {
+	ANOMALY_COL_CMD = 0,
+	ANOMALY_COL_TOTAL,
+	ANOMALY_COL_RECENT,
+	ANOMALY_COL_DISABLED,
+	ANOMALY_COL_STATUS,
+	ANOMALY_COL_NUMBER
+} anomaly_col_t;
+
+
+/** \brief Column titles. */
+static const gchar *ANOMALY_COL_TITLE[ANOMALY_COL_NUMBER] = {
+	N_("Command"),
+	N_("Errors"),
+	N_("Recent"),
+	N_("Disabled"),
+	N_("Status")
+};
+
+
+/** \brief Response ID of the refresh button. */
+#define RESPONSE_REFRESH 1
+
+
+static void rig_gui_anomaly_fill     (GtkListStore *);
+static void rig_gui_anomaly_response (GtkDialog *, gint, gpointer);
+
+
+
+/** \brief Create command error dialog.
+ *
+ * This function creates the dialog window which is used for showing
+ * the error statistics of the rig commands.
+ */
+void
+rig_gui_anomaly_run ()
+{
+	GtkWidget         *dialog;
+	GtkWidget         *treeview;
+	GtkWidget         *swin;
+	GtkListStore      *store;
+	GtkCellRenderer   *renderer;
+	GtkTreeViewColumn *column;
+	guint              i;
+
+
+	store = gtk_list_store_new (ANOMALY_COL_NUMBER,
+				    G_TYPE_STRING,
+				    G_TYPE_UINT,
+				    G_TYPE_UINT,
+				    G_TYPE_UINT,
+				    G_TYPE_STRING);
+	rig_gui_anomaly_fill (store);
+
+	treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+	g_object_unref (store);
+
+	for (i = 0; i < ANOMALY_COL_NUMBER; i++) {
+		renderer = gtk_cell_renderer_text_new ();
+		column = gtk_tree_view_column_new_with_attributes (_(ANOMALY_COL_TITLE[i]),
+								   renderer,
+								   "text", i,
+								   NULL);
+		gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+	}
+
+	swin = gtk_scrolled_window_new (NULL, NULL);
+	gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (swin),
+					GTK_POLICY_AUTOMATIC,
+					GTK_POLICY_AUTOMATIC);
+	gtk_container_add (GTK_CONTAINER (swin), treeview);
+
+	/* create dialog and add list */
+	dialog = gtk_dialog_new_with_buttons (_("Command Errors"), GTK_WINDOW (grigapp),
+					      GTK_DIALOG_DESTROY_WITH_PARENT,
+					      GTK_STOCK_REFRESH, RESPONSE_REFRESH,
+					      GTK_STOCK_CLOSE, GTK_RESPONSE_NONE, NULL);
+	gtk_window_set_default_size (GTK_WINDOW (dialog), -1, 300);
+
+	g_signal_connect (dialog, "response",
+			  G_CALLBACK (rig_gui_anomaly_response),
+			  store);
+
+	gtk_box_pack_start (GTK_BOX (GTK_DIALOG (dialog)->vbox),
+			    swin, TRUE, TRUE, 0);
+
+	gtk_widget_show_all (dialog);
+}
+
+
+/** \brief Fill the command list.
+ *  \param store The list store.
+ *
+ * Only commands that have failed at least once are listed.
+ */
+static void
+rig_gui_anomaly_fill (GtkListStore *store)
+{
+	rig_anomaly_stats_t stats;
+	GtkTreeIter         item;
+	gchar              *status;
+	gint64              now;
+	guint               i;
+
+
+	gtk_list_store_clear (store);
+
+	now = g_get_monotonic_time ();
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		if (!rig_anomaly_get_stats (i, &stats) || (stats.total == 0))
+			continue;
+
+		if (stats.off) {
+			status = g_strdup_printf (_("Disabled, retry in %d sec"),
+						  (gint) (MAX (stats.reprobe - now, 0) / G_USEC_PER_SEC));
+		}
+		else {
+			status = g_strdup (_("Enabled"));
+		}
+
+		gtk_list_store_append (store, &item);
+		gtk_list_store_set (store, &item,
+				    ANOMALY_COL_CMD, rig_daemon_cmd_to_str (i),
+				    ANOMALY_COL_TOTAL, stats.total,
+				    ANOMALY_COL_RECENT, stats.recent,
+				    ANOMALY_COL_DISABLED, stats.disabled,
+				    ANOMALY_COL_STATUS, status,
+				    -1);
+
+		g_free (status);
+	}
+}
+
+
+/** \brief Handle dialog response.
+ *  \param dialog The dialog.
+ *  \param response The response ID.
+ *  \param store The list store.
+ */
+static void
+rig_gui_anomaly_response (GtkDialog *dialog, gint response, gpointer store)
+{
+	if (response == RESPONSE_REFRESH) {
+		rig_gui_anomaly_fill (GTK_LIST_STORE (store));
+	}
+	else {
+		gtk_widget_destroy (GTK_WIDGET (dialog));
+	}
+}
@@ -41,7 +41,7 @@
 
 /** \brief Enumerated values representing the widgets.
  *
- * These values are used by the timeout function to identify
+ * These values are used by the change listener to identify
  * each particular widget within the main container. The values
  * are attached to the widgets.
  */
@@ -62,6 +62,13 @@ typedef enum rig_gui_buttons_e {
 #define HANDLER_ID_KEY  "SIG"
 
 
+/** \brief Data passed to rig_gui_buttons_update(). */
+typedef struct {
+    grig_settings_t snap;      /*!< Snapshot of the rig settings. */
+    guint64         changed;   /*!< The fields that have changed. */
+} rig_gui_buttons_upd_t;
+
+
 /* private function prototypes */
 static GtkWidget *rig_gui_buttons_create_power_button    (void);
 static GtkWidget *rig_gui_buttons_create_ptt_button      (void);
@@ -75,8 +82,8 @@ static void rig_gui_buttons_lock_cb     (GtkWidget *, gpointer);
 static void rig_gui_buttons_att_cb      (GtkWidget *, gpointer);
 static void rig_gui_buttons_preamp_cb   (GtkWidget *, gpointer);
 
-static gint rig_gui_buttons_timeout_exec  (gpointer);
-static gint rig_gui_buttons_timeout_stop  (GtkWidget *, GdkEvent *, gpointer);
+static void rig_gui_buttons_changed       (guint64, gpointer);
+static gint rig_gui_buttons_listener_stop (GtkWidget *, GdkEvent *, gpointer);
 static void rig_gui_buttons_update        (GtkWidget *, gpointer);
 
 
@@ -90,7 +97,7 @@ GtkWidget *
 rig_gui_buttons_create ()
 {
     GtkWidget *vbox;    /* container */
-    guint timerid;
+    guint listenerid;
 
     /* create vertical box and add widgets */
     vbox = gtk_vbox_new (FALSE, 0);
@@ -114,15 +121,18 @@ rig_gui_buttons_create ()
                 rig_gui_buttons_create_att_selector (),
                 FALSE, FALSE, 0);
 
-    /* start readback timer */
-    timerid = g_timeout_add (RIG_GUI_BUTTONS_DEF_TVAL,
-                    rig_gui_buttons_timeout_exec,
-                    vbox);
+    /* listen for changes */
+    listenerid = rig_data_add_listener (RIG_DATA_DIRTY (RIG_DATA_FIELD_PSTAT) |
+                                        RIG_DATA_DIRTY (RIG_DATA_FIELD_PTT) |
+                                        RIG_DATA_DIRTY (RIG_DATA_FIELD_ATT) |
+                                        RIG_DATA_DIRTY (RIG_DATA_FIELD_PREAMP),
+                                        rig_gui_buttons_changed,
+                                        vbox);
 
-    /* register timer_stop function at exit */
+    /* register listener_stop function at exit */
     g_signal_connect(G_OBJECT(vbox), "destroy",
-                     G_CALLBACK (rig_gui_buttons_timeout_stop),
-                     GUINT_TO_POINTER(timerid));
+                     G_CALLBACK (rig_gui_buttons_listener_stop),
+                     GUINT_TO_POINTER(listenerid));
 
     gtk_widget_show_all (vbox);
 
@@ -493,48 +503,48 @@ rig_gui_buttons_preamp_cb   (GtkWidget *widget, gpointer data)
 
 
 
-/** \brief Execute timeout function.
+/** \brief Update the controls after a change notification.
+ *  \param changed The fields that have changed.
  *  \param vbox The composite widget containing the controls.
- *  \return Always TRUE to keep the timer running.
  *
  * This function reads the relevant rig settings from the rid-data object and
- * updates the control widgets within vbox. The function is called peridically
- * by the Gtk+ scheduler.
+ * updates the control widgets within vbox. The function is called by the
+ * rig-data object when any of the displayed settings have changed.
  *
  * \note Because this is an internal service, no checks are made on the sanity
  *       of the parameter (ie. whether it really is the vbox we think it is).
  */
-static gint 
-rig_gui_buttons_timeout_exec  (gpointer vbox)
+static void
+rig_gui_buttons_changed       (guint64 changed, gpointer vbox)
 {
+    rig_gui_buttons_upd_t upd;
+
+    /* read all settings in one go */
+    rig_data_snapshot (&upd.snap);
+    upd.changed = changed;
 
     /* update each child widget of the container */
     gtk_container_foreach (GTK_CONTAINER (vbox),
                     rig_gui_buttons_update,
-                    NULL);
-
-    return TRUE;
+                    &upd);
 }
 
 
 
-/** \brief Stop timeout function.
- *  \param timer The ID of the timer to stop.
+/** \brief Stop listening for changes.
+ *  \param data The ID of the listener.
  *  \return Always TRUE.
  *
- * This function is used to stop the readback timer just before the
- * program is quit. It should be called automatically by Gtk+ when
- * the gtk_main_loop is exited.
+ * This function is used to remove the change listener when the
+ * controls are destroyed. It should be called automatically by Gtk+
+ * when the gtk_main_loop is exited.
  */
 static gint
-rig_gui_buttons_timeout_stop (GtkWidget *widget,
-                              GdkEvent  *event,
-                              gpointer   data)
+rig_gui_buttons_listener_stop (GtkWidget *widget,
+                               GdkEvent  *event,
+                               gpointer   data)
 {
-
-    GSource *source = g_main_context_find_source_by_id (NULL, GPOINTER_TO_UINT (data));
-    if (source)
-        g_source_destroy (source);
+    rig_data_remove_listener (GPOINTER_TO_UINT (data));
 
     return TRUE;
 }
@@ -543,12 +553,12 @@ rig_gui_buttons_timeout_stop (GtkWidget *widget,
 
 /** \brief Update control widget.
  *  \param widget The widget to update.
- *  \param data User data; always NULL.
+ *  \param data Pointer to the snapshot and the changed fields.
  *
- * This function is called by the periodic timeout function in
- * order to update the control widgets. It is called with one
- * widget at a time. The function then checks the internal ID
- * of the widget and updates it accordingly.
+ * This function is called by the change listener in order to
+ * update the control widgets. It is called with one widget at
+ * a time. The function then checks the internal ID of the widget
+ * and updates it if the corresponding setting has changed.
  *
  * \note No checks are done to compare the current rig setting
  *       with the widget settings, instead the callback signal
@@ -562,6 +572,8 @@ rig_gui_buttons_timeout_stop (GtkWidget *widget,
 static void
 rig_gui_buttons_update        (GtkWidget *widget, gpointer data)
 {
+    rig_gui_buttons_upd_t *upd = (rig_gui_buttons_upd_t *) data;
+    grig_settings_t *snap = &upd->snap;
     guint id;
     gint  handler;
     powerstat_t pstat;
@@ -575,9 +587,12 @@ rig_gui_buttons_update        (GtkWidget *widget, gpointer data)
 
         /* power button */
     case RIG_GUI_POWER_BUTTON:
+
+        if (!(upd->changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_PSTAT)))
+            break;
         
         /* get power status */
-        pstat = rig_data_get_pstat ();
+        pstat = snap->pstat;
 
         /* get signal handler ID */
         handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), 
@@ -597,9 +612,12 @@ rig_gui_buttons_update        (GtkWidget *widget, gpointer data)
 
         /* ptt button */
     case RIG_GUI_PTT_BUTTON:
+
+        if (!(upd->changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_PTT)))
+            break;
         
         /* get PTT status */
-        ptt = rig_data_get_ptt ();
+        ptt = snap->ptt;
 
         /* get signal handler ID */
         handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), 
@@ -620,6 +638,9 @@ rig_gui_buttons_update        (GtkWidget *widget, gpointer data)
         /* ATT selector */
     case RIG_GUI_ATT_SELECTOR:
 
+        if (!(upd->changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_ATT)))
+            break;
+
         /* get signal handler ID */
         handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), 
                                     HANDLER_ID_KEY));
@@ -630,7 +651,7 @@ rig_gui_buttons_update        (GtkWidget *widget, gpointer data)
         /* get current ATT value; remember that -1 => ATT OFF
             which is the 0th element in the combo box list.
         */
-        attidx = rig_data_get_att_index (rig_data_get_att ()) + 1;
+        attidx = rig_data_get_att_index (snap->att) + 1;
         gtk_combo_box_set_active (GTK_COMBO_BOX (widget), attidx);
             
         /* unblock signal handler */
@@ -641,6 +662,9 @@ rig_gui_buttons_update        (GtkWidget *widget, gpointer data)
         /* PREAMP selector */
     case RIG_GUI_PREAMP_SELECTOR:
 
+        if (!(upd->changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_PREAMP)))
+            break;
+
         /* get signal handler ID */
         handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), 
                                     HANDLER_ID_KEY));
@@ -651,7 +675,7 @@ rig_gui_buttons_update        (GtkWidget *widget, gpointer data)
         /* get current preamp value; remember that -1 => ATT OFF
             which is the 0th element in the combo box list.
         */
-        attidx = rig_data_get_preamp_index (rig_data_get_preamp ()) + 1;
+        attidx = rig_data_get_preamp_index (snap->preamp) + 1;
         gtk_combo_box_set_active (GTK_COMBO_BOX (widget), attidx);
             
         /* unblock signal handler */
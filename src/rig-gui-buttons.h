@@ -34,16 +34,6 @@
 #define RIG_GUI_BUTTONS_H 1
 
 
-/** \brief Minimum delay in msec between widget updates. */
-#define RIG_GUI_BUTTONS_MIN_TVAL 500
-
-/** \brief Default delay in msec between widget updates. */
-#define RIG_GUI_BUTTONS_DEF_TVAL 967
-
-/** \brief Maximum delay in msec between widget updates. */
-#define RIG_GUI_BUTTONS_MAX_TVAL 10000
-
-
 GtkWidget *rig_gui_buttons_create (void);
 
 #endif
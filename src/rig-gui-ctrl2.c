@@ -44,7 +44,7 @@
 
 /** \brief Enumerated values representing the widgets.
  *
- * These values are used by the timeout function to identify
+ * These values are used by the change listener to identify
  * each particular widget within the main container. The values
  * are attached to the widgets.
  */
@@ -65,6 +65,13 @@ typedef enum rig_gui_ctrl2_e {
 #define HANDLER_ID_KEY  "SIG"
 
 
+/** \brief Data passed to rig_gui_ctrl2_update(). */
+typedef struct {
+    grig_settings_t snap;      /*!< Snapshot of the rig settings. */
+    guint64         changed;   /*!< The fields that have changed. */
+} rig_gui_ctrl2_upd_t;
+
+
 /** \brief Table to convert mode index to combo box index
  *
  * The hamlib modes can be converted to a linear index using the
@@ -124,18 +131,18 @@ gint cidx2mode[16] = {
 
 
 /* private function prototypes */
-static GtkWidget *rig_gui_ctrl2_create_agc_selector    (void);
-static GtkWidget *rig_gui_ctrl2_create_mode_selector   (void);
-static GtkWidget *rig_gui_ctrl2_create_filter_selector (void);
-static GtkWidget *rig_gui_ctrl2_create_antenna_selector (void);
+static GtkWidget *rig_gui_ctrl2_create_agc_selector    (const grig_settings_t *);
+static GtkWidget *rig_gui_ctrl2_create_mode_selector   (const grig_settings_t *);
+static GtkWidget *rig_gui_ctrl2_create_filter_selector (const grig_settings_t *);
+static GtkWidget *rig_gui_ctrl2_create_antenna_selector (const grig_settings_t *);
 
 static void rig_gui_ctrl2_agc_cb      (GtkWidget *, gpointer);
 static void rig_gui_ctrl2_mode_cb     (GtkWidget *, gpointer);
 static void rig_gui_ctrl2_filter_cb   (GtkWidget *, gpointer);
 static void rig_gui_ctrl2_antenna_cb  (GtkWidget *, gpointer);
 
-static gint rig_gui_ctrl2_timeout_exec  (gpointer);
-static gint rig_gui_ctrl2_timeout_stop  (GtkWidget *, GdkEvent *, gpointer);
+static void rig_gui_ctrl2_changed       (guint64, gpointer);
+static gint rig_gui_ctrl2_listener_stop (GtkWidget *, GdkEvent *, gpointer);
 static void rig_gui_ctrl2_update        (GtkWidget *, gpointer);
 
 
@@ -150,34 +157,41 @@ GtkWidget *
 rig_gui_ctrl2_create ()
 {
     GtkWidget *vbox;    /* container */
-    guint timerid;
+    grig_settings_t snap;
+    guint listenerid;
+
+    /* initial settings read in one go */
+    rig_data_snapshot (&snap);
 
     /* create vertical box and add widgets */
     vbox = gtk_vbox_new (FALSE, 0);
 
     /* add controls */
     gtk_box_pack_start   (GTK_BOX (vbox),
-                    rig_gui_ctrl2_create_mode_selector (),
+                    rig_gui_ctrl2_create_mode_selector (&snap),
                     FALSE, FALSE, 0);
     gtk_box_pack_start   (GTK_BOX (vbox),
-                    rig_gui_ctrl2_create_filter_selector (),
+                    rig_gui_ctrl2_create_filter_selector (&snap),
                     FALSE, FALSE, 0);
     gtk_box_pack_start   (GTK_BOX (vbox),
-                    rig_gui_ctrl2_create_agc_selector (),
+                    rig_gui_ctrl2_create_agc_selector (&snap),
                     FALSE, FALSE, 0);
     gtk_box_pack_start   (GTK_BOX (vbox),
-                    rig_gui_ctrl2_create_antenna_selector (),
+                    rig_gui_ctrl2_create_antenna_selector (&snap),
                     FALSE, FALSE, 0);
 
-    /* start readback timer */
-    timerid = g_timeout_add (RIG_GUI_CTRL2_DEF_TVAL,
-                    rig_gui_ctrl2_timeout_exec,
-                    vbox);
+    /* listen for changes */
+    listenerid = rig_data_add_listener (RIG_DATA_DIRTY (RIG_DATA_FIELD_MODE) |
+                                        RIG_DATA_DIRTY (RIG_DATA_FIELD_PBW) |
+                                        RIG_DATA_DIRTY (RIG_DATA_FIELD_AGC) |
+                                        RIG_DATA_DIRTY (RIG_DATA_FIELD_ANTENNA),
+                                        rig_gui_ctrl2_changed,
+                                        vbox);
 
-    /* register timer_stop function at exit */
+    /* register listener_stop function at exit */
     g_signal_connect(G_OBJECT(vbox), "destroy",
-                     G_CALLBACK (rig_gui_ctrl2_timeout_stop),
-                     GUINT_TO_POINTER(timerid));
+                     G_CALLBACK (rig_gui_ctrl2_listener_stop),
+                     GUINT_TO_POINTER(listenerid));
 
     gtk_widget_show_all (vbox);
 
@@ -187,6 +201,7 @@ rig_gui_ctrl2_create ()
 
 
 /** \brief Create AGC selector.
+ *  \param snap The current rig settings.
  *  \return The AGC selector widget.
  *
  * This function creates the widget used to select the AGC setting.
@@ -195,7 +210,7 @@ rig_gui_ctrl2_create ()
  * \bug Grig does not implement the RIG_AGC_USER option!
  */
 static GtkWidget *
-rig_gui_ctrl2_create_agc_selector    ()
+rig_gui_ctrl2_create_agc_selector    (const grig_settings_t *snap)
 {
     GtkWidget *combo;
     gint       sigid;
@@ -215,7 +230,7 @@ rig_gui_ctrl2_create_agc_selector    ()
     gtk_widget_set_tooltip_text (combo, _("Automatic Gain Control Level"));
 
     /* select current level */
-    switch (rig_data_get_agc ()) {
+    switch (snap->agc) {
 
     case RIG_AGC_OFF:
         gtk_combo_box_set_active (GTK_COMBO_BOX (combo), 0);
@@ -267,6 +282,7 @@ rig_gui_ctrl2_create_agc_selector    ()
 
 
 /** \brief Create mode selector.
+ *  \param snap The current rig settings.
  *  \return The mode selector widget.
  *
  * This function creates the widget used to select the current mode.
@@ -284,7 +300,7 @@ rig_gui_ctrl2_create_agc_selector    ()
  * \bug Grig does not implement the RIG_MODE_NONE mode.
  */
 static GtkWidget *
-rig_gui_ctrl2_create_mode_selector   ()
+rig_gui_ctrl2_create_mode_selector   (const grig_settings_t *snap)
 {
     GtkWidget   *combo;
     gint         sigid;
@@ -302,7 +318,7 @@ rig_gui_ctrl2_create_mode_selector   ()
         /* if this mode is supported, add entry to combo box,
             store indices and increment combo box index
         */
-        if (rig_data_get_all_modes () & mode) {
+        if (snap->allmodes & mode) {
 
             gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (combo),
                                             _(midx2str[i]));
@@ -316,7 +332,7 @@ rig_gui_ctrl2_create_mode_selector   ()
 
     /* set current mode */
     gtk_combo_box_set_active (GTK_COMBO_BOX (combo),
-                    midx2cidx[rig_utils_mode_to_index (rig_data_get_mode ())]);
+                    midx2cidx[rig_utils_mode_to_index (snap->mode)]);
 
     gtk_widget_set_tooltip_text (combo, _("Communication mode"));
 
@@ -340,6 +356,7 @@ rig_gui_ctrl2_create_mode_selector   ()
 
 
 /** \brief Create filter selector.
+ *  \param snap The current rig settings.
  *  \return The filter selctor widget.
  *
  * This function creates the filter/bandwidth selector widget. The current
@@ -347,7 +364,7 @@ rig_gui_ctrl2_create_mode_selector   ()
  * and RIG_PASSBAND_WIDE.
  */
 static GtkWidget *
-rig_gui_ctrl2_create_filter_selector ()
+rig_gui_ctrl2_create_filter_selector (const grig_settings_t *snap)
 {
     GtkWidget   *combo;
     gint         sigid;
@@ -363,7 +380,7 @@ rig_gui_ctrl2_create_filter_selector ()
     gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (combo), _("[User]"));
 
     /* set current passband width */
-    switch (rig_data_get_pbwidth ()) {
+    switch (snap->pbw) {
 
     case RIG_DATA_PB_WIDE:
         gtk_combo_box_set_active (GTK_COMBO_BOX (combo), 0);
@@ -403,6 +420,7 @@ rig_gui_ctrl2_create_filter_selector ()
 }
 
 /** \brief Create antenna selector.
+ *  \param snap The current rig settings.
  *  \return The antenna selector widget.
  *
  * This function creates the widget used to select the current antenna.
@@ -420,7 +438,7 @@ rig_gui_ctrl2_create_filter_selector ()
  * \bug Grig does not implement the RIG_ANT_NONE antenna.
  */
 static GtkWidget *
-rig_gui_ctrl2_create_antenna_selector   ()
+rig_gui_ctrl2_create_antenna_selector   (const grig_settings_t *snap)
 {
 	GtkWidget   *combo;
 	gint         sigid;
@@ -439,7 +457,7 @@ rig_gui_ctrl2_create_antenna_selector   ()
 		/* if this antenna is supported, add entry to combo box,
 		   store indices and increment combo box index
 		*/
-		if (rig_data_get_all_antennas () & antenna) {
+		if (snap->allantennas & antenna) {
 
 			snprintf(antstr, sizeof(antstr)-1, _("ANT %d"), i+1);
 
@@ -455,7 +473,7 @@ rig_gui_ctrl2_create_antenna_selector   ()
 
     /* set current antenna */
     gtk_combo_box_set_active (GTK_COMBO_BOX (combo),
-                  midx2cidx[rig_utils_mode_to_index (rig_data_get_antenna ())]);
+                  midx2cidx[rig_utils_mode_to_index (snap->antenna)]);
 
 	/* add tooltips when widget is realized */
     gtk_widget_set_tooltip_text (combo, _("Antenna Port"));
@@ -597,48 +615,48 @@ rig_gui_ctrl2_antenna_cb   (GtkWidget *widget, gpointer data)
 }
 
 
-/** \brief Execute timeout function.
+/** \brief Update the controls after a change notification.
+ *  \param changed The fields that have changed.
  *  \param vbox The composite widget containing the controls.
- *  \return Always TRUE to keep the timer running.
  *
  * This function reads the relevant rig settings from the rid-data object and
- * updates the control widgets within vbox. The function is called peridically
- * by the Gtk+ scheduler.
+ * updates the control widgets within vbox. The function is called by the
+ * rig-data object when any of the displayed settings have changed.
  *
  * \note Because this is an internal service, no checks are made on the sanity
  *       of the parameter (ie. whether it really is the vbox we think it is).
  */
-static gint 
-rig_gui_ctrl2_timeout_exec  (gpointer vbox)
+static void
+rig_gui_ctrl2_changed       (guint64 changed, gpointer vbox)
 {
+    rig_gui_ctrl2_upd_t upd;
+
+    /* read all settings in one go */
+    rig_data_snapshot (&upd.snap);
+    upd.changed = changed;
 
     /* update each child widget of the container */
     gtk_container_foreach (GTK_CONTAINER (vbox),
                     rig_gui_ctrl2_update,
-                    NULL);
-
-    return TRUE;
+                    &upd);
 }
 
 
 
-/** \brief Stop timeout function.
- *  \param timer The ID of the timer to stop.
+/** \brief Stop listening for changes.
+ *  \param data The ID of the listener.
  *  \return Always TRUE.
  *
- * This function is used to stop the readback timer just before the
- * program is quit. It should be called automatically by Gtk+ when
- * the gtk_main_loop is exited.
+ * This function is used to remove the change listener when the
+ * controls are destroyed. It should be called automatically by Gtk+
+ * when the gtk_main_loop is exited.
  */
 static gboolean
-rig_gui_ctrl2_timeout_stop (GtkWidget *widget,
-                            GdkEvent  *event,
-                            gpointer   data)
+rig_gui_ctrl2_listener_stop (GtkWidget *widget,
+                             GdkEvent  *event,
+                             gpointer   data)
 {
-
-    GSource *source = g_main_context_find_source_by_id (NULL, GPOINTER_TO_UINT (data));
-    if (source)
-        g_source_destroy (source);
+    rig_data_remove_listener (GPOINTER_TO_UINT (data));
 
     return TRUE;
 }
@@ -647,12 +665,12 @@ rig_gui_ctrl2_timeout_stop (GtkWidget *widget,
 
 /** \brief Update control widget.
  *  \param widget The widget to update.
- *  \param data User data; always NULL.
+ *  \param data Pointer to the snapshot and the changed fields.
  *
- * This function is called by the periodic timeout function in
- * order to update the control widgets. It is called with one
- * widget at a time. The function then checks the internal ID
- * of the widget and updates it accordingly.
+ * This function is called by the change listener in order to
+ * update the control widgets. It is called with one widget at
+ * a time. The function then checks the internal ID of the widget
+ * and updates it if the corresponding setting has changed.
  *
  * \note No checks are done to compare the current rig setting
  *       with the widget settings, instead the callback signal
@@ -662,6 +680,9 @@ rig_gui_ctrl2_timeout_stop (GtkWidget *widget,
 static void
 rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
 {
+    rig_gui_ctrl2_upd_t *upd = (rig_gui_ctrl2_upd_t *) data;
+    grig_settings_t *snap = &upd->snap;
+    guint64 changed = upd->changed;
     guint id;
     gint  handler;
 
@@ -675,6 +696,9 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
         /* agc selector */
     case RIG_GUI_AGC_SELECTOR:
 
+        if (!(changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_AGC)))
+            break;
+
         /* get signal handler ID */
         handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), HANDLER_ID_KEY));
 
@@ -685,7 +709,7 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
             settings (like RIG_AGC_USER), we need to handle each supported
             case individually.
         */
-        switch (rig_data_get_agc ()) {
+        switch (snap->agc) {
 
         case RIG_AGC_OFF:
             gtk_combo_box_set_active (GTK_COMBO_BOX (widget), 0);
@@ -724,6 +748,9 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
         /* mode selector */
     case RIG_GUI_MODE_SELECTOR:
 
+        if (!(changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_MODE)))
+            break;
+
         /* get signal handler ID */
         handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), HANDLER_ID_KEY));
 
@@ -732,7 +759,7 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
 
         /* set current mode */
         gtk_combo_box_set_active (GTK_COMBO_BOX (widget),
-                        midx2cidx[rig_utils_mode_to_index (rig_data_get_mode ())]);
+                        midx2cidx[rig_utils_mode_to_index (snap->mode)]);
         
         /* unblock signal handler */
         g_signal_handler_unblock (G_OBJECT (widget), handler);
@@ -742,6 +769,9 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
         /* filter selector */
     case RIG_GUI_FILTER_SELECTOR:
 
+        if (!(changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_PBW)))
+            break;
+
         /* get signal handler ID */
         handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), HANDLER_ID_KEY));
 
@@ -749,7 +779,7 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
         g_signal_handler_block (G_OBJECT (widget), handler);
 
         /* set current passband width */
-        switch (rig_data_get_pbwidth ()) {
+        switch (snap->pbw) {
 
         case RIG_DATA_PB_WIDE:
             gtk_combo_box_set_active (GTK_COMBO_BOX (widget), 0);
@@ -772,6 +802,9 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
 		/* antenna selector */
 	case RIG_GUI_ANTENNA_SELECTOR:
 
+		if (!(changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_ANTENNA)))
+			break;
+
 		/* get signal handler ID */
 		handler = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (widget), HANDLER_ID_KEY));
 
@@ -780,7 +813,7 @@ rig_gui_ctrl2_update        (GtkWidget *widget, gpointer data)
 
 		/* set current antenna */
 		gtk_combo_box_set_active (GTK_COMBO_BOX (widget),
-					  midx2cidx[rig_utils_mode_to_index (rig_data_get_antenna ())]);
+					  midx2cidx[rig_utils_mode_to_index (snap->antenna)]);
 		
 		/* unblock signal handler */
 		g_signal_handler_unblock (G_OBJECT (widget), handler);
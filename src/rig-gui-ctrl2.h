@@ -32,16 +32,6 @@
 #ifndef RIG_GUI_CTRL2_H
 #define RIG_GUI_CTRL2_H 1
 
-/** \brief Minimum delay in msec between widget updates. */
-#define RIG_GUI_CTRL2_MIN_TVAL 1100
-
-/** \brief Default delay in msec between widget updates. */
-#define RIG_GUI_CTRL2_DEF_TVAL 1790
-
-/** \brief Maximum delay in msec between widget updates. */
-#define RIG_GUI_CTRL2_MAX_TVAL 10000
-
-
 GtkWidget *rig_gui_ctrl2_create (void);
 
 #endif
@@ -35,6 +35,7 @@
 #include <hamlib/rig.h>
 #include <math.h>
 #include "rig-data.h"
+#include "rig-daemon-poll.h"
 #include "rig-utils.h"
 #include "rig-gui-func.h"
 #include "grig-debug.h"
@@ -48,13 +49,16 @@ static gint func_window_delete  (GtkWidget *widget, GdkEvent *event, gpointer da
 static void func_window_destroy (GtkWidget *widget, gpointer data);
 static void create_controls   (GtkBox *box);
 static void bool_state_cb    (GtkToggleButton *toggle_button, gpointer data);
-static gboolean func_levels_update (gpointer data);
+static void func_levels_update (guint64 changed, gpointer data);
 
 
 static GtkWidget *dialog;
 
 static gboolean visible = FALSE;
-static guint timerid = 0;
+static guint listenerid = 0;
+
+/* the rig the window was opened for */
+static gint rig = 0;
 
 
 /* controls */
@@ -85,6 +89,9 @@ rig_gui_func_create ()
 		return;
 	}
 	
+	/* the window stays with the rig that is selected now */
+	rig = rig_data_current ();
+
 	/* create hbox and add toggle buttons */
 	hbox = gtk_hbox_new (TRUE, 5);
 	create_controls (GTK_BOX (hbox));
@@ -116,8 +123,12 @@ rig_gui_func_create ()
 
 	gtk_widget_show_all (dialog);
 
-	/* start callback */
-	timerid = g_timeout_add (1073, func_levels_update, NULL);
+	/* listen for changes */
+	listenerid = rig_data_add_rig_listener (rig, RIG_DATA_DIRTY (RIG_DATA_FIELD_FUNCS),
+					        func_levels_update, NULL);
+
+	/* keep the buttons up to date while the window is open */
+	rig_daemon_poll_boost (RIG_CMD_GET_FUNC, TRUE);
 }
 
 
@@ -142,10 +153,11 @@ func_window_destroy    (GtkWidget *widget,
 {
 
 	/* stop callback */
-	g_source_remove (timerid);
-	timerid = 0;
+	rig_data_remove_listener (listenerid);
+	listenerid = 0;
 
-	/* clear func-active flag in rig-data */
+	/* back to normal polling rate */
+	rig_daemon_poll_boost (RIG_CMD_GET_FUNC, FALSE);
 
 	visible = FALSE;
 
@@ -176,8 +188,12 @@ bool_state_cb (GtkToggleButton *toggle_button, gpointer data)
 {
 	int func = GPOINTER_TO_INT (data);
 	int value = gtk_toggle_button_get_active (toggle_button);
+	gint prev;
 
+	/* the setter acts on the rig of this window */
+	prev = rig_data_bind (rig);
 	rig_data_set_func (func, value);
+	rig_data_bind (prev);
 
 #if 0
 	default:
@@ -193,10 +209,14 @@ static void
 create_controls   (GtkBox *box)
 {
 	setting_t func;
+	grig_settings_t snap;
 	guint count = 0;
 	int i;
 	const gchar *funcstr;
 
+	/* initial states read in one go */
+	rig_data_snapshot (&snap);
+
 	for (i=0; i<RIG_SETTING_MAX; i++) {
 
 		func = rig_idx2setting(i);
@@ -209,7 +229,7 @@ create_controls   (GtkBox *box)
 		if (rig_data_has_set_func (func) && strlen(funcstr) != 0) {
 
 			fctrls[i] = gtk_toggle_button_new_with_label (funcstr);
-			gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (fctrls[i]), rig_data_get_func (func));
+			gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (fctrls[i]), snap.funcs[i]);
 			hids[i] = g_signal_connect (fctrls[i], "toggled",
 						G_CALLBACK (bool_state_cb),
 						GINT_TO_POINTER (func));
@@ -230,12 +250,16 @@ create_controls   (GtkBox *box)
 
 }
 
-static gboolean
-func_levels_update (gpointer data)
+static void
+func_levels_update (guint64 changed, gpointer data)
 {
 	setting_t func;
+	grig_settings_t snap;
 	int i;
 
+	/* read all states in one go */
+	rig_data_snapshot (&snap);
+
 	for (i=0; i<RIG_SETTING_MAX; i++) {
 
 		func = rig_idx2setting(i);
@@ -245,11 +269,9 @@ func_levels_update (gpointer data)
 
 		if (rig_data_has_get_func (func) && fctrls[i]) {
 			g_signal_handler_block (fctrls[i], hids[i]);
-			gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (fctrls[i]), rig_data_get_func (func));
+			gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (fctrls[i]), snap.funcs[i]);
 			g_signal_handler_unblock (fctrls[i], hids[i]);
 		}
 	}
-
-	return TRUE;
 }
 
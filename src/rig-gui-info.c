@@ -40,11 +40,11 @@
 #include <hamlib/rig.h>
 #include <glib/gi18n.h>
 #include "rig-data.h"
+#include "rig-daemon.h"
 #include "rig-gui-info.h"
 #include "rig-gui-info-data.h"
 
 extern GtkWidget   *grigapp;    /* defined in main.c */
-extern RIG         *myrig;      /* define in rig-demon.c */
 
 
 /* subsystem containers */
@@ -150,6 +150,7 @@ rig_gui_info_run ()
 static GtkWidget *
 rig_gui_info_create_header ()
 {
+	RIG       *myrig = rig_daemon_get_rig ();
 	GtkWidget *table;
 	GtkWidget *label;
 	gchar     *text;
@@ -240,6 +241,7 @@ rig_gui_info_create_header ()
 static GtkWidget *
 rig_gui_info_create_offset_frame ()
 {
+	RIG       *myrig = rig_daemon_get_rig ();
 	GtkWidget *frame;
 	GtkWidget *table;
 	GtkWidget *label;
@@ -332,6 +334,7 @@ rig_gui_info_create_offset_frame ()
 static GtkWidget *
 rig_gui_info_create_level_frame    ()
 {
+	RIG       *myrig = rig_daemon_get_rig ();
 	GtkWidget *swin;
 	GtkWidget *table;
 	GtkWidget *label;
@@ -431,6 +434,7 @@ rig_gui_info_create_level_frame    ()
 static GtkWidget *
 rig_gui_info_create_if_frame      ()
 {
+	RIG       *myrig = rig_daemon_get_rig ();
 	GtkWidget *frame;
 	GtkWidget *table;
 	GtkWidget *label;
@@ -704,6 +708,7 @@ rig_gui_info_create_if_frame      ()
 static GtkWidget *
 rig_gui_info_create_tunstep_frame  ()
 {
+	RIG       *myrig = rig_daemon_get_rig ();
 	GtkWidget *swin;
 	GtkWidget *table;
 	GtkWidget *label;
@@ -963,6 +968,7 @@ rig_gui_info_create_frontend_frame ()
 static GtkWidget *
 rig_gui_info_create_func_frame    ()
 {
+	RIG       *myrig = rig_daemon_get_rig ();
 	GtkWidget *swin;
 	GtkWidget *table;
 	GtkWidget *label;
@@ -1058,6 +1064,7 @@ rig_gui_info_create_func_frame    ()
 static GtkWidget *
 rig_gui_info_create_vfo_ops_frame    ()
 {
+	RIG       *myrig = rig_daemon_get_rig ();
 	GtkWidget *swin;
 	GtkWidget *table;
 	GtkWidget *label;
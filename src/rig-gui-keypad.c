@@ -182,18 +182,20 @@ grig_keypad_init(GrigKeypad * self)
 
     /* create new signals */
     /* XXX maybe this should go in class_init? */
-    g_signal_new("grig-keypad-enter-pressed", GTK_TYPE_WIDGET,
-                G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
-                NULL, g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
-
-    g_signal_new("grig-keypad-clear-pressed", GTK_TYPE_WIDGET,
-                G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
-                NULL, g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
-
-    g_signal_new("grig-keypad-num-pressed", GTK_TYPE_WIDGET,
-                G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
-                NULL, g_cclosure_marshal_VOID__UINT, G_TYPE_NONE, 1,
-                G_TYPE_UINT);
+    if (g_signal_lookup("grig-keypad-enter-pressed", GTK_TYPE_WIDGET) == 0) {
+        g_signal_new("grig-keypad-enter-pressed", GTK_TYPE_WIDGET,
+                    G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
+                    NULL, g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+        g_signal_new("grig-keypad-clear-pressed", GTK_TYPE_WIDGET,
+                    G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
+                    NULL, g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+        g_signal_new("grig-keypad-num-pressed", GTK_TYPE_WIDGET,
+                    G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
+                    NULL, g_cclosure_marshal_VOID__UINT, G_TYPE_NONE, 1,
+                    G_TYPE_UINT);
+    }
 
 
     /* connect signal handlers */
@@ -85,6 +85,8 @@
 #include "compat.h"
 #include "rig-data.h"
 #include "grig-gtk-workarounds.h"
+#include "grig-startup.h"
+#include "grig-timeline.h"
 #include "rig-gui-lcd.h"
 
 
@@ -135,8 +137,8 @@ static void           rig_gui_lcd_calc_dim         (void);
 static void           rig_gui_lcd_draw_text        (void);
 static void           rig_gui_lcd_draw_digit       (gint position, char digit);
 
-static gint           rig_gui_lcd_timeout_exec     (gpointer);
-static gint           rig_gui_lcd_timeout_stop     (GtkWidget *, GdkEvent *, gpointer);
+static void           rig_gui_lcd_changed          (guint64, gpointer);
+static gint           rig_gui_lcd_listener_stop    (GtkWidget *, GdkEvent *, gpointer);
 
 static void           ritval_to_bytearr            (gchar *, shortfreq_t);
 
@@ -151,15 +153,21 @@ static void           rig_gui_lcd_update_vfo       (void);
 GtkWidget *
 rig_gui_lcd_create ()
 {
-	guint      timerid;
+	guint      listenerid;
 	guint      i;
+	gint64     start;
 
 	/* init data */
 	lcd.exposed = FALSE;
 	lcd.manual = FALSE;
 
-	/* load digit pixmaps from file */
-	rig_gui_lcd_load_digits (NULL);
+	/* load digit pixmaps from file; they are kept when the
+	   controls are rebuilt for another rig */
+	if (digits_normal[0] == NULL) {
+		start = grig_startup_begin ();
+		rig_gui_lcd_load_digits (NULL);
+		grig_startup_end ("LCD digits", -1, start);
+	}
 
 	/* calculate frequently used sizes and positions */
 	rig_gui_lcd_calc_dim ();
@@ -174,9 +182,11 @@ rig_gui_lcd_create ()
 		lcd.xits[i] = 'X';
 	}
 
-	g_signal_new("freq-changed", GTK_TYPE_WIDGET,
-		G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
-		NULL, g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+	if (g_signal_lookup ("freq-changed", GTK_TYPE_WIDGET) == 0) {
+		g_signal_new("freq-changed", GTK_TYPE_WIDGET,
+			G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION, 0, NULL,
+			NULL, g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+	}
 
 	/* create canvas */
 	lcd.canvas = gtk_drawing_area_new ();
@@ -202,20 +212,22 @@ rig_gui_lcd_create ()
 	}
 #endif
 
-	/* start readback timer but only if service is available 
+	/* listen for changes but only if service is available 
 	   or we are in DISABLE_HW mode
 	*/
 #ifndef DISABLE_HW
 	if (rig_data_has_get_freq1 ()) {
 #endif
-		timerid = g_timeout_add (RIG_GUI_LCD_DEF_TVAL,
-                                 rig_gui_lcd_timeout_exec,
-                                 NULL);
+		listenerid = rig_data_add_listener (RIG_DATA_DIRTY (RIG_DATA_FIELD_FREQ1) |
+						    RIG_DATA_DIRTY (RIG_DATA_FIELD_RIT) |
+						    RIG_DATA_DIRTY (RIG_DATA_FIELD_VFO),
+						    rig_gui_lcd_changed,
+						    NULL);
 
-		/* register timer_stop function at exit */
+		/* register listener_stop function at exit */
         g_signal_connect(G_OBJECT(lcd.canvas), "destroy",
-                         G_CALLBACK (rig_gui_lcd_timeout_stop),
-                         GUINT_TO_POINTER(timerid));
+                         G_CALLBACK (rig_gui_lcd_listener_stop),
+                         GUINT_TO_POINTER(listenerid));
 #ifndef DISABLE_HW
 	}
 #endif
@@ -373,7 +385,11 @@ rig_gui_lcd_expose_cb   (GtkWidget      *widget,
                          gpointer        data)
 {
 
-	guint i;
+	guint  i;
+	gint64 start;
+
+
+	start = grig_timeline_begin ();
 
 	/* finalize the graphics context */
 	lcd.gc1 = gdk_gc_new (GDK_DRAWABLE (widget->window));
@@ -427,6 +443,8 @@ rig_gui_lcd_expose_cb   (GtkWidget      *widget,
 
 
 	/* initialize offscreen buffer */
+	if (buffer != NULL)
+		g_object_unref (buffer);
 	buffer = gdk_pixmap_new (GDK_DRAWABLE (lcd.canvas->window),
                              lcd.width, lcd.height, -1);
 
@@ -442,6 +460,7 @@ rig_gui_lcd_expose_cb   (GtkWidget      *widget,
 	*/
 	lcd.exposed = TRUE;
 
+	grig_timeline_end ("expose", __FUNCTION__, start, NULL, 0);
 
 	return TRUE;
 }
@@ -481,6 +500,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 	shortfreq_t    newrit;     /* new RIT/XIT value */
 	guint          power;      /* usd for 10**power */
 	gchar         *str;
+	grig_settings_t snap;      /* limits and steps of the current mode */
 
 	/* in case of expose-event call the expose event handler */
 	switch (event->type) {
@@ -494,6 +514,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 	case GDK_BUTTON_PRESS:
 
 		object = rig_gui_lcd_get_event_object (event);
+		rig_data_snapshot (&snap);
 
 		/* if no object, just return  */
 		if (object == EVENT_OBJECT_NONE) {
@@ -508,9 +529,9 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 			power = 13 - object;
 			deltar = pow (10, power);
 
-			if (deltar < rig_data_get_ritstep ()) {
+			if (deltar < snap.ritstep) {
                 //				return TRUE;
-				deltar = rig_data_get_ritstep ();
+				deltar = snap.ritstep;
 			}
 
 			/* check which mouse button */
@@ -527,7 +548,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newrit <= rig_data_get_ritmax ()) {
+				if (newrit <= snap.ritmax) {
 
 					rig_data_set_rit (newrit);
 					rig_gui_lcd_set_rit_digits (newrit);
@@ -550,7 +571,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				newrit = (freq_t) g_strtod (str, NULL);
 
 				/* try new frequency */
-				if (newrit >= rig_data_get_ritmin ()) {
+				if (newrit >= -snap.ritmax) {
 
 					rig_data_set_rit (newrit);
 					rig_gui_lcd_set_rit_digits (newrit);
@@ -571,7 +592,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newrit >= rig_data_get_ritmin ()) {
+				if (newrit >= -snap.ritmax) {
 
 					rig_data_set_rit (newrit);
 					rig_gui_lcd_set_rit_digits (newrit);
@@ -593,9 +614,9 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 			power = 9 - object;
 			deltaf = pow (10, power);
 
-			if (deltaf < rig_data_get_fstep ()) {
+			if (deltaf < snap.fstep) {
                 //				return TRUE;
-				deltaf = rig_data_get_fstep ();
+				deltaf = snap.fstep;
 			}
 
 			/* check which mouse button */
@@ -608,7 +629,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newfreq <= rig_data_get_fmax ()) {
+				if (newfreq <= snap.fmax) {
 
 					rig_data_set_freq (1, newfreq);
 					rig_gui_lcd_set_freq_digits (newfreq);
@@ -631,7 +652,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				newfreq = (freq_t) g_strtod (str, NULL);
 
 				/* try new frequency */
-				if (newfreq >= rig_data_get_fmin ()) {
+				if (newfreq >= snap.fmin) {
 
 					rig_data_set_freq (1, newfreq);
 					rig_gui_lcd_set_freq_digits (newfreq);
@@ -648,7 +669,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newfreq >= rig_data_get_fmin ()) {
+				if (newfreq >= snap.fmin) {
 
 					rig_data_set_freq (1, newfreq);
 					rig_gui_lcd_set_freq_digits (newfreq);
@@ -670,6 +691,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 	case GDK_SCROLL:
 
 		object = rig_gui_lcd_get_event_object (event);
+		rig_data_snapshot (&snap);
 
 		/* if no object, just return */
 		if (object == EVENT_OBJECT_NONE) {
@@ -684,9 +706,9 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 			power = 13 - object;
 			deltar = pow (10, power);
 
-			if (deltar < rig_data_get_ritstep ()) {
+			if (deltar < snap.ritstep) {
                 //				return TRUE;
-				deltar = rig_data_get_ritstep ();
+				deltar = snap.ritstep;
 			}
 
 			/* check which mouse button */
@@ -703,7 +725,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newrit <= rig_data_get_ritmax ()) {
+				if (newrit <= snap.ritmax) {
 
 					rig_data_set_rit (newrit);
 					rig_gui_lcd_set_rit_digits (newrit);
@@ -722,7 +744,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newrit >= rig_data_get_ritmin ()) {
+				if (newrit >= -snap.ritmax) {
 
 					rig_data_set_rit (newrit);
 					rig_gui_lcd_set_rit_digits (newrit);
@@ -744,9 +766,9 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 			power = 9 - object;
 			deltaf = pow (10, power);
 
-			if (deltaf < rig_data_get_fstep ()) {
+			if (deltaf < snap.fstep) {
                 //				return TRUE;
-				deltaf = rig_data_get_fstep ();
+				deltaf = snap.fstep;
 			}
 
 			/* check which mouse button */
@@ -759,7 +781,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newfreq <= rig_data_get_fmax ()) {
+				if (newfreq <= snap.fmax) {
 
 					rig_data_set_freq (1, newfreq);
 					rig_gui_lcd_set_freq_digits (newfreq);
@@ -774,7 +796,7 @@ rig_gui_lcd_handle_event     (GtkWidget *widget,
 				/* check whether we are within current
 				   frequency range; if so, apply new frequency
 				*/
-				if (newfreq >= rig_data_get_fmin ()) {
+				if (newfreq >= snap.fmin) {
 
 					rig_data_set_freq (1, newfreq);
 					rig_gui_lcd_set_freq_digits (newfreq);
@@ -1305,72 +1327,61 @@ rig_gui_lcd_set_rit_digits   (shortfreq_t freq)
 
 
 
-/** \brief Execute timeout function.
+/** \brief Update the display after a change notification.
+ *  \param changed The fields that have changed.
  *  \param data User data; currently NULL.
- *  \return Always TRUE to keep the timer running.
- *
- * This function is in charge for updating the signal strength meter. It acquires
- * the signal strength from the rig-data object, converts it to needle endpoint
- * coordinates and repaints the s-meter.
  *
- * The function is called peridically by the Gtk+ scheduler.
- *
- * \bug DDD copied from smeter (ie. wrong)
+ * This function is called by the rig-data object when the frequency,
+ * RIT or VFO have changed. Only the parts of the display corresponding
+ * to the changed fields are redrawn.
  *
  * \bug Add XIT support
  */
-static gint 
-rig_gui_lcd_timeout_exec  (gpointer data)
+static void
+rig_gui_lcd_changed  (guint64 changed, gpointer data)
 {
-	static guint vfoupd;
+	grig_settings_t snap;
+
+	/* read all settings in one go */
+	rig_data_snapshot (&snap);
 		
 	/* update frequency if applicable */
-	if (rig_data_has_get_freq1 ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_FREQ1)) &&
+	    rig_data_has_get_freq1 ()) {
 		
-		lcd.freq1 = rig_data_get_freq (1);
+		lcd.freq1 = snap.freq1;
 		rig_gui_lcd_set_freq_digits (lcd.freq1);
 	}
 
 	/* update RIT/XIT if applicable */
-	if (rig_data_has_get_rit () || rig_data_has_set_rit ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_RIT)) &&
+	    (rig_data_has_get_rit () || rig_data_has_set_rit ())) {
 
-		lcd.rit = rig_data_get_rit ();
+		lcd.rit = snap.rit;
 		rig_gui_lcd_set_rit_digits (lcd.rit);
 	}
 
-	/* VFO updated every second cycle */
-	if (vfoupd) {
+	if (changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_VFO)) {
 		rig_gui_lcd_update_vfo ();
-		vfoupd = 0;
-	}
-	else {
-		vfoupd += 1;
 	}
-
-	return TRUE;
 }
 
 
 
-/** \brief Stop timeout function.
- *  \param timer The ID of the timer to stop.
+/** \brief Stop listening for changes.
+ *  \param data The ID of the listener.
  *  \return Always TRUE.
  *
- * This function is used to stop the readback timer just before the
- * program is quit. It should be called automatically by Gtk+ when
- * the gtk_main_loop is exited.
- *
- * \bug DDD is wrong; copied from smeter.
+ * This function is used to remove the change listener when the display
+ * is destroyed. It should be called automatically by Gtk+ when the
+ * gtk_main_loop is exited.
  */
 static gint
-rig_gui_lcd_timeout_stop (GtkWidget *widget,
-                          GdkEvent  *event,
-                          gpointer   data)
+rig_gui_lcd_listener_stop (GtkWidget *widget,
+                           GdkEvent  *event,
+                           gpointer   data)
 {
-
-	GSource *source = g_main_context_find_source_by_id (NULL, GPOINTER_TO_UINT (data));
-    if (source)
-        g_source_destroy (source);
+	rig_data_remove_listener (GPOINTER_TO_UINT (data));
 
 	return TRUE;
 }
@@ -65,8 +65,6 @@
 #define LCD_FG_DEFAULT_BLUE   33153
 
 
-#define RIG_GUI_LCD_DEF_TVAL 400
-
 /** \brief Coordinate structure for digits. */
 typedef struct {
 	guint x;     /*!< X coordinate. */
@@ -0,0 +1,771 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+/** \file    rig-gui-message-model.c
+ *  \brief   Tree model for the message window.
+ *
+ * This object implements the GtkTreeModel interface on top of debug lines
+ * without copying them into a GtkListStore. The columns of a row are only
+ * parsed when the tree view asks for them, i.e. when the row is visible,
+ * and the last parsed row is cached since the view reads all columns of a
+ * row in a row.
+ *
+ * A live model keeps the latest lines in a bounded ring; when the ring is
+ * full the oldest row is removed for each new one.
+ *
+ * A file model maps the log file into memory and builds an index of line
+ * offsets from an idle source, C_MSG_MODEL_CHUNK bytes at a time, so that
+ * the GUI stays responsive while a large file is loaded. A file model can
+ * follow the file: grig_msg_model_poll() maps the file again when it has
+ * grown and indexes only the new part. If the file has shrunk, it has been
+ * rotated; the caller then replaces the model with a new one, which is much
+ * cheaper for the view than removing all rows one by one.
+ *
+ * Both kinds keep the message counters shown in the summary of the message
+ * window; they count every line that has been added, including lines that
+ * have since been dropped from the ring.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <hamlib/rig.h>
+#include "grig-debug.h"
+#include "rig-gui-message-model.h"
+
+
+#define C_MSG_MODEL_CHUNK  (256 * 1024)  /*!< Bytes indexed per idle call. */
+
+
+/** \brief Debug level names. */
+static const gchar *DEBUG_STR[RIG_DEBUG_TRACE + 1] = {
+	N_("NONE"),
+	N_("BUG"),
+	N_("ERROR"),
+	N_("WARNING"),
+	N_("DEBUG"),
+	N_("TRACE")
+};
+
+
+static void          grig_msg_model_class_init   (GrigMsgModelClass *klass);
+static void          grig_msg_model_init         (GrigMsgModel *model);
+static void          grig_msg_model_iface_init   (GtkTreeModelIface *iface);
+static void          grig_msg_model_finalize     (GObject *object);
+
+static GtkTreeModelFlags msg_model_get_flags     (GtkTreeModel *model);
+static gint          msg_model_get_n_columns     (GtkTreeModel *model);
+static GType         msg_model_get_column_type   (GtkTreeModel *model, gint index);
+static gboolean      msg_model_get_iter          (GtkTreeModel *model,
+						  GtkTreeIter *iter,
+						  GtkTreePath *path);
+static GtkTreePath  *msg_model_get_path          (GtkTreeModel *model,
+						  GtkTreeIter *iter);
+static void          msg_model_get_value         (GtkTreeModel *model,
+						  GtkTreeIter *iter,
+						  gint column,
+						  GValue *value);
+static gboolean      msg_model_iter_next         (GtkTreeModel *model,
+						  GtkTreeIter *iter);
+static gboolean      msg_model_iter_children     (GtkTreeModel *model,
+						  GtkTreeIter *iter,
+						  GtkTreeIter *parent);
+static gboolean      msg_model_iter_has_child    (GtkTreeModel *model,
+						  GtkTreeIter *iter);
+static gint          msg_model_iter_n_children   (GtkTreeModel *model,
+						  GtkTreeIter *iter);
+static gboolean      msg_model_iter_nth_child    (GtkTreeModel *model,
+						  GtkTreeIter *iter,
+						  GtkTreeIter *parent,
+						  gint n);
+static gboolean      msg_model_iter_parent       (GtkTreeModel *model,
+						  GtkTreeIter *iter,
+						  GtkTreeIter *child);
+
+static guint         msg_model_split    (const gchar *line, gsize len,
+					 const gchar **field, gsize *flen);
+static void          msg_model_count    (GrigMsgModel *model,
+					 const gchar *line, gsize len);
+static const gchar  *msg_model_row      (GrigMsgModel *model, guint row,
+					 gsize *len);
+static void          msg_model_parse    (GrigMsgModel *model, guint row);
+static void          msg_model_inserted (GrigMsgModel *model, guint row);
+static void          msg_model_deleted  (GrigMsgModel *model, guint row);
+static gboolean      msg_model_load     (gpointer data);
+
+
+static GObjectClass *parent_class = NULL;
+
+
+GType
+grig_msg_model_get_type (void)
+{
+	static GType grig_msg_model_type = 0;
+
+	if (!grig_msg_model_type) {
+
+		static const GTypeInfo grig_msg_model_info = {
+			sizeof (GrigMsgModelClass),
+			NULL, NULL,
+			(GClassInitFunc) grig_msg_model_class_init,
+			NULL, NULL,
+			sizeof (GrigMsgModel),
+			0,
+			(GInstanceInitFunc) grig_msg_model_init,
+		};
+
+		static const GInterfaceInfo tree_model_info = {
+			(GInterfaceInitFunc) grig_msg_model_iface_init,
+			NULL,
+			NULL
+		};
+
+		grig_msg_model_type = g_type_register_static (G_TYPE_OBJECT,
+							      "GrigMsgModel",
+							      &grig_msg_model_info,
+							      0);
+
+		g_type_add_interface_static (grig_msg_model_type,
+					     GTK_TYPE_TREE_MODEL,
+					     &tree_model_info);
+	}
+
+	return grig_msg_model_type;
+}
+
+
+static void
+grig_msg_model_class_init (GrigMsgModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	parent_class = g_type_class_peek_parent (klass);
+	object_class->finalize = grig_msg_model_finalize;
+}
+
+
+static void
+grig_msg_model_init (GrigMsgModel *model)
+{
+	model->stamp = g_random_int ();
+	model->cacherow = -1;
+}
+
+
+static void
+grig_msg_model_iface_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags       = msg_model_get_flags;
+	iface->get_n_columns   = msg_model_get_n_columns;
+	iface->get_column_type = msg_model_get_column_type;
+	iface->get_iter        = msg_model_get_iter;
+	iface->get_path        = msg_model_get_path;
+	iface->get_value       = msg_model_get_value;
+	iface->iter_next       = msg_model_iter_next;
+	iface->iter_children   = msg_model_iter_children;
+	iface->iter_has_child  = msg_model_iter_has_child;
+	iface->iter_n_children = msg_model_iter_n_children;
+	iface->iter_nth_child  = msg_model_iter_nth_child;
+	iface->iter_parent     = msg_model_iter_parent;
+}
+
+
+static void
+grig_msg_model_finalize (GObject *object)
+{
+	GrigMsgModel *model = GRIG_MSG_MODEL (object);
+	guint         i;
+
+
+	if (model->loader > 0) {
+		g_source_remove (model->loader);
+	}
+
+	if (model->ring != NULL) {
+		for (i = 0; i < model->nrows; i++) {
+			g_free (model->ring[(model->ringhead + i) % model->ringsize]);
+		}
+		g_free (model->ring);
+	}
+
+	if (model->map != NULL) {
+		g_mapped_file_unref (model->map);
+	}
+	if (model->index != NULL) {
+		g_array_free (model->index, TRUE);
+	}
+	g_free (model->filename);
+
+	for (i = 0; i < MSG_LIST_COL_NUMBER; i++) {
+		g_free (model->cache[i]);
+	}
+
+	parent_class->finalize (object);
+}
+
+
+/** \brief Create a new live model.
+ *  \param maxrows The max number of rows kept.
+ *  \return A new tree model.
+ *
+ * Lines are added to the model with grig_msg_model_append().
+ */
+GtkTreeModel *
+grig_msg_model_new_live (guint maxrows)
+{
+	GrigMsgModel *model;
+
+	model = g_object_new (GRIG_MSG_MODEL_TYPE, NULL);
+	model->ringsize = MAX (maxrows, 1);
+	model->ring = g_new0 (gchar *, model->ringsize);
+
+	return GTK_TREE_MODEL (model);
+}
+
+
+/** \brief Create a new model showing a log file.
+ *  \param filename The log file.
+ *  \param follow Whether to follow the file as it grows.
+ *  \param error Location to store the error or NULL.
+ *  \return A new tree model or NULL if the file could not be mapped.
+ *
+ * The file is indexed in the background; the rows appear as they are
+ * indexed.
+ */
+GtkTreeModel *
+grig_msg_model_new_file (const gchar *filename, gboolean follow, GError **error)
+{
+	GrigMsgModel *model;
+	GMappedFile  *map;
+
+
+	map = g_mapped_file_new (filename, FALSE, error);
+	if (map == NULL) {
+		return NULL;
+	}
+
+	model = g_object_new (GRIG_MSG_MODEL_TYPE, NULL);
+	model->filename = g_strdup (filename);
+	model->map = map;
+	model->index = g_array_new (FALSE, FALSE, sizeof (gsize));
+	model->follow = follow;
+	model->loader = g_idle_add_full (G_PRIORITY_LOW, msg_model_load, model, NULL);
+
+	return GTK_TREE_MODEL (model);
+}
+
+
+/** \brief Add a line to a live model.
+ *  \param model The model.
+ *  \param line The line; the model takes ownership.
+ *
+ * If the model is full, the oldest row is removed.
+ */
+void
+grig_msg_model_append (GrigMsgModel *model, gchar *line)
+{
+	g_return_if_fail (model->ring != NULL);
+
+	if (model->nrows == model->ringsize) {
+		g_free (model->ring[model->ringhead]);
+		model->ring[model->ringhead] = NULL;
+		model->ringhead = (model->ringhead + 1) % model->ringsize;
+		model->nrows--;
+		msg_model_deleted (model, 0);
+	}
+
+	model->ring[(model->ringhead + model->nrows) % model->ringsize] = line;
+	model->nrows++;
+	msg_model_count (model, line, strlen (line));
+	msg_model_inserted (model, model->nrows - 1);
+}
+
+
+/** \brief Check whether a followed file has changed.
+ *  \param model The model.
+ *  \return FALSE if the file has been rotated and the model should be
+ *          replaced with a new one, TRUE otherwise.
+ *
+ * This function should be called periodically for a file model that
+ * follows its file. If the file has grown, it is mapped again and the new
+ * lines are indexed; the part already indexed is not read again.
+ */
+gboolean
+grig_msg_model_poll (GrigMsgModel *model)
+{
+	GStatBuf     st;
+	GMappedFile *map;
+
+
+	if ((model->map == NULL) || !model->follow) {
+		return TRUE;
+	}
+
+	if (g_stat (model->filename, &st) != 0) {
+		return TRUE;
+	}
+
+	if ((gsize) st.st_size < model->indexed) {
+		/* file has been rotated */
+		return FALSE;
+	}
+
+	if ((gsize) st.st_size <= g_mapped_file_get_length (model->map)) {
+		return TRUE;
+	}
+
+	map = g_mapped_file_new (model->filename, FALSE, NULL);
+	if (map == NULL) {
+		return TRUE;
+	}
+
+	g_mapped_file_unref (model->map);
+	model->map = map;
+
+	if (model->loader == 0) {
+		model->loader = g_idle_add_full (G_PRIORITY_LOW, msg_model_load,
+						 model, NULL);
+	}
+
+	return TRUE;
+}
+
+
+/** \brief Check whether the model is still indexing its file. */
+gboolean
+grig_msg_model_is_loading (GrigMsgModel *model)
+{
+	return (model->loader > 0);
+}
+
+
+/** \brief Get the message counters of the model. */
+const grig_msg_counts_t *
+grig_msg_model_get_counts (GrigMsgModel *model)
+{
+	return &model->counts;
+}
+
+
+/** \brief Index the next chunk of the file.
+ *
+ * Only complete lines are indexed; a partial last line is picked up when
+ * the rest of it has been written.
+ */
+static gboolean
+msg_model_load (gpointer data)
+{
+	GrigMsgModel *model = GRIG_MSG_MODEL (data);
+	const gchar  *contents;
+	const gchar  *line;
+	const gchar  *end;
+	const gchar  *stop;
+	gsize         length;
+	gsize         offset;
+
+
+	contents = g_mapped_file_get_contents (model->map);
+	length = g_mapped_file_get_length (model->map);
+
+	if ((contents == NULL) || (model->indexed >= length)) {
+		model->loader = 0;
+		return FALSE;
+	}
+
+	line = contents + model->indexed;
+	stop = contents + MIN (length, model->indexed + C_MSG_MODEL_CHUNK);
+
+	while (line < stop) {
+		end = memchr (line, '\n', (contents + length) - line);
+		if (end == NULL) {
+			break;
+		}
+
+		offset = line - contents;
+		g_array_append_val (model->index, offset);
+		model->indexed = end + 1 - contents;
+		model->nrows++;
+
+		msg_model_count (model, line, end - line);
+		msg_model_inserted (model, model->nrows - 1);
+
+		line = end + 1;
+	}
+
+	if ((line >= contents + length) || (line < stop)) {
+		/* reached the end of the mapping */
+		model->loader = 0;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/** \brief Split a line into fields.
+ *  \param line The line.
+ *  \param len The length of the line.
+ *  \param field Array of MSG_LIST_COL_NUMBER field pointers.
+ *  \param flen Array of MSG_LIST_COL_NUMBER field lengths.
+ *  \return The number of fields found.
+ *
+ * This works like g_strsplit() with GRIG_DEBUG_SEPARATOR and at most
+ * MSG_LIST_COL_NUMBER fields but does not copy anything.
+ */
+static guint
+msg_model_split (const gchar *line, gsize len, const gchar **field, gsize *flen)
+{
+	const gchar *end = line + len;
+	const gchar *sep;
+	gsize        seplen = strlen (GRIG_DEBUG_SEPARATOR);
+	guint        n = 0;
+
+
+	while (n < MSG_LIST_COL_NUMBER - 1) {
+		field[n] = line;
+
+		sep = g_strstr_len (line, end - line, GRIG_DEBUG_SEPARATOR);
+		if (sep == NULL) {
+			break;
+		}
+
+		flen[n++] = sep - line;
+		line = sep + seplen;
+	}
+
+	field[n] = line;
+	flen[n++] = end - line;
+
+	return n;
+}
+
+
+/** \brief Update the counters with a new line. */
+static void
+msg_model_count (GrigMsgModel *model, const gchar *line, gsize len)
+{
+	const gchar *field[MSG_LIST_COL_NUMBER];
+	gsize        flen[MSG_LIST_COL_NUMBER];
+	gint         level;
+
+
+	switch (msg_model_split (line, len, field, flen)) {
+
+	case 1:
+		/* message from Gtk+/GLib */
+		model->counts.other++;
+		model->counts.level[RIG_DEBUG_ERR]++;
+		break;
+
+	case MSG_LIST_COL_NUMBER:
+		if (!g_ascii_strncasecmp (field[1], "HAMLIB", flen[1]) && (flen[1] == 6))
+			model->counts.hamlib++;
+		else if (!g_ascii_strncasecmp (field[1], "GRIG", flen[1]) && (flen[1] == 4))
+			model->counts.grig++;
+		else
+			model->counts.other++;
+
+		level = atoi (field[2]);
+		if ((level >= RIG_DEBUG_NONE) && (level <= RIG_DEBUG_TRACE))
+			model->counts.level[level]++;
+		break;
+
+	default:
+		/* corrupt line */
+		model->counts.grig++;
+		model->counts.level[RIG_DEBUG_ERR]++;
+		break;
+	}
+}
+
+
+/** \brief Get the text of a row.
+ *  \param model The model.
+ *  \param row The row number.
+ *  \param len Location to store the length of the line.
+ *  \return Pointer to the line, not NUL terminated in file mode.
+ */
+static const gchar *
+msg_model_row (GrigMsgModel *model, guint row, gsize *len)
+{
+	const gchar *line;
+	gsize        end;
+
+
+	if (model->ring != NULL) {
+		line = model->ring[(model->ringhead + row) % model->ringsize];
+		*len = strlen (line);
+		return line;
+	}
+
+	line = g_mapped_file_get_contents (model->map);
+	end = (row + 1 < model->index->len) ?
+		g_array_index (model->index, gsize, row + 1) : model->indexed;
+
+	/* exclude the \n */
+	*len = end - 1 - g_array_index (model->index, gsize, row);
+
+	return line + g_array_index (model->index, gsize, row);
+}
+
+
+/** \brief Parse the columns of a row into the cache. */
+static void
+msg_model_parse (GrigMsgModel *model, guint row)
+{
+	const gchar *line;
+	const gchar *field[MSG_LIST_COL_NUMBER];
+	gsize        flen[MSG_LIST_COL_NUMBER];
+	gsize        len;
+	gint         level;
+	guint        i;
+
+
+	if (model->cacherow == (gint) row) {
+		return;
+	}
+
+	for (i = 0; i < MSG_LIST_COL_NUMBER; i++) {
+		g_free (model->cache[i]);
+	}
+
+	line = msg_model_row (model, row, &len);
+
+	/* strip \r from files written on other systems */
+	if ((len > 0) && (line[len - 1] == '\r'))
+		len--;
+
+	switch (msg_model_split (line, len, field, flen)) {
+
+	case 1:
+		model->cache[MSG_LIST_COL_TIME] = g_strdup ("");
+		model->cache[MSG_LIST_COL_SOURCE] = g_strdup (_("SYS"));
+		model->cache[MSG_LIST_COL_LEVEL] = g_strdup (_(DEBUG_STR[RIG_DEBUG_ERR]));
+		model->cache[MSG_LIST_COL_MSG] = g_strndup (line, len);
+		break;
+
+	case MSG_LIST_COL_NUMBER:
+		level = atoi (field[2]);
+		if ((level < RIG_DEBUG_NONE) || (level > RIG_DEBUG_TRACE))
+			level = RIG_DEBUG_ERR;
+
+		model->cache[MSG_LIST_COL_TIME] = g_strndup (field[0], flen[0]);
+		model->cache[MSG_LIST_COL_SOURCE] = g_strndup (field[1], flen[1]);
+		model->cache[MSG_LIST_COL_LEVEL] = g_strdup (_(DEBUG_STR[level]));
+		model->cache[MSG_LIST_COL_MSG] = g_strndup (field[3], flen[3]);
+		break;
+
+	default:
+		model->cache[MSG_LIST_COL_TIME] = g_strdup ("");
+		model->cache[MSG_LIST_COL_SOURCE] = g_strdup (_("GRIG"));
+		model->cache[MSG_LIST_COL_LEVEL] = g_strdup (_(DEBUG_STR[RIG_DEBUG_ERR]));
+		model->cache[MSG_LIST_COL_MSG] = g_strdup (_("Log file seems corrupt"));
+		break;
+	}
+
+	model->cacherow = row;
+}
+
+
+/** \brief Emit row-inserted for a new row. */
+static void
+msg_model_inserted (GrigMsgModel *model, guint row)
+{
+	GtkTreePath *path;
+	GtkTreeIter  iter;
+
+
+	path = gtk_tree_path_new_from_indices (row, -1);
+	iter.stamp = model->stamp;
+	iter.user_data = GUINT_TO_POINTER (row);
+	gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+	gtk_tree_path_free (path);
+}
+
+
+/** \brief Emit row-deleted for a removed row. */
+static void
+msg_model_deleted (GrigMsgModel *model, guint row)
+{
+	GtkTreePath *path;
+
+
+	/* row numbers have shifted */
+	model->cacherow = -1;
+
+	path = gtk_tree_path_new_from_indices (row, -1);
+	gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+	gtk_tree_path_free (path);
+}
+
+
+
+/* GtkTreeModel interface */
+
+static GtkTreeModelFlags
+msg_model_get_flags (GtkTreeModel *model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+
+static gint
+msg_model_get_n_columns (GtkTreeModel *model)
+{
+	return MSG_LIST_COL_NUMBER;
+}
+
+
+static GType
+msg_model_get_column_type (GtkTreeModel *model, gint index)
+{
+	return G_TYPE_STRING;
+}
+
+
+static gboolean
+msg_model_get_iter (GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	GrigMsgModel *self = GRIG_MSG_MODEL (model);
+	gint          row;
+
+
+	row = gtk_tree_path_get_indices (path)[0];
+	if ((row < 0) || ((guint) row >= self->nrows)) {
+		return FALSE;
+	}
+
+	iter->stamp = self->stamp;
+	iter->user_data = GINT_TO_POINTER (row);
+
+	return TRUE;
+}
+
+
+static GtkTreePath *
+msg_model_get_path (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (iter->stamp == GRIG_MSG_MODEL (model)->stamp, NULL);
+
+	return gtk_tree_path_new_from_indices (GPOINTER_TO_INT (iter->user_data), -1);
+}
+
+
+static void
+msg_model_get_value (GtkTreeModel *model, GtkTreeIter *iter,
+		     gint column, GValue *value)
+{
+	GrigMsgModel *self = GRIG_MSG_MODEL (model);
+	guint         row = GPOINTER_TO_UINT (iter->user_data);
+
+
+	g_value_init (value, G_TYPE_STRING);
+
+	g_return_if_fail (iter->stamp == self->stamp);
+
+	if ((row >= self->nrows) || (column < 0) || (column >= MSG_LIST_COL_NUMBER)) {
+		return;
+	}
+
+	msg_model_parse (self, row);
+	g_value_set_string (value, self->cache[column]);
+}
+
+
+static gboolean
+msg_model_iter_next (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GrigMsgModel *self = GRIG_MSG_MODEL (model);
+	guint         row = GPOINTER_TO_UINT (iter->user_data) + 1;
+
+
+	if (row >= self->nrows) {
+		return FALSE;
+	}
+
+	iter->user_data = GUINT_TO_POINTER (row);
+
+	return TRUE;
+}
+
+
+static gboolean
+msg_model_iter_children (GtkTreeModel *model, GtkTreeIter *iter,
+			 GtkTreeIter *parent)
+{
+	return msg_model_iter_nth_child (model, iter, parent, 0);
+}
+
+
+static gboolean
+msg_model_iter_has_child (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+
+static gint
+msg_model_iter_n_children (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	if (iter != NULL) {
+		return 0;
+	}
+
+	return GRIG_MSG_MODEL (model)->nrows;
+}
+
+
+static gboolean
+msg_model_iter_nth_child (GtkTreeModel *model, GtkTreeIter *iter,
+			  GtkTreeIter *parent, gint n)
+{
+	GrigMsgModel *self = GRIG_MSG_MODEL (model);
+
+
+	if ((parent != NULL) || (n < 0) || ((guint) n >= self->nrows)) {
+		return FALSE;
+	}
+
+	iter->stamp = self->stamp;
+	iter->user_data = GINT_TO_POINTER (n);
+
+	return TRUE;
+}
+
+
+static gboolean
+msg_model_iter_parent (GtkTreeModel *model, GtkTreeIter *iter,
+		       GtkTreeIter *child)
+{
+	return FALSE;
+}
@@ -0,0 +1,117 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+#ifndef RIG_GUI_MESSAGE_MODEL_H
+#define RIG_GUI_MESSAGE_MODEL_H 1
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gtk/gtk.h>
+#include <hamlib/rig.h>
+
+
+G_BEGIN_DECLS
+
+#define GRIG_MSG_MODEL_TYPE            (grig_msg_model_get_type ())
+#define GRIG_MSG_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GRIG_MSG_MODEL_TYPE, GrigMsgModel))
+#define GRIG_MSG_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GRIG_MSG_MODEL_TYPE, GrigMsgModelClass))
+#define IS_GRIG_MSG_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GRIG_MSG_MODEL_TYPE))
+#define IS_GRIG_MSG_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GRIG_MSG_MODEL_TYPE))
+
+
+/** \brief Columns in the message list. */
+typedef enum {
+	MSG_LIST_COL_TIME = 0,
+	MSG_LIST_COL_SOURCE,
+	MSG_LIST_COL_LEVEL,
+	MSG_LIST_COL_MSG,
+	MSG_LIST_COL_NUMBER
+} msg_list_col_t;
+
+
+/** \brief Message counters of a model. */
+typedef struct {
+	guint   level[RIG_DEBUG_TRACE + 1];  /*!< Number of messages per debug level. */
+	guint   hamlib;                      /*!< Number of messages from hamlib. */
+	guint   grig;                        /*!< Number of messages from grig. */
+	guint   other;                       /*!< Number of messages from other sources. */
+} grig_msg_counts_t;
+
+
+typedef struct _GrigMsgModel       GrigMsgModel;
+typedef struct _GrigMsgModelClass  GrigMsgModelClass;
+
+struct _GrigMsgModel
+{
+	GObject parent;
+
+	gint               stamp;      /*!< Iterator stamp. */
+	guint              nrows;      /*!< Number of rows. */
+	grig_msg_counts_t  counts;     /*!< Message counters. */
+
+	/* live mode */
+	gchar            **ring;       /*!< Bounded ring of lines (live mode). */
+	guint              ringsize;   /*!< Size of the ring. */
+	guint              ringhead;   /*!< Index of the first row in the ring. */
+
+	/* file mode */
+	gchar             *filename;   /*!< The file shown (file mode). */
+	GMappedFile       *map;        /*!< The file mapped into memory. */
+	GArray            *index;      /*!< Start offset of each line. */
+	gsize              indexed;    /*!< Offset after the last complete line. */
+	guint              loader;     /*!< Idle source indexing the file. */
+	gboolean           follow;     /*!< Follow the file as it grows. */
+
+	/* the columns of one row are parsed when the view asks for them */
+	gint               cacherow;
+	gchar             *cache[MSG_LIST_COL_NUMBER];
+};
+
+struct _GrigMsgModelClass
+{
+	GObjectClass parent_class;
+};
+
+
+GType          grig_msg_model_get_type   (void);
+GtkTreeModel  *grig_msg_model_new_live   (guint maxrows);
+GtkTreeModel  *grig_msg_model_new_file   (const gchar *filename,
+					  gboolean follow,
+					  GError **error);
+void           grig_msg_model_append     (GrigMsgModel *model, gchar *line);
+gboolean       grig_msg_model_poll       (GrigMsgModel *model);
+gboolean       grig_msg_model_is_loading (GrigMsgModel *model);
+const grig_msg_counts_t *grig_msg_model_get_counts (GrigMsgModel *model);
+
+G_END_DECLS
+
+#endif
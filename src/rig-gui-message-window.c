@@ -29,35 +29,37 @@
  
  
 */
+/** \file rig-gui-message-window.c
+ *  \brief Message window.
+ *
+ * The message window shows the debug messages, either live from the debug
+ * handler or from a log file. The rows are provided by a GrigMsgModel so
+ * that only the visible rows are ever turned into strings. The live view
+ * keeps the latest C_MSG_WIN_LIVE_ROWS messages. A log file is indexed in
+ * the background; if it is the file currently written by grig, the view
+ * follows it as it grows. A binary trace is converted to text by a worker
+ * thread and shown when the conversion is done. The level and command
+ * selected in the file chooser are applied while converting, so that the
+ * block index of the trace lets the worker skip most of a large trace.
+ */
 #include <stdarg.h>
+#include <string.h>
 #include <time.h>
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
 #include <glib/gprintf.h>
+#include <glib/gstdio.h>
 #include <hamlib/rig.h>
 #include "grig-debug.h"
 #include "rig-gui-message-window.h"
+#include "rig-gui-message-model.h"
+#include "grig-timeline.h"
+#include "grig-trace.h"
+#include "rig-daemon.h"
 
 
-/* define message level type for convenience */
-typedef enum rig_debug_level_e level_t;
-
-/* columns in the message list */
-typedef enum {
-	MSG_LIST_COL_TIME = 0,
-	MSG_LIST_COL_SOURCE,
-	MSG_LIST_COL_LEVEL,
-	MSG_LIST_COL_MSG,
-	MSG_LIST_COL_NUMBER
-} msg_list_col_t;
-
-
-/* data structure to hold one message */
-typedef struct {
-	time_t    time;     /* time stamp */
-	level_t   level;    /* debug level */
-	gchar    *message;  /* the message itself */
-} message_t;
+#define C_MSG_WIN_LIVE_ROWS  5000   /* rows kept in the live view */
+#define C_MSG_WIN_REFRESH    250    /* refresh period in msec */
 
 
 /* Easy access to column titles */
@@ -74,13 +76,9 @@ const gfloat MSG_LIST_COL_TITLE_ALIGN[MSG_LIST_COL_NUMBER] = {
 };
 
 
-const gchar *DEBUG_STR[6] = {
-	N_("NONE"),
-	N_("BUG"),
-	N_("ERROR"),
-	N_("WARNING"),
-	N_("DEBUG"),
-	N_("TRACE")
+/* Initial column widths in pixels */
+static const gint MSG_LIST_COL_WIDTH[MSG_LIST_COL_NUMBER] = {
+	140, 70, 70, 400
 };
 
 
@@ -89,26 +87,36 @@ extern GtkWidget    *grigapp;
 static gboolean visible     = FALSE;   /* Is message window visible? */
 static gboolean initialised = FALSE;   /* Is module initialised? */
 
-/* counters */
-static guint32  bugs        = 0;       /* Number of bug messages */    
-static guint32  errors      = 0;       /* Number of error messages */
-static guint32  warnings    = 0;       /* Number of warning messages */
-static guint32  verboses    = 0;       /* Number of verbose messages */
-static guint32  traces      = 0;       /* Number of trace messages */
-static guint32  hamlibs     = 0;       /* Number of messages from hamlib */
-static guint32  grigs       = 0;       /* Number of messages from grig */
-static guint32  others      = 0;       /* Number of messages from other sources */
-
 /* summary labels; they need to be accessible at runtime */
 static GtkWidget *buglabel,*errlabel,*warnlabel,*verblabel,*tracelabel,*sumlabel;
 static GtkWidget *hamliblabel, *griglabel, *otherlabel;
+static GtkWidget *supplabel;
+
+/* periodic refresh of the list and the counters */
+static guint      refreshtimer = 0;
 
 /* The message window itself */
 static GtkWidget *window;
 
 
-/* the tree view model */
-GtkTreeModel      *model;
+/* the tree view and its model */
+static GtkWidget    *treeview;
+static GtkTreeModel *model;
+
+/* next line to fetch from the debug handler in live mode */
+static guint64       liveseq = 0;
+
+
+/** \brief Binary trace converted to text by a worker thread. */
+typedef struct {
+	gchar   *filename;   /*!< The trace. */
+	gchar   *tmpname;    /*!< The text file; NULL if the conversion failed. */
+	GError  *error;      /*!< Why the conversion failed. */
+	grig_trace_filter_t filter; /*!< The messages to convert. */
+} trace_job_t;
+
+/* the worker converting a binary trace, if any */
+static GThread      *converter = NULL;
 
 
 static void message_window_destroy  (GtkWidget *, gpointer);
@@ -118,16 +126,22 @@ static void message_window_response (GtkWidget *, gint, gpointer);
 static GtkWidget    *create_message_list    (void);
 static GtkTreeModel *create_list_model      (void);
 static GtkWidget    *create_message_summary (void);
+static gboolean      refresh_message_window (gpointer);
+static void          update_summary         (void);
+static void          set_model              (GtkTreeModel *);
 
 /* load debug file related */
 static void load_debug_file    (void);
-static int  read_debug_file    (const gchar *filename);
+static int  read_debug_file    (const gchar *filename,
+				const grig_trace_filter_t *filter);
+static GtkWidget *create_filter_widget (GtkWidget **level, GtkWidget **cmd);
+static int  show_debug_file    (const gchar *filename,
+				const gchar *textfile,
+				gboolean follow);
+static gpointer convert_trace      (gpointer data);
+static gboolean convert_trace_done (gpointer data);
 static void clear_message_list (void);
 
-static void add_debug_message (const gchar *datetime,
-			       const gchar *source,
-			       enum rig_debug_level_e debug_level,
-			       const char *message);
 
 /* Initialise message window.
  *
@@ -232,6 +246,13 @@ rig_gui_message_window_show ()
 		visible = TRUE;
 //	}
 
+	/* keep the list and the counters up to date while we are shown */
+	refresh_message_window (NULL);
+	if (refreshtimer == 0) {
+		refreshtimer = g_timeout_add (C_MSG_WIN_REFRESH,
+					      refresh_message_window, NULL);
+	}
+
 }
 
 
@@ -246,105 +267,6 @@ rig_gui_message_window_hide  ()
 
 
 
-/** \brief Add a message to message list */
-static void
-add_debug_message (const gchar *datetime,
-		   const gchar *source,
-		   enum rig_debug_level_e debug_level,
-		   const char *message)
-{
-	guint        total;     /* totalt number of messages */
-	gchar       *str;       /* string to show message count */
-	GtkTreeIter  item;      /* new item added to the list store */
-
-
-	gtk_list_store_append (GTK_LIST_STORE (model), &item);
-	gtk_list_store_set (GTK_LIST_STORE (model), &item,
-			    MSG_LIST_COL_TIME, datetime,
-			    MSG_LIST_COL_SOURCE, source,
-			    MSG_LIST_COL_LEVEL, _(DEBUG_STR[debug_level]),
-			    MSG_LIST_COL_MSG, message,
-			    -1);
-
-	/* increment source counter */
-	if (!g_ascii_strcasecmp (source, "HAMLIB")) {
-		hamlibs++;
-		str = g_strdup_printf ("%d", hamlibs);
-		gtk_label_set_text (GTK_LABEL (hamliblabel), str);
-		g_free (str);
-	}
-	else if (!g_ascii_strcasecmp (source, "GRIG")) {
-		grigs++;
-		str = g_strdup_printf ("%d", grigs);
-		gtk_label_set_text (GTK_LABEL (griglabel), str);
-		g_free (str);
-	}
-	else {
-		others++;
-		str = g_strdup_printf ("%d", others);
-		gtk_label_set_text (GTK_LABEL (otherlabel), str);
-		g_free (str);
-	}
-
-
-	/* increment severity counter */
-	switch (debug_level) {
-		
-		/* internal bugs */
-	case RIG_DEBUG_BUG:
-		bugs++;
-		str = g_strdup_printf ("%d", bugs);
-		gtk_label_set_text (GTK_LABEL (buglabel), str);
-		g_free (str);
-		break;
-
-		/* runtime error */
-	case RIG_DEBUG_ERR:
-		errors++;
-		str = g_strdup_printf ("%d", errors);
-		gtk_label_set_text (GTK_LABEL (errlabel), str);
-		g_free (str);
-		break;
-
-		/* warning */
-	case RIG_DEBUG_WARN:
-		warnings++;
-		str = g_strdup_printf ("%d", warnings);
-		gtk_label_set_text (GTK_LABEL (warnlabel), str);
-		g_free (str);
-		break;
-
-		/* verbose info */
-	case RIG_DEBUG_VERBOSE:
-		verboses++;
-		str = g_strdup_printf ("%d", verboses);
-		gtk_label_set_text (GTK_LABEL (verblabel), str);
-		g_free (str);
-		break;
-
-		/* trace */
-	case RIG_DEBUG_TRACE:
-		traces++;
-		str = g_strdup_printf ("%d", traces);
-		gtk_label_set_text (GTK_LABEL (tracelabel), str);
-		g_free (str);
-		break;
-
-	default:
-		break;
-	}
-
-	/* the sum does not have to be updated for each line */
-	total = bugs+errors+warnings+verboses+traces;
-	str = g_strdup_printf ("<b>%d</b>", total);
-	gtk_label_set_markup (GTK_LABEL (sumlabel), str);
-	g_free (str);
-
-}
-
-
-
-
 /* callback function called when the dialog window is destroyed */
 static void
 message_window_destroy    (GtkWidget *widget,
@@ -353,6 +275,11 @@ message_window_destroy    (GtkWidget *widget,
 	/* clean up memory */
 	/* GSList, ... */
 
+	if (refreshtimer > 0) {
+		g_source_remove (refreshtimer);
+		refreshtimer = 0;
+	}
+
 	visible = FALSE;
 	initialised = FALSE;
 }
@@ -393,6 +320,9 @@ message_window_response (GtkWidget *widget,
  * This function creates the file chooser dialog, which can be used to select
  * a file containing debug messages. When the dialog returns, the selected
  * file is checked and, if the file exists, is read line by line.
+ *
+ * The dialog also has a filter by level and command; it is only applied to
+ * binary traces.
  */
 static void
 load_debug_file ()
@@ -400,8 +330,12 @@ load_debug_file ()
 
 	gchar *filename;
 
+	grig_trace_filter_t filter;
 
 	GtkWidget *dialog;
+	GtkWidget *level;
+	GtkWidget *cmd;
+	gint       idx;
 
 	/* create file chooser dialog */
 	dialog = gtk_file_chooser_dialog_new (_("Open Debug File"),
@@ -411,15 +345,28 @@ load_debug_file ()
 					      GTK_STOCK_OPEN, GTK_RESPONSE_ACCEPT,
 					      NULL);
 
-	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT) {
+	gtk_file_chooser_set_extra_widget (GTK_FILE_CHOOSER (dialog),
+					   create_filter_widget (&level, &cmd));
 
-		clear_message_list ();
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT) {
 
 		filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
 
+		/* the first level entry is Bug; everything up to the
+		   selected level is shown */
+		grig_trace_filter_all (&filter);
+		idx = gtk_combo_box_get_active (GTK_COMBO_BOX (level));
+		filter.levels = (1 << (RIG_DEBUG_BUG + idx + 1)) - 1;
+
+		/* the first command entry is All */
+		idx = gtk_combo_box_get_active (GTK_COMBO_BOX (cmd));
+		if (idx > 0) {
+			filter.cmd = RIG_CMD_NONE + idx;
+		}
+
 		/* sanity check of filename will be performed 
 		   in read_debug_file */
-		read_debug_file (filename);
+		read_debug_file (filename, &filter);
 
 		g_free (filename);
 	}
@@ -429,130 +376,257 @@ load_debug_file ()
 }
 
 
-/** \brief Read contents of debug file. */
+/** \brief Create the level and command filter of the file chooser.
+ *  \param level Where to store the level combo box.
+ *  \param cmd Where to store the command combo box.
+ *  \return The container holding both.
+ */
+static GtkWidget *
+create_filter_widget (GtkWidget **level, GtkWidget **cmd)
+{
+	GtkWidget   *hbox;
+	const gchar *name;
+	gint         i;
+
+
+	*level = gtk_combo_box_text_new ();
+	gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (*level), _("Bugs"));
+	gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (*level), _("Errors"));
+	gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (*level), _("Warnings"));
+	gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (*level), _("Verbose"));
+	gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (*level), _("Trace"));
+	gtk_combo_box_set_active (GTK_COMBO_BOX (*level), RIG_DEBUG_TRACE - RIG_DEBUG_BUG);
+
+	*cmd = gtk_combo_box_text_new ();
+	gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (*cmd), _("All commands"));
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+		name = rig_daemon_cmd_to_str (i);
+		if (g_str_has_prefix (name, "RIG_CMD_")) {
+			name += strlen ("RIG_CMD_");
+		}
+		gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (*cmd), name);
+	}
+	gtk_combo_box_set_active (GTK_COMBO_BOX (*cmd), 0);
+
+	hbox = gtk_hbox_new (FALSE, 5);
+	gtk_box_pack_start (GTK_BOX (hbox), gtk_label_new (_("Show up to")),
+			    FALSE, FALSE, 0);
+	gtk_box_pack_start (GTK_BOX (hbox), *level, FALSE, FALSE, 0);
+	gtk_box_pack_start (GTK_BOX (hbox), gtk_label_new (_("for")),
+			    FALSE, FALSE, 0);
+	gtk_box_pack_start (GTK_BOX (hbox), *cmd, FALSE, FALSE, 0);
+	gtk_widget_show_all (hbox);
+
+	return hbox;
+}
+
+
+/** \brief Read contents of debug file.
+ *  \param filename The file to show.
+ *  \param filter The messages to show from a binary trace.
+ *  \return 0 if the file has been opened or is being converted.
+ *
+ * The file is mapped into memory and indexed in the background, see
+ * GrigMsgModel. If it is the log file grig is writing to, the list
+ * follows the file as new messages are written.
+ *
+ * A binary trace is converted to a temporary text file by a worker thread
+ * so that the GUI does not block; it is shown when the conversion is done
+ * and it is not followed. Only the messages matching \a filter are
+ * converted; the block index of the trace lets the worker skip the
+ * blocks that have none.
+ */
 static int
-read_debug_file (const gchar *filename)
+read_debug_file (const gchar *filename, const grig_trace_filter_t *filter)
 {
-	GIOChannel  *logfile = NULL;   /* the log file */
-	GError      *error = NULL;     /* error structure */
-	gint         errorcode = 0;    /* error code returned by function */
-	gchar       *line;             /* line read from file */
-	gsize        length;           /* length of line read from file */
-	gchar      **buff;
+	trace_job_t  *job;
+	GError       *error = NULL;
+	gchar        *current;
+	gchar        *title;
+	gboolean      follow;
 
 
 	/* check file and read contents */
-	if (g_file_test (filename, G_FILE_TEST_EXISTS)) {
-
-		/* open file */
-		logfile = g_io_channel_new_file (filename, "r", &error);
-
-		if (logfile) {
-			/* read the file line by line */
-			while (g_io_channel_read_line (logfile,
-						       &line,
-						       &length,
-						       NULL,
-						       NULL) != G_IO_STATUS_EOF) {
-
-				/* trim line and split it */
-				line = g_strdelimit (line, "\n", '\0');
-
-				buff = g_strsplit (line,
-						   GRIG_DEBUG_SEPARATOR,
-						   MSG_LIST_COL_NUMBER);
-
-				/* buff[0] = date and time
-				   buff[1] = source
-				   buff[2] = level
-				   buff[3] = message
-				   unless it comes from Gtk+/Glib, in which case
-				   buff[0] contains the message and it is the
-				   only element
-				*/
-				switch (g_strv_length (buff)) {
-
-				case 1:
-					add_debug_message ("", _("SYS"), RIG_DEBUG_ERR, buff[0]);
-					break;
-
-				case 4:
-					add_debug_message (buff[0], buff[1],
-							   (guint) g_ascii_strtod (buff[2], NULL),
-							   buff[3]);
-					break;
-				default:
-					add_debug_message ("", _("GRIG"), RIG_DEBUG_ERR,
-							   _("Log file seems corrupt"));
-					break;
-				}
-
-				/* clean up */
-				g_free (line);
-				g_strfreev (buff);
-			}
-
-			errorcode = 0;
-
-			/* Close IO channel; don't care about status.
-			   Shutdown will flush the stream and close the channel
-			   as soon as the reference count is dropped. Order matters!
-			*/
-			g_io_channel_shutdown (logfile, TRUE, NULL);
-			g_io_channel_unref (logfile);
+	if (!g_file_test (filename, G_FILE_TEST_EXISTS)) {
+		return 1;
+	}
 
-		}
-		else {
-			/* an error occurred */
+	if (!grig_trace_is_binary (filename)) {
+		current = grig_debug_get_log_file ();
+		follow = (current != NULL) && !g_strcmp0 (current, filename);
+		g_free (current);
+
+		return show_debug_file (filename, filename, follow);
+	}
+
+	if (converter != NULL) {
+		grig_debug_local (RIG_DEBUG_WARN,
+				  _("%s: Still converting the previous trace"),
+				  __FUNCTION__);
+		return 1;
+	}
+
+	job = g_new0 (trace_job_t, 1);
+	job->filename = g_strdup (filename);
+	job->filter = *filter;
+
+	converter = g_thread_try_new ("grig-trace", convert_trace, job, &error);
+	if (converter == NULL) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s:%d: Error converting trace (%s)"),
+				  __FILE__, __LINE__, error->message);
+		g_clear_error (&error);
+		g_free (job->filename);
+		g_free (job);
 
-			grig_debug_local (RIG_DEBUG_ERR,
-					  _("%s:%d: Error open debug log (%s)"),
-					  __FILE__, __LINE__, error->message);
+		return 1;
+	}
+
+	title = g_strdup_printf (_("Grig Message Window: %s (converting)"), filename);
+	gtk_window_set_title (GTK_WINDOW (window), title);
+	g_free (title);
 
-			g_clear_error (&error);
+	return 0;
+}
+
+
+/** \brief Show a text log file.
+ *  \param filename The file shown in the title.
+ *  \param textfile The file to read; differs from \a filename for a
+ *                   converted trace.
+ *  \param follow Whether to follow the file as it grows.
+ *  \return 0 if the file has been opened.
+ */
+static int
+show_debug_file (const gchar *filename, const gchar *textfile, gboolean follow)
+{
+	GtkTreeModel *newmodel;
+	GError       *error = NULL;
+	gchar        *title;
 
-			errorcode = 1;
+
+	newmodel = grig_msg_model_new_file (textfile, follow, &error);
+
+	if (newmodel == NULL) {
+		/* an error occurred */
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s:%d: Error open debug log (%s)"),
+				  __FILE__, __LINE__, error->message);
+
+		g_clear_error (&error);
+
+		return 1;
+	}
+
+	set_model (newmodel);
+
+	title = g_strdup_printf (_("Grig Message Window: %s"), filename);
+	gtk_window_set_title (GTK_WINDOW (window), title);
+	g_free (title);
+
+	return 0;
+}
+
+
+/** \brief Convert a binary trace to a temporary text file.
+ *  \param data The trace_job_t.
+ *  \return Always NULL.
+ *
+ * This runs in the converter thread; the result is handed back to the
+ * main loop with convert_trace_done().
+ */
+static gpointer
+convert_trace (gpointer data)
+{
+	trace_job_t *job = (trace_job_t *) data;
+	FILE        *tmpfile;
+	gint         fd;
+
+
+	fd = g_file_open_tmp ("grig-trace-XXXXXX.log", &job->tmpname, &job->error);
+	if (fd != -1) {
+		tmpfile = fdopen (fd, "w");
+		if (!grig_trace_to_text (job->filename, &job->filter, tmpfile,
+					 &job->error)) {
+			g_unlink (job->tmpname);
+			g_free (job->tmpname);
+			job->tmpname = NULL;
 		}
+		fclose (tmpfile);
+	}
+
+	g_idle_add (convert_trace_done, job);
+
+	return NULL;
+}
+
+
+/** \brief Show a converted trace.
+ *  \param data The trace_job_t.
+ *  \return Always FALSE.
+ *
+ * The trace is only shown if the message window still exists.
+ */
+static gboolean
+convert_trace_done (gpointer data)
+{
+	trace_job_t *job = (trace_job_t *) data;
+
+
+	g_thread_join (converter);
+	converter = NULL;
+
+	if (job->tmpname == NULL) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s:%d: Error converting trace (%s)"),
+				  __FILE__, __LINE__, job->error->message);
+		g_clear_error (&job->error);
 	}
 	else {
-		errorcode = 1;
+		if (initialised) {
+			show_debug_file (job->filename, job->tmpname, FALSE);
+		}
+
+		/* the mapping stays valid after the file has been removed */
+		g_unlink (job->tmpname);
+		g_free (job->tmpname);
 	}
 
-	return errorcode;
+	g_free (job->filename);
+	g_free (job);
+
+	return FALSE;
 }
 
 
 /** \brief Clear the message list
  *
- * Besides clearing the message list, the function also resets
- * the counters and set the text of the corresponding widgets
- * to zero.
+ * The list goes back to showing the live messages, starting with the
+ * next message; the counters are reset as well.
  */
 static void
 clear_message_list ()
 {
-	/* clear the meaase list */
-	gtk_list_store_clear (GTK_LIST_STORE (model));
-
-	/* reset the counters and text widgets */
-	bugs = 0;
-	errors = 0;
-	warnings = 0;
-	verboses = 0;
-	traces = 0;
-	grigs = 0;
-	hamlibs = 0;
-	others = 0;
-
-	gtk_label_set_text (GTK_LABEL (buglabel), "0");
-	gtk_label_set_text (GTK_LABEL (errlabel), "0");
-	gtk_label_set_text (GTK_LABEL (warnlabel), "0");
-	gtk_label_set_text (GTK_LABEL (verblabel), "0");
-	gtk_label_set_text (GTK_LABEL (tracelabel), "0");
-	gtk_label_set_text (GTK_LABEL (hamliblabel), "0");
-	gtk_label_set_text (GTK_LABEL (griglabel), "0");
-	gtk_label_set_text (GTK_LABEL (otherlabel), "0");
-	gtk_label_set_markup (GTK_LABEL (sumlabel), "<b>0</b>");
+	set_model (grig_msg_model_new_live (C_MSG_WIN_LIVE_ROWS));
+
+	gtk_window_set_title (GTK_WINDOW (window), _("Grig Message Window"));
+}
+
+
+/** \brief Show a new model in the list.
+ *  \param newmodel The new model; the list takes over the reference.
+ *
+ * Replacing the model is much cheaper than removing all rows of the old
+ * one.
+ */
+static void
+set_model (GtkTreeModel *newmodel)
+{
+	gtk_tree_view_set_model (GTK_TREE_VIEW (treeview), newmodel);
+	g_object_unref (newmodel);
+	model = newmodel;
+
+	update_summary ();
 }
 
 
@@ -561,9 +635,6 @@ clear_message_list ()
 static GtkWidget *
 create_message_list    ()
 {
-	/* high level treev iew widget */
-	GtkWidget *treeview;
-
 	/* scrolled window containing the tree view */
 	GtkWidget *swin;
 
@@ -593,8 +664,15 @@ create_message_list    ()
 		/* only aligns the headers? */
 		gtk_tree_view_column_set_alignment (column, MSG_LIST_COL_TITLE_ALIGN[i]);
 
+		/* fixed size columns so that the view does not have to
+		   look at every row */
+		gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+		gtk_tree_view_column_set_fixed_width (column, MSG_LIST_COL_WIDTH[i]);
+		gtk_tree_view_column_set_resizable (column, TRUE);
 	}
 
+	gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (treeview), TRUE);
+
 	/* create tree view model and finalise tree view */
 	model = create_list_model ();
 	gtk_tree_view_set_model (GTK_TREE_VIEW (treeview), model);
@@ -612,24 +690,15 @@ create_message_list    ()
 }
 
 
-/* create tree view model; we actually create a GtkListStore because we are
-   only interested in a flat list. A GtkListStore can be cast to a GtkTreeModel
-   without any problems.
+/* create tree view model; we start with the live messages, including the
+   ones that are still available from before the window was created.
 */
 static GtkTreeModel *
 create_list_model ()
 {
-	GtkListStore *liststore;
-
-	liststore = gtk_list_store_new (MSG_LIST_COL_NUMBER,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING);
-
-	/*** Fill existing data into the list here ***/
+	liveseq = 0;
 
-	return GTK_TREE_MODEL (liststore);
+	return grig_msg_model_new_live (C_MSG_WIN_LIVE_ROWS);
 }
 
 
@@ -668,13 +737,16 @@ create_message_summary ()
 	tracelabel = gtk_label_new ("0");
 	gtk_misc_set_alignment (GTK_MISC (tracelabel), 1.0, 0.5);
 
+	supplabel = gtk_label_new ("0");
+	gtk_misc_set_alignment (GTK_MISC (supplabel), 1.0, 0.5);
+
 	sumlabel = gtk_label_new (NULL);
 	gtk_label_set_use_markup (GTK_LABEL (sumlabel), TRUE);
 	gtk_label_set_markup (GTK_LABEL (sumlabel), "<b>0</b>");
 	gtk_misc_set_alignment (GTK_MISC (sumlabel), 1.0, 0.5);
 
 	/* create table and add widgets */
-	table = gtk_table_new (10, 2, TRUE);
+	table = gtk_table_new (12, 2, TRUE);
 	gtk_table_set_col_spacings (GTK_TABLE (table), 5);
 	gtk_container_set_border_width (GTK_CONTAINER (table), 10);
 
@@ -761,6 +833,16 @@ create_message_summary ()
 	gtk_table_attach_defaults (GTK_TABLE (table), sumlabel,
 				   1, 2, 10, 11);
 
+	label = gtk_label_new (_("Suppressed"));
+	gtk_misc_set_alignment (GTK_MISC (label), 0.0, 0.5);
+	gtk_widget_set_tooltip_text (label,
+				     _("Repeated messages that have not been logged"));
+	gtk_table_attach_defaults (GTK_TABLE (table),
+				   label,
+				   0, 1, 11, 12);
+	gtk_table_attach_defaults (GTK_TABLE (table), supplabel,
+				   1, 2, 11, 12);
+
 	/* frame around the table */
 	frame = gtk_frame_new (_(" Summary "));
 	gtk_frame_set_label_align (GTK_FRAME (frame), 0.5, 0.5);
@@ -769,3 +851,120 @@ create_message_summary ()
 	return frame;
 }
 
+
+/** \brief Refresh the message window.
+ *
+ * This function is called periodically while the message window is
+ * visible. It adds the new live messages or checks the followed file,
+ * updates the counters and keeps the list scrolled to the end if it
+ * was at the end before. It stops itself when the window has been hidden.
+ */
+static gboolean
+refresh_message_window (gpointer data)
+{
+	GrigMsgModel  *msgmodel = GRIG_MSG_MODEL (model);
+	GtkAdjustment *adj;
+	GPtrArray     *lines;
+	gboolean       atend;
+	guint          nrows;
+	guint          i;
+	gint64         start;
+
+
+	if (!visible) {
+		refreshtimer = 0;
+		return FALSE;
+	}
+
+	start = grig_timeline_begin ();
+
+	adj = gtk_tree_view_get_vadjustment (GTK_TREE_VIEW (treeview));
+	atend = (gtk_adjustment_get_value (adj) >=
+		 gtk_adjustment_get_upper (adj) - gtk_adjustment_get_page_size (adj) - 1.0);
+	nrows = gtk_tree_model_iter_n_children (model, NULL);
+
+	if (msgmodel->ring != NULL) {
+		/* live mode */
+		lines = g_ptr_array_new ();
+		grig_debug_get_history (&liveseq, lines);
+		for (i = 0; i < lines->len; i++) {
+			grig_msg_model_append (msgmodel, g_ptr_array_index (lines, i));
+		}
+		g_ptr_array_free (lines, TRUE);
+	}
+	else if (!grig_msg_model_poll (msgmodel)) {
+		/* the file has been rotated; start over with a new model */
+		GtkTreeModel *newmodel;
+
+		newmodel = grig_msg_model_new_file (msgmodel->filename, TRUE, NULL);
+		if (newmodel != NULL) {
+			set_model (newmodel);
+			msgmodel = GRIG_MSG_MODEL (model);
+		}
+	}
+
+	update_summary ();
+
+	if (atend && (gtk_tree_model_iter_n_children (model, NULL) != nrows)) {
+		nrows = gtk_tree_model_iter_n_children (model, NULL);
+		if (nrows > 0) {
+			GtkTreePath *path = gtk_tree_path_new_from_indices (nrows - 1, -1);
+			gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (treeview), path,
+						      NULL, FALSE, 0.0, 0.0);
+			gtk_tree_path_free (path);
+		}
+	}
+
+	grig_timeline_end ("timer", __FUNCTION__, start, NULL, 0);
+
+	return TRUE;
+}
+
+
+/** \brief Update the summary labels from the model counters. */
+static void
+update_summary ()
+{
+	const grig_msg_counts_t *counts;
+	GtkWidget               *labels[RIG_DEBUG_TRACE + 1];
+	gchar                   *str;
+	guint                    total = 0;
+	guint                    i;
+
+
+	counts = grig_msg_model_get_counts (GRIG_MSG_MODEL (model));
+
+	labels[RIG_DEBUG_NONE]    = NULL;
+	labels[RIG_DEBUG_BUG]     = buglabel;
+	labels[RIG_DEBUG_ERR]     = errlabel;
+	labels[RIG_DEBUG_WARN]    = warnlabel;
+	labels[RIG_DEBUG_VERBOSE] = verblabel;
+	labels[RIG_DEBUG_TRACE]   = tracelabel;
+
+	for (i = RIG_DEBUG_BUG; i <= RIG_DEBUG_TRACE; i++) {
+		str = g_strdup_printf ("%u", counts->level[i]);
+		gtk_label_set_text (GTK_LABEL (labels[i]), str);
+		g_free (str);
+		total += counts->level[i];
+	}
+
+	str = g_strdup_printf ("%u", counts->hamlib);
+	gtk_label_set_text (GTK_LABEL (hamliblabel), str);
+	g_free (str);
+
+	str = g_strdup_printf ("%u", counts->grig);
+	gtk_label_set_text (GTK_LABEL (griglabel), str);
+	g_free (str);
+
+	str = g_strdup_printf ("%u", counts->other);
+	gtk_label_set_text (GTK_LABEL (otherlabel), str);
+	g_free (str);
+
+	str = g_strdup_printf ("<b>%u</b>", total);
+	gtk_label_set_markup (GTK_LABEL (sumlabel), str);
+	g_free (str);
+
+	str = g_strdup_printf ("%u", grig_debug_get_suppressed ());
+	gtk_label_set_text (GTK_LABEL (supplabel), str);
+	g_free (str);
+}
@@ -0,0 +1,289 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file rig-gui-profiler.c
+ *  \ingroup info
+ *  \brief Daemon profiler window.
+ *
+ * This dialog shows the timing statistics collected by the daemon profiler
+ * (see rig-daemon-prof.c): the overall command rate, bus utilisation and
+ * cycle time, followed by the execution time percentiles of each command.
+ * The contents are refreshed every C_PROFILER_REFRESH msec while the dialog
+ * is open.
+ */
+#include <gtk/gtk.h>
+#include <hamlib/rig.h>
+#include <glib/gi18n.h>
+#include "grig-timeline.h"
+#include "rig-daemon.h"
+#include "rig-daemon-prof.h"
+#include "rig-gui-profiler.h"
+
+extern GtkWidget   *grigapp;    /* defined in main.c */
+
+
+/** \brief Refresh interval of the dialog [msec]. */
+#define C_PROFILER_REFRESH 1000
+
+
+/** \brief Columns in the command list. */
+typedef enum {
+	PROFILER_COL_CMD = 0,
+	PROFILER_COL_COUNT,
+	PROFILER_COL_ERRORS,
+	PROFILER_COL_P50,
+	PROFILER_COL_P90,
+	PROFILER_COL_P99,
+	PROFILER_COL_MAX,
+	PROFILER_COL_NUMBER
+} profiler_col_t;
+
+
+/** \brief Column titles. */
+static const gchar *PROFILER_COL_TITLE[PROFILER_COL_NUMBER] = {
+	N_("Command"),
+	N_("Count"),
+	N_("Errors"),
+	N_("p50 [ms]"),
+	N_("p90 [ms]"),
+	N_("p99 [ms]"),
+	N_("Max [ms]")
+};
+
+
+/** \brief Widgets updated by the refresh timer. */
+typedef struct {
+	GtkListStore *store;     /*!< The command list. */
+	GtkWidget    *summary;   /*!< Label showing the overall statistics. */
+	guint         timerid;   /*!< The refresh timer. */
+} profiler_t;
+
+
+static gboolean rig_gui_profiler_fill     (gpointer);
+static void     rig_gui_profiler_row      (GtkListStore *, const gchar *,
+					   const rig_daemon_hist_t *);
+static void     rig_gui_profiler_response (GtkDialog *, gint, gpointer);
+static void     rig_gui_profiler_destroy  (GtkWidget *, gpointer);
+
+
+
+/** \brief Create daemon profiler dialog.
+ *
+ * This function creates the dialog window which is used for showing
+ * the timing statistics of the rig daemon.
+ */
+void
+rig_gui_profiler_run ()
+{
+	GtkWidget         *dialog;
+	GtkWidget         *treeview;
+	GtkWidget         *swin;
+	GtkCellRenderer   *renderer;
+	GtkTreeViewColumn *column;
+	profiler_t        *prof;
+	guint              i;
+
+
+	prof = g_new0 (profiler_t, 1);
+
+	prof->store = gtk_list_store_new (PROFILER_COL_NUMBER,
+					  G_TYPE_STRING,
+					  G_TYPE_UINT,
+					  G_TYPE_UINT,
+					  G_TYPE_STRING,
+					  G_TYPE_STRING,
+					  G_TYPE_STRING,
+					  G_TYPE_STRING);
+
+	treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (prof->store));
+	g_object_unref (prof->store);
+
+	for (i = 0; i < PROFILER_COL_NUMBER; i++) {
+		renderer = gtk_cell_renderer_text_new ();
+		if (i != PROFILER_COL_CMD)
+			g_object_set (renderer, "xalign", 1.0, NULL);
+		column = gtk_tree_view_column_new_with_attributes (_(PROFILER_COL_TITLE[i]),
+								   renderer,
+								   "text", i,
+								   NULL);
+		gtk_tree_view_append_column (GTK_TREE_VIEW (treeview), column);
+	}
+
+	swin = gtk_scrolled_window_new (NULL, NULL);
+	gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (swin),
+					GTK_POLICY_AUTOMATIC,
+					GTK_POLICY_AUTOMATIC);
+	gtk_container_add (GTK_CONTAINER (swin), treeview);
+
+	prof->summary = gtk_label_new (NULL);
+	gtk_misc_set_alignment (GTK_MISC (prof->summary), 0.0, 0.5);
+	gtk_misc_set_padding (GTK_MISC (prof->summary), 5, 5);
+
+	rig_gui_profiler_fill (prof);
+
+	/* create dialog and add contents */
+	dialog = gtk_dialog_new_with_buttons (_("Daemon Profiler"), GTK_WINDOW (grigapp),
+					      GTK_DIALOG_DESTROY_WITH_PARENT,
+					      GTK_STOCK_CLOSE, GTK_RESPONSE_NONE, NULL);
+	gtk_window_set_default_size (GTK_WINDOW (dialog), -1, 400);
+
+	g_signal_connect (dialog, "response",
+			  G_CALLBACK (rig_gui_profiler_response),
+			  NULL);
+	g_signal_connect (dialog, "destroy",
+			  G_CALLBACK (rig_gui_profiler_destroy),
+			  prof);
+
+	gtk_box_pack_start (GTK_BOX (GTK_DIALOG (dialog)->vbox),
+			    prof->summary, FALSE, FALSE, 0);
+	gtk_box_pack_start (GTK_BOX (GTK_DIALOG (dialog)->vbox),
+			    swin, TRUE, TRUE, 0);
+
+	prof->timerid = g_timeout_add (C_PROFILER_REFRESH, rig_gui_profiler_fill, prof);
+
+	gtk_widget_show_all (dialog);
+}
+
+
+/** \brief Refresh the dialog contents.
+ *  \param data The profiler_t structure of the dialog.
+ *  \return Always TRUE to keep the timer running.
+ *
+ * Only commands that have been executed at least once are listed; the
+ * first row shows the cycle time.
+ */
+static gboolean
+rig_gui_profiler_fill (gpointer data)
+{
+	profiler_t               *prof = (profiler_t *) data;
+	rig_daemon_prof_totals_t  totals;
+	rig_daemon_hist_t         hist;
+	gchar                    *text;
+	guint                     i;
+	gint64                    start;
+
+
+	start = grig_timeline_begin ();
+
+	rig_daemon_prof_get_totals (&totals);
+
+	text = g_strdup_printf (_("%u commands in %.0f sec\n"\
+				  "Rate: %.1f cmds/sec\n"\
+				  "Bus utilisation: %.0f%%\n"\
+				  "Sleeping: %.0f%%"),
+				totals.commands, totals.elapsed / 1.0e6,
+				totals.rate,
+				100.0 * totals.load,
+				totals.elapsed ? 100.0 * totals.idle / totals.elapsed : 0.0);
+	gtk_label_set_text (GTK_LABEL (prof->summary), text);
+	g_free (text);
+
+	gtk_list_store_clear (prof->store);
+
+	rig_gui_profiler_row (prof->store, _("(cycle)"), &totals.cycle);
+
+	for (i = RIG_CMD_NONE + 1; i < RIG_CMD_NUMBER; i++) {
+
+		if (rig_daemon_prof_get_cmd (i, &hist) && hist.count) {
+			rig_gui_profiler_row (prof->store, rig_daemon_cmd_to_str (i), &hist);
+		}
+	}
+
+	grig_timeline_end ("timer", __FUNCTION__, start, NULL, 0);
+
+	return TRUE;
+}
+
+
+/** \brief Append a histogram to the command list.
+ *  \param store The list store.
+ *  \param name The name shown in the first column.
+ *  \param hist The histogram.
+ */
+static void
+rig_gui_profiler_row (GtkListStore *store, const gchar *name,
+		      const rig_daemon_hist_t *hist)
+{
+	GtkTreeIter  item;
+	gchar       *p50;
+	gchar       *p90;
+	gchar       *p99;
+	gchar       *max;
+
+
+	p50 = g_strdup_printf ("%.1f", rig_daemon_prof_percentile (hist, 0.50) / 1000.0);
+	p90 = g_strdup_printf ("%.1f", rig_daemon_prof_percentile (hist, 0.90) / 1000.0);
+	p99 = g_strdup_printf ("%.1f", rig_daemon_prof_percentile (hist, 0.99) / 1000.0);
+	max = g_strdup_printf ("%.1f", hist->max / 1000.0);
+
+	gtk_list_store_append (store, &item);
+	gtk_list_store_set (store, &item,
+			    PROFILER_COL_CMD, name,
+			    PROFILER_COL_COUNT, hist->count,
+			    PROFILER_COL_ERRORS, hist->errors,
+			    PROFILER_COL_P50, p50,
+			    PROFILER_COL_P90, p90,
+			    PROFILER_COL_P99, p99,
+			    PROFILER_COL_MAX, max,
+			    -1);
+
+	g_free (p50);
+	g_free (p90);
+	g_free (p99);
+	g_free (max);
+}
+
+
+/** \brief Handle dialog response.
+ *  \param dialog The dialog.
+ *  \param response The response ID.
+ *  \param data Unused.
+ */
+static void
+rig_gui_profiler_response (GtkDialog *dialog, gint response, gpointer data)
+{
+	gtk_widget_destroy (GTK_WIDGET (dialog));
+}
+
+
+/** \brief Stop the refresh timer when the dialog is destroyed.
+ *  \param widget The dialog.
+ *  \param data The profiler_t structure of the dialog.
+ */
+static void
+rig_gui_profiler_destroy (GtkWidget *widget, gpointer data)
+{
+	profiler_t *prof = (profiler_t *) data;
+
+
+	g_source_remove (prof->timerid);
+	g_free (prof);
+}
@@ -64,13 +64,16 @@ static void create_controls   (GtkBox *box);
 static void float_level_cb    (GtkRange *range, gpointer data);
 static gchar *float_format_value_cb (GtkScale *scale, gdouble value);
 static gchar *sfreq_format_value_cb (GtkScale *scale, gdouble value);
-static gboolean rx_levels_update (gpointer data);
+static void rx_levels_update (guint64 changed, gpointer data);
 
 
 
 static GtkWidget *dialog;
 static gboolean visible = FALSE;
-static guint timerid = 0;
+static guint listenerid = 0;
+
+/* the rig the window was opened for */
+static gint rig = 0;
 
 /* controls */
 static GtkWidget *afs,*rfs,*ifs,*cwp,*pbti,*pbto,*apf,*nrs,*not,*sql,*bal;
@@ -100,6 +103,9 @@ rig_gui_rx_create ()
 		return;
 	}
 
+	/* the window stays with the rig that is selected now */
+	rig = rig_data_current ();
+
 	/* create hbox and add sliders */
 	hbox = gtk_hbox_new (TRUE, 5);
 	create_controls (GTK_BOX (hbox));
@@ -128,8 +134,19 @@ rig_gui_rx_create ()
 
 	gtk_widget_show_all (dialog);
 
-	/* start callback */
-	timerid = g_timeout_add (1007, rx_levels_update, NULL);
+	/* listen for changes */
+	listenerid = rig_data_add_rig_listener (rig, RIG_DATA_DIRTY (RIG_DATA_FIELD_AFG) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_RFG) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_IFS) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_CWPITCH) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_PBTIN) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_PBTOUT) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_APF) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_NR) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_NOTCH) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_SQL) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_BALANCE),
+					        rx_levels_update, NULL);
 }
 
 
@@ -154,8 +171,8 @@ rx_window_destroy    (GtkWidget *widget,
 {
 
 	/* stop callback */
-	g_source_remove (timerid);
-	timerid = 0;
+	rig_data_remove_listener (listenerid);
+	listenerid = 0;
 
 	/* clear rx-active flag in rig-data */
 
@@ -190,6 +207,10 @@ float_level_cb (GtkRange *range, gpointer data)
 {
 	int level = GPOINTER_TO_INT (data);
 	float value = -1.0 * gtk_range_get_value (range);
+	gint prev;
+
+	/* the setters act on the rig of this window */
+	prev = rig_data_bind (rig);
 
 	switch (level) {
 
@@ -243,6 +264,8 @@ float_level_cb (GtkRange *range, gpointer data)
 				  __FILE__, __LINE__, level);
 		break;
 	}
+
+	rig_data_bind (prev);
 }
 
 static gchar *
@@ -269,12 +292,16 @@ create_controls   (GtkBox *box)
 {
 	GtkWidget *label;
 	GtkWidget *vbox;
+	grig_settings_t snap;
 	guint count = 0;
 
+	/* initial values read in one go */
+	rig_data_snapshot (&snap);
+
 	/* afs */
 	if (rig_data_has_set_afg ()) {
 		afs = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (afs), -1.0*rig_data_get_afg ());
+		gtk_range_set_value (GTK_RANGE (afs), -1.0*snap.afg);
 		afi = g_signal_connect (afs, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_AF));
@@ -294,7 +321,7 @@ create_controls   (GtkBox *box)
 	/* rfs */
 	if (rig_data_has_set_rfg ()) {
 		rfs = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (rfs), -1.0*rig_data_get_rfg ());
+		gtk_range_set_value (GTK_RANGE (rfs), -1.0*snap.rfg);
 		rfi = g_signal_connect (rfs, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_RF));
@@ -313,15 +340,15 @@ create_controls   (GtkBox *box)
 
 	/* ifs */
 	if (rig_data_has_set_ifs ()) {
-		if (rig_data_get_ifsmax () > 0) {
-			ifs = gtk_vscale_new_with_range (-rig_data_get_ifsmax (),
-							 rig_data_get_ifsmax (),
+		if (snap.ifsmax > 0) {
+			ifs = gtk_vscale_new_with_range (-snap.ifsmax,
+							 snap.ifsmax,
 							 10.0);
 		}
 		else {
 			ifs = gtk_vscale_new_with_range (-10000, 10000, 10);
 		}
-		gtk_range_set_value (GTK_RANGE (ifs), -1.0*rig_data_get_ifs ());
+		gtk_range_set_value (GTK_RANGE (ifs), -1.0*snap.ifs);
 		ifi = g_signal_connect (ifs, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_IF));
@@ -341,7 +368,7 @@ create_controls   (GtkBox *box)
 	/* cwp */
 	if (rig_data_has_set_cwpitch ()) {
 		cwp = gtk_vscale_new_with_range (-1000, -500, 10.0);
-		gtk_range_set_value (GTK_RANGE (cwp), -1.0*rig_data_get_cwpitch ());
+		gtk_range_set_value (GTK_RANGE (cwp), -1.0*snap.cwpitch);
 		cwi = g_signal_connect (cwp, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_CWPITCH));
@@ -361,7 +388,7 @@ create_controls   (GtkBox *box)
 	/* pbti */
 	if (rig_data_has_set_pbtin ()) {
 		pbti = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (pbti), -1.0*rig_data_get_pbtin ());
+		gtk_range_set_value (GTK_RANGE (pbti), -1.0*snap.pbtin);
 		pbii = g_signal_connect (pbti, "value-changed",
 					 G_CALLBACK (float_level_cb),
 					 GINT_TO_POINTER (RIG_LEVEL_PBT_IN));
@@ -381,7 +408,7 @@ create_controls   (GtkBox *box)
 	/* pbto */
 	if (rig_data_has_set_pbtout ()) {
 		pbto = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (pbto), -1.0*rig_data_get_pbtout ());
+		gtk_range_set_value (GTK_RANGE (pbto), -1.0*snap.pbtout);
 		pboi = g_signal_connect (pbto, "value-changed",
 					 G_CALLBACK (float_level_cb),
 					 GINT_TO_POINTER (RIG_LEVEL_PBT_OUT));
@@ -402,7 +429,7 @@ create_controls   (GtkBox *box)
 	/* apf */
 	if (rig_data_has_set_apf ()) {
 		apf = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (apf), -1.0*rig_data_get_apf ());
+		gtk_range_set_value (GTK_RANGE (apf), -1.0*snap.apf);
 		api = g_signal_connect (apf, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_APF));
@@ -422,7 +449,7 @@ create_controls   (GtkBox *box)
 	/* nrs */
 	if (rig_data_has_set_nr ()) {
 		nrs = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (nrs), -1.0*rig_data_get_nr ());
+		gtk_range_set_value (GTK_RANGE (nrs), -1.0*snap.nr);
 		nri = g_signal_connect (nrs, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_NR));
@@ -442,7 +469,7 @@ create_controls   (GtkBox *box)
 	/* not */
 	if (rig_data_has_set_notch ()) {
 		not = gtk_vscale_new_with_range (-3000, -500, 10.0);
-		gtk_range_set_value (GTK_RANGE (not), -1.0*rig_data_get_notch ());
+		gtk_range_set_value (GTK_RANGE (not), -1.0*snap.notch);
 		noi = g_signal_connect (not, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_NOTCHF));
@@ -462,7 +489,7 @@ create_controls   (GtkBox *box)
 	/* sql */
 	if (rig_data_has_set_sql ()) {
 		sql = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (sql), -1.0*rig_data_get_sql ());
+		gtk_range_set_value (GTK_RANGE (sql), -1.0*snap.sql);
 		sqi = g_signal_connect (sql, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_SQL));
@@ -482,7 +509,7 @@ create_controls   (GtkBox *box)
 	/* bal */
 	if (rig_data_has_set_balance ()) {
 		bal = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (bal), -1.0*rig_data_get_balance ());
+		gtk_range_set_value (GTK_RANGE (bal), -1.0*snap.balance);
 		bai = g_signal_connect (bal, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_BALANCE));
@@ -511,97 +538,110 @@ create_controls   (GtkBox *box)
 }
 
 
-static gboolean
-rx_levels_update (gpointer data)
+static void
+rx_levels_update (guint64 changed, gpointer data)
 {
+	grig_settings_t snap;
+
+	/* read all levels in one go */
+	rig_data_snapshot (&snap);
+
 	/* afs */
-	if (rig_data_has_get_afg ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_AFG)) &&
+	    rig_data_has_get_afg ()) {
 		g_signal_handler_block (afs, afi);
-		gtk_range_set_value (GTK_RANGE (afs), -1.0*rig_data_get_afg ());
+		gtk_range_set_value (GTK_RANGE (afs), -1.0*snap.afg);
 		g_signal_handler_unblock (afs, afi);
 	}
 
 
 	/* rfs */
-	if (rig_data_has_get_rfg ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_RFG)) &&
+	    rig_data_has_get_rfg ()) {
 		g_signal_handler_block (rfs, rfi);
-		gtk_range_set_value (GTK_RANGE (rfs), -1.0*rig_data_get_rfg ());
+		gtk_range_set_value (GTK_RANGE (rfs), -1.0*snap.rfg);
 		g_signal_handler_unblock (rfs, rfi);
 	}
 
 
 	/* ifs */
-	if (rig_data_has_get_ifs ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_IFS)) &&
+	    rig_data_has_get_ifs ()) {
 		g_signal_handler_block (ifs, ifi);
-		gtk_range_set_value (GTK_RANGE (ifs), -1.0*rig_data_get_ifs ());
+		gtk_range_set_value (GTK_RANGE (ifs), -1.0*snap.ifs);
 		g_signal_handler_unblock (ifs, ifi);
 	}
 
 
 	/* cwp */
-	if (rig_data_has_get_cwpitch ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_CWPITCH)) &&
+	    rig_data_has_get_cwpitch ()) {
 		g_signal_handler_block (cwp, cwi);
-		gtk_range_set_value (GTK_RANGE (cwp), -1.0*rig_data_get_cwpitch ());
+		gtk_range_set_value (GTK_RANGE (cwp), -1.0*snap.cwpitch);
 		g_signal_handler_unblock (cwp, cwi);
 	}
 
 
 	/* pbti */
-	if (rig_data_has_get_pbtin ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_PBTIN)) &&
+	    rig_data_has_get_pbtin ()) {
 		g_signal_handler_block (pbti, pbii);
-		gtk_range_set_value (GTK_RANGE (pbti), -1.0*rig_data_get_pbtin ());
+		gtk_range_set_value (GTK_RANGE (pbti), -1.0*snap.pbtin);
 		g_signal_handler_unblock (pbti, pbii);
 	}
 
 
 	/* pbto */
-	if (rig_data_has_get_pbtout ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_PBTOUT)) &&
+	    rig_data_has_get_pbtout ()) {
 		g_signal_handler_block (pbto, pboi);
-		gtk_range_set_value (GTK_RANGE (pbto), -1.0*rig_data_get_pbtout ());
+		gtk_range_set_value (GTK_RANGE (pbto), -1.0*snap.pbtout);
 		g_signal_handler_unblock (pbto, pboi);
 	}
 
 
 	/* apf */
-	if (rig_data_has_get_apf ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_APF)) &&
+	    rig_data_has_get_apf ()) {
 		g_signal_handler_block (apf, api);
-		gtk_range_set_value (GTK_RANGE (apf), -1.0*rig_data_get_apf ());
+		gtk_range_set_value (GTK_RANGE (apf), -1.0*snap.apf);
 		g_signal_handler_unblock (apf, api);
 	}
 
 
 	/* nrs */
-	if (rig_data_has_get_nr ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_NR)) &&
+	    rig_data_has_get_nr ()) {
 		g_signal_handler_block (nrs, nri);
-		gtk_range_set_value (GTK_RANGE (nrs), -1.0*rig_data_get_nr ());
+		gtk_range_set_value (GTK_RANGE (nrs), -1.0*snap.nr);
 		g_signal_handler_unblock (nrs, nri);
 	}
 
 
 	/* not */
-	if (rig_data_has_get_notch ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_NOTCH)) &&
+	    rig_data_has_get_notch ()) {
 		g_signal_handler_block (not, noi);
-		gtk_range_set_value (GTK_RANGE (not), -1.0*rig_data_get_notch ());
+		gtk_range_set_value (GTK_RANGE (not), -1.0*snap.notch);
 		g_signal_handler_unblock (not, noi);
 	}
 
 
 	/* sql */
-	if (rig_data_has_get_sql ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_SQL)) &&
+	    rig_data_has_get_sql ()) {
 		g_signal_handler_block (sql, sqi);
-		gtk_range_set_value (GTK_RANGE (sql), -1.0*rig_data_get_sql ());
+		gtk_range_set_value (GTK_RANGE (sql), -1.0*snap.sql);
 		g_signal_handler_unblock (sql, sqi);
 	}
 
 
 	/* bal */
-	if (rig_data_has_get_balance ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_BALANCE)) &&
+	    rig_data_has_get_balance ()) {
 		g_signal_handler_block (bal, bai);
-		gtk_range_set_value (GTK_RANGE (bal), -1.0*rig_data_get_balance ());
+		gtk_range_set_value (GTK_RANGE (bal), -1.0*snap.balance);
 		g_signal_handler_unblock (bal, bai);
 	}
-
-
-	return TRUE;
 }
 
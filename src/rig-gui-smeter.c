@@ -52,6 +52,8 @@
 #include "compat.h"
 #include "rig-data.h"
 #include "grig-gtk-workarounds.h"
+#include "grig-startup.h"
+#include "grig-timeline.h"
 #include "rig-gui-smeter-conv.h"
 #include "rig-gui-smeter.h"
 
@@ -100,6 +102,8 @@ static void       rig_gui_smeter_create_canvas  (void);
 static GtkWidget *rig_gui_mode_selector_create  (void);
 static GtkWidget *rig_gui_scale_selector_create (void);
 
+static void rig_gui_smeter_changed       (guint64, gpointer);
+static void rig_gui_smeter_start         (void);
 static gint rig_gui_smeter_timeout_exec  (gpointer);
 static gboolean rig_gui_smeter_timeout_stop (GtkWidget *, GdkEvent *, gpointer);
 
@@ -124,7 +128,7 @@ rig_gui_smeter_create ()
 {
     GtkWidget *vbox;
     GtkWidget *hbox;
-    guint      timerid;
+    gint64     start;
 
 
     /* initialize some data */
@@ -135,6 +139,8 @@ rig_gui_smeter_create ()
     smeter.txmode    = SMETER_TX_MODE_NONE;
     smeter.scale     = SMETER_SCALE_100;
     smeter.exposed   = FALSE;
+    smeter.timerid   = 0;
+    smeter.listenerid = 0;
 
     /* create horizontal box containing selectors */
     hbox = gtk_hbox_new (TRUE, 0);
@@ -143,7 +149,9 @@ rig_gui_smeter_create ()
 
 
     /* create cnvas */
+    start = grig_startup_begin ();
     rig_gui_smeter_create_canvas ();
+    grig_startup_end ("S-meter canvas", -1, start);
 
 
     /* create vertical box */
@@ -152,16 +160,20 @@ rig_gui_smeter_create ()
     gtk_box_pack_start (GTK_BOX (vbox), smeter.canvas, FALSE, FALSE, 0);
     gtk_box_pack_start (GTK_BOX (vbox), hbox,  FALSE, FALSE, 5);
 
-    /* start readback timer but only if service is available */
+    /* listen for changes but only if service is available */
     if (rig_data_has_get_strength ()) {
-        timerid = g_timeout_add (RIG_GUI_SMETER_DEF_TVAL,
-                     rig_gui_smeter_timeout_exec,
-                     NULL);
-
-        /* stop timer when widget is deleted */
+        smeter.listenerid = rig_data_add_listener (RIG_DATA_DIRTY (RIG_DATA_FIELD_PTT) |
+                                                   RIG_DATA_DIRTY (RIG_DATA_FIELD_STRENGTH) |
+                                                   RIG_DATA_DIRTY (RIG_DATA_FIELD_POWER) |
+                                                   RIG_DATA_DIRTY (RIG_DATA_FIELD_SWR) |
+                                                   RIG_DATA_DIRTY (RIG_DATA_FIELD_ALC),
+                                                   rig_gui_smeter_changed,
+                                                   NULL);
+
+        /* stop listener and timer when widget is deleted */
         g_signal_connect(G_OBJECT(vbox), "destroy",
                          G_CALLBACK (rig_gui_smeter_timeout_stop),
-                         GUINT_TO_POINTER(timerid));
+                         NULL);
     }
 
     gtk_widget_show_all (vbox);
@@ -213,9 +225,11 @@ rig_gui_smeter_create_canvas ()
     /* create background pixmap and add it to canvas */
     //fname = g_strconcat (PACKAGE_PIXMAPS_DIR, G_DIR_SEPARATOR_S,
     //             "smeter.png", NULL);
-    fname = pixmap_file_name ("smeter.png");
-    smeter.pixbuf = gdk_pixbuf_new_from_file (fname, NULL);
-    g_free (fname);
+    if (smeter.pixbuf == NULL) {
+        fname = pixmap_file_name ("smeter.png");
+        smeter.pixbuf = gdk_pixbuf_new_from_file (fname, NULL);
+        g_free (fname);
+    }
 
     /* get initial coordinates */
     convert_angle_to_rect (smeter.value, &coor);
@@ -223,17 +237,47 @@ rig_gui_smeter_create_canvas ()
 }
 
 
+/** \brief Handle change notification.
+ *  \param changed The fields that have changed.
+ *  \param data User data; currently NULL.
+ *
+ * This function is called by the rig-data object when the signal strength
+ * or any of the TX readings have changed. It starts the needle animation.
+ */
+static void
+rig_gui_smeter_changed       (guint64 changed, gpointer data)
+{
+    rig_gui_smeter_start ();
+}
+
+
+/** \brief Start the needle animation.
+ *
+ * This function starts the animation timer unless it is already running.
+ * The timer stops by itself once the needle has reached the value read
+ * from the rig.
+ */
+static void
+rig_gui_smeter_start         ()
+{
+    if (smeter.timerid == 0) {
+        smeter.timerid = g_timeout_add (smeter.tval,
+                                        rig_gui_smeter_timeout_exec,
+                                        NULL);
+    }
+}
+
+
 /** \brief Execute timeout function.
  *  \param data User data; currently NULL.
- *  \return Always TRUE to keep the timer running.
+ *  \return TRUE while the needle is moving, FALSE when it has settled.
  *
  * This function is in charge for updating the signal strength meter. It acquires
  * the signal strength from the rig-data object, converts it to needle endpoint
  * coordinates and repaints the s-meter.
  *
- * The function is called peridically by the Gtk+ scheduler.
- *
- * \note Optimize?
+ * The function is called peridically by the Gtk+ scheduler while the needle
+ * is moving towards the value read from the rig.
  */
 static gint 
 rig_gui_smeter_timeout_exec  (gpointer data)
@@ -243,18 +287,24 @@ rig_gui_smeter_timeout_exec  (gpointer data)
     gfloat             valf = 0.0;     /* RF power, SWR or ALC from hamlib */
     gfloat             maxdelta;
     gfloat             delta;
+    gint64             start;
+    grig_settings_t    snap;
 
 
+    start = grig_timeline_begin ();
+
+    /* PTT and readings of the same daemon cycle */
+    rig_data_snapshot (&snap);
 
     /* are we in RX or TX mode? */
-    if (rig_data_get_ptt () == RIG_PTT_OFF) {
+    if (snap.ptt == RIG_PTT_OFF) {
 
 #if SMETER_TEST
         /* test s-meter with random numbers */
         db = (gint) g_random_int_range (-100, 100);
 #else
         /* get current value from rig-data */
-        db = rig_data_get_strength ();
+        db = snap.strength;
 #endif
 
         rdang = convert_db_to_angle (db, DB_TO_ANGLE_MODE_POLY);
@@ -274,7 +324,7 @@ rig_gui_smeter_timeout_exec  (gpointer data)
             /* test s-meter with random numbers */
             valf = (gfloat) g_random_double_range (0.8, 1.5);
 #else
-            valf = rig_data_get_power ();
+            valf = snap.power;
 
             /* now, valf corresponds to the scale of the rig,
                that is, 1.0 = PMAX(rig). We need to scale this
@@ -294,7 +344,7 @@ rig_gui_smeter_timeout_exec  (gpointer data)
             /* test s-meter with random numbers */
             valf = (gfloat) g_random_double_range (0.1, 0.15);
 #else
-            valf = rig_data_get_swr ();
+            valf = snap.swr;
 #endif
             break;
 
@@ -304,7 +354,7 @@ rig_gui_smeter_timeout_exec  (gpointer data)
             /* test s-meter with random numbers */
             valf = (gfloat) g_random_double_range (-0.5, 0.3);
 #else
-            valf = rig_data_get_alc ();
+            valf = snap.alc;
 #endif
             break;
 
@@ -322,6 +372,16 @@ rig_gui_smeter_timeout_exec  (gpointer data)
         delta = fabs (rdang - smeter.value);
     }
 
+    /* has the needle settled? */
+#if !SMETER_TEST
+    if (delta <= 0.1) {
+        smeter.timerid = 0;
+        grig_timeline_end ("timer", __FUNCTION__, start, NULL, 0);
+
+        return FALSE;
+    }
+#endif
+
     /* is there a significant change? */
     if (delta > 0.1) {
 
@@ -370,28 +430,30 @@ rig_gui_smeter_timeout_exec  (gpointer data)
         }
     }
 
+    grig_timeline_end ("timer", __FUNCTION__, start, NULL, 0);
 
     return TRUE;
 }
 
 
 /** \brief Stop timeout function.
- *  \param timer The ID of the timer to stop.
  *  \return Always TRUE.
  *
- * This function is used to stop the readback timer just before the
- * program is quit. It should be called automatically by Gtk+ when
- * the gtk_main_loop is exited.
+ * This function is used to stop the change listener and the animation
+ * timer just before the program is quit. It should be called automatically
+ * by Gtk+ when the gtk_main_loop is exited.
  */
 static gboolean
 rig_gui_smeter_timeout_stop (GtkWidget *widget,
                              GdkEvent  *event,
                              gpointer   data)
 {
+    rig_data_remove_listener (smeter.listenerid);
 
-    GSource *source = g_main_context_find_source_by_id (NULL, GPOINTER_TO_UINT (data));
-    if (source)
-        g_source_destroy (source);
+    if (smeter.timerid) {
+        g_source_remove (smeter.timerid);
+        smeter.timerid = 0;
+    }
 
     return TRUE;
 }
@@ -507,6 +569,10 @@ rig_gui_smeter_mode_cb   (GtkWidget *widget, gpointer data)
     /* store the mode if value is self-consistent */
     if ((index > -1) && (index < SMETER_TX_MODE_LAST)) {
         smeter.txmode = index;
+
+        /* show the new reading */
+        if (smeter.listenerid)
+            rig_gui_smeter_start ();
     }
 
 }
@@ -531,6 +597,10 @@ rig_gui_smeter_scale_cb   (GtkWidget *widget, gpointer data)
     /* store the mode if value is self-consistent */
     if ((index > -1) && (index < SMETER_SCALE_LAST)) {
         smeter.scale = index;
+
+        /* show the new reading */
+        if (smeter.listenerid)
+            rig_gui_smeter_start ();
     }
 
 }
@@ -552,6 +622,10 @@ rig_gui_smeter_expose_cb   (GtkWidget      *widget,
                 gpointer        data)
 {
     GdkColor color;
+    gint64   start;
+
+
+    start = grig_timeline_begin ();
 
     /* draw background pixmap */
     gdk_draw_pixbuf (GDK_DRAWABLE (widget->window), NULL, smeter.pixbuf,
@@ -580,6 +654,8 @@ rig_gui_smeter_expose_cb   (GtkWidget      *widget,
                 FALSE, 0, 0, 160, 80);
 
     /* initialize offscreen buffer */
+    if (buffer != NULL)
+        g_object_unref (buffer);
     buffer = gdk_pixmap_new (GDK_DRAWABLE (smeter.canvas->window),
                  160, 80, -1);
 
@@ -588,6 +664,7 @@ rig_gui_smeter_expose_cb   (GtkWidget      *widget,
     */
     smeter.exposed = TRUE;
 
+    grig_timeline_end ("expose", __FUNCTION__, start, NULL, 0);
 
     return TRUE;
 }
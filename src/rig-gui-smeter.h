@@ -111,6 +111,8 @@ typedef struct {
 	gfloat                  value;       /*!< Current value (angle).   */
 	gfloat                  lastvalue;   /*!< Previous value (angle).  */
 	guint                   tval;        /*!< Current update delay.    */
+	guint                   timerid;     /*!< Animation timer (0 if stopped). */
+	guint                   listenerid;  /*!< Change listener ID.      */
 	gfloat                  falloff;     /*!< Current falloff delay.   */
 	smeter_scale_t          scale;       /*!< Current scale.           */
 	smeter_tx_mode_t        txmode;      /*!< Display mode in TX.      */
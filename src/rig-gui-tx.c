@@ -64,13 +64,16 @@ static void float_level_cb    (GtkRange *range, gpointer data);
 static gchar *float_format_value_cb (GtkScale *scale, gdouble value);
 static gchar *wpm_format_value_cb (GtkScale *scale, gdouble value);
 static gchar *delay_format_value_cb (GtkScale *scale, gdouble value);
-static gboolean tx_levels_update (gpointer data);
+static void tx_levels_update (guint64 changed, gpointer data);
 
 
 static GtkWidget *dialog;
 
 static gboolean visible = FALSE;
-static guint timerid = 0;
+static guint listenerid = 0;
+
+/* the rig the window was opened for */
+static gint rig = 0;
 
 
 /* controls */
@@ -101,6 +104,9 @@ rig_gui_tx_create ()
 		return;
 	}
 	
+	/* the window stays with the rig that is selected now */
+	rig = rig_data_current ();
+
 	/* create hbox and add sliders */
 	hbox = gtk_hbox_new (TRUE, 5);
 	create_controls (GTK_BOX (hbox));
@@ -132,8 +138,14 @@ rig_gui_tx_create ()
 
 	gtk_widget_show_all (dialog);
 
-	/* start callback */
-	timerid = g_timeout_add (1073, tx_levels_update, NULL);
+	/* listen for changes */
+	listenerid = rig_data_add_rig_listener (rig, RIG_DATA_DIRTY (RIG_DATA_FIELD_KEYSPD) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_BKINDEL) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_MICG) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_VOXG) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_VOXDEL) |
+					        RIG_DATA_DIRTY (RIG_DATA_FIELD_ANTIVOX),
+					        tx_levels_update, NULL);
 }
 
 
@@ -158,8 +170,8 @@ tx_window_destroy    (GtkWidget *widget,
 {
 
 	/* stop callback */
-	g_source_remove (timerid);
-	timerid = 0;
+	rig_data_remove_listener (listenerid);
+	listenerid = 0;
 
 	/* clear tx-active flag in rig-data */
 
@@ -193,6 +205,10 @@ float_level_cb (GtkRange *range, gpointer data)
 {
 	int level = GPOINTER_TO_INT (data);
 	float value = -1.0 * gtk_range_get_value (range);
+	gint prev;
+
+	/* the setters act on the rig of this window */
+	prev = rig_data_bind (rig);
 
 	switch (level) {
 
@@ -239,6 +255,8 @@ float_level_cb (GtkRange *range, gpointer data)
 				  __FILE__, __LINE__, level);
 		break;
 	}
+
+	rig_data_bind (prev);
 }
 
 static gchar *
@@ -271,12 +289,16 @@ create_controls   (GtkBox *box)
 {
 	GtkWidget *label;
 	GtkWidget *vbox;
+	grig_settings_t snap;
 	guint count = 0;
 
+	/* initial values read in one go */
+	rig_data_snapshot (&snap);
+
 	/* kss */
 	if (rig_data_has_set_keyspd ()) {
 		kss = gtk_vscale_new_with_range (-50.0, -1.0, 1.0);
-		gtk_range_set_value (GTK_RANGE (kss), -1.0*rig_data_get_keyspd ());
+		gtk_range_set_value (GTK_RANGE (kss), -1.0*snap.keyspd);
 		ksi = g_signal_connect (kss, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_KEYSPD));
@@ -296,7 +318,7 @@ create_controls   (GtkBox *box)
 	/* bks */
 	if (rig_data_has_set_bkindel ()) {
 		bks = gtk_vscale_new_with_range (-10000.0, 0.0, 10.0);
-		gtk_range_set_value (GTK_RANGE (bks), -1.0*rig_data_get_bkindel ());
+		gtk_range_set_value (GTK_RANGE (bks), -1.0*snap.bkindel);
 		bki = g_signal_connect (bks, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_BKINDL));
@@ -316,7 +338,7 @@ create_controls   (GtkBox *box)
 	/* rfs */
 	if (rig_data_has_set_power ()) {
 		rfs = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (rfs), -1.0*rig_data_get_power ());
+		gtk_range_set_value (GTK_RANGE (rfs), -1.0*snap.power);
 		g_signal_connect (rfs, "value-changed",
 				  G_CALLBACK (float_level_cb),
 				  GINT_TO_POINTER (RIG_LEVEL_RFPOWER));
@@ -337,7 +359,7 @@ create_controls   (GtkBox *box)
 	/* als */
 	if (rig_data_has_set_alc ()) {
 		als = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (als), -1.0*rig_data_get_alc ());
+		gtk_range_set_value (GTK_RANGE (als), -1.0*snap.alc);
 		g_signal_connect (als, "value-changed",
 				  G_CALLBACK (float_level_cb),
 				  GINT_TO_POINTER (RIG_LEVEL_ALC));
@@ -358,7 +380,7 @@ create_controls   (GtkBox *box)
 	/* mgs */
 	if (rig_data_has_set_micg ()) {
 		mgs = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (mgs), -1.0*rig_data_get_micg ());
+		gtk_range_set_value (GTK_RANGE (mgs), -1.0*snap.micg);
 		mgi = g_signal_connect (mgs, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_MICGAIN));
@@ -378,7 +400,7 @@ create_controls   (GtkBox *box)
 	/* cps */
 	if (rig_data_has_set_comp ()) {
 		cps = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (cps), -1.0*rig_data_get_comp ());
+		gtk_range_set_value (GTK_RANGE (cps), -1.0*snap.comp);
 		g_signal_connect (cps, "value-changed",
 				  G_CALLBACK (float_level_cb),
 				  GINT_TO_POINTER (RIG_LEVEL_COMP));
@@ -398,7 +420,7 @@ create_controls   (GtkBox *box)
 	/* vgs */
 	if (rig_data_has_set_voxg ()) {
 		vgs = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (cps), -1.0*rig_data_get_voxg ());
+		gtk_range_set_value (GTK_RANGE (cps), -1.0*snap.voxg);
 		vgi = g_signal_connect (vgs, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_VOXGAIN));
@@ -418,7 +440,7 @@ create_controls   (GtkBox *box)
 	/* vds */
 	if (rig_data_has_set_voxdel ()) {
 		vds = gtk_vscale_new_with_range (-10000.0, 0.0, 10.0);
-		gtk_range_set_value (GTK_RANGE (bks), -1.0*rig_data_get_voxdel ());
+		gtk_range_set_value (GTK_RANGE (bks), -1.0*snap.voxdel);
 		vdi = g_signal_connect (vds, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_VOXDELAY));
@@ -438,7 +460,7 @@ create_controls   (GtkBox *box)
 	/* avs */
 	if (rig_data_has_set_antivox ()) {
 		avs = gtk_vscale_new_with_range (-1.0, 0.0, 0.01);
-		gtk_range_set_value (GTK_RANGE (avs), -1.0*rig_data_get_antivox ());
+		gtk_range_set_value (GTK_RANGE (avs), -1.0*snap.antivox);
 		avi = g_signal_connect (avs, "value-changed",
 					G_CALLBACK (float_level_cb),
 					GINT_TO_POINTER (RIG_LEVEL_ANTIVOX));
@@ -467,50 +489,59 @@ create_controls   (GtkBox *box)
 }
 
 
-static gboolean
-tx_levels_update (gpointer data)
+static void
+tx_levels_update (guint64 changed, gpointer data)
 {
+	grig_settings_t snap;
+
+	/* read all levels in one go */
+	rig_data_snapshot (&snap);
+
 	/* kss */
-	if (rig_data_has_get_keyspd ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_KEYSPD)) &&
+	    rig_data_has_get_keyspd ()) {
 		g_signal_handler_block (kss, ksi);
-		gtk_range_set_value (GTK_RANGE (kss), -1.0*rig_data_get_keyspd ());
+		gtk_range_set_value (GTK_RANGE (kss), -1.0*snap.keyspd);
 		g_signal_handler_unblock (kss, ksi);
 	}
 
 	/* bks */
-	if (rig_data_has_get_bkindel ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_BKINDEL)) &&
+	    rig_data_has_get_bkindel ()) {
 		g_signal_handler_block (bks, bki);
-		gtk_range_set_value (GTK_RANGE (bks), -1.0*rig_data_get_bkindel ());
+		gtk_range_set_value (GTK_RANGE (bks), -1.0*snap.bkindel);
 		g_signal_handler_unblock (bks, bki);
 	}
 
 	/* mgs */
-	if (rig_data_has_get_micg ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_MICG)) &&
+	    rig_data_has_get_micg ()) {
 		g_signal_handler_block (mgs, mgi);
-		gtk_range_set_value (GTK_RANGE (mgs), -1.0*rig_data_get_micg ());
+		gtk_range_set_value (GTK_RANGE (mgs), -1.0*snap.micg);
 		g_signal_handler_unblock (mgs, mgi);
 	}
 
 	/* vgs */
-	if (rig_data_has_get_voxg ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_VOXG)) &&
+	    rig_data_has_get_voxg ()) {
 		g_signal_handler_block (vgs, vgi);
-		gtk_range_set_value (GTK_RANGE (vgs), -1.0*rig_data_get_voxg ());
+		gtk_range_set_value (GTK_RANGE (vgs), -1.0*snap.voxg);
 		g_signal_handler_unblock (vgs, vgi);
 	}
 
 	/* vds */
-	if (rig_data_has_get_voxdel ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_VOXDEL)) &&
+	    rig_data_has_get_voxdel ()) {
 		g_signal_handler_block (vds, vdi);
-		gtk_range_set_value (GTK_RANGE (vds), -1.0*rig_data_get_voxdel ());
+		gtk_range_set_value (GTK_RANGE (vds), -1.0*snap.voxdel);
 		g_signal_handler_unblock (vds, vdi);
 	}
 
 	/* avs */
-	if (rig_data_has_get_antivox ()) {
+	if ((changed & RIG_DATA_DIRTY (RIG_DATA_FIELD_ANTIVOX)) &&
+	    rig_data_has_get_antivox ()) {
 		g_signal_handler_block (avs, avi);
-		gtk_range_set_value (GTK_RANGE (avs), -1.0*rig_data_get_antivox ());
+		gtk_range_set_value (GTK_RANGE (avs), -1.0*snap.antivox);
 		g_signal_handler_unblock (avs, avi);
 	}
-
-	return TRUE;
 }
@@ -149,6 +149,8 @@ rig_gui_vfo_create_toggle ()
 static void
 rig_gui_vfo_toggle_cb (GtkWidget *widget, gpointer data)
 {
+    grig_settings_t snap;
+
 
     if (rig_data_has_vfo_op_toggle ()) {
         rig_data_vfo_op_toggle ();
@@ -156,15 +158,18 @@ rig_gui_vfo_toggle_cb (GtkWidget *widget, gpointer data)
     else if (rig_data_has_set_vfo () &&
                  rig_data_has_get_vfo ()) {
 
+        /* use the same VFO for all decisions below */
+        rig_data_snapshot (&snap);
+
         /* do not toggle in memory mode */
         /* XXX disable other VFO buttons? */
-        if (rig_data_get_vfo() == RIG_VFO_MEM)
+        if (snap.vfo == RIG_VFO_MEM)
             return;
 
                 /* do we have VFO A and B? */
                 if (rig_data_get_vfos() & (RIG_VFO_A | RIG_VFO_B)) {
                         
-                        if (rig_data_get_vfo () == RIG_VFO_A) {
+                        if (snap.vfo == RIG_VFO_A) {
                                 rig_data_set_vfo (RIG_VFO_B);
                         }
                         else {
@@ -175,7 +180,7 @@ rig_gui_vfo_toggle_cb (GtkWidget *widget, gpointer data)
                 /* else try MAIN/SUB */
                 else if (rig_data_get_vfos () & (RIG_VFO_MAIN | RIG_VFO_SUB)) {
 
-                        if (rig_data_get_vfo () == RIG_VFO_MAIN) {
+                        if (snap.vfo == RIG_VFO_MAIN) {
                                 rig_data_set_vfo (RIG_VFO_SUB);
                         }
                         else {
@@ -203,11 +208,15 @@ rig_gui_vfo_toggle_cb (GtkWidget *widget, gpointer data)
 static void
 rig_gui_vfo_memory_cb(GtkWidget *widget, gpointer data)
 {
+    grig_settings_t snap;
+
     if (rig_data_has_set_vfo() && rig_data_has_get_vfo()) {
 
-            if (rig_data_get_vfo() != RIG_VFO_MEM) {
+            rig_data_snapshot (&snap);
+
+            if (snap.vfo != RIG_VFO_MEM) {
             g_object_set_data(G_OBJECT(widget),
-                "vfo", (gpointer)(uintptr_t) rig_data_get_vfo());
+                "vfo", (gpointer)(uintptr_t) snap.vfo);
 
              rig_data_set_vfo(RIG_VFO_MEM);
 
@@ -50,6 +50,13 @@
 /* we keep this global so that we can enable and disable it at runtime */
 static GtkWidget *keypadbox = NULL;
 
+/* main container and the rig controls packed into it; the controls are
+   rebuilt from the capabilities of the rig when another rig is selected */
+static GtkWidget *mainbox = NULL;
+static GtkWidget *controls = NULL;
+
+static GtkWidget *rig_gui_controls_create (void);
+
 
 
 static void
@@ -100,8 +107,65 @@ void rig_gui_show_keypad (gboolean *show)
 GtkWidget *
 rig_gui_create ()
 {
-	GtkWidget *hbox;     /* the main container */
 	GtkWidget *vbox;
+
+
+	controls = rig_gui_controls_create ();
+
+	/* create main vertical box */
+	vbox = gtk_vbox_new (FALSE, 0);
+	gtk_box_pack_start (GTK_BOX (vbox), grig_menubar_create (),
+			    FALSE, FALSE, 0);
+	gtk_box_pack_start (GTK_BOX (vbox), controls, FALSE, FALSE, 5);
+	gtk_box_pack_start (GTK_BOX (vbox), gtk_hseparator_new (), FALSE, FALSE, 0);
+
+/* 	gtk_box_pack_start (GTK_BOX (vbox), rig_gui_levels_create (), */
+/* 			    FALSE, FALSE, 5); */
+
+    gtk_widget_show_all (vbox);
+
+	/* from now on the controls can be rebuilt */
+	mainbox = vbox;
+    
+	return vbox;
+}
+
+
+/** \brief Rebuild the rig controls.
+ *
+ * This function is called when another rig has been selected. It destroys
+ * the current controls, which removes their rig-data listeners, and creates
+ * new ones from the capabilities of the selected rig. The menubar is kept.
+ */
+void
+rig_gui_rebuild ()
+{
+	if (mainbox == NULL)
+		return;
+
+	gtk_widget_destroy (controls);
+	keypadbox = NULL;
+
+	controls = rig_gui_controls_create ();
+	gtk_box_pack_start (GTK_BOX (mainbox), controls, FALSE, FALSE, 5);
+	gtk_box_reorder_child (GTK_BOX (mainbox), controls, 1);
+	gtk_widget_show_all (controls);
+
+	/* let the window shrink if the new rig has fewer controls */
+	gtk_window_resize (GTK_WINDOW (gtk_widget_get_toplevel (mainbox)), 1, 1);
+}
+
+
+/** \brief Create the controls of the selected rig.
+ *  \return The container with the controls.
+ *
+ * From left to right: buttons, smeter, (lcd + keypad), ctrl2. Each part
+ * queries the capabilities of the rig that is selected when it is created.
+ */
+static GtkWidget *
+rig_gui_controls_create ()
+{
+	GtkWidget *hbox;     /* the main container */
 	GtkWidget *lcdbox;
 	GtkWidget *lcd;
 	GtkWidget *keypad;
@@ -130,9 +194,6 @@ rig_gui_create ()
 			    FALSE, FALSE, 5);
     gtk_widget_show (lcdbox);
 
-	/* create the main container */
-	/* from left to right: buttons, smeter, (lcd + keypad), ctrl2 */
-
 	hbox = gtk_hbox_new (FALSE, 5);
 
 	gtk_box_pack_start (GTK_BOX (hbox), rig_gui_buttons_create (),
@@ -145,17 +206,6 @@ rig_gui_create ()
 			    FALSE, FALSE, 0);
     gtk_widget_show (hbox);
 
-	/* create main vertical box */
-	vbox = gtk_vbox_new (FALSE, 0);
-	gtk_box_pack_start (GTK_BOX (vbox), grig_menubar_create (),
-			    FALSE, FALSE, 0);
-	gtk_box_pack_start (GTK_BOX (vbox), hbox, FALSE, FALSE, 5);
-	gtk_box_pack_start (GTK_BOX (vbox), gtk_hseparator_new (), FALSE, FALSE, 0);
-
-/* 	gtk_box_pack_start (GTK_BOX (vbox), rig_gui_levels_create (), */
-/* 			    FALSE, FALSE, 5); */
-
-
 	/* keypad callbacks */
 
 	g_signal_connect(G_OBJECT(keypad), "grig-keypad-enter-pressed",
@@ -171,8 +221,5 @@ rig_gui_create ()
 	g_signal_connect (G_OBJECT (lcd), "freq-changed",
 			G_CALLBACK (rig_gui_freq_changed_cb), keypad);
 
-    gtk_widget_show_all (vbox);
-    
-	return vbox;
+	return hbox;
 }
-
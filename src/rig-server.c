@@ -0,0 +1,1337 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    rig-server.c
+ *  \ingroup rigd
+ *  \brief   rigctld compatible network server.
+ *
+ * Other programs, eg. loggers or digital mode programs, can control the
+ * rig through grig by using Hamlib's NET rigctl backend (model 2) or by
+ * talking the rigctld protocol directly. The server listens on a TCP port
+ * of the loopback interface or on a Unix socket.
+ *
+ * Reads are answered from the 'get' settings in rig-data.c without any
+ * communication with the rig, so additional clients do not add any CAT
+ * traffic. Writes go through the rig-data setters like the GUI controls,
+ * ie. they are executed by the daemon and show up in the GUI.
+ *
+ * The server runs in the main loop: connections are accepted by a
+ * GSocketService and each client socket is non-blocking with its own
+ * sources for reading and, when a reply could not be sent at once, for
+ * writing. Requests are counted per client; see rig_server_dump().
+ *
+ * Only the default (non-extended) response protocol is supported and a
+ * request line holds a single command. There is one server per rig; all
+ * functions refer to the current rig, see rig_data_current().
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include <glib/gi18n.h>
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <gtk/gtk.h>
+#include <hamlib/rig.h>
+#include "grig-debug.h"
+#include "rig-data.h"
+#include "rig-daemon.h"
+#include "rig-server.h"
+
+
+/** \brief A listening server. */
+typedef struct {
+	GSocketService *service;   /*!< Accepts the connections. */
+	gchar          *address;   /*!< Address as given by the user. */
+	gchar          *path;      /*!< Path of the Unix socket or NULL. */
+	gint            rig;       /*!< The rig served. */
+	GList          *clients;   /*!< Connected clients, server_client_t. */
+	guint           accepted;  /*!< Connections accepted so far. */
+} server_t;
+
+
+/** \brief A connected client. */
+typedef struct {
+	server_t          *server;     /*!< The server. */
+	GSocketConnection *conn;       /*!< The connection. */
+	GSocket           *socket;     /*!< The socket of conn. */
+	GSource           *insrc;      /*!< Source watching for input. */
+	GSource           *outsrc;     /*!< Source watching for output space, or NULL. */
+	GString           *inbuf;      /*!< Received bytes not yet processed. */
+	GString           *outbuf;     /*!< Replies not yet sent. */
+	gchar             *peer;       /*!< Name of the peer. */
+	gint64             connected;  /*!< Time of connection. */
+	guint              requests;   /*!< Requests received. */
+	guint              errors;     /*!< Requests answered with an error. */
+	gboolean           quit;       /*!< Close after sending the replies. */
+} server_client_t;
+
+
+/** \brief Handler of a command.
+ *
+ * The handler gets the arguments and appends the reply of a 'get' command
+ * to out; it returns the Hamlib status reported to the client.
+ */
+typedef gint (*server_handler_t) (gchar **args, GString *out);
+
+
+/** \brief A protocol command. */
+typedef struct {
+	gchar             sname;    /*!< Short name or 0. */
+	const gchar      *lname;    /*!< Long name without backslash. */
+	guint             nargs;    /*!< Number of arguments. */
+	gboolean          get;      /*!< A successful 'get' only returns its values. */
+	server_handler_t  handler;  /*!< The handler; NULL for quit. */
+} server_cmd_t;
+
+
+/** \brief A level and where grig keeps it. */
+typedef struct {
+	setting_t    level;     /*!< The Hamlib level. */
+	glong        value;     /*!< Offset of the value in grig_settings_t. */
+	glong        avail;     /*!< Offset of the flags in grig_cmd_avail_t. */
+	gboolean     isfloat;   /*!< Whether the value is a float. */
+	void       (*setf) (float);  /*!< Setter of a float level or NULL. */
+	void       (*seti) (int);    /*!< Setter of an int level or NULL. */
+} server_level_t;
+
+
+#define LEVEL_F(lvl,field,setter) { RIG_LEVEL_##lvl,			\
+			G_STRUCT_OFFSET (grig_settings_t, field),		\
+			G_STRUCT_OFFSET (grig_cmd_avail_t, field),		\
+			TRUE, setter, NULL }
+
+#define LEVEL_I(lvl,field,setter) { RIG_LEVEL_##lvl,			\
+			G_STRUCT_OFFSET (grig_settings_t, field),		\
+			G_STRUCT_OFFSET (grig_cmd_avail_t, field),		\
+			FALSE, NULL, setter }
+
+
+/** \brief Levels available to the clients. */
+static const server_level_t LEVELS[] = {
+	LEVEL_F (AF, afg, rig_data_set_afg),
+	LEVEL_F (RF, rfg, rig_data_set_rfg),
+	LEVEL_F (SQL, sql, rig_data_set_sql),
+	LEVEL_I (IF, ifs, rig_data_set_ifs),
+	LEVEL_F (APF, apf, rig_data_set_apf),
+	LEVEL_F (NR, nr, rig_data_set_nr),
+	LEVEL_I (NOTCHF, notch, rig_data_set_notch),
+	LEVEL_F (PBT_IN, pbtin, rig_data_set_pbtin),
+	LEVEL_F (PBT_OUT, pbtout, rig_data_set_pbtout),
+	LEVEL_I (CWPITCH, cwpitch, rig_data_set_cwpitch),
+	LEVEL_I (KEYSPD, keyspd, rig_data_set_keyspd),
+	LEVEL_I (BKINDL, bkindel, rig_data_set_bkindel),
+	LEVEL_F (BALANCE, balance, rig_data_set_balance),
+	LEVEL_I (VOXDELAY, voxdel, rig_data_set_voxdel),
+	LEVEL_F (VOXGAIN, voxg, rig_data_set_voxg),
+	LEVEL_F (ANTIVOX, antivox, rig_data_set_antivox),
+	LEVEL_F (MICGAIN, micg, rig_data_set_micg),
+	LEVEL_F (COMP, comp, rig_data_set_comp),
+	LEVEL_F (RFPOWER, power, rig_data_set_power),
+	LEVEL_I (AGC, agc, rig_data_set_agc),
+	LEVEL_I (ATT, att, rig_data_set_att),
+	LEVEL_I (PREAMP, preamp, rig_data_set_preamp),
+	LEVEL_I (STRENGTH, strength, NULL),
+	LEVEL_F (SWR, swr, NULL),
+	LEVEL_F (ALC, alc, NULL)
+};
+
+
+static gint server_set_freq       (gchar **, GString *);
+static gint server_get_freq       (gchar **, GString *);
+static gint server_set_mode       (gchar **, GString *);
+static gint server_get_mode       (gchar **, GString *);
+static gint server_set_vfo        (gchar **, GString *);
+static gint server_get_vfo        (gchar **, GString *);
+static gint server_set_ptt        (gchar **, GString *);
+static gint server_get_ptt        (gchar **, GString *);
+static gint server_set_split_vfo  (gchar **, GString *);
+static gint server_get_split_vfo  (gchar **, GString *);
+static gint server_set_split_freq (gchar **, GString *);
+static gint server_get_split_freq (gchar **, GString *);
+static gint server_set_rit        (gchar **, GString *);
+static gint server_get_rit        (gchar **, GString *);
+static gint server_set_xit        (gchar **, GString *);
+static gint server_get_xit        (gchar **, GString *);
+static gint server_set_level      (gchar **, GString *);
+static gint server_get_level      (gchar **, GString *);
+static gint server_set_func       (gchar **, GString *);
+static gint server_get_func       (gchar **, GString *);
+static gint server_vfo_op         (gchar **, GString *);
+static gint server_set_powerstat  (gchar **, GString *);
+static gint server_get_powerstat  (gchar **, GString *);
+static gint server_get_info       (gchar **, GString *);
+static gint server_chk_vfo        (gchar **, GString *);
+static gint server_dump_state     (gchar **, GString *);
+
+
+/** \brief The supported commands. */
+static const server_cmd_t COMMANDS[] = {
+	{ 'F', "set_freq",       1, FALSE, server_set_freq },
+	{ 'f', "get_freq",       0, TRUE,  server_get_freq },
+	{ 'M', "set_mode",       2, FALSE, server_set_mode },
+	{ 'm', "get_mode",       0, TRUE,  server_get_mode },
+	{ 'V', "set_vfo",        1, FALSE, server_set_vfo },
+	{ 'v', "get_vfo",        0, TRUE,  server_get_vfo },
+	{ 'T', "set_ptt",        1, FALSE, server_set_ptt },
+	{ 't', "get_ptt",        0, TRUE,  server_get_ptt },
+	{ 'S', "set_split_vfo",  2, FALSE, server_set_split_vfo },
+	{ 's', "get_split_vfo",  0, TRUE,  server_get_split_vfo },
+	{ 'I', "set_split_freq", 1, FALSE, server_set_split_freq },
+	{ 'i', "get_split_freq", 0, TRUE,  server_get_split_freq },
+	{ 'J', "set_rit",        1, FALSE, server_set_rit },
+	{ 'j', "get_rit",        0, TRUE,  server_get_rit },
+	{ 'Z', "set_xit",        1, FALSE, server_set_xit },
+	{ 'z', "get_xit",        0, TRUE,  server_get_xit },
+	{ 'L', "set_level",      2, FALSE, server_set_level },
+	{ 'l', "get_level",      1, TRUE,  server_get_level },
+	{ 'U', "set_func",       2, FALSE, server_set_func },
+	{ 'u', "get_func",       1, TRUE,  server_get_func },
+	{ 'G', "vfo_op",         1, FALSE, server_vfo_op },
+	{ 0,   "set_powerstat",  1, FALSE, server_set_powerstat },
+	{ 0,   "get_powerstat",  0, TRUE,  server_get_powerstat },
+	{ '_', "get_info",       0, TRUE,  server_get_info },
+	{ 0,   "chk_vfo",        0, TRUE,  server_chk_vfo },
+	{ 0,   "dump_state",     0, TRUE,  server_dump_state },
+	{ 'q', "quit",           0, TRUE,  NULL },
+	{ 'Q', "quit",           0, TRUE,  NULL }
+};
+
+
+static server_t *servers[C_MAX_RIGS];   /*!< Server of each rig or NULL. */
+
+
+static gboolean rig_server_incoming (GSocketService *, GSocketConnection *,
+				     GObject *, gpointer);
+static gboolean rig_server_readable (GSocket *, GIOCondition, gpointer);
+static gboolean rig_server_writable (GSocket *, GIOCondition, gpointer);
+static gboolean rig_server_flush    (server_client_t *);
+static void     rig_server_close    (server_client_t *);
+static void     rig_server_exec     (server_client_t *, gchar *);
+static gboolean rig_server_number   (const gchar *, gdouble *);
+
+
+
+/** \brief Start the server of the current rig.
+ *  \param address "[HOST:]PORT" or "unix:PATH".
+ *  \param error Location for the error or NULL.
+ *  \return TRUE if the server is listening.
+ *
+ * Without HOST the server only listens on the loopback interface. HOST
+ * must be a numeric address. The daemon of the rig should be running.
+ */
+gboolean
+rig_server_start (const gchar *address, GError **error)
+{
+	server_t       *srv;
+	GSocketAddress *sockaddr;
+	GInetAddress   *inetaddr;
+	const gchar    *port;
+	gchar          *host;
+	gint            rig = rig_data_current ();
+	gboolean        ok;
+
+
+	g_return_val_if_fail (servers[rig] == NULL, FALSE);
+
+	srv = g_new0 (server_t, 1);
+	srv->rig = rig;
+	srv->address = g_strdup (address);
+
+	if (g_str_has_prefix (address, "unix:")) {
+		srv->path = g_strdup (address + strlen ("unix:"));
+
+		/* a stale socket of a previous run would make bind fail */
+		g_unlink (srv->path);
+		sockaddr = g_unix_socket_address_new (srv->path);
+	}
+	else {
+		port = strrchr (address, ':');
+		if (port != NULL) {
+			host = g_strndup (address, port - address);
+			port++;
+			inetaddr = g_inet_address_new_from_string (host);
+			g_free (host);
+		}
+		else {
+			port = address;
+			inetaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+		}
+
+		if ((inetaddr == NULL) || (atoi (port) <= 0) || (atoi (port) > 65535)) {
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+				     _("Invalid server address %s"), address);
+			if (inetaddr != NULL)
+				g_object_unref (inetaddr);
+			g_free (srv->address);
+			g_free (srv);
+			return FALSE;
+		}
+
+		sockaddr = g_inet_socket_address_new (inetaddr, atoi (port));
+		g_object_unref (inetaddr);
+	}
+
+	srv->service = g_socket_service_new ();
+	ok = g_socket_listener_add_address (G_SOCKET_LISTENER (srv->service), sockaddr,
+					    G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT,
+					    NULL, NULL, error);
+	g_object_unref (sockaddr);
+
+	if (!ok) {
+		g_object_unref (srv->service);
+		g_free (srv->path);
+		g_free (srv->address);
+		g_free (srv);
+		return FALSE;
+	}
+
+	g_signal_connect (srv->service, "incoming",
+			  G_CALLBACK (rig_server_incoming), srv);
+	g_socket_service_start (srv->service);
+
+	servers[rig] = srv;
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Listening on %s"),
+			  __FUNCTION__, address);
+
+	return TRUE;
+}
+
+
+/** \brief Stop the server of the current rig.
+ *
+ * All clients are disconnected.
+ */
+void
+rig_server_stop ()
+{
+	server_t *srv = servers[rig_data_current ()];
+
+
+	if (srv == NULL)
+		return;
+
+	while (srv->clients != NULL) {
+		rig_server_close (srv->clients->data);
+	}
+
+	g_socket_service_stop (srv->service);
+	g_socket_listener_close (G_SOCKET_LISTENER (srv->service));
+	g_object_unref (srv->service);
+
+	if (srv->path != NULL) {
+		g_unlink (srv->path);
+		g_free (srv->path);
+	}
+
+	servers[srv->rig] = NULL;
+	g_free (srv->address);
+	g_free (srv);
+}
+
+
+/** \brief Print the clients of the current rig.
+ *  \param out Where to append the text.
+ */
+void
+rig_server_dump (GString *out)
+{
+	server_t        *srv = servers[rig_data_current ()];
+	server_client_t *client;
+	GList           *node;
+	gdouble          secs;
+
+
+	if (srv == NULL)
+		return;
+
+	g_string_append_printf (out, _("Server %s: %u clients, %u connections\n"),
+				srv->address, g_list_length (srv->clients), srv->accepted);
+
+	for (node = srv->clients; node != NULL; node = node->next) {
+		client = node->data;
+		secs = MAX (g_get_monotonic_time () - client->connected, 1) / 1.0e6;
+
+		g_string_append_printf (out, _("  %-24s %8u requests %8.1f/s %6u errors\n"),
+					client->peer, client->requests,
+					client->requests / secs, client->errors);
+	}
+}
+
+
+/** \brief Accept a connection.
+ *  \param service The server socket service.
+ *  \param conn The new connection.
+ *  \param source Unused.
+ *  \param data The server_t.
+ *  \return TRUE since the connection has been handled.
+ */
+static gboolean
+rig_server_incoming (GSocketService *service, GSocketConnection *conn,
+		     GObject *source, gpointer data)
+{
+	server_t        *srv = (server_t *) data;
+	server_client_t *client;
+	GSocketAddress  *addr;
+	GInetAddress    *inetaddr;
+	gchar           *host;
+
+
+	if (g_list_length (srv->clients) >= C_SERVER_MAX_CLIENTS) {
+		grig_debug_local (RIG_DEBUG_WARN,
+				  _("%s: Too many clients on %s"),
+				  __FUNCTION__, srv->address);
+		/* the service closes the connection when we do not keep it */
+		return TRUE;
+	}
+
+	client = g_new0 (server_client_t, 1);
+	client->server = srv;
+	client->conn = g_object_ref (conn);
+	client->socket = g_socket_connection_get_socket (conn);
+	client->inbuf = g_string_new (NULL);
+	client->outbuf = g_string_new (NULL);
+	client->connected = g_get_monotonic_time ();
+
+	addr = g_socket_connection_get_remote_address (conn, NULL);
+	if ((addr != NULL) && G_IS_INET_SOCKET_ADDRESS (addr)) {
+		inetaddr = g_inet_socket_address_get_address (G_INET_SOCKET_ADDRESS (addr));
+		host = g_inet_address_to_string (inetaddr);
+		client->peer = g_strdup_printf ("%s:%u", host,
+						g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr)));
+		g_free (host);
+	}
+	else {
+		client->peer = g_strdup_printf ("unix#%u", srv->accepted + 1);
+	}
+	if (addr != NULL)
+		g_object_unref (addr);
+
+	g_socket_set_blocking (client->socket, FALSE);
+
+	client->insrc = g_socket_create_source (client->socket, G_IO_IN, NULL);
+	g_source_set_callback (client->insrc, (GSourceFunc) rig_server_readable,
+			       client, NULL);
+	g_source_attach (client->insrc, NULL);
+
+	srv->clients = g_list_append (srv->clients, client);
+	srv->accepted++;
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Client %s connected"),
+			  __FUNCTION__, client->peer);
+
+	return TRUE;
+}
+
+
+/** \brief Read and execute requests.
+ *  \param socket The client socket.
+ *  \param cond The condition.
+ *  \param data The server_client_t.
+ *  \return FALSE if the client has been closed.
+ */
+static gboolean
+rig_server_readable (GSocket *socket, GIOCondition cond, gpointer data)
+{
+	server_client_t *client = (server_client_t *) data;
+	GError          *error = NULL;
+	gchar            buf[512];
+	gchar           *line;
+	gchar           *eol;
+	gssize           len;
+	gint             prev;
+
+
+	len = g_socket_receive (socket, buf, sizeof (buf), NULL, &error);
+
+	if (len < 0) {
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+			g_clear_error (&error);
+			return TRUE;
+		}
+
+		grig_debug_local (RIG_DEBUG_VERBOSE,
+				  _("%s: Client %s: %s"),
+				  __FUNCTION__, client->peer, error->message);
+		g_clear_error (&error);
+	}
+
+	if (len <= 0) {
+		rig_server_close (client);
+		return FALSE;
+	}
+
+	g_string_append_len (client->inbuf, buf, len);
+
+	/* the commands apply to the rig of the server */
+	prev = rig_data_bind (client->server->rig);
+
+	line = client->inbuf->str;
+	while (!client->quit && ((eol = strchr (line, '\n')) != NULL)) {
+		*eol = '\0';
+		rig_server_exec (client, line);
+		line = eol + 1;
+	}
+
+	rig_data_bind (prev);
+
+	g_string_erase (client->inbuf, 0, line - client->inbuf->str);
+
+	if (client->inbuf->len > C_SERVER_MAX_LINE) {
+		grig_debug_local (RIG_DEBUG_WARN,
+				  _("%s: Client %s: request too long"),
+				  __FUNCTION__, client->peer);
+		rig_server_close (client);
+		return FALSE;
+	}
+
+	if (!rig_server_flush (client) || (client->quit && (client->outbuf->len == 0))) {
+		rig_server_close (client);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+/** \brief Send pending replies when the socket accepts data again.
+ *  \param socket The client socket.
+ *  \param cond The condition.
+ *  \param data The server_client_t.
+ *  \return FALSE if the source has been removed.
+ */
+static gboolean
+rig_server_writable (GSocket *socket, GIOCondition cond, gpointer data)
+{
+	server_client_t *client = (server_client_t *) data;
+
+
+	if (!rig_server_flush (client) || (client->quit && (client->outbuf->len == 0))) {
+		rig_server_close (client);
+		return FALSE;
+	}
+
+	/* rig_server_flush() destroys the source when everything is sent */
+	return (client->outsrc != NULL);
+}
+
+
+/** \brief Send as much of the pending replies as possible.
+ *  \param client The client.
+ *  \return FALSE if the client must be closed.
+ */
+static gboolean
+rig_server_flush (server_client_t *client)
+{
+	GError *error = NULL;
+	gssize  len;
+
+
+	if (client->outbuf->len > 0) {
+		len = g_socket_send (client->socket, client->outbuf->str,
+				     client->outbuf->len, NULL, &error);
+
+		if (len < 0) {
+			if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+				grig_debug_local (RIG_DEBUG_VERBOSE,
+						  _("%s: Client %s: %s"),
+						  __FUNCTION__, client->peer, error->message);
+				g_clear_error (&error);
+				return FALSE;
+			}
+			g_clear_error (&error);
+			len = 0;
+		}
+
+		g_string_erase (client->outbuf, 0, len);
+	}
+
+	if (client->outbuf->len > C_SERVER_MAX_OUTPUT) {
+		grig_debug_local (RIG_DEBUG_WARN,
+				  _("%s: Client %s does not read its replies"),
+				  __FUNCTION__, client->peer);
+		return FALSE;
+	}
+
+	if ((client->outbuf->len > 0) && (client->outsrc == NULL)) {
+		client->outsrc = g_socket_create_source (client->socket, G_IO_OUT, NULL);
+		g_source_set_callback (client->outsrc, (GSourceFunc) rig_server_writable,
+				       client, NULL);
+		g_source_attach (client->outsrc, NULL);
+	}
+	else if ((client->outbuf->len == 0) && (client->outsrc != NULL)) {
+		g_source_destroy (client->outsrc);
+		g_source_unref (client->outsrc);
+		client->outsrc = NULL;
+	}
+
+	return TRUE;
+}
+
+
+/** \brief Disconnect a client.
+ *  \param client The client; freed.
+ */
+static void
+rig_server_close (server_client_t *client)
+{
+	server_t *srv = client->server;
+	gdouble   secs;
+
+
+	secs = MAX (g_get_monotonic_time () - client->connected, 1) / 1.0e6;
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Client %s disconnected after %.0f sec, "\
+			    "%u requests (%.1f/s), %u errors"),
+			  __FUNCTION__, client->peer, secs, client->requests,
+			  client->requests / secs, client->errors);
+
+	g_source_destroy (client->insrc);
+	g_source_unref (client->insrc);
+
+	if (client->outsrc != NULL) {
+		g_source_destroy (client->outsrc);
+		g_source_unref (client->outsrc);
+	}
+
+	g_io_stream_close (G_IO_STREAM (client->conn), NULL, NULL);
+	g_object_unref (client->conn);
+
+	srv->clients = g_list_remove (srv->clients, client);
+
+	g_string_free (client->inbuf, TRUE);
+	g_string_free (client->outbuf, TRUE);
+	g_free (client->peer);
+	g_free (client);
+}
+
+
+/** \brief Execute one request line.
+ *  \param client The client.
+ *  \param line The request without the newline.
+ */
+static void
+rig_server_exec (server_client_t *client, gchar *line)
+{
+	const server_cmd_t *cmd = NULL;
+	gchar             **tokens;
+	gchar             **args;
+	guint               ntok;
+	guint               i;
+	gint                status;
+
+
+	g_strstrip (line);
+	if (*line == '\0')
+		return;
+
+	client->requests++;
+
+	tokens = g_strsplit_set (line, " \t", 0);
+
+	/* drop the empty tokens of repeated separators */
+	for (i = 0, ntok = 0; tokens[i] != NULL; i++) {
+		if (*tokens[i] != '\0')
+			tokens[ntok++] = tokens[i];
+		else
+			g_free (tokens[i]);
+	}
+	tokens[ntok] = NULL;
+
+	for (i = 0; i < G_N_ELEMENTS (COMMANDS); i++) {
+		if ((tokens[0][0] == '\\') ? !strcmp (tokens[0] + 1, COMMANDS[i].lname) :
+		    ((tokens[0][1] == '\0') && (tokens[0][0] == COMMANDS[i].sname))) {
+			cmd = &COMMANDS[i];
+			break;
+		}
+	}
+
+	/* the extended response protocol is not supported */
+	if (cmd == NULL) {
+		status = -RIG_ENIMPL;
+	}
+	else if (ntok - 1 < cmd->nargs) {
+		status = -RIG_EINVAL;
+	}
+	else if (cmd->handler == NULL) {
+		client->quit = TRUE;
+		g_strfreev (tokens);
+		return;
+	}
+	else {
+		args = tokens + 1;
+		status = cmd->handler (args, client->outbuf);
+	}
+
+	if (status != RIG_OK)
+		client->errors++;
+
+	if ((status != RIG_OK) || (cmd == NULL) || !cmd->get)
+		g_string_append_printf (client->outbuf, "RPRT %d\n", status);
+
+	g_strfreev (tokens);
+}
+
+
+/** \brief Parse a number.
+ *  \param str The text.
+ *  \param value Where to store the number.
+ *  \return TRUE if str is a number.
+ */
+static gboolean
+rig_server_number (const gchar *str, gdouble *value)
+{
+	gchar *end;
+
+	*value = g_ascii_strtod (str, &end);
+
+	return (end != str) && (*end == '\0');
+}
+
+
+/** \brief Set the frequency. */
+static gint
+server_set_freq (gchar **args, GString *out)
+{
+	gdouble freq;
+
+	if (!rig_data_get_has_set_addr ()->freq1)
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[0], &freq) || (freq <= 0))
+		return -RIG_EINVAL;
+
+	rig_data_set_freq (1, freq);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the frequency. */
+static gint
+server_get_freq (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+
+	if (!rig_data_get_has_get_addr ()->freq1)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+	g_string_append_printf (out, "%.0f\n", snap.freq1);
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the mode and passband width in Hz; -1 keeps the width. */
+static gint
+server_set_mode (gchar **args, GString *out)
+{
+	RIG      *myrig = rig_daemon_get_rig ();
+	rmode_t   mode;
+	gdouble   width;
+	pbwidth_t narrow;
+	pbwidth_t wide;
+
+
+	if (!rig_data_get_has_set_addr ()->mode)
+		return -RIG_ENAVAIL;
+
+	mode = rig_parse_mode (args[0]);
+	if ((mode == RIG_MODE_NONE) || !rig_server_number (args[1], &width))
+		return -RIG_EINVAL;
+
+	rig_data_set_mode (mode);
+
+	if (width >= 0) {
+		narrow = rig_passband_narrow (myrig, mode);
+		wide = rig_passband_wide (myrig, mode);
+
+		if ((width == 0) || (width == rig_passband_normal (myrig, mode)))
+			rig_data_set_pbwidth (RIG_DATA_PB_NORMAL);
+		else if (narrow && (width <= narrow))
+			rig_data_set_pbwidth (RIG_DATA_PB_NARROW);
+		else if (wide && (width >= wide))
+			rig_data_set_pbwidth (RIG_DATA_PB_WIDE);
+		else
+			rig_data_set_pbwidth (RIG_DATA_PB_NORMAL);
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the mode and passband width in Hz. */
+static gint
+server_get_mode (gchar **args, GString *out)
+{
+	RIG             *myrig = rig_daemon_get_rig ();
+	grig_settings_t  snap;
+	pbwidth_t        width;
+
+
+	if (!rig_data_get_has_get_addr ()->mode)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+
+	switch (snap.pbw) {
+	case RIG_DATA_PB_NARROW:
+		width = rig_passband_narrow (myrig, snap.mode);
+		break;
+
+	case RIG_DATA_PB_WIDE:
+		width = rig_passband_wide (myrig, snap.mode);
+		break;
+
+	default:
+		width = 0;
+		break;
+	}
+
+	if (width == 0)
+		width = rig_passband_normal (myrig, snap.mode);
+
+	g_string_append_printf (out, "%s\n%ld\n", rig_strrmode (snap.mode), (long) width);
+
+	return RIG_OK;
+}
+
+
+/** \brief Select the VFO. */
+static gint
+server_set_vfo (gchar **args, GString *out)
+{
+	vfo_t vfo;
+
+	if (!rig_data_get_has_set_addr ()->vfo)
+		return -RIG_ENAVAIL;
+
+	vfo = rig_parse_vfo (args[0]);
+	if (vfo == RIG_VFO_NONE)
+		return -RIG_EINVAL;
+
+	if (vfo != RIG_VFO_CURR)
+		rig_data_set_vfo (vfo);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the selected VFO. */
+static gint
+server_get_vfo (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+
+	if (!rig_data_get_has_get_addr ()->vfo)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+	g_string_append_printf (out, "%s\n", rig_strvfo (snap.vfo));
+
+	return RIG_OK;
+}
+
+
+/** \brief Key or unkey the transmitter. */
+static gint
+server_set_ptt (gchar **args, GString *out)
+{
+	gdouble ptt;
+
+	if (!rig_data_get_has_set_addr ()->ptt)
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[0], &ptt))
+		return -RIG_EINVAL;
+
+	rig_data_set_ptt (ptt ? RIG_PTT_ON : RIG_PTT_OFF);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the PTT status. */
+static gint
+server_get_ptt (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+
+	if (!rig_data_get_has_get_addr ()->ptt)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+	g_string_append_printf (out, "%d\n", snap.ptt);
+
+	return RIG_OK;
+}
+
+
+/** \brief Switch split on or off; grig always transmits on the other VFO. */
+static gint
+server_set_split_vfo (gchar **args, GString *out)
+{
+	gdouble split;
+
+	if (!rig_data_get_has_set_addr ()->split)
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[0], &split))
+		return -RIG_EINVAL;
+
+	rig_data_set_split (split ? RIG_SPLIT_ON : RIG_SPLIT_OFF);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the split status and the TX VFO. */
+static gint
+server_get_split_vfo (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+	vfo_t           txvfo;
+
+
+	if (!rig_data_get_has_get_addr ()->split)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+
+	txvfo = snap.vfo;
+	if (snap.split == RIG_SPLIT_ON) {
+		switch (snap.vfo) {
+		case RIG_VFO_A:    txvfo = RIG_VFO_B;    break;
+		case RIG_VFO_B:    txvfo = RIG_VFO_A;    break;
+		case RIG_VFO_MAIN: txvfo = RIG_VFO_SUB;  break;
+		case RIG_VFO_SUB:  txvfo = RIG_VFO_MAIN; break;
+		default:           break;
+		}
+	}
+
+	g_string_append_printf (out, "%d\n%s\n", snap.split, rig_strvfo (txvfo));
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the TX frequency, ie. the secondary frequency. */
+static gint
+server_set_split_freq (gchar **args, GString *out)
+{
+	gdouble freq;
+
+	if (!rig_data_get_has_set_addr ()->freq2)
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[0], &freq) || (freq <= 0))
+		return -RIG_EINVAL;
+
+	rig_data_set_freq (2, freq);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the TX frequency, ie. the secondary frequency. */
+static gint
+server_get_split_freq (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+
+	if (!rig_data_get_has_get_addr ()->freq2)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+	g_string_append_printf (out, "%.0f\n", snap.freq2);
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the RIT offset. */
+static gint
+server_set_rit (gchar **args, GString *out)
+{
+	gdouble rit;
+
+	if (!rig_data_get_has_set_addr ()->rit)
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[0], &rit))
+		return -RIG_EINVAL;
+
+	rig_data_set_rit ((shortfreq_t) rit);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the RIT offset. */
+static gint
+server_get_rit (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+
+	if (!rig_data_get_has_get_addr ()->rit)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+	g_string_append_printf (out, "%ld\n", (long) snap.rit);
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the XIT offset. */
+static gint
+server_set_xit (gchar **args, GString *out)
+{
+	gdouble xit;
+
+	if (!rig_data_get_has_set_addr ()->xit)
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[0], &xit))
+		return -RIG_EINVAL;
+
+	rig_data_set_xit ((shortfreq_t) xit);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the XIT offset. */
+static gint
+server_get_xit (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+
+	if (!rig_data_get_has_get_addr ()->xit)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+	g_string_append_printf (out, "%ld\n", (long) snap.xit);
+
+	return RIG_OK;
+}
+
+
+/** \brief Find a level by name.
+ *  \param name The Hamlib name of the level.
+ *  \return The level or NULL if grig does not handle it.
+ */
+static const server_level_t *
+server_find_level (const gchar *name)
+{
+	setting_t level = rig_parse_level (name);
+	guint     i;
+
+	for (i = 0; (level != RIG_LEVEL_NONE) && (i < G_N_ELEMENTS (LEVELS)); i++) {
+		if (LEVELS[i].level == level)
+			return &LEVELS[i];
+	}
+
+	return NULL;
+}
+
+
+/** \brief Set a level. */
+static gint
+server_set_level (gchar **args, GString *out)
+{
+	const server_level_t *lvl = server_find_level (args[0]);
+	gdouble               value;
+
+
+	if ((lvl == NULL) || ((lvl->setf == NULL) && (lvl->seti == NULL)) ||
+	    !G_STRUCT_MEMBER (int, rig_data_get_has_set_addr (), lvl->avail))
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[1], &value))
+		return -RIG_EINVAL;
+
+	if (lvl->isfloat)
+		lvl->setf ((float) value);
+	else
+		lvl->seti ((int) value);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get a level. */
+static gint
+server_get_level (gchar **args, GString *out)
+{
+	const server_level_t *lvl = server_find_level (args[0]);
+	grig_settings_t       snap;
+
+
+	if ((lvl == NULL) ||
+	    !G_STRUCT_MEMBER (int, rig_data_get_has_get_addr (), lvl->avail))
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+
+	if (lvl->isfloat)
+		g_string_append_printf (out, "%f\n", G_STRUCT_MEMBER (float, &snap, lvl->value));
+	else
+		g_string_append_printf (out, "%d\n", G_STRUCT_MEMBER (int, &snap, lvl->value));
+
+	return RIG_OK;
+}
+
+
+/** \brief Switch a function on or off; LOCK is kept apart by grig. */
+static gint
+server_set_func (gchar **args, GString *out)
+{
+	setting_t func = rig_parse_func (args[0]);
+	gdouble   status;
+
+
+	if (!rig_server_number (args[1], &status))
+		return -RIG_EINVAL;
+
+	if (func == RIG_FUNC_LOCK) {
+		if (!rig_data_get_has_set_addr ()->lock)
+			return -RIG_ENAVAIL;
+
+		rig_data_set_lock (status != 0);
+	}
+	else {
+		if ((func == RIG_FUNC_NONE) ||
+		    !rig_data_get_has_set_addr ()->funcs[rig_setting2idx (func)])
+			return -RIG_ENAVAIL;
+
+		rig_data_set_func (func, status != 0);
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the status of a function. */
+static gint
+server_get_func (gchar **args, GString *out)
+{
+	setting_t       func = rig_parse_func (args[0]);
+	grig_settings_t snap;
+
+
+	rig_data_snapshot (&snap);
+
+	if (func == RIG_FUNC_LOCK) {
+		if (!rig_data_get_has_get_addr ()->lock)
+			return -RIG_ENAVAIL;
+
+		g_string_append_printf (out, "%d\n", snap.lock);
+	}
+	else {
+		if ((func == RIG_FUNC_NONE) ||
+		    !rig_data_get_has_get_addr ()->funcs[rig_setting2idx (func)])
+			return -RIG_ENAVAIL;
+
+		g_string_append_printf (out, "%d\n", snap.funcs[rig_setting2idx (func)]);
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Execute a VFO operation; grig knows TOGGLE, CPY and XCHG. */
+static gint
+server_vfo_op (gchar **args, GString *out)
+{
+	switch (rig_parse_vfo_op (args[0])) {
+	case RIG_OP_TOGGLE:
+		if (!rig_data_has_vfo_op_toggle ())
+			return -RIG_ENAVAIL;
+		rig_data_vfo_op_toggle ();
+		break;
+
+	case RIG_OP_CPY:
+		if (!rig_data_has_vfo_op_copy ())
+			return -RIG_ENAVAIL;
+		rig_data_vfo_op_copy ();
+		break;
+
+	case RIG_OP_XCHG:
+		if (!rig_data_has_vfo_op_xchg ())
+			return -RIG_ENAVAIL;
+		rig_data_vfo_op_xchg ();
+		break;
+
+	default:
+		return -RIG_EINVAL;
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Switch the rig on or off. */
+static gint
+server_set_powerstat (gchar **args, GString *out)
+{
+	gdouble pstat;
+
+	if (!rig_data_get_has_set_addr ()->pstat)
+		return -RIG_ENAVAIL;
+
+	if (!rig_server_number (args[0], &pstat))
+		return -RIG_EINVAL;
+
+	rig_data_set_pstat (pstat ? RIG_POWER_ON : RIG_POWER_OFF);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the power status. */
+static gint
+server_get_powerstat (gchar **args, GString *out)
+{
+	grig_settings_t snap;
+
+	if (!rig_data_get_has_get_addr ()->pstat)
+		return -RIG_ENAVAIL;
+
+	rig_data_snapshot (&snap);
+	g_string_append_printf (out, "%d\n", snap.pstat);
+
+	return RIG_OK;
+}
+
+
+/** \brief Get the rig name; the rig itself is not asked. */
+static gint
+server_get_info (gchar **args, GString *out)
+{
+	RIG *myrig = rig_daemon_get_rig ();
+
+	g_string_append_printf (out, "%s %s\n", myrig->caps->mfg_name,
+				myrig->caps->model_name);
+
+	return RIG_OK;
+}
+
+
+/** \brief Tell the client that commands do not take a VFO argument. */
+static gint
+server_chk_vfo (gchar **args, GString *out)
+{
+	g_string_append (out, "0\n");
+
+	return RIG_OK;
+}
+
+
+/** \brief Describe the rig to Hamlib's NET rigctl backend.
+ *
+ * The output follows rigctld's dump_state, protocol version 1.
+ */
+static gint
+server_dump_state (gchar **args, GString *out)
+{
+	RIG               *myrig = rig_daemon_get_rig ();
+	struct rig_state  *rs = &myrig->state;
+	gint               i;
+
+
+	g_string_append (out, "1\n");
+	g_string_append_printf (out, "%d\n", myrig->caps->rig_model);
+	g_string_append (out, "0\n");
+
+	for (i = 0; (i < HAMLIB_FRQRANGESIZ) && !RIG_IS_FRNG_END (rs->rx_range_list[i]); i++) {
+		g_string_append_printf (out, "%.0f %.0f 0x%llx %d %d 0x%x 0x%x\n",
+					rs->rx_range_list[i].startf, rs->rx_range_list[i].endf,
+					(unsigned long long) rs->rx_range_list[i].modes,
+					rs->rx_range_list[i].low_power, rs->rx_range_list[i].high_power,
+					rs->rx_range_list[i].vfo, rs->rx_range_list[i].ant);
+	}
+	g_string_append (out, "0 0 0 0 0 0 0\n");
+
+	for (i = 0; (i < HAMLIB_FRQRANGESIZ) && !RIG_IS_FRNG_END (rs->tx_range_list[i]); i++) {
+		g_string_append_printf (out, "%.0f %.0f 0x%llx %d %d 0x%x 0x%x\n",
+					rs->tx_range_list[i].startf, rs->tx_range_list[i].endf,
+					(unsigned long long) rs->tx_range_list[i].modes,
+					rs->tx_range_list[i].low_power, rs->tx_range_list[i].high_power,
+					rs->tx_range_list[i].vfo, rs->tx_range_list[i].ant);
+	}
+	g_string_append (out, "0 0 0 0 0 0 0\n");
+
+	for (i = 0; (i < HAMLIB_TSLSTSIZ) && !RIG_IS_TS_END (rs->tuning_steps[i]); i++) {
+		g_string_append_printf (out, "0x%llx %ld\n",
+					(unsigned long long) rs->tuning_steps[i].modes,
+					(long) rs->tuning_steps[i].ts);
+	}
+	g_string_append (out, "0 0\n");
+
+	for (i = 0; (i < HAMLIB_FLTLSTSIZ) && !RIG_IS_FLT_END (rs->filters[i]); i++) {
+		g_string_append_printf (out, "0x%llx %ld\n",
+					(unsigned long long) rs->filters[i].modes,
+					(long) rs->filters[i].width);
+	}
+	g_string_append (out, "0 0\n");
+
+	g_string_append_printf (out, "%ld\n%ld\n%ld\n%d\n",
+				(long) rs->max_rit, (long) rs->max_xit,
+				(long) rs->max_ifshift, (int) rs->announces);
+
+	for (i = 0; (i < HAMLIB_MAXDBLSTSIZ) && rs->preamp[i]; i++) {
+		g_string_append_printf (out, "%d ", rs->preamp[i]);
+	}
+	g_string_append_c (out, '\n');
+
+	for (i = 0; (i < HAMLIB_MAXDBLSTSIZ) && rs->attenuator[i]; i++) {
+		g_string_append_printf (out, "%d ", rs->attenuator[i]);
+	}
+	g_string_append_c (out, '\n');
+
+	g_string_append_printf (out, "0x%llx\n0x%llx\n0x%llx\n0x%llx\n0x%llx\n0x%llx\n",
+				(unsigned long long) rs->has_get_func,
+				(unsigned long long) rs->has_set_func,
+				(unsigned long long) rs->has_get_level,
+				(unsigned long long) rs->has_set_level,
+				(unsigned long long) rs->has_get_parm,
+				(unsigned long long) rs->has_set_parm);
+
+	g_string_append_printf (out, "vfo_ops=0x%x\n", myrig->caps->vfo_ops);
+	g_string_append (out, "done\n");
+
+	return RIG_OK;
+}
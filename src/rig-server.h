@@ -0,0 +1,49 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+#ifndef RIG_SERVER_H
+#define RIG_SERVER_H 1
+
+#include <glib.h>
+
+
+#define C_SERVER_DEF_PORT     4532    /*!< Default TCP port, same as rigctld. */
+#define C_SERVER_MAX_CLIENTS  32      /*!< Max number of clients per rig. */
+#define C_SERVER_MAX_LINE     1024    /*!< Longest accepted request line. */
+#define C_SERVER_MAX_OUTPUT   65536   /*!< Unsent replies before a client is dropped. */
+
+
+gboolean  rig_server_start  (const gchar *address, GError **error);
+void      rig_server_stop   (void);
+void      rig_server_dump   (GString *out);
+
+#endif
@@ -0,0 +1,364 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+/** \file    rig-shm.c
+ *  \ingroup shm
+ *  \brief   Shared memory publication of the rig state.
+ *
+ * This is the writer side of grig-shm.h. Every time fields of a rig are
+ * marked as changed (see rig_data_mark_dirty()), the 'get' settings are
+ * copied into the shared memory segment of the rig under its sequence lock
+ * and the readers waiting on the futex are woken up. The changed fields
+ * get a new time stamp.
+ *
+ * Both the daemon and the GUI setters mark fields, so the publication of
+ * each rig is serialised by a mutex. All functions refer to the current
+ * rig, see rig_data_current().
+ *
+ * The segment has a fixed name per rig number so that readers can find
+ * it. It is created exclusively; an existing segment is only replaced if
+ * the grig that created it is no longer running, e.g. after a crash.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#endif
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <hamlib/rig.h>
+#include "grig-debug.h"
+#include "grig-shm.h"
+#include "rig-data.h"
+#include "rig-daemon.h"
+#include "rig-shm.h"
+
+
+G_STATIC_ASSERT (RIG_DATA_FIELD_NUMBER == GRIG_SHM_FIELD_NUMBER);
+G_STATIC_ASSERT (RIG_DATA_FIELD_NUMBER <= GRIG_SHM_FIELDS);
+G_STATIC_ASSERT (RIG_DATA_FIELD_FREQ1 == GRIG_SHM_FIELD_FREQ1);
+G_STATIC_ASSERT (RIG_DATA_FIELD_FLIMITS == GRIG_SHM_FIELD_FLIMITS);
+G_STATIC_ASSERT (RIG_SETTING_MAX <= 64);
+
+
+/** \brief Publication state of a rig. */
+typedef struct {
+	grig_shm_t  *shm;     /*!< The mapped segment or NULL. */
+	gchar       *name;    /*!< Name of the segment. */
+	GMutex       mutex;   /*!< Serialises the writers. */
+} rig_shm_t;
+
+
+static rig_shm_t shms[C_MAX_RIGS];   /*!< Publication state of each rig. */
+
+
+static void     rig_shm_copy  (grig_shm_values_t *, const grig_settings_t *);
+static gboolean rig_shm_stale (const gchar *);
+
+
+
+/** \brief Create the segment of the current rig.
+ *  \param error Location for the error or NULL.
+ *  \return TRUE if the rig is published.
+ *
+ * The segment is readable by the user running grig only. The daemon of
+ * the rig should be running; the current values are published at once.
+ *
+ * This fails if another grig is publishing the same rig number.
+ */
+gboolean
+rig_shm_open (GError **error)
+{
+	rig_shm_t  *s = &shms[rig_data_current ()];
+	grig_shm_t *shm;
+	gint        fd;
+
+
+	g_return_val_if_fail (s->shm == NULL, FALSE);
+
+	s->name = g_strdup_printf (GRIG_SHM_NAME, rig_data_current ());
+
+	fd = shm_open (s->name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+	if ((fd < 0) && (errno == EEXIST) && rig_shm_stale (s->name)) {
+		grig_debug_local (RIG_DEBUG_WARN,
+				  _("%s: Replacing %s left by a grig that is not running"),
+				  __FUNCTION__, s->name);
+		shm_unlink (s->name);
+		fd = shm_open (s->name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	}
+
+	if ((fd < 0) && (errno == EEXIST)) {
+		g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_EXIST,
+			     _("Shared memory %s is in use by another grig"),
+			     s->name);
+		g_free (s->name);
+		s->name = NULL;
+		return FALSE;
+	}
+
+	if ((fd < 0) || (ftruncate (fd, sizeof (grig_shm_t)) < 0)) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+			     _("Could not create shared memory %s: %s"),
+			     s->name, g_strerror (errno));
+		if (fd >= 0) {
+			close (fd);
+			shm_unlink (s->name);
+		}
+		g_free (s->name);
+		s->name = NULL;
+		return FALSE;
+	}
+
+	shm = mmap (NULL, sizeof (grig_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+
+	if (shm == MAP_FAILED) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errno),
+			     _("Could not map shared memory %s: %s"),
+			     s->name, g_strerror (errno));
+		shm_unlink (s->name);
+		g_free (s->name);
+		s->name = NULL;
+		return FALSE;
+	}
+
+	/* the new segment is zero-filled */
+	shm->version = GRIG_SHM_VERSION;
+	shm->size = sizeof (grig_shm_t);
+	shm->pid = getpid ();
+	shm->model = rig_daemon_get_rig_id ();
+	shm->flags = GRIG_SHM_FLAG_ALIVE;
+	g_atomic_int_set ((gint *) &shm->magic, GRIG_SHM_MAGIC);
+
+	g_atomic_pointer_set (&s->shm, shm);
+
+	rig_shm_publish (RIG_DATA_DIRTY_ALL);
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Publishing rig state in %s"),
+			  __FUNCTION__, s->name);
+
+	return TRUE;
+}
+
+
+/** \brief Check whether an existing segment has been abandoned.
+ *  \param name The name of the segment.
+ *  \return TRUE if the segment may be removed.
+ *
+ * The segment is abandoned if it has been closed or if the process that
+ * created it is gone. A segment that is not initialised yet may belong to
+ * a grig that is just starting and is kept.
+ */
+static gboolean
+rig_shm_stale (const gchar *name)
+{
+	grig_shm_t  *shm;
+	struct stat  st;
+	gboolean     stale = FALSE;
+	gint         fd;
+
+
+	fd = shm_open (name, O_RDONLY, 0);
+	if (fd < 0)
+		return FALSE;
+
+	if ((fstat (fd, &st) < 0) || (st.st_size < (off_t) sizeof (grig_shm_t))) {
+		close (fd);
+		return FALSE;
+	}
+
+	shm = mmap (NULL, sizeof (grig_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+
+	if (shm == MAP_FAILED)
+		return FALSE;
+
+	if (g_atomic_int_get ((gint *) &shm->magic) == (gint) GRIG_SHM_MAGIC) {
+		stale = !(g_atomic_int_get ((gint *) &shm->flags) & GRIG_SHM_FLAG_ALIVE) ||
+			((kill (shm->pid, 0) < 0) && (errno == ESRCH));
+	}
+
+	munmap (shm, sizeof (grig_shm_t));
+
+	return stale;
+}
+
+
+/** \brief Remove the segment of the current rig.
+ *
+ * Readers which still have the segment mapped see the alive flag cleared
+ * and are woken up.
+ */
+void
+rig_shm_close ()
+{
+	rig_shm_t  *s = &shms[rig_data_current ()];
+	grig_shm_t *shm = s->shm;
+
+
+	if (shm == NULL)
+		return;
+
+	g_mutex_lock (&s->mutex);
+	g_atomic_pointer_set (&s->shm, NULL);
+	g_mutex_unlock (&s->mutex);
+
+	g_atomic_int_and ((guint *) &shm->flags, ~GRIG_SHM_FLAG_ALIVE);
+	g_atomic_int_add ((gint *) &shm->seq, 2);
+#ifdef __linux__
+	syscall (SYS_futex, &shm->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+
+	munmap (shm, sizeof (grig_shm_t));
+	shm_unlink (s->name);
+	g_free (s->name);
+	s->name = NULL;
+}
+
+
+/** \brief Publish the current values.
+ *  \param mask The changed fields, see RIG_DATA_DIRTY().
+ *
+ * Does nothing if the current rig is not published.
+ */
+void
+rig_shm_publish (guint64 mask)
+{
+	rig_shm_t       *s = &shms[rig_data_current ()];
+	grig_shm_t      *shm;
+	grig_settings_t  get;
+	gint64           now;
+	guint            i;
+
+
+	if ((mask == 0) || (g_atomic_pointer_get (&s->shm) == NULL))
+		return;
+
+	g_mutex_lock (&s->mutex);
+
+	shm = s->shm;
+	if (shm == NULL) {
+		g_mutex_unlock (&s->mutex);
+		return;
+	}
+
+	/* take the snapshot under the lock so that a later one is never
+	   overwritten by an earlier one */
+	rig_data_snapshot (&get);
+	now = g_get_monotonic_time ();
+
+	g_atomic_int_inc ((gint *) &shm->seq);
+
+	shm->state.updates++;
+	shm->state.updated = now;
+	for (i = 0; i < RIG_DATA_FIELD_NUMBER; i++) {
+		if (mask & RIG_DATA_DIRTY (i))
+			shm->state.stamps[i] = now;
+	}
+	rig_shm_copy (&shm->state.values, &get);
+
+	g_atomic_int_inc ((gint *) &shm->seq);
+
+	g_mutex_unlock (&s->mutex);
+
+#ifdef __linux__
+	/* a few updates per second; not worth tracking the waiters */
+	syscall (SYS_futex, &shm->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+
+/** \brief Convert the settings to the shared layout.
+ *  \param values The shared values.
+ *  \param get The settings.
+ */
+static void
+rig_shm_copy (grig_shm_values_t *values, const grig_settings_t *get)
+{
+	guint i;
+
+
+	values->freq1    = get->freq1;
+	values->freq2    = get->freq2;
+	values->fmin     = get->fmin;
+	values->fmax     = get->fmax;
+	values->mode     = get->mode;
+	values->vfo      = get->vfo;
+	values->antenna  = get->antenna;
+	values->pbw      = get->pbw;
+	values->pstat    = get->pstat;
+	values->ptt      = get->ptt;
+	values->lock     = get->lock;
+	values->split    = get->split;
+	values->rit      = get->rit;
+	values->xit      = get->xit;
+	values->fstep    = get->fstep;
+	values->agc      = get->agc;
+	values->att      = get->att;
+	values->preamp   = get->preamp;
+	values->ifs      = get->ifs;
+	values->notch    = get->notch;
+	values->cwpitch  = get->cwpitch;
+	values->keyspd   = get->keyspd;
+	values->bkindel  = get->bkindel;
+	values->voxdel   = get->voxdel;
+	values->strength = get->strength;
+	values->afg      = get->afg;
+	values->rfg      = get->rfg;
+	values->sql      = get->sql;
+	values->apf      = get->apf;
+	values->nr       = get->nr;
+	values->pbtin    = get->pbtin;
+	values->pbtout   = get->pbtout;
+	values->balance  = get->balance;
+	values->voxg     = get->voxg;
+	values->antivox  = get->antivox;
+	values->micg     = get->micg;
+	values->comp     = get->comp;
+	values->power    = get->power;
+	values->swr      = get->swr;
+	values->alc      = get->alc;
+
+	values->funcs = 0;
+	for (i = 0; i < RIG_SETTING_MAX; i++) {
+		if (get->funcs[i])
+			values->funcs |= G_GUINT64_CONSTANT (1) << i;
+	}
+}
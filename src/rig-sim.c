@@ -0,0 +1,1232 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+    Grig:  Gtk+ user interface for the Hamradio Control Libraries.
+
+    Copyright (C)  2001-2007  Alexandru Csete.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/groundstation/
+    More details can be found at the project home page:
+
+            http://groundstation.sourceforge.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+ 
+ 
+ 
+ 
+*/
+
+/** \file    rig-sim.c
+ *  \ingroup rigd
+ *  \brief   Simulated rig.
+ *
+ * This file implements a Hamlib backend for a rig that does not exist. It
+ * is registered with Hamlib at start-up as model C_RIG_SIM_MODEL and can
+ * be selected with -m like any other model. Unlike the Hamlib dummy rig
+ * it takes time to answer and it fails now and then, which makes it
+ * possible to test and benchmark the daemon without a radio.
+ *
+ * The time of each call is the time needed to transfer the command and
+ * the reply over the serial port at the configured rate (-s), plus a fixed
+ * latency and an exponentially distributed jitter. A call can time out,
+ * which costs the port timeout, or be rejected by the rig. While the rig
+ * is switched off every call except the power status times out.
+ *
+ * The timing is configured with conf parameters (-C), eg.
+ *
+ * \code
+ * grig -m 99001 -s 4800 -C latency=10,jitter=5,timeouts=1,rejects=2
+ * \endcode
+ *
+ * Individual Hamlib calls can be given their own timing in the file
+ * specified with the simfile parameter, which has one group per call
+ * named after the Hamlib function without the rig_ prefix and a Script
+ * group controlling the simulated values:
+ *
+ * \code
+ * [get_level]
+ * Latency=40
+ * Jitter=20
+ * Timeouts=5
+ *
+ * [Script]
+ * Drift=2.5
+ * SMeter=-20
+ * Noise=3
+ * FadePeriod=20
+ * FadeDepth=15
+ * \endcode
+ *
+ * Latencies are in msec and failure rates in percent. Drift is the
+ * frequency drift of both VFOs in Hz/sec; the S-meter reading is SMeter dB
+ * relative to S9 with gaussian noise and a slow sinusoidal fade. Setting
+ * the seed parameter makes the sequence of latencies and failures
+ * repeatable.
+ */
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <gtk/gtk.h>
+#include <glib/gi18n.h>
+#include <hamlib/rig.h>
+#include "grig-debug.h"
+#include "rig-data.h"
+#include "rig-sim.h"
+
+
+#define KEY_LATENCY      "Latency"
+#define KEY_JITTER       "Jitter"
+#define KEY_TIMEOUTS     "Timeouts"
+#define KEY_REJECTS      "Rejects"
+#define KEY_BYTES        "Bytes"
+
+#define GROUP_SCRIPT     "Script"
+#define KEY_DRIFT        "Drift"
+#define KEY_SMETER       "SMeter"
+#define KEY_NOISE        "Noise"
+#define KEY_FADE_PERIOD  "FadePeriod"
+#define KEY_FADE_DEPTH   "FadeDepth"
+
+
+/** \brief Conf parameter tokens. */
+enum {
+	TOK_SIM_LATENCY = 1,
+	TOK_SIM_JITTER,
+	TOK_SIM_TIMEOUTS,
+	TOK_SIM_REJECTS,
+	TOK_SIM_BYTES,
+	TOK_SIM_DRIFT,
+	TOK_SIM_SMETER,
+	TOK_SIM_NOISE,
+	TOK_SIM_SEED,
+	TOK_SIM_FILE
+};
+
+
+/** \brief Simulated Hamlib calls. */
+typedef enum {
+	SIM_OP_GET_FREQ = 0,
+	SIM_OP_SET_FREQ,
+	SIM_OP_GET_MODE,
+	SIM_OP_SET_MODE,
+	SIM_OP_GET_VFO,
+	SIM_OP_SET_VFO,
+	SIM_OP_GET_PTT,
+	SIM_OP_SET_PTT,
+	SIM_OP_GET_RIT,
+	SIM_OP_SET_RIT,
+	SIM_OP_GET_XIT,
+	SIM_OP_SET_XIT,
+	SIM_OP_GET_LEVEL,
+	SIM_OP_SET_LEVEL,
+	SIM_OP_GET_FUNC,
+	SIM_OP_SET_FUNC,
+	SIM_OP_GET_POWERSTAT,
+	SIM_OP_SET_POWERSTAT,
+	SIM_OP_VFO_OP,
+	SIM_OP_NUMBER
+} sim_op_t;
+
+
+/** \brief Names of the simulated calls, used as group names in the simfile. */
+static const gchar *SIM_OP_NAME[SIM_OP_NUMBER] = {
+	[SIM_OP_GET_FREQ]      = "get_freq",
+	[SIM_OP_SET_FREQ]      = "set_freq",
+	[SIM_OP_GET_MODE]      = "get_mode",
+	[SIM_OP_SET_MODE]      = "set_mode",
+	[SIM_OP_GET_VFO]       = "get_vfo",
+	[SIM_OP_SET_VFO]       = "set_vfo",
+	[SIM_OP_GET_PTT]       = "get_ptt",
+	[SIM_OP_SET_PTT]       = "set_ptt",
+	[SIM_OP_GET_RIT]       = "get_rit",
+	[SIM_OP_SET_RIT]       = "set_rit",
+	[SIM_OP_GET_XIT]       = "get_xit",
+	[SIM_OP_SET_XIT]       = "set_xit",
+	[SIM_OP_GET_LEVEL]     = "get_level",
+	[SIM_OP_SET_LEVEL]     = "set_level",
+	[SIM_OP_GET_FUNC]      = "get_func",
+	[SIM_OP_SET_FUNC]      = "set_func",
+	[SIM_OP_GET_POWERSTAT] = "get_powerstat",
+	[SIM_OP_SET_POWERSTAT] = "set_powerstat",
+	[SIM_OP_VFO_OP]        = "vfo_op"
+};
+
+
+/** \brief Timing of a simulated call. */
+typedef struct {
+	gdouble   latency;    /*!< Fixed latency [msec]. */
+	gdouble   jitter;     /*!< Mean of the exponential jitter [msec]. */
+	gdouble   timeouts;   /*!< Probability of a timeout [%]. */
+	gdouble   rejects;    /*!< Probability of RIG_ERJCTED [%]. */
+	guint     bytes;      /*!< Bytes transferred by command and reply. */
+} sim_timing_t;
+
+
+/** \brief State of the simulated rig. */
+typedef struct {
+	sim_timing_t  deftiming;              /*!< Timing set with conf parameters. */
+	sim_timing_t  timing[SIM_OP_NUMBER];  /*!< Timing of each call. */
+	gchar        *simfile;                /*!< File with per-call timing and script. */
+	guint32       seed;                   /*!< Random seed; 0 to seed from the clock. */
+	GRand        *rand;                   /*!< Random generator. */
+
+	gdouble       drift;       /*!< Frequency drift [Hz/sec]. */
+	gdouble       smeter;      /*!< Mean S-meter reading [dB rel. S9]. */
+	gdouble       noise;       /*!< S-meter noise (standard deviation) [dB]. */
+	gdouble       fadeperiod;  /*!< Period of the S-meter fade [sec]; 0 for none. */
+	gdouble       fadedepth;   /*!< Amplitude of the S-meter fade [dB]. */
+	gint64        start;       /*!< When the rig has been opened. */
+	gint64        last;        /*!< When the drift has last been applied. */
+
+	vfo_t         vfo;                    /*!< Current VFO. */
+	freq_t        freq[2];                /*!< Frequency of VFO A and B. */
+	rmode_t       mode[2];                /*!< Mode of VFO A and B. */
+	pbwidth_t     width[2];               /*!< Passband width of VFO A and B. */
+	ptt_t         ptt;                    /*!< PTT status. */
+	shortfreq_t   rit;                    /*!< RIT offset. */
+	shortfreq_t   xit;                    /*!< XIT offset. */
+	powerstat_t   pstat;                  /*!< Power status. */
+	setting_t     funcs;                  /*!< Active functions. */
+	value_t       levels[RIG_SETTING_MAX];  /*!< Level values. */
+} sim_priv_t;
+
+
+/** \brief Modes supported by the simulated rig. */
+#define SIM_MODES (RIG_MODE_AM | RIG_MODE_CW | RIG_MODE_USB | RIG_MODE_LSB | \
+		   RIG_MODE_RTTY | RIG_MODE_FM | RIG_MODE_CWR)
+
+/** \brief Functions supported by the simulated rig. */
+#define SIM_FUNCS (RIG_FUNC_NB | RIG_FUNC_COMP | RIG_FUNC_VOX | RIG_FUNC_TONE | \
+		   RIG_FUNC_ANF | RIG_FUNC_NR | RIG_FUNC_LOCK)
+
+
+static int rig_sim_init          (RIG *);
+static int rig_sim_cleanup       (RIG *);
+static int rig_sim_open          (RIG *);
+static int rig_sim_close         (RIG *);
+static int rig_sim_set_conf      (RIG *, token_t, const char *);
+static int rig_sim_get_conf      (RIG *, token_t, char *);
+static int rig_sim_set_freq      (RIG *, vfo_t, freq_t);
+static int rig_sim_get_freq      (RIG *, vfo_t, freq_t *);
+static int rig_sim_set_mode      (RIG *, vfo_t, rmode_t, pbwidth_t);
+static int rig_sim_get_mode      (RIG *, vfo_t, rmode_t *, pbwidth_t *);
+static int rig_sim_set_vfo       (RIG *, vfo_t);
+static int rig_sim_get_vfo       (RIG *, vfo_t *);
+static int rig_sim_set_ptt       (RIG *, vfo_t, ptt_t);
+static int rig_sim_get_ptt       (RIG *, vfo_t, ptt_t *);
+static int rig_sim_set_rit       (RIG *, vfo_t, shortfreq_t);
+static int rig_sim_get_rit       (RIG *, vfo_t, shortfreq_t *);
+static int rig_sim_set_xit       (RIG *, vfo_t, shortfreq_t);
+static int rig_sim_get_xit       (RIG *, vfo_t, shortfreq_t *);
+static int rig_sim_set_level     (RIG *, vfo_t, setting_t, value_t);
+static int rig_sim_get_level     (RIG *, vfo_t, setting_t, value_t *);
+static int rig_sim_set_func      (RIG *, vfo_t, setting_t, int);
+static int rig_sim_get_func      (RIG *, vfo_t, setting_t, int *);
+static int rig_sim_set_powerstat (RIG *, powerstat_t);
+static int rig_sim_get_powerstat (RIG *, powerstat_t *);
+static int rig_sim_vfo_op        (RIG *, vfo_t, vfo_op_t);
+
+static int     rig_sim_io        (RIG *, sim_op_t);
+static void    rig_sim_script    (sim_priv_t *);
+static gint    rig_sim_vfo_idx   (sim_priv_t *, vfo_t);
+static gdouble rig_sim_gauss     (sim_priv_t *);
+static void    rig_sim_load_file (sim_priv_t *);
+
+
+/** \brief Conf parameters of the simulated rig. */
+static const struct confparams sim_cfg_params[] = {
+	{ TOK_SIM_LATENCY, "latency", "Latency", "Fixed latency of each call [ms]",
+	  "0", RIG_CONF_NUMERIC, { .n = { 0, 10000, 1 } } },
+	{ TOK_SIM_JITTER, "jitter", "Jitter", "Mean of the random latency [ms]",
+	  "0", RIG_CONF_NUMERIC, { .n = { 0, 10000, 1 } } },
+	{ TOK_SIM_TIMEOUTS, "timeouts", "Timeouts", "Probability of a timeout [%]",
+	  "0", RIG_CONF_NUMERIC, { .n = { 0, 100, 0.1 } } },
+	{ TOK_SIM_REJECTS, "rejects", "Rejects", "Probability of a rejected command [%]",
+	  "0", RIG_CONF_NUMERIC, { .n = { 0, 100, 0.1 } } },
+	{ TOK_SIM_BYTES, "bytes", "Bytes", "Bytes transferred by command and reply",
+	  "20", RIG_CONF_NUMERIC, { .n = { 0, 1000, 1 } } },
+	{ TOK_SIM_DRIFT, "drift", "Drift", "Frequency drift [Hz/s]",
+	  "0", RIG_CONF_NUMERIC, { .n = { -1000, 1000, 0.1 } } },
+	{ TOK_SIM_SMETER, "smeter", "S-meter", "Mean S-meter reading [dB rel. S9]",
+	  "-20", RIG_CONF_NUMERIC, { .n = { -54, 60, 1 } } },
+	{ TOK_SIM_NOISE, "noise", "Noise", "S-meter noise [dB]",
+	  "2", RIG_CONF_NUMERIC, { .n = { 0, 30, 0.1 } } },
+	{ TOK_SIM_SEED, "seed", "Seed", "Random seed, 0 for none",
+	  "0", RIG_CONF_NUMERIC, { .n = { 0, 4294967295.0, 1 } } },
+	{ TOK_SIM_FILE, "simfile", "Sim file", "File with per-call timing and value script",
+	  "", RIG_CONF_STRING, },
+	{ RIG_CONF_END, NULL, }
+};
+
+
+/** \brief Capabilities of the simulated rig. */
+static struct rig_caps sim_caps = {
+	.rig_model       = C_RIG_SIM_MODEL,
+	.model_name      = "Simulator",
+	.mfg_name        = "Grig",
+	.version         = "0.1",
+	.copyright       = "GPL",
+	.status          = RIG_STATUS_BETA,
+	.rig_type        = RIG_TYPE_TRANSCEIVER,
+	.ptt_type        = RIG_PTT_RIG,
+	.dcd_type        = RIG_DCD_NONE,
+	.port_type       = RIG_PORT_NONE,
+	.timeout         = 500,
+	.has_get_func    = SIM_FUNCS,
+	.has_set_func    = SIM_FUNCS,
+	.has_get_level   = GRIG_LEVEL_RD,
+	.has_set_level   = GRIG_LEVEL_WR,
+	.preamp          = { 10, RIG_DBLST_END },
+	.attenuator      = { 6, 12, 18, RIG_DBLST_END },
+	.max_rit         = Hz (9990),
+	.max_xit         = Hz (9990),
+	.vfo_ops         = GRIG_VFO_OP,
+	.targetable_vfo  = RIG_TARGETABLE_ALL,
+
+	.rx_range_list1  = {
+		{ .startf = kHz (150), .endf = MHz (60), .modes = SIM_MODES,
+		  .low_power = -1, .high_power = -1,
+		  .vfo = RIG_VFO_A | RIG_VFO_B, .ant = RIG_ANT_1 },
+		RIG_FRNG_END,
+	},
+	.tx_range_list1  = {
+		{ .startf = MHz (1.8), .endf = MHz (54), .modes = SIM_MODES,
+		  .low_power = W (5), .high_power = W (100),
+		  .vfo = RIG_VFO_A | RIG_VFO_B, .ant = RIG_ANT_1 },
+		RIG_FRNG_END,
+	},
+	.tuning_steps    = {
+		{ SIM_MODES, 10 },
+		RIG_TS_END,
+	},
+	.filters         = {
+		{ RIG_MODE_SSB, kHz (2.4) },
+		{ RIG_MODE_CW | RIG_MODE_CWR, 500 },
+		{ RIG_MODE_RTTY, 500 },
+		{ RIG_MODE_AM, kHz (6) },
+		{ RIG_MODE_FM, kHz (15) },
+		RIG_FLT_END,
+	},
+
+	.cfgparams       = sim_cfg_params,
+
+	.rig_init        = rig_sim_init,
+	.rig_cleanup     = rig_sim_cleanup,
+	.rig_open        = rig_sim_open,
+	.rig_close       = rig_sim_close,
+	.set_conf        = rig_sim_set_conf,
+	.get_conf        = rig_sim_get_conf,
+	.set_freq        = rig_sim_set_freq,
+	.get_freq        = rig_sim_get_freq,
+	.set_mode        = rig_sim_set_mode,
+	.get_mode        = rig_sim_get_mode,
+	.set_vfo         = rig_sim_set_vfo,
+	.get_vfo         = rig_sim_get_vfo,
+	.set_ptt         = rig_sim_set_ptt,
+	.get_ptt         = rig_sim_get_ptt,
+	.set_rit         = rig_sim_set_rit,
+	.get_rit         = rig_sim_get_rit,
+	.set_xit         = rig_sim_set_xit,
+	.get_xit         = rig_sim_get_xit,
+	.set_level       = rig_sim_set_level,
+	.get_level       = rig_sim_get_level,
+	.set_func        = rig_sim_set_func,
+	.get_func        = rig_sim_get_func,
+	.set_powerstat   = rig_sim_set_powerstat,
+	.get_powerstat   = rig_sim_get_powerstat,
+	.vfo_op          = rig_sim_vfo_op
+};
+
+
+
+/** \brief Register the simulated rig with Hamlib.
+ *
+ * This function must be called before the model list is shown or the
+ * simulated rig is opened.
+ */
+void
+rig_sim_register ()
+{
+	rig_register (&sim_caps);
+}
+
+
+/** \brief Allocate the state of the simulated rig.
+ *  \param rig The rig.
+ *  \return RIG_OK.
+ */
+static int
+rig_sim_init (RIG *rig)
+{
+	sim_priv_t *priv;
+
+
+	priv = g_new0 (sim_priv_t, 1);
+
+	priv->deftiming.bytes = C_RIG_SIM_DEF_BYTES;
+	priv->smeter = -20.0;
+	priv->noise = 2.0;
+
+	priv->vfo = RIG_VFO_A;
+	priv->freq[0] = MHz (14.1);
+	priv->freq[1] = MHz (7.05);
+	priv->mode[0] = RIG_MODE_USB;
+	priv->mode[1] = RIG_MODE_LSB;
+	priv->width[0] = kHz (2.4);
+	priv->width[1] = kHz (2.4);
+	priv->ptt = RIG_PTT_OFF;
+	priv->pstat = RIG_POWER_ON;
+
+	priv->levels[rig_setting2idx (RIG_LEVEL_AF)].f = 0.5;
+	priv->levels[rig_setting2idx (RIG_LEVEL_RF)].f = 1.0;
+	priv->levels[rig_setting2idx (RIG_LEVEL_RFPOWER)].f = 0.5;
+	priv->levels[rig_setting2idx (RIG_LEVEL_MICGAIN)].f = 0.5;
+	priv->levels[rig_setting2idx (RIG_LEVEL_CWPITCH)].i = 600;
+	priv->levels[rig_setting2idx (RIG_LEVEL_KEYSPD)].i = 20;
+	priv->levels[rig_setting2idx (RIG_LEVEL_AGC)].i = RIG_AGC_FAST;
+
+	rig->state.priv = priv;
+
+	/* the port is not opened but the rate is used by the time model */
+	rig->state.rigport.parm.serial.rate = C_RIG_SIM_DEF_RATE;
+
+	/* every call must reach the backend in order to be timed */
+	rig_set_cache_timeout_ms (rig, HAMLIB_CACHE_ALL, 0);
+
+	return RIG_OK;
+}
+
+
+/** \brief Free the state of the simulated rig.
+ *  \param rig The rig.
+ *  \return RIG_OK.
+ */
+static int
+rig_sim_cleanup (RIG *rig)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+
+
+	if (priv != NULL) {
+		g_free (priv->simfile);
+		g_free (priv);
+		rig->state.priv = NULL;
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Open the simulated rig.
+ *  \param rig The rig.
+ *  \return RIG_OK.
+ *
+ * The timing of each call is initialised from the conf parameters and
+ * then overridden by the simfile, if any.
+ */
+static int
+rig_sim_open (RIG *rig)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	guint       i;
+
+
+	for (i = 0; i < SIM_OP_NUMBER; i++) {
+		priv->timing[i] = priv->deftiming;
+	}
+
+	if (priv->simfile != NULL) {
+		rig_sim_load_file (priv);
+	}
+
+	if (priv->seed != 0) {
+		priv->rand = g_rand_new_with_seed (priv->seed);
+	}
+	else {
+		priv->rand = g_rand_new ();
+	}
+
+	priv->start = g_get_monotonic_time ();
+	priv->last = priv->start;
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Simulating %d baud, latency %.1f ms, jitter %.1f ms, "\
+			    "%.1f%% timeouts, %.1f%% rejects"),
+			  __FUNCTION__, rig->state.rigport.parm.serial.rate,
+			  priv->deftiming.latency, priv->deftiming.jitter,
+			  priv->deftiming.timeouts, priv->deftiming.rejects);
+
+	return RIG_OK;
+}
+
+
+/** \brief Close the simulated rig.
+ *  \param rig The rig.
+ *  \return RIG_OK.
+ */
+static int
+rig_sim_close (RIG *rig)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+
+
+	if (priv->rand != NULL) {
+		g_rand_free (priv->rand);
+		priv->rand = NULL;
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Set a conf parameter.
+ *  \param rig The rig.
+ *  \param token The parameter.
+ *  \param val The new value.
+ *  \return RIG_OK or -RIG_EINVAL if the token is unknown.
+ */
+static int
+rig_sim_set_conf (RIG *rig, token_t token, const char *val)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	gdouble     num;
+
+
+	num = g_ascii_strtod (val, NULL);
+
+	switch (token) {
+
+	case TOK_SIM_LATENCY:
+		priv->deftiming.latency = MAX (num, 0.0);
+		break;
+
+	case TOK_SIM_JITTER:
+		priv->deftiming.jitter = MAX (num, 0.0);
+		break;
+
+	case TOK_SIM_TIMEOUTS:
+		priv->deftiming.timeouts = CLAMP (num, 0.0, 100.0);
+		break;
+
+	case TOK_SIM_REJECTS:
+		priv->deftiming.rejects = CLAMP (num, 0.0, 100.0);
+		break;
+
+	case TOK_SIM_BYTES:
+		priv->deftiming.bytes = (guint) MAX (num, 0.0);
+		break;
+
+	case TOK_SIM_DRIFT:
+		priv->drift = num;
+		break;
+
+	case TOK_SIM_SMETER:
+		priv->smeter = num;
+		break;
+
+	case TOK_SIM_NOISE:
+		priv->noise = MAX (num, 0.0);
+		break;
+
+	case TOK_SIM_SEED:
+		priv->seed = (guint32) strtoul (val, NULL, 10);
+		break;
+
+	case TOK_SIM_FILE:
+		g_free (priv->simfile);
+		priv->simfile = (val[0] != '\0') ? g_strdup (val) : NULL;
+		break;
+
+	default:
+		return -RIG_EINVAL;
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Get a conf parameter.
+ *  \param rig The rig.
+ *  \param token The parameter.
+ *  \param val Buffer where the value is written.
+ *  \return RIG_OK or -RIG_EINVAL if the token is unknown.
+ */
+static int
+rig_sim_get_conf (RIG *rig, token_t token, char *val)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	gdouble     num;
+
+
+	switch (token) {
+
+	case TOK_SIM_LATENCY:
+		num = priv->deftiming.latency;
+		break;
+
+	case TOK_SIM_JITTER:
+		num = priv->deftiming.jitter;
+		break;
+
+	case TOK_SIM_TIMEOUTS:
+		num = priv->deftiming.timeouts;
+		break;
+
+	case TOK_SIM_REJECTS:
+		num = priv->deftiming.rejects;
+		break;
+
+	case TOK_SIM_BYTES:
+		num = priv->deftiming.bytes;
+		break;
+
+	case TOK_SIM_DRIFT:
+		num = priv->drift;
+		break;
+
+	case TOK_SIM_SMETER:
+		num = priv->smeter;
+		break;
+
+	case TOK_SIM_NOISE:
+		num = priv->noise;
+		break;
+
+	case TOK_SIM_SEED:
+		num = priv->seed;
+		break;
+
+	case TOK_SIM_FILE:
+		g_strlcpy (val, priv->simfile ? priv->simfile : "", 128);
+		return RIG_OK;
+
+	default:
+		return -RIG_EINVAL;
+	}
+
+	g_ascii_formatd (val, 128, "%g", num);
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the frequency of a VFO. */
+static int
+rig_sim_set_freq (RIG *rig, vfo_t vfo, freq_t freq)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_FREQ)) != RIG_OK)
+		return retcode;
+
+	priv->freq[rig_sim_vfo_idx (priv, vfo)] = freq;
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the frequency of a VFO. */
+static int
+rig_sim_get_freq (RIG *rig, vfo_t vfo, freq_t *freq)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_FREQ)) != RIG_OK)
+		return retcode;
+
+	/* the rig resolves 1 Hz */
+	*freq = floor (priv->freq[rig_sim_vfo_idx (priv, vfo)] + 0.5);
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the mode and passband of a VFO. */
+static int
+rig_sim_set_mode (RIG *rig, vfo_t vfo, rmode_t mode, pbwidth_t width)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	gint        idx;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_MODE)) != RIG_OK)
+		return retcode;
+
+	if (!(mode & SIM_MODES))
+		return -RIG_EINVAL;
+
+	idx = rig_sim_vfo_idx (priv, vfo);
+	priv->mode[idx] = mode;
+
+	if (width == RIG_PASSBAND_NORMAL)
+		priv->width[idx] = rig_passband_normal (rig, mode);
+	else if (width != RIG_PASSBAND_NOCHANGE)
+		priv->width[idx] = width;
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the mode and passband of a VFO. */
+static int
+rig_sim_get_mode (RIG *rig, vfo_t vfo, rmode_t *mode, pbwidth_t *width)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	gint        idx;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_MODE)) != RIG_OK)
+		return retcode;
+
+	idx = rig_sim_vfo_idx (priv, vfo);
+	*mode = priv->mode[idx];
+	*width = priv->width[idx];
+
+	return RIG_OK;
+}
+
+
+/** \brief Select the current VFO. */
+static int
+rig_sim_set_vfo (RIG *rig, vfo_t vfo)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_VFO)) != RIG_OK)
+		return retcode;
+
+	priv->vfo = rig_sim_vfo_idx (priv, vfo) ? RIG_VFO_B : RIG_VFO_A;
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the current VFO. */
+static int
+rig_sim_get_vfo (RIG *rig, vfo_t *vfo)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_VFO)) != RIG_OK)
+		return retcode;
+
+	*vfo = priv->vfo;
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the PTT status. */
+static int
+rig_sim_set_ptt (RIG *rig, vfo_t vfo, ptt_t ptt)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_PTT)) != RIG_OK)
+		return retcode;
+
+	priv->ptt = ptt;
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the PTT status. */
+static int
+rig_sim_get_ptt (RIG *rig, vfo_t vfo, ptt_t *ptt)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_PTT)) != RIG_OK)
+		return retcode;
+
+	*ptt = priv->ptt;
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the RIT offset. */
+static int
+rig_sim_set_rit (RIG *rig, vfo_t vfo, shortfreq_t rit)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_RIT)) != RIG_OK)
+		return retcode;
+
+	priv->rit = CLAMP (rit, -sim_caps.max_rit, sim_caps.max_rit);
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the RIT offset. */
+static int
+rig_sim_get_rit (RIG *rig, vfo_t vfo, shortfreq_t *rit)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_RIT)) != RIG_OK)
+		return retcode;
+
+	*rit = priv->rit;
+
+	return RIG_OK;
+}
+
+
+/** \brief Set the XIT offset. */
+static int
+rig_sim_set_xit (RIG *rig, vfo_t vfo, shortfreq_t xit)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_XIT)) != RIG_OK)
+		return retcode;
+
+	priv->xit = CLAMP (xit, -sim_caps.max_xit, sim_caps.max_xit);
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the XIT offset. */
+static int
+rig_sim_get_xit (RIG *rig, vfo_t vfo, shortfreq_t *xit)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_XIT)) != RIG_OK)
+		return retcode;
+
+	*xit = priv->xit;
+
+	return RIG_OK;
+}
+
+
+/** \brief Set a level. */
+static int
+rig_sim_set_level (RIG *rig, vfo_t vfo, setting_t level, value_t val)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_LEVEL)) != RIG_OK)
+		return retcode;
+
+	if (!(level & sim_caps.has_set_level))
+		return -RIG_EINVAL;
+
+	priv->levels[rig_setting2idx (level)] = val;
+
+	return RIG_OK;
+}
+
+
+/** \brief Read a level.
+ *
+ * The meters are simulated: the S-meter follows the script while in RX,
+ * SWR and ALC show plausible values while in TX.
+ */
+static int
+rig_sim_get_level (RIG *rig, vfo_t vfo, setting_t level, value_t *val)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	gdouble     db;
+	gdouble     t;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_LEVEL)) != RIG_OK)
+		return retcode;
+
+	if (!(level & sim_caps.has_get_level))
+		return -RIG_EINVAL;
+
+	switch (level) {
+
+	case RIG_LEVEL_STRENGTH:
+		db = priv->smeter + priv->noise * rig_sim_gauss (priv);
+
+		if (priv->fadeperiod > 0.0) {
+			t = (g_get_monotonic_time () - priv->start) / 1.0e6;
+			db += priv->fadedepth * sin (2.0 * G_PI * t / priv->fadeperiod);
+		}
+
+		val->i = (priv->ptt == RIG_PTT_OFF) ? (int) CLAMP (floor (db + 0.5), -54, 60) : -54;
+		break;
+
+	case RIG_LEVEL_SWR:
+		val->f = (priv->ptt == RIG_PTT_OFF) ? 1.0 : 1.3 + 0.05 * rig_sim_gauss (priv);
+		break;
+
+	case RIG_LEVEL_ALC:
+		val->f = (priv->ptt == RIG_PTT_OFF) ? 0.0 :
+			CLAMP (0.3 + 0.05 * rig_sim_gauss (priv), 0.0, 1.0);
+		break;
+
+	default:
+		*val = priv->levels[rig_setting2idx (level)];
+		break;
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Switch a function on or off. */
+static int
+rig_sim_set_func (RIG *rig, vfo_t vfo, setting_t func, int status)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_FUNC)) != RIG_OK)
+		return retcode;
+
+	if (!(func & SIM_FUNCS))
+		return -RIG_EINVAL;
+
+	if (status)
+		priv->funcs |= func;
+	else
+		priv->funcs &= ~func;
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the status of a function. */
+static int
+rig_sim_get_func (RIG *rig, vfo_t vfo, setting_t func, int *status)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_FUNC)) != RIG_OK)
+		return retcode;
+
+	if (!(func & SIM_FUNCS))
+		return -RIG_EINVAL;
+
+	*status = (priv->funcs & func) ? 1 : 0;
+
+	return RIG_OK;
+}
+
+
+/** \brief Switch the rig on or off. */
+static int
+rig_sim_set_powerstat (RIG *rig, powerstat_t status)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_SET_POWERSTAT)) != RIG_OK)
+		return retcode;
+
+	priv->pstat = (status == RIG_POWER_OFF) ? RIG_POWER_OFF : RIG_POWER_ON;
+
+	return RIG_OK;
+}
+
+
+/** \brief Read the power status. */
+static int
+rig_sim_get_powerstat (RIG *rig, powerstat_t *status)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_GET_POWERSTAT)) != RIG_OK)
+		return retcode;
+
+	*status = priv->pstat;
+
+	return RIG_OK;
+}
+
+
+/** \brief Execute a VFO operation. */
+static int
+rig_sim_vfo_op (RIG *rig, vfo_t vfo, vfo_op_t op)
+{
+	sim_priv_t *priv = (sim_priv_t *) rig->state.priv;
+	gint        cur;
+	freq_t      freq;
+	rmode_t     mode;
+	pbwidth_t   width;
+	int         retcode;
+
+
+	if ((retcode = rig_sim_io (rig, SIM_OP_VFO_OP)) != RIG_OK)
+		return retcode;
+
+	cur = rig_sim_vfo_idx (priv, RIG_VFO_CURR);
+
+	switch (op) {
+
+	case RIG_OP_TOGGLE:
+		priv->vfo = cur ? RIG_VFO_A : RIG_VFO_B;
+		break;
+
+	case RIG_OP_CPY:
+		priv->freq[!cur]  = priv->freq[cur];
+		priv->mode[!cur]  = priv->mode[cur];
+		priv->width[!cur] = priv->width[cur];
+		break;
+
+	case RIG_OP_XCHG:
+		freq  = priv->freq[0];
+		mode  = priv->mode[0];
+		width = priv->width[0];
+		priv->freq[0]  = priv->freq[1];
+		priv->mode[0]  = priv->mode[1];
+		priv->width[0] = priv->width[1];
+		priv->freq[1]  = freq;
+		priv->mode[1]  = mode;
+		priv->width[1] = width;
+		break;
+
+	default:
+		return -RIG_EINVAL;
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Simulate the communication with the rig.
+ *  \param rig The rig.
+ *  \param op The call.
+ *  \return RIG_OK, -RIG_ETIMEOUT or -RIG_ERJCTED.
+ *
+ * This function blocks for as long as the real rig would need to answer
+ * and decides whether the call fails. It also advances the value script.
+ */
+static int
+rig_sim_io (RIG *rig, sim_op_t op)
+{
+	sim_priv_t   *priv = (sim_priv_t *) rig->state.priv;
+	sim_timing_t *t = &priv->timing[op];
+	gdouble       usec = 0.0;
+	gdouble       r;
+	gint          rate;
+
+
+	rig_sim_script (priv);
+
+	/* the rig does not answer while switched off */
+	if ((priv->pstat == RIG_POWER_OFF) &&
+	    (op != SIM_OP_GET_POWERSTAT) && (op != SIM_OP_SET_POWERSTAT)) {
+		g_usleep (1000 * rig->state.rigport.timeout);
+		return -RIG_ETIMEOUT;
+	}
+
+	/* serial transfer: 8 data bits plus start and stop bit */
+	rate = rig->state.rigport.parm.serial.rate;
+	if (rate > 0) {
+		usec += 1.0e7 * t->bytes / rate;
+	}
+
+	usec += 1000.0 * t->latency;
+
+	if (t->jitter > 0.0) {
+		usec -= 1000.0 * t->jitter * log (1.0 - g_rand_double (priv->rand));
+	}
+
+	r = g_rand_double_range (priv->rand, 0.0, 100.0);
+
+	if (r < t->timeouts) {
+		g_usleep (1000 * rig->state.rigport.timeout);
+
+		grig_debug_local (RIG_DEBUG_TRACE,
+				  _("%s: Simulated timeout in %s"),
+				  __FUNCTION__, SIM_OP_NAME[op]);
+
+		return -RIG_ETIMEOUT;
+	}
+
+	g_usleep ((gulong) usec);
+
+	if (r < t->timeouts + t->rejects) {
+		grig_debug_local (RIG_DEBUG_TRACE,
+				  _("%s: Simulated reject in %s"),
+				  __FUNCTION__, SIM_OP_NAME[op]);
+
+		return -RIG_ERJCTED;
+	}
+
+	return RIG_OK;
+}
+
+
+/** \brief Advance the value script.
+ *  \param priv The rig state.
+ *
+ * Both VFOs drift at the configured rate since the previous call.
+ */
+static void
+rig_sim_script (sim_priv_t *priv)
+{
+	gint64 now;
+
+
+	now = g_get_monotonic_time ();
+
+	if (priv->drift != 0.0) {
+		priv->freq[0] += priv->drift * (now - priv->last) / 1.0e6;
+		priv->freq[1] += priv->drift * (now - priv->last) / 1.0e6;
+	}
+
+	priv->last = now;
+}
+
+
+/** \brief Get the index of a VFO.
+ *  \param priv The rig state.
+ *  \param vfo The VFO; RIG_VFO_CURR refers to the current VFO.
+ *  \return 1 for VFO B, 0 otherwise.
+ */
+static gint
+rig_sim_vfo_idx (sim_priv_t *priv, vfo_t vfo)
+{
+	if ((vfo == RIG_VFO_CURR) || (vfo == RIG_VFO_NONE)) {
+		vfo = priv->vfo;
+	}
+
+	return ((vfo == RIG_VFO_B) || (vfo == RIG_VFO_SUB)) ? 1 : 0;
+}
+
+
+/** \brief Get a normally distributed random number.
+ *  \param priv The rig state.
+ *  \return A random number with mean 0 and standard deviation 1.
+ */
+static gdouble
+rig_sim_gauss (sim_priv_t *priv)
+{
+	gdouble u1;
+	gdouble u2;
+
+
+	u1 = 1.0 - g_rand_double (priv->rand);
+	u2 = g_rand_double (priv->rand);
+
+	return sqrt (-2.0 * log (u1)) * cos (2.0 * G_PI * u2);
+}
+
+
+/** \brief Load the simfile.
+ *  \param priv The rig state.
+ *
+ * Missing groups and keys keep the values set by the conf parameters.
+ */
+static void
+rig_sim_load_file (sim_priv_t *priv)
+{
+	GKeyFile    *cfg;
+	GError      *error = NULL;
+	const gchar *group;
+	guint        i;
+
+
+	cfg = g_key_file_new ();
+
+	if (!g_key_file_load_from_file (cfg, priv->simfile, G_KEY_FILE_NONE, &error)) {
+		grig_debug_local (RIG_DEBUG_ERR,
+				  _("%s: Could not load %s: %s"),
+				  __FUNCTION__, priv->simfile, error->message);
+		g_clear_error (&error);
+		g_key_file_free (cfg);
+		return;
+	}
+
+	for (i = 0; i < SIM_OP_NUMBER; i++) {
+		group = SIM_OP_NAME[i];
+
+		if (!g_key_file_has_group (cfg, group))
+			continue;
+
+		if (g_key_file_has_key (cfg, group, KEY_LATENCY, NULL))
+			priv->timing[i].latency = MAX (0.0, g_key_file_get_double (cfg, group, KEY_LATENCY, NULL));
+
+		if (g_key_file_has_key (cfg, group, KEY_JITTER, NULL))
+			priv->timing[i].jitter = MAX (0.0, g_key_file_get_double (cfg, group, KEY_JITTER, NULL));
+
+		if (g_key_file_has_key (cfg, group, KEY_TIMEOUTS, NULL))
+			priv->timing[i].timeouts = CLAMP (g_key_file_get_double (cfg, group, KEY_TIMEOUTS, NULL), 0.0, 100.0);
+
+		if (g_key_file_has_key (cfg, group, KEY_REJECTS, NULL))
+			priv->timing[i].rejects = CLAMP (g_key_file_get_double (cfg, group, KEY_REJECTS, NULL), 0.0, 100.0);
+
+		if (g_key_file_has_key (cfg, group, KEY_BYTES, NULL))
+			priv->timing[i].bytes = MAX (0, g_key_file_get_integer (cfg, group, KEY_BYTES, NULL));
+	}
+
+	group = GROUP_SCRIPT;
+
+	if (g_key_file_has_key (cfg, group, KEY_DRIFT, NULL))
+		priv->drift = g_key_file_get_double (cfg, group, KEY_DRIFT, NULL);
+
+	if (g_key_file_has_key (cfg, group, KEY_SMETER, NULL))
+		priv->smeter = g_key_file_get_double (cfg, group, KEY_SMETER, NULL);
+
+	if (g_key_file_has_key (cfg, group, KEY_NOISE, NULL))
+		priv->noise = MAX (0.0, g_key_file_get_double (cfg, group, KEY_NOISE, NULL));
+
+	if (g_key_file_has_key (cfg, group, KEY_FADE_PERIOD, NULL))
+		priv->fadeperiod = MAX (0.0, g_key_file_get_double (cfg, group, KEY_FADE_PERIOD, NULL));
+
+	if (g_key_file_has_key (cfg, group, KEY_FADE_DEPTH, NULL))
+		priv->fadedepth = g_key_file_get_double (cfg, group, KEY_FADE_DEPTH, NULL);
+
+	grig_debug_local (RIG_DEBUG_VERBOSE,
+			  _("%s: Loaded simulation settings from %s"),
+			  __FUNCTION__, priv->simfile);
+
+	g_key_file_free (cfg);
+}
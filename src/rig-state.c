@@ -529,6 +529,20 @@ rig_state_load (const gchar *file)
 							   &(state->power),
 							   &(newval->power));
 
+			/* tell the daemon which values are waiting to be sent */
+			rig_daemon_post_cmd (RIG_CMD_SET_FREQ_1);
+			rig_daemon_post_cmd (RIG_CMD_SET_FREQ_2);
+			rig_daemon_post_cmd (RIG_CMD_SET_RIT);
+			rig_daemon_post_cmd (RIG_CMD_SET_XIT);
+			rig_daemon_post_cmd (RIG_CMD_SET_VFO);
+			rig_daemon_post_cmd (RIG_CMD_SET_SPLIT);
+			rig_daemon_post_cmd (RIG_CMD_SET_LOCK);
+			rig_daemon_post_cmd (RIG_CMD_SET_MODE);
+			rig_daemon_post_cmd (RIG_CMD_SET_ATT);
+			rig_daemon_post_cmd (RIG_CMD_SET_PREAMP);
+			rig_daemon_post_cmd (RIG_CMD_SET_AGC);
+			rig_daemon_post_cmd (RIG_CMD_SET_POWER);
+
 			/* enable daemon */
 			rig_daemon_set_suspend (FALSE);
 		}